@@ -496,12 +496,22 @@ double Max( double v1, double v2){
 	else return v2;
 }
 
-double GTI_DIRINT( const double poa[3], const double inc[3], double zen, double tilt, double ext, double alb, int doy, double tDew, double elev, double& dnOut, double& dfOut, double& ghOut, double poaCompOut[3]){
+/* Iterative GTI-DIRINT solution, with at most maxIterations model evaluations. gtiScale > 0 starts the iteration from the
+   measured POA scaled by it, rather than from the measured POA itself; gtiScaleOut returns the scale of the GTI that gave
+   the best solution, bestDiffOut its difference from the measured POA, and iterations the number of model evaluations */
+static double gti_dirint_solve( const double poa[3], const double inc[3], double zen, double tilt, double ext, double alb, int doy, double tDew, double elev, double gtiScale, int maxIterations,
+	double& dnOut, double& dfOut, double& ghOut, double poaCompOut[3], double &gtiScaleOut, double &bestDiffOut, int &iterations ){
 	
 	double diff = 1E6;
 	double bestDiff = 1E6;
 	double Ktp=0;
 	double GTI[] = { poa[0], poa[1], poa[2] };
+	if (gtiScale > 0)
+	{
+		GTI[0] = Max( 1.0, poa[0] * gtiScale);
+		GTI[1] = Max( 1.0, poa[1] * gtiScale);
+		GTI[2] = Max( 1.0, poa[2] * gtiScale);
+	}
 
 	double Ci[30] = {1., 1., 1., 0.5, 0.5,
 					 0.5, 0.5, 0.5, 0.5, 0.5,
@@ -511,19 +521,20 @@ double GTI_DIRINT( const double poa[3], const double inc[3], double zen, double
 					 0.125, 0.125, 0.125, 0.125, 0.125};
 
 	double poa_tmp[3], diffc_tmp[3], poaBest[3] = {0, 0, 0};
+	double gtiBest = GTI[1];
 	
 	// Begin iterative solution for Kt
 //	double Io = 1367.0 * (1.0 + 0.033 * cos(0.0172142 * doy));    // Extraterrestrial dn (Taken from DIRINT Model)
 	double cz = cos(zen);
 	int i = 0;
 	
-	while (fabs(diff) > 1.0 && i++ < 30 ){
+	while (fabs(diff) > 1.0 && i++ < maxIterations ){
 
 		// Calculate Kt using GTI and Eq. 2
 //		double Kt_inc = GTI[1] / (Io * Max(0.065, cos(inc[1])));
 
-		//Calculate DNI using Kt and DIRINT Eq.s
-		double dn_tmp;
+		//Calculate DNI using Kt and DIRINT Eq.s, which leaves dn unchanged if the GTI is missing
+		double dn_tmp = 0;
 		double Ktp_tmp = ModifiedDISC( GTI, inc, tDew, elev, doy, dn_tmp);
 
 		//Calculate DHI using Eq. 3
@@ -545,8 +556,13 @@ double GTI_DIRINT( const double poa[3], const double inc[3], double zen, double
 			poaBest[0] = poa_tmp[0];
 			poaBest[1] = poa_tmp[1];
 			poaBest[2] = poa_tmp[2];
+			gtiBest = GTI[1];
 		}
 
+		// the last iteration's adjustment would not be used
+		if (i == maxIterations)
+			break;
+
 		// Adjust GTI using Eq. 4
 		// Apply the same change to previous/ subsequent GTI's as well (based on Bill's email)
 		GTI[0] = Max( 1.0, GTI[0] - Ci[i] * diff);
@@ -561,9 +577,40 @@ double GTI_DIRINT( const double poa[3], const double inc[3], double zen, double
 
 	ghOut = dnOut * cos(inc[1]) + dfOut;
 
+	gtiScaleOut = (poa[1] > 0) ? gtiBest / poa[1] : 0;
+	bestDiffOut = bestDiff;
+	iterations = i;
+
 	return Ktp;
 }
 
+double GTI_DIRINT( const double poa[3], const double inc[3], double zen, double tilt, double ext, double alb, int doy, double tDew, double elev, double& dnOut, double& dfOut, double& ghOut, double poaCompOut[3]){
+	double gtiScale, bestDiff;
+	int iterations;
+	return gti_dirint_solve( poa, inc, zen, tilt, ext, alb, doy, tDew, elev, 0, 30, dnOut, dfOut, ghOut, poaCompOut, gtiScale, bestDiff, iterations );
+}
+
+/* zero negative decomposed irradiances, returning 40, 41, or 42 if dni, dhi, or ghi was negative */
+static int poa_decomp_error( double &dn, double &df, double &gh ){
+	int errorcode = 0;
+	if (gh < 0)
+	{
+		gh = 0;
+		errorcode = 42;
+	}
+	if (df < 0) //check for df before gh because gh is only calculated using dn and df, so is least likely to be the actual culprit
+	{
+		df = 0;
+		errorcode = 41;
+	}
+	if (dn < 0) //check for dn last because it is the most likely culprit of the problem
+	{
+		dn = 0;
+		errorcode = 40;
+	}
+	return errorcode;
+}
+
 int poaDecomp( double , double angle[], double sun[], double alb, poaDecompReq *pA, double &dn, double &df, double &gh, double poa[3], double diffc[3]){
 
 	int errorcode = 0; //code to return whether the decomposition method succeeded or failed
@@ -641,23 +688,107 @@ int poaDecomp( double , double angle[], double sun[], double alb, poaDecompReq *
 	}
 
 	//Check for bad values and return an error code as applicable
-	if (gh < 0)
-	{
-		gh = 0;
-		errorcode = 42;
-	}
-	if (df < 0) //check for df before gh because gh is only calculated using dn and df, so is least likely to be the actual culprit
-	{
-		df = 0;
-		errorcode = 41;
+	errorcode = poa_decomp_error(dn, df, gh);
+
+	return errorcode;
+}
+
+int poaDecomp_batch( poaDecompReq &pA, size_t start, size_t n, const double *tDew, double alb, bool warmStart,
+	double *dn, double *df, double *gh, double *poa[3], int *errorcode, poa_decomp_stats *stats ){
+
+	poa_decomp_stats counts;
+	double r90(M_PI/2);
+	size_t stepsInDay = 24;
+	if( pA.stepScale == 'm'){
+		stepsInDay *= 60 / (unsigned int)pA.stepSize;
 	}
-	if (dn < 0) //check for dn last because it is the most likely culprit of the problem
+	size_t nSteps = pA.POA.size();
+
+	double gtiScale = 0; // scale of the previous step's solution, 0 if there is none to start from
+	double previousKtp = 0; // Kt prime of the previous step's solution
+	for (size_t k = 0; k < n; k++)
 	{
-		dn = 0;
-		errorcode = 40;
+		size_t i = start + k;
+		double poaStep[3] = { 0, 0, 0 };
+		dn[k] = df[k] = gh[k] = 0;
+		errorcode[k] = 0;
+
+		// sun below the horizon, flagged by the -999 incidence angle from the POA set up
+		if (pA.inc[i] == -999)
+		{
+			counts.night++;
+			gtiScale = 0;
+			previousKtp = 0;
+			for (size_t j = 0; j < 3; j++) poa[j][k] = 0;
+			continue;
+		}
+		counts.steps++;
+
+		int code = 0;
+		pA.i = i;
+		pA.dayStart = i - i % stepsInDay;
+		pA.doy = (int)(i / stepsInDay);
+		pA.tDew = tDew[k];
+
+		double angle[5] = { pA.inc[i], pA.tilt[i], 0, 0, 0 };
+		double sun[9] = { 0, pA.zen[i], 0, 0, 0, 0, 0, 0, pA.exTer[i] };
+
+		if ( angle[0] < r90 ){
+			// readings outside the POA data are missing to ModifiedDISC
+			double gti[] = { (i > 0) ? pA.POA[ i-1 ] : -999, pA.POA[ i ], (i + 1 < nSteps) ? pA.POA[ i+1 ] : -999 };
+			double inc[] = { (i > 0) ? pA.inc[ i-1 ] : -999, pA.inc[ i ], (i + 1 < nSteps) ? pA.inc[ i+1 ] : -999 };
+
+			// the clearness of the measured POA on the plane (Eq. 2) tells a steady sky from a passing cloud without any model evaluation
+			double Io = 1367.0 * (1.0 + 0.033 * cos(0.0172142 * pA.doy));
+			bool steady = gti[0] > 0 && fabs(gti[1] / Max(0.065, cos(inc[1])) - gti[0] / Max(0.065, cos(inc[0]))) <= 0.15 * Io;
+			if (gtiScale > 0 && steady && previousKtp >= 0.7) counts.clearSky++;
+			if (warmStart && gtiScale > 0 && !steady) counts.skyChanges++;
+
+			double scale = 0, bestDiff = 0;
+			int iterations = 0;
+			bool warm = warmStart && gtiScale > 0 && steady;
+			double Ktp = gti_dirint_solve( gti, inc, sun[1], angle[1], sun[8], alb, pA.doy, pA.tDew, pA.elev, warm ? gtiScale : 0, warm ? 5 : 30, dn[k], df[k], gh[k], poaStep, scale, bestDiff, iterations );
+			counts.iterations += iterations;
+			if (warm) counts.warmStarts++;
+
+			// a warm start that did not converge in a few evaluations repeats the solution from the measured POA, keeping the better one
+			if (warm && fabs(bestDiff) > 1.0)
+			{
+				double dnCold, dfCold, ghCold, poaCold[3], scaleCold, bestDiffCold;
+				double KtpCold = gti_dirint_solve( gti, inc, sun[1], angle[1], sun[8], alb, pA.doy, pA.tDew, pA.elev, 0, 30, dnCold, dfCold, ghCold, poaCold, scaleCold, bestDiffCold, iterations );
+				counts.iterations += iterations;
+				counts.coldRestarts++;
+				if (fabs(bestDiffCold) <= fabs(bestDiff))
+				{
+					dn[k] = dnCold; df[k] = dfCold; gh[k] = ghCold;
+					for (size_t j = 0; j < 3; j++) poaStep[j] = poaCold[j];
+					scale = scaleCold;
+					bestDiff = bestDiffCold;
+					Ktp = KtpCold;
+				}
+			}
+			if (iterations == 1 && fabs(bestDiff) <= 1.0) counts.firstPass++;
+			gtiScale = (fabs(bestDiff) <= 1.0) ? scale : 0;
+			previousKtp = Ktp;
+			code = poa_decomp_error(dn[k], df[k], gh[k]);
+		}
+		else {
+			// incidence beyond 90 degrees uses the day's average Kt prime, as poaDecomp() does
+			double diffc[3];
+			code = poaDecomp( pA.POA[i], angle, sun, alb, &pA, dn[k], df[k], gh[k], poaStep, diffc );
+			counts.iterations++;
+			gtiScale = 0;
+			previousKtp = 0;
+		}
+
+		for (size_t j = 0; j < 3; j++) poa[j][k] = poaStep[j];
+		errorcode[k] = code;
+		if (code != 0)
+			counts.errors++;
 	}
 
-	return errorcode;
+	if (stats != 0) *stats = counts;
+	return (int)counts.errors;
 }
 
 void isotropic( double , double dn, double df, double alb, double inc, double tilt, double zen, double poa[3], double diffc[3] )
@@ -831,6 +962,229 @@ void perez( double , double dn, double df, double alb, double inc, double tilt,
 		}
 }
 
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__) && defined(__linux__)
+// compile the vector kernels for each instruction set, and pick one at load time for the processor
+#define IRRADPROC_BATCH_KERNEL __attribute__((target_clones("avx512f","avx2","default")))
+#else
+#define IRRADPROC_BATCH_KERNEL
+#endif
+
+// the vector kernels work through their inputs in blocks small enough to keep the scratch arrays on the stack
+#define IRRADPROC_BATCH_BLOCK 256
+
+void solarpos_batch(size_t n, const int *year, const int *month, const int *day, const int *hour, const double *minute,
+	double lat, double lng, double tz, double *sunn[9])
+{
+	for (size_t i = 0; i < n; i++)
+	{
+		double sun[9];
+		solarpos(year[i], month[i], day[i], hour[i], minute[i], lat, lng, tz, sun);
+		for (int k = 0; k < 9; k++)
+			sunn[k][i] = sun[k];
+	}
+}
+
+IRRADPROC_BATCH_KERNEL
+void incidence_batch(size_t n, int mode, double tilt, double sazm, double rlim, const double *zen, const double *azm,
+	bool en_backtrack, double gcr, double *angle[5])
+{
+	if (mode == 4)
+		mode = 0; //treat timeseries tilt as fixed tilt for each timestep
+
+	if (mode != 0 && mode != 3)
+	{
+		for (size_t i = 0; i < n; i++)
+		{
+			double a[5];
+			incidence(mode, tilt, sazm, rlim, zen[i], azm[i], en_backtrack, gcr, a);
+			for (int k = 0; k < 5; k++)
+				angle[k][i] = a[k];
+		}
+		return;
+	}
+
+	// a fixed surface, or one turned to the sun azimuth, has the same tilt at every step: libm evaluates
+	// the sines and cosines, and the incidence argument is branch-free arithmetic in between
+	double tiltRadians = tilt*DTOR;
+	double sazmRadians = sazm*DTOR;
+	double sinTilt = sin(tiltRadians);
+	double cosTilt = cos(tiltRadians);
+	double sz[IRRADPROC_BATCH_BLOCK], cz[IRRADPROC_BATCH_BLOCK], ca[IRRADPROC_BATCH_BLOCK], arg[IRRADPROC_BATCH_BLOCK];
+	for (size_t i0 = 0; i0 < n; i0 += IRRADPROC_BATCH_BLOCK)
+	{
+		size_t m = (n - i0 < IRRADPROC_BATCH_BLOCK) ? n - i0 : IRRADPROC_BATCH_BLOCK;
+		for (size_t j = 0; j < m; j++)
+		{
+			sz[j] = sin(zen[i0 + j]);
+			cz[j] = cos(zen[i0 + j]);
+			ca[j] = cos(azm[i0 + j] - ((mode == 0) ? sazmRadians : azm[i0 + j]));
+		}
+
+		// clamping to [-1,1] gives acos() of pi and 0, the values incidence() assigns outside that range
+		for (size_t j = 0; j < m; j++)
+		{
+			double x = sz[j]*ca[j]*sinTilt + cz[j]*cosTilt;
+			arg[j] = (x < -1.0) ? -1.0 : (x > 1.0) ? 1.0 : x;
+		}
+
+		for (size_t j = 0; j < m; j++)
+		{
+			size_t i = i0 + j;
+			angle[0][i] = acos(arg[j]);
+			angle[1][i] = tiltRadians;
+			angle[2][i] = (mode == 0) ? sazmRadians : azm[i];
+			angle[3][i] = 0;
+			angle[4][i] = 0;
+		}
+	}
+}
+
+/// Perez coefficient for the sky clearness bin of EPS, selected without a search so the caller's loop can vectorize
+static inline double perez_bin(const double F[8], double EPS)
+{
+	double f = F[0];
+	f = (EPS > 1.065) ? F[1] : f;
+	f = (EPS > 1.23) ? F[2] : f;
+	f = (EPS > 1.5) ? F[3] : f;
+	f = (EPS > 1.95) ? F[4] : f;
+	f = (EPS > 2.8) ? F[5] : f;
+	f = (EPS > 4.5) ? F[6] : f;
+	f = (EPS > 6.2) ? F[7] : f;
+	return f;
+}
+
+IRRADPROC_BATCH_KERNEL
+void perez_batch(size_t n, const double *, const double *dn, const double *df, const double *alb, const double *inc,
+	const double *tilt, const double *zen, double *poa[3], double *diffc[3])
+{
+	static const double F11R[8] = { -0.0083117, 0.1299457, 0.3296958, 0.5682053, 0.8730280, 1.1326077, 1.0601591, 0.6777470 };
+	static const double F12R[8] = { 0.5877285, 0.6825954, 0.4868735, 0.1874525, -0.3920403, -1.2367284, -1.5999137, -0.3272588 };
+	static const double F13R[8] = { -0.0620636, -0.1513752, -0.2210958, -0.2951290, -0.3616149, -0.4118494, -0.3589221, -0.2504286 };
+	static const double F21R[8] = { -0.0596012, -0.0189325, 0.0554140, 0.1088631, 0.2255647, 0.2877813, 0.2642124, 0.1561313 };
+	static const double F22R[8] = { 0.0721249, 0.0659650, -0.0639588, -0.1519229, -0.4620442, -0.8230357, -1.1272340, -1.3765031 };
+	static const double F23R[8] = { -0.0220216, -0.0288748, -0.0260542, -0.0139754, 0.0012448, 0.0558651, 0.1310694, 0.2506212 };
+	const double B2 = 0.000005534;
+
+	// libm terms of each step, evaluated the way perez() does; the power terms only where the full model runs
+	double cz[IRRADPROC_BATCH_BLOCK], ci[IRRADPROC_BATCH_BLOCK], ct[IRRADPROC_BATCH_BLOCK], st[IRRADPROC_BATCH_BLOCK];
+	double am[IRRADPROC_BATCH_BLOCK], zen3[IRRADPROC_BATCH_BLOCK];
+	// results of the block, written to the caller's arrays afterwards so the arithmetic loop has no aliasing to check
+	double p0[IRRADPROC_BATCH_BLOCK], p1[IRRADPROC_BATCH_BLOCK], p2[IRRADPROC_BATCH_BLOCK];
+	double d0[IRRADPROC_BATCH_BLOCK], d1[IRRADPROC_BATCH_BLOCK], d2[IRRADPROC_BATCH_BLOCK];
+	double dnb[IRRADPROC_BATCH_BLOCK], dfb[IRRADPROC_BATCH_BLOCK], albb[IRRADPROC_BATCH_BLOCK], zenb[IRRADPROC_BATCH_BLOCK];
+
+	for (size_t i0 = 0; i0 < n; i0 += IRRADPROC_BATCH_BLOCK)
+	{
+		size_t m = (n - i0 < IRRADPROC_BATCH_BLOCK) ? n - i0 : IRRADPROC_BATCH_BLOCK;
+		for (size_t j = 0; j < m; j++)
+		{
+			size_t i = i0 + j;
+			dnb[j] = dn[i];
+			dfb[j] = df[i];
+			albb[j] = alb[i];
+			zenb[j] = zen[i];
+			cz[j] = cos(zen[i]);
+			ci[j] = cos(inc[i]);
+			ct[j] = cos(tilt[i]);
+			st[j] = sin(tilt[i]);
+			am[j] = zen3[j] = 0;
+			if (zen[i] >= 0.0 && zen[i] <= 1.5271631 && df[i] > 0.0)
+			{
+				double ZENITH = zen[i]/DTOR;
+				am[j] = pow(93.9 - ZENITH, -1.253);
+				zen3[j] = pow(ZENITH, 3.0);
+			}
+		}
+
+		// every branch of perez() is evaluated and the one that applies is selected, so this loop vectorizes
+		for (size_t j = 0; j < m; j++)
+		{
+			double DN = (dnb[j] < 0.0) ? 0.0 : dnb[j];
+			double z = zenb[j];
+			double D = dfb[j];
+			double CZ = cz[j];
+			double COSINC = ci[j];
+			bool lowSun = (z < 0.0) | (z > 1.5271631);
+
+			// zenith beyond 87.5 degrees: isotropic diffuse only, with beam while the sun is above the horizon
+			double dfIso = (D < 0.0) ? 0.0 : D;
+			double isoSky = dfIso*( 1.0 + ct[j] )/2.0;
+			double beamInc = DN*COSINC;
+			double isoBeam = ((COSINC > 0.0) & (z < 1.5707963)) ? beamInc : 0.0;
+
+			// no diffuse: beam only
+			double beamOnly = (COSINC > 0.0) ? beamInc : 0.0;
+
+			// full model, with the brightness bin selected by comparisons instead of a search
+			double ZH = ( CZ > 0.0871557 ) ? CZ:0.0871557;
+			double AIRMASS = 1.0 / (CZ + 0.15 * am[j]);
+			double DELTA = D * AIRMASS / 1367.0;
+			double T = zen3[j];
+			double EPS = (DN + D) / D;
+			EPS = (EPS + T*B2) / (1.0 + T*B2);
+			double x = perez_bin(F11R, EPS) + perez_bin(F12R, EPS)*DELTA + perez_bin(F13R, EPS)*z;
+			double F1 = ( 0.0 > x ) ? 0.0:x;
+			double F2 = perez_bin(F21R, EPS) + perez_bin(F22R, EPS)*DELTA + perez_bin(F23R, EPS)*z;
+			double ZC = ( COSINC < 0.0 ) ? 0.0 : COSINC;
+			double A = D*(1-F1)*( 1.0 + ct[j] )/2.0;
+			double B = D*F1*ZC/ZH;
+			double C = D*F2*st[j];
+
+			bool full = !lowSun & (D > 0.0);
+			p0[j] = lowSun ? isoBeam : full ? DN*ZC : beamOnly;
+			p1[j] = lowSun ? isoSky : full ? A + B + C : 0.0;
+			p2[j] = full ? albb[j]*(DN*CZ+D)*(1.0 - ct[j] )/2.0 : 0.0;
+			d0[j] = lowSun ? isoSky : full ? A : 0.0;
+			d1[j] = full ? B : 0.0;
+			d2[j] = full ? C : 0.0;
+		}
+
+		for (size_t j = 0; j < m; j++)
+		{
+			size_t i = i0 + j;
+			poa[0][i] = p0[j];
+			poa[1][i] = p1[j];
+			poa[2][i] = p2[j];
+			if (diffc != 0)
+			{
+				diffc[0][i] = d0[j];
+				diffc[1][i] = d1[j];
+				diffc[2][i] = d2[j];
+			}
+		}
+	}
+}
+
+void isotropic_batch(size_t n, const double *hextra, const double *dn, const double *df, const double *alb, const double *inc,
+	const double *tilt, const double *zen, double *poa[3], double *diffc[3])
+{
+	for (size_t i = 0; i < n; i++)
+	{
+		double p[3], d[3];
+		isotropic(hextra[i], dn[i], df[i], alb[i], inc[i], tilt[i], zen[i], p, diffc != 0 ? d : 0);
+		for (int k = 0; k < 3; k++)
+			poa[k][i] = p[k];
+		if (diffc != 0)
+			for (int k = 0; k < 3; k++)
+				diffc[k][i] = d[k];
+	}
+}
+
+void hdkr_batch(size_t n, const double *hextra, const double *dn, const double *df, const double *alb, const double *inc,
+	const double *tilt, const double *zen, double *poa[3], double *diffc[3])
+{
+	for (size_t i = 0; i < n; i++)
+	{
+		double p[3], d[3];
+		hdkr(hextra[i], dn[i], df[i], alb[i], inc[i], tilt[i], zen[i], p, diffc != 0 ? d : 0);
+		for (int k = 0; k < 3; k++)
+			poa[k][i] = p[k];
+		if (diffc != 0)
+			for (int k = 0; k < 3; k++)
+				diffc[k][i] = d[k];
+	}
+}
+
 void irrad::setup()
 {
 	year = month = day = hour = -999;
@@ -848,6 +1202,9 @@ void irrad::setup()
 
 	calculatedDirectNormal = directNormal;
 	calculatedDiffuseHorizontal = 0.0;
+
+	sunPositionCache = 0;
+	sunPositionIndex = 0;
 }
 irrad::irrad()
 {
@@ -857,7 +1214,7 @@ irrad::irrad(weather_record wf, weather_header hdr,
 	int skyModelIn, int radiationModeIn, int trackModeIn,
 	bool useWeatherFileAlbedo, bool instantaneousWeather, bool backtrackingEnabled,
 	double dtHour, double tiltDegreesIn, double azimuthDegreesIn, double trackerRotationLimitDegreesIn, double groundCoverageRatioIn,
-	std::vector<double> monthlyTiltDegrees, std::vector<double> userSpecifiedAlbedo, 
+	const std::vector<double> &monthlyTiltDegrees, const std::vector<double> &userSpecifiedAlbedo, 
 	poaDecompReq * poaAllIn) : 
 	skyModel(skyModelIn), radiationMode(radiationModeIn), trackingMode(trackModeIn), enableBacktrack(backtrackingEnabled),
 	delt(dtHour), tiltDegrees(tiltDegreesIn), surfaceAzimuthDegrees(azimuthDegreesIn), rotationLimitDegrees(trackerRotationLimitDegreesIn),
@@ -1046,29 +1403,31 @@ void irrad::set_sun_component(size_t index, double value)
 	}
 }
 
-int irrad::calc()
+sun_position_cache::sun_position_cache(double latitudeDegreesIn, double longitudeDegreesIn, double timezoneIn, size_t numberOfSteps)
+	: latitudeDegrees(latitudeDegreesIn), longitudeDegrees(longitudeDegreesIn), timezone(timezoneIn),
+	steps(numberOfSteps), numberOfHits(0)
 {
-	int code = check();
-	if ( code < 0 )
-		return -100+code;
-/*
-	calculates effective sun position at current timestep, with delt specified in hours
+}
 
-	sunAnglesRadians: results from solarpos
-	timeStepSunPosition: [0]  effective hour of day used for sun position
-			[1]  effective minute of hour used for sun position
-			[2]  is sun up?  (0=no, 1=midday, 2=sunup, 3=sundown)
-	surfaceAnglesRadians: result from incidence
-	planeOfArrayIrradianceFront: result from sky model
-	diff: broken out diffuse components from sky model
-*/	
-	double t_cur = hour + minute/60.0;
+bool sun_position_cache::at_location(double lat, double lon, double tz) const
+{
+	return lat == latitudeDegrees && lon == longitudeDegrees && tz == timezone;
+}
 
-	// calculate sunrise and sunset hours in local standard time for the current day
-	solarpos( year, month, day, 12, 0.0, latitudeDegrees, longitudeDegrees, timezone, sunAnglesRadians );
+void irrad::set_sun_position_cache(sun_position_cache * cache, size_t index)
+{
+	sunPositionCache = cache;
+	sunPositionIndex = index;
+}
 
-	double t_sunrise = sunAnglesRadians[4];
-	double t_sunset = sunAnglesRadians[5];
+/// Find the sunrise and sunset hours in local standard time that irrad::calc() uses for a day
+static void sunrise_sunset(int year, int month, int day, double latitudeDegrees, double longitudeDegrees, double timezone, double *sunrise, double *sunset)
+{
+	double sunanglesnoon[9];
+	solarpos( year, month, day, 12, 0.0, latitudeDegrees, longitudeDegrees, timezone, sunanglesnoon );
+
+	double t_sunrise = sunanglesnoon[4];
+	double t_sunset = sunanglesnoon[5];
 
 	if (t_sunset > 24.0 && t_sunset != 100.0) //sunset is legitimately the next day but we're not in endless days, so recalculate sunset from the previous day
 	{
@@ -1104,54 +1463,204 @@ int irrad::calc()
 			t_sunrise = sunanglestemp[4] + 24.0;
 	}
 
+	*sunrise = t_sunrise;
+	*sunset = t_sunset;
+}
+
+void irrad::calc_sunrise_sunset(double *sunrise, double *sunset)
+{
+	sunrise_sunset(year, month, day, latitudeDegrees, longitudeDegrees, timezone, sunrise, sunset);
+}
+
+/// Find the time used for the sun position of a time step, returning whether the sun is up (0=no, 1=midday, 2=sunrise, 3=sunset)
+static int sun_position_time(int hour, double minute, double delt, double t_sunrise, double t_sunset, int *hr_calc, double *min_calc)
+{
+	double t_cur = hour + minute/60.0;
+
 	// recall: if delt <= 0.0, do not interpolate sunrise and sunset hours, just use specified time stamp
 	// time step encompasses the sunrise
 	if ( delt > 0 && t_cur >= t_sunrise - delt/2.0 && t_cur < t_sunrise + delt/2.0 )
 	{
 		double t_calc = (t_sunrise + (t_cur+delt/2.0))/2.0; // midpoint of sunrise and end of timestep
-		int hr_calc = (int)t_calc;
-		double min_calc = (t_calc-hr_calc)*60.0;
-
-		timeStepSunPosition[0] = hr_calc;
-		timeStepSunPosition[1] = (int)min_calc;
-				
-		solarpos( year, month, day, hr_calc, min_calc, latitudeDegrees, longitudeDegrees, timezone, sunAnglesRadians );
-
-		timeStepSunPosition[2] = 2;				
+		*hr_calc = (int)t_calc;
+		*min_calc = (t_calc-*hr_calc)*60.0;
+		return 2;
 	}
 	// timestep encompasses the sunset
 	else if ( delt > 0 && t_cur > t_sunset - delt/2.0 && t_cur <= t_sunset + delt/2.0 )
 	{
 		double t_calc = ( (t_cur-delt/2.0) + t_sunset )/2.0; // midpoint of beginning of timestep and sunset
-		int hr_calc = (int)t_calc;
-		double min_calc = (t_calc-hr_calc)*60.0;
+		*hr_calc = (int)t_calc;
+		*min_calc = (t_calc-*hr_calc)*60.0;
+		return 3;
+	}
 
-		timeStepSunPosition[0] = hr_calc;
-		timeStepSunPosition[1] = (int)min_calc;
-				
-		solarpos( year, month, day, hr_calc, min_calc, latitudeDegrees, longitudeDegrees, timezone, sunAnglesRadians );
+	// otherwise the sun position is calculated at the time stamp
+	*hr_calc = hour;
+	*min_calc = minute;
 
-		timeStepSunPosition[2] = 3;
-	}
-	// timestep is not sunrise nor sunset, but sun is up  (calculate position at provided t_cur)
-	else if ( (t_sunrise < t_sunset && t_cur >= t_sunrise && t_cur <= t_sunset) || //this captures normal daylight cases
+	// timestep is not sunrise nor sunset, but sun is up
+	if ( (t_sunrise < t_sunset && t_cur >= t_sunrise && t_cur <= t_sunset) || //this captures normal daylight cases
 		(t_sunrise > t_sunset && (t_cur <= t_sunset || t_cur >= t_sunrise)) ) //this captures cases where sunset (from previous day) is 1:30AM, sunrise 2:30AM, in arctic circle
-	{				
-		timeStepSunPosition[0] = hour;
-		timeStepSunPosition[1] = (int)minute;
-		solarpos( year, month, day, hour, minute, latitudeDegrees, longitudeDegrees, timezone, sunAnglesRadians );
-		timeStepSunPosition[2] = 1;
+		return 1;
+
+	// sun is down, assign sundown values
+	return 0;
+}
+
+void sun_position_batch(size_t n, const int *year, const int *month, const int *day, const int *hour, const double *minute,
+	double delt, double lat, double lng, double tz, double *sunn[9], int *sunpos[3])
+{
+	// sunrise and sunset change once per day, then each step only needs the time used for its sun position
+	std::vector<double> minuteCalc(n);
+	int key = -1;
+	double t_sunrise = 0, t_sunset = 0;
+	for (size_t i = 0; i < n; i++)
+	{
+		int dayKey = year[i] * 10000 + month[i] * 100 + day[i];
+		if (dayKey != key)
+		{
+			sunrise_sunset(year[i], month[i], day[i], lat, lng, tz, &t_sunrise, &t_sunset);
+			key = dayKey;
+		}
+		sunpos[2][i] = sun_position_time(hour[i], minute[i], delt, t_sunrise, t_sunset, &sunpos[0][i], &minuteCalc[i]);
+		sunpos[1][i] = (int)minuteCalc[i];
+	}
+
+	solarpos_batch(n, year, month, day, sunpos[0], &minuteCalc[0], lat, lng, tz, sunn);
+}
+
+bool sun_position_cache::precompute(weather_data_provider &weatherData, double delt)
+{
+	size_t n = weatherData.nrecords();
+	std::vector<int> year(n), month(n), day(n), hour(n);
+	std::vector<double> minute(n);
+
+	// read the time stamps from the first record, leaving the position where it was
+	size_t position = (size_t)weatherData.get_counter_value();
+	weatherData.rewind();
+	weather_record rec;
+	for (size_t i = 0; i < n; i++)
+	{
+		if (!weatherData.read(&rec))
+		{
+			weatherData.set_counter_to(position);
+			return false;
+		}
+		year[i] = rec.year;
+		month[i] = rec.month;
+		day[i] = rec.day;
+		hour[i] = rec.hour;
+		minute[i] = rec.minute;
+	}
+	weatherData.set_counter_to(position);
+
+	std::vector<double> sun(9 * n);
+	std::vector<int> pos(3 * n);
+	double *sunn[9];
+	int *sunpos[3];
+	for (size_t k = 0; k < 9; k++) sunn[k] = &sun[0] + k * n;
+	for (size_t k = 0; k < 3; k++) sunpos[k] = &pos[0] + k * n;
+	if (n > 0)
+		sun_position_batch(n, &year[0], &month[0], &day[0], &hour[0], &minute[0], delt, latitudeDegrees, longitudeDegrees, timezone, sunn, sunpos);
+
+	if (steps.size() < n)
+		steps.resize(n);
+	for (size_t i = 0; i < n; i++)
+	{
+		step &s = steps[i];
+		s.valid = true;
+		s.year = year[i];
+		s.month = month[i];
+		s.day = day[i];
+		s.hour = hour[i];
+		s.minute = minute[i];
+		s.delt = delt;
+		for (int k = 0; k < 9; k++) s.sunAnglesRadians[k] = sunn[k][i];
+		for (int k = 0; k < 3; k++) s.timeStepSunPosition[k] = sunpos[k][i];
+	}
+	return true;
+}
+
+void irrad::calc_sun_position()
+{
+	// the sun position depends only on location and time, so a cached step with the same time is reused as is
+	sun_position_cache::step *cached = 0;
+	if (sunPositionCache && sunPositionIndex < sunPositionCache->steps.size()
+		&& sunPositionCache->at_location(latitudeDegrees, longitudeDegrees, timezone))
+	{
+		cached = &sunPositionCache->steps[sunPositionIndex];
+		if (cached->valid && cached->year == year && cached->month == month && cached->day == day
+			&& cached->hour == hour && cached->minute == minute && cached->delt == delt)
+		{
+			for (int i = 0; i < 9; i++) sunAnglesRadians[i] = cached->sunAnglesRadians[i];
+			for (int i = 0; i < 3; i++) timeStepSunPosition[i] = cached->timeStepSunPosition[i];
+			sunPositionCache->numberOfHits++;
+			return;
+		}
+	}
+
+	// calculate sunrise and sunset hours in local standard time for the current day
+	double t_sunrise, t_sunset;
+	if (cached)
+	{
+		int key = year * 10000 + month * 100 + day;
+		std::lock_guard<std::mutex> lock(sunPositionCache->sunriseSunsetLock);
+		std::unordered_map<int, std::pair<double, double> >::iterator it = sunPositionCache->sunriseSunset.find(key);
+		if (it != sunPositionCache->sunriseSunset.end())
+		{
+			t_sunrise = it->second.first;
+			t_sunset = it->second.second;
+			sunPositionCache->numberOfHits++;
+		}
+		else
+		{
+			calc_sunrise_sunset(&t_sunrise, &t_sunset);
+			sunPositionCache->sunriseSunset[key] = std::make_pair(t_sunrise, t_sunset);
+		}
 	}
 	else
-	{	
-		// sun is down, assign sundown values
-		solarpos(year, month, day, hour, minute, latitudeDegrees, longitudeDegrees, timezone, sunAnglesRadians);
-		timeStepSunPosition[0] = hour;
-		timeStepSunPosition[1] = (int)minute;
-		timeStepSunPosition[2] = 0;
+		calc_sunrise_sunset(&t_sunrise, &t_sunset);
+
+	int hr_calc;
+	double min_calc;
+	timeStepSunPosition[2] = sun_position_time(hour, minute, delt, t_sunrise, t_sunset, &hr_calc, &min_calc);
+	timeStepSunPosition[0] = hr_calc;
+	timeStepSunPosition[1] = (int)min_calc;
+	solarpos( year, month, day, hr_calc, min_calc, latitudeDegrees, longitudeDegrees, timezone, sunAnglesRadians );
+
+	if (cached)
+	{
+		cached->valid = true;
+		cached->year = year;
+		cached->month = month;
+		cached->day = day;
+		cached->hour = hour;
+		cached->minute = minute;
+		cached->delt = delt;
+		for (int i = 0; i < 9; i++) cached->sunAnglesRadians[i] = sunAnglesRadians[i];
+		for (int i = 0; i < 3; i++) cached->timeStepSunPosition[i] = timeStepSunPosition[i];
 	}
+}
+
+int irrad::calc()
+{
+	int code = check();
+	if ( code < 0 )
+		return -100+code;
+/*
+	calculates effective sun position at current timestep, with delt specified in hours
+
+	sunAnglesRadians: results from solarpos
+	timeStepSunPosition: [0]  effective hour of day used for sun position
+			[1]  effective minute of hour used for sun position
+			[2]  is sun up?  (0=no, 1=midday, 2=sunup, 3=sundown)
+	surfaceAnglesRadians: result from incidence
+	planeOfArrayIrradianceFront: result from sky model
+	diff: broken out diffuse components from sky model
+*/	
+	calc_sun_position();
 
-			
 	planeOfArrayIrradianceFront[0]=planeOfArrayIrradianceFront[1]=planeOfArrayIrradianceFront[2] = 0;
 	diffuseIrradianceFront[0]=diffuseIrradianceFront[1]=diffuseIrradianceFront[2] = 0;
 	surfaceAnglesRadians[0]=surfaceAnglesRadians[1]=surfaceAnglesRadians[2]=surfaceAnglesRadians[3]=surfaceAnglesRadians[4] = 0;
@@ -1223,64 +1732,50 @@ int irrad::calc()
 
 }
 
-int irrad::calc_rear_side(double transmissionFactor, double groundClearanceHeight, double slopeLength)
+bifacial_view_factors::bifacial_view_factors()
+	: groundValid(false), groundRowToRow(0), groundVerticalHeight(0), groundClearanceGround(0), groundDistanceBetweenRows(0), groundHorizontalLength(0),
+	groundPosition(intervals), skyConfigFactors(intervals),
+	rearGroundShade(intervals), frontGroundShade(intervals), rearGroundGHI(intervals), frontGroundGHI(intervals),
+	frontIrradiance(cellRows), frontReflected(cellRows), rearIrradiance(cellRows), numberOfHits(0)
 {
-	// do irradiance calculations if sun is up
-	if (timeStepSunPosition[2] > 0)
+	for (size_t i = 0; i < cellRows; i++)
 	{
-
-		double tiltRadian = surfaceAnglesRadians[1];		// The tracked angle in radians
-
-		// Update ground clearance height for HSAT
-		if (this->trackingMode == 1) {
-			groundClearanceHeight = groundClearanceHeight - (0.5 * slopeLength) * sin(fabs(tiltRadian));
-		}
-
-		// System geometry
-		double rowToRow = slopeLength / this->groundCoverageRatio;		// Row to row spacing between the front of one row to the front of the next row
-		double clearanceGround = groundClearanceHeight;					// The normalized clearance from the bottom edge of module to ground
-		double distanceBetweenRows = rowToRow - cos(tiltRadian);	    // The normalized distance from the read of module to front of module in next row
-		double verticalHeight = slopeLength * sin(tiltRadian);
-		double horizontalLength = slopeLength * cos(tiltRadian);
-
-		// Determine the factors for points on the ground from the leading edge of one row of PV panels to the edge of the next row of panels behind
-		std::vector<double> rearSkyConfigFactors, frontSkyConfigFactors;
-		this->getSkyConfigurationFactors(rowToRow, verticalHeight, clearanceGround, distanceBetweenRows, horizontalLength, rearSkyConfigFactors, frontSkyConfigFactors);
-
-		// Determine if ground is shading from direct beam radio for points on the ground from leading edge of PV panels to leading edge of next row behind
-		double pvBackShadeFraction, pvFrontShadeFraction, maxShadow;
-		pvBackShadeFraction = pvFrontShadeFraction = maxShadow = 0;
-		std::vector<int> rearGroundShade, frontGroundShade;
-		this->getGroundShadeFactors(rowToRow, verticalHeight, clearanceGround, distanceBetweenRows, horizontalLength, sunAnglesRadians[0], sunAnglesRadians[2], rearGroundShade, frontGroundShade, maxShadow, pvBackShadeFraction, pvFrontShadeFraction);
-
-		// Get the rear ground GHI
-		std::vector<double> rearGroundGHI, frontGroundGHI;
-		this->getGroundGHI(transmissionFactor, rearSkyConfigFactors, frontSkyConfigFactors, rearGroundShade, frontGroundShade, rearGroundGHI, frontGroundGHI);
-
-		// Calculate the irradiance on the front of the PV module (to get front reflected)
-		std::vector<double> frontIrradiancePerCellrow, frontReflected;
-		double frontAverageIrradiance = 0;
-		getFrontSurfaceIrradiances(pvFrontShadeFraction, rowToRow, verticalHeight, clearanceGround, distanceBetweenRows, horizontalLength, frontGroundGHI, frontIrradiancePerCellrow, frontAverageIrradiance, frontReflected);
-
-		// Calculate the irradiance on the back of the PV module
-		std::vector<double> rearIrradiancePerCellrow;
-		double rearAverageIrradiance = 0;
-		getBackSurfaceIrradiances(pvBackShadeFraction, rowToRow, verticalHeight, clearanceGround, distanceBetweenRows, horizontalLength, rearGroundGHI, frontGroundGHI, frontReflected, rearIrradiancePerCellrow, rearAverageIrradiance);
-		planeOfArrayIrradianceRearAverage = rearAverageIrradiance;
+		front.rows[i].ground.resize(degrees);
+		rear.rows[i].ground.resize(degrees);
+		rear.rows[i].reflected.resize(degrees * (cellRows + 1));
 	}
-	return true;
 }
 
-void irrad::getSkyConfigurationFactors(double rowToRow, double verticalHeight, double clearanceGround, double distanceBetweenRows, double horizontalLength, std::vector<double> & rearSkyConfigFactors, std::vector<double> & frontSkyConfigFactors)
+bool bifacial_view_factors::side_view::same_geometry(double rowToRowIn, double verticalHeightIn, double clearanceGroundIn, double distanceBetweenRowsIn, double horizontalLengthIn, double tiltRadiansIn) const
 {
+	return valid && rowToRow == rowToRowIn && verticalHeight == verticalHeightIn && clearanceGround == clearanceGroundIn
+		&& distanceBetweenRows == distanceBetweenRowsIn && horizontalLength == horizontalLengthIn && tiltRadians == tiltRadiansIn;
+}
+
+void bifacial_view_factors::set_ground(double rowToRow, double verticalHeight, double clearanceGround, double distanceBetweenRows, double horizontalLength)
+{
+	if (groundValid && groundRowToRow == rowToRow && groundVerticalHeight == verticalHeight && groundClearanceGround == clearanceGround
+		&& groundDistanceBetweenRows == distanceBetweenRows && groundHorizontalLength == horizontalLength)
+	{
+		numberOfHits++;
+		return;
+	}
+	groundValid = true;
+	groundRowToRow = rowToRow;
+	groundVerticalHeight = verticalHeight;
+	groundClearanceGround = clearanceGround;
+	groundDistanceBetweenRows = distanceBetweenRows;
+	groundHorizontalLength = horizontalLength;
+
 	// Calculate sky configuration factors using 100 intervals
-	size_t intervals = 100;
 	double deltaInterval = static_cast<double>(rowToRow / intervals);
 	double x = -deltaInterval / 2.0;
 
 	for (size_t i = 0; i != intervals; i++)
 	{
 		x += deltaInterval;
+		groundPosition[i] = x;
+
 		double angleA = atan((verticalHeight + clearanceGround) / (2.0 * rowToRow + horizontalLength - x));
 		if (angleA < 0.0) {
 			angleA += M_PI;
@@ -1329,16 +1824,276 @@ void irrad::getSkyConfigurationFactors(double rowToRow, double verticalHeight, d
 		}
 		skyAll = sky1 + sky2 + sky3;
 
-		rearSkyConfigFactors.push_back(skyAll);
-		frontSkyConfigFactors.push_back(skyAll);
+		skyConfigFactors[i] = skyAll;
+	}
+}
+
+void bifacial_view_factors::set_front_view(double rowToRow, double verticalHeight, double clearanceGround, double distanceBetweenRows, double horizontalLength, double tiltRadians)
+{
+	if (front.same_geometry(rowToRow, verticalHeight, clearanceGround, distanceBetweenRows, horizontalLength, tiltRadians))
+		return;
+	front.valid = true;
+	front.rowToRow = rowToRow;
+	front.verticalHeight = verticalHeight;
+	front.clearanceGround = clearanceGround;
+	front.distanceBetweenRows = distanceBetweenRows;
+	front.horizontalLength = horizontalLength;
+	front.tiltRadians = tiltRadians;
+
+	// Calculate x,y coordinates of bottom and top edges of PV row in back of desired PV row so that portions of sky and ground viewed by the 
+	// PV cell may be determined. Origin of x-y axis is the ground point below the lower front edge of the desired PV row. The row in back of 
+	// the desired row is in the positive x direction.
+	double PbotX = -rowToRow;                        // x value for point on bottom edge of PV module/panel of row in front of (in PV panel slope lengths)
+	double PbotY = clearanceGround;                  // y value for point on bottom edge of PV module/panel of row in front of (in PV panel slope lengths)
+	double PtopX = -distanceBetweenRows;			 // x value for point on top edge of PV module/panel of row in front of (in PV panel slope lengths)
+	double PtopY = verticalHeight + clearanceGround; // y value for point on top edge of PV module/panel of row in front of (in PV panel slope lengths)
+
+	for (size_t i = 0; i != cellRows; i++)
+	{
+		cell_row_view &row = front.rows[i];
+
+		// Calculate the field of view of 180 degrees for each cell row, beginning with the angle providing the upper most view of the sky (j=0)
+		double PcellX = horizontalLength * (i + 0.5) / ((double)cellRows);				   // x value for location of PV cell with OFFSET FOR SARA REFERENCE CELLS     4/26/2016
+		double PcellY = clearanceGround + verticalHeight * (i + 0.5) / ((double)cellRows); // y value for location of PV cell with OFFSET FOR SARA REFERENCE CELLS     4/26/2016
+		double elevationAngleUp = atan((PtopY - PcellY) / (PcellX - PtopX));          // Elevation angle up from PV cell to top of PV module/panel, radians
+		double elevationAngleDown = atan((PcellY - PbotY) / (PcellX - PbotX));        // Elevation angle down from PV cell to bottom of PV module/panel, radians
+		row.iStopIso = (size_t)round((M_PI - tiltRadians - elevationAngleUp) / DTOR);							   // Last whole degree in arc range that sees sky, first is 0
+		row.iHorBright = (size_t)round(fmax(0.0, 6.0 - elevationAngleUp / DTOR));	   			       // Number of whole degrees for which horizon brightening occurs
+		row.iStartGrd = (size_t)round((M_PI - tiltRadians + elevationAngleDown) / DTOR);                          // First whole degree in arc range that sees ground, last is 180
+
+		// Ground seen in each degree
+		for (size_t j = row.iStartGrd; j < degrees; j++)
+		{
+			ground_view &view = row.ground[j];
+			double startElevationDown = (j - row.iStartGrd) * DTOR + elevationAngleDown;
+			double stopElevationDown = (j + 1 - row.iStartGrd) * DTOR + elevationAngleDown;
+			double projectedX1 = PcellX - PcellY / tan(startElevationDown);
+			double projectedX2 = PcellX - PcellY / tan(stopElevationDown);
+
+			// Use average value if projection approximates the rtr      
+			view.average = fabs(projectedX1 - projectedX2) > 0.99 * rowToRow;
+			if (view.average)
+				continue;
+
+			projectedX1 = intervals * projectedX1 / rowToRow;
+			projectedX2 = intervals * projectedX2 / rowToRow;
+
+			// offset so array indexes are positive
+			while (projectedX1 < 0.0 || projectedX2 < 0.0)
+			{
+				projectedX1 += intervals;
+				projectedX2 += intervals;
+			}
+			view.projectedX1 = projectedX1;
+			view.projectedX2 = projectedX2;
+			view.index1 = (int)static_cast<size_t>(projectedX1);
+			view.index2 = (int)static_cast<size_t>(projectedX2);
+		}
+	}
+}
+
+void bifacial_view_factors::set_rear_view(double rowToRow, double verticalHeight, double clearanceGround, double distanceBetweenRows, double horizontalLength, double tiltRadians)
+{
+	if (rear.same_geometry(rowToRow, verticalHeight, clearanceGround, distanceBetweenRows, horizontalLength, tiltRadians))
+		return;
+	rear.valid = true;
+	rear.rowToRow = rowToRow;
+	rear.verticalHeight = verticalHeight;
+	rear.clearanceGround = clearanceGround;
+	rear.distanceBetweenRows = distanceBetweenRows;
+	rear.horizontalLength = horizontalLength;
+	rear.tiltRadians = tiltRadians;
+
+	// Calculate x,y coordinates of bottom and top edges of PV row in back of desired PV row so that portions of sky and ground viewed by the 
+	// PV cell may be determined. Origin of x-y axis is the ground point below the lower front edge of the desired PV row. The row in back of 
+	// the desired row is in the positive x direction.
+	double PbotX = rowToRow;                         // x value for point on bottom edge of PV module/panel of row in back of (in PV panel slope lengths)
+	double PbotY = clearanceGround;                  // y value for point on bottom edge of PV module/panel of row in back of (in PV panel slope lengths)
+	double PtopX = rowToRow + horizontalLength;      // x value for point on top edge of PV module/panel of row in back of (in PV panel slope lengths)
+	double PtopY = verticalHeight + clearanceGround; // y value for point on top edge of PV module/panel of row in back of (in PV panel slope lengths)
+
+	for (size_t i = 0; i != cellRows; i++)
+	{
+		cell_row_view &row = rear.rows[i];
+
+		// Calculate the field of view of 180 degrees for each cell row, beginning with the angle providing the upper most view of the sky (j=0)
+		double PcellX = horizontalLength * (i + 0.5) / ((double)cellRows);				   // x value for location of PV cell with OFFSET FOR SARA REFERENCE CELLS     4/26/2016
+		double PcellY = clearanceGround + verticalHeight * (i + 0.5) / ((double)cellRows); // y value for location of PV cell with OFFSET FOR SARA REFERENCE CELLS     4/26/2016
+		double elevationAngleUp = atan((PtopY - PcellY) / (PtopX - PcellX));          // Elevation angle up from PV cell to top of PV module/panel, radians
+		double elevationAngleDown = atan((PcellY - PbotY) / (PbotX - PcellX));        // Elevation angle down from PV cell to bottom of PV module/panel, radians
+		row.iStopIso = (size_t)round((tiltRadians - elevationAngleUp) / DTOR);							   // Last whole degree in arc range that sees sky, first is 0
+		row.iHorBright = (size_t)round(fmax(0.0, 6.0 - elevationAngleUp / DTOR));	   			       // Number of whole degrees for which horizon brightening occurs
+		row.iStartGrd = (size_t)round((tiltRadians + elevationAngleDown) / DTOR);                          // First whole degree in arc range that sees ground, last is 180
+
+		// Front surface of the next row seen in each degree, as the length of each of its cell rows in view
+		for (size_t j = row.iStopIso; j < row.iStartGrd; j++)
+		{
+			double diagonalDistance = (PbotX - PcellX) / cos(elevationAngleDown);
+			double startAlpha = -(double)(j - row.iStopIso) * DTOR + elevationAngleUp + elevationAngleDown;
+			double stopAlpha = -(double)(j + 1 - row.iStopIso) * DTOR + elevationAngleUp + elevationAngleDown;
+			double m = diagonalDistance * sin(startAlpha);
+			double theta = M_PI - elevationAngleDown - (M_PI / 2.0 - startAlpha) - tiltRadians;
+			double projectedX2 = m / cos(theta);
+
+			m = diagonalDistance * sin(stopAlpha);
+			theta = M_PI - elevationAngleDown - (M_PI / 2.0 - stopAlpha) - tiltRadians;
+			double projectedX1 = m / cos(theta);
+			projectedX1 = fmax(0.0, projectedX1);
+
+			double *cellLengthsSeen = &row.reflected[j * (cellRows + 1)];
+			double deltaCell = 1.0 / cellRows;
+			double tolerance = 0.0001;
+			for (size_t k = 0; k < cellRows; k++)
+			{
+				double cellBottom = k * deltaCell;
+				double cellTop = (k + 1) * deltaCell;
+				double cellLengthSeen = 0.0;
+
+				if (cellBottom >= projectedX1 - tolerance && cellTop <= projectedX2 + tolerance) {
+					cellLengthSeen = cellTop - cellBottom;
+				}
+				else if (cellBottom <= projectedX1 + tolerance && cellTop >= projectedX2 - tolerance) {
+					cellLengthSeen = projectedX2 - projectedX1;
+				}
+				else if (cellBottom >= projectedX1 - tolerance && projectedX2 > cellBottom - tolerance && cellTop >= projectedX2 - tolerance) {
+					cellLengthSeen = projectedX2 - cellBottom;
+				}
+				else if (cellBottom <= projectedX1 + tolerance && projectedX1 < cellTop + tolerance && cellTop <= projectedX2 + tolerance) {
+					cellLengthSeen = cellTop - projectedX1;
+				}
+				cellLengthsSeen[k] = cellLengthSeen;
+			}
+			cellLengthsSeen[cellRows] = projectedX2 - projectedX1;
+		}
+
+		// Ground seen in each degree
+		for (size_t j = row.iStartGrd; j < degrees; j++)
+		{
+			ground_view &view = row.ground[j];
+			double startElevationDown = (double)(j - row.iStartGrd) * DTOR + elevationAngleDown;
+			double stopElevationDown = (double)(j + 1 - row.iStartGrd) * DTOR + elevationAngleDown;
+			double projectedX2 = PcellX + PcellY / tan(startElevationDown);
+			double projectedX1 = PcellX + PcellY / tan(stopElevationDown);
+
+			// Use average value if projection approximates the rtr      
+			view.average = fabs(projectedX1 - projectedX2) > 0.99 * rowToRow;
+			if (view.average)
+				continue;
+
+			projectedX1 = intervals * projectedX1 / rowToRow;
+			projectedX2 = intervals * projectedX2 / rowToRow;
+
+			// offset so array indexed are less than number of intervals
+			while (projectedX1 >= intervals || projectedX2 >= intervals)
+			{
+				projectedX1 -= intervals;
+				projectedX2 -= intervals;
+			}
+			while (projectedX1 < -(int)intervals || projectedX2 < -(int)intervals)
+			{
+				projectedX1 += intervals;
+				projectedX2 += intervals;
+			}
+			view.projectedX1 = projectedX1;
+			view.projectedX2 = projectedX2;
+			view.index1 = static_cast<int>(projectedX1 + intervals) - (int)intervals;
+			view.index2 = static_cast<int>(projectedX2 + intervals) - (int)intervals;
+		}
+	}
+}
+
+int irrad::calc_rear_side(double transmissionFactor, double groundClearanceHeight, double slopeLength, bifacial_view_factors * viewFactors)
+{
+	// do irradiance calculations if sun is up
+	if (timeStepSunPosition[2] > 0)
+	{
+
+		double tiltRadian = surfaceAnglesRadians[1];		// The tracked angle in radians
+
+		// Update ground clearance height for HSAT
+		if (this->trackingMode == 1) {
+			groundClearanceHeight = groundClearanceHeight - (0.5 * slopeLength) * sin(fabs(tiltRadian));
+		}
+
+		// System geometry
+		double rowToRow = slopeLength / this->groundCoverageRatio;		// Row to row spacing between the front of one row to the front of the next row
+		double clearanceGround = groundClearanceHeight;					// The normalized clearance from the bottom edge of module to ground
+		double distanceBetweenRows = rowToRow - cos(tiltRadian);	    // The normalized distance from the read of module to front of module in next row
+		double verticalHeight = slopeLength * sin(tiltRadian);
+		double horizontalLength = slopeLength * cos(tiltRadian);
+
+		// Without view factors kept for the subarray, calculate them for this time step only
+		std::unique_ptr<bifacial_view_factors> stepViewFactors;
+		if (viewFactors == 0)
+		{
+			stepViewFactors.reset(new bifacial_view_factors());
+			viewFactors = stepViewFactors.get();
+		}
+
+		// Determine the factors for points on the ground from the leading edge of one row of PV panels to the edge of the next row of panels behind
+		viewFactors->set_ground(rowToRow, verticalHeight, clearanceGround, distanceBetweenRows, horizontalLength);
+
+		// Determine if ground is shading from direct beam radio for points on the ground from leading edge of PV panels to leading edge of next row behind
+		double pvBackShadeFraction, pvFrontShadeFraction, maxShadow;
+		pvBackShadeFraction = pvFrontShadeFraction = maxShadow = 0;
+		calc_ground_shade(*viewFactors, rowToRow, verticalHeight, clearanceGround, distanceBetweenRows, horizontalLength, sunAnglesRadians[0], sunAnglesRadians[2], maxShadow, pvBackShadeFraction, pvFrontShadeFraction);
+
+		// Get the rear ground GHI
+		calc_ground_ghi(transmissionFactor, &viewFactors->skyConfigFactors[0], &viewFactors->skyConfigFactors[0], &viewFactors->rearGroundShade[0], &viewFactors->frontGroundShade[0], &viewFactors->rearGroundGHI[0], &viewFactors->frontGroundGHI[0]);
+
+		// Calculate the irradiance on the front of the PV module (to get front reflected)
+		double frontAverageIrradiance = 0;
+		calc_front_surface(*viewFactors, pvFrontShadeFraction, rowToRow, verticalHeight, clearanceGround, distanceBetweenRows, horizontalLength, &viewFactors->frontGroundGHI[0], &viewFactors->frontIrradiance[0], frontAverageIrradiance, &viewFactors->frontReflected[0]);
+
+		// Calculate the irradiance on the back of the PV module
+		double rearAverageIrradiance = 0;
+		calc_back_surface(*viewFactors, pvBackShadeFraction, rowToRow, verticalHeight, clearanceGround, distanceBetweenRows, horizontalLength, &viewFactors->rearGroundGHI[0], &viewFactors->frontGroundGHI[0], &viewFactors->frontReflected[0], &viewFactors->rearIrradiance[0], rearAverageIrradiance);
+		planeOfArrayIrradianceRearAverage = rearAverageIrradiance;
 	}
+	return true;
+}
+
+void irrad::getSkyConfigurationFactors(double rowToRow, double verticalHeight, double clearanceGround, double distanceBetweenRows, double horizontalLength, std::vector<double> & rearSkyConfigFactors, std::vector<double> & frontSkyConfigFactors)
+{
+	bifacial_view_factors viewFactors;
+	viewFactors.set_ground(rowToRow, verticalHeight, clearanceGround, distanceBetweenRows, horizontalLength);
+	rearSkyConfigFactors = viewFactors.skyConfigFactors;
+	frontSkyConfigFactors = viewFactors.skyConfigFactors;
 }
 
 void irrad::getGroundShadeFactors(double rowToRow, double verticalHeight, double clearanceGround, double distanceBetweenRows, double horizontalLength, double solarAzimuthRadians, double solarElevationRadians, std::vector<int> & rearGroundShade, std::vector<int> & frontGroundShade, double & maxShadow, double & pvBackSurfaceShadeFraction, double & pvFrontSurfaceShadeFraction)
 {
-	// calculate ground shade factors using 100 intervals
-	size_t intervals = 100;
-	double deltaInterval = static_cast<double>(rowToRow / intervals);
+	bifacial_view_factors viewFactors;
+	viewFactors.set_ground(rowToRow, verticalHeight, clearanceGround, distanceBetweenRows, horizontalLength);
+	calc_ground_shade(viewFactors, rowToRow, verticalHeight, clearanceGround, distanceBetweenRows, horizontalLength, solarAzimuthRadians, solarElevationRadians, maxShadow, pvBackSurfaceShadeFraction, pvFrontSurfaceShadeFraction);
+	rearGroundShade = viewFactors.rearGroundShade;
+	frontGroundShade = viewFactors.frontGroundShade;
+}
+
+void irrad::getGroundGHI(double transmissionFactor, const std::vector<double> & rearSkyConfigFactors, const std::vector<double> & frontSkyConfigFactors, const std::vector<int> & rearGroundShade, const std::vector<int> & frontGroundShade, std::vector<double> & rearGroundGHI, std::vector<double> & frontGroundGHI)
+{
+	rearGroundGHI.resize(bifacial_view_factors::intervals);
+	frontGroundGHI.resize(bifacial_view_factors::intervals);
+	calc_ground_ghi(transmissionFactor, &rearSkyConfigFactors[0], &frontSkyConfigFactors[0], &rearGroundShade[0], &frontGroundShade[0], &rearGroundGHI[0], &frontGroundGHI[0]);
+}
+
+void irrad::getFrontSurfaceIrradiances(double pvFrontShadeFraction, double rowToRow, double verticalHeight, double clearanceGround, double distanceBetweenRows, double horizontalLength, const std::vector<double> & frontGroundGHI, std::vector<double> & frontIrradiance, double & frontAverageIrradiance, std::vector<double> & frontReflected)
+{
+	bifacial_view_factors viewFactors;
+	frontIrradiance.resize(bifacial_view_factors::cellRows);
+	frontReflected.resize(bifacial_view_factors::cellRows);
+	calc_front_surface(viewFactors, pvFrontShadeFraction, rowToRow, verticalHeight, clearanceGround, distanceBetweenRows, horizontalLength, &frontGroundGHI[0], &frontIrradiance[0], frontAverageIrradiance, &frontReflected[0]);
+}
+
+void irrad::getBackSurfaceIrradiances(double pvBackShadeFraction, double rowToRow, double verticalHeight, double clearanceGround, double distanceBetweenRows, double horizontalLength, const std::vector<double> & rearGroundGHI, const std::vector<double> & frontGroundGHI, const std::vector<double> & frontReflected, std::vector<double> & rearIrradiance, double & rearAverageIrradiance)
+{
+	bifacial_view_factors viewFactors;
+	rearIrradiance.resize(bifacial_view_factors::cellRows);
+	calc_back_surface(viewFactors, pvBackShadeFraction, rowToRow, verticalHeight, clearanceGround, distanceBetweenRows, horizontalLength, &rearGroundGHI[0], &frontGroundGHI[0], &frontReflected[0], &rearIrradiance[0], rearAverageIrradiance);
+}
+
+void irrad::calc_ground_shade(bifacial_view_factors &viewFactors, double rowToRow, double verticalHeight, double clearanceGround, double distanceBetweenRows, double horizontalLength, double solarAzimuthRadians, double solarElevationRadians, double & maxShadow, double & pvBackSurfaceShadeFraction, double & pvFrontSurfaceShadeFraction)
+{
 	double surfaceAzimuthAngleRadians = surfaceAnglesRadians[2];
 	double shadingStart1, shadingStart2, shadingEnd1, shadingEnd2;
 	shadingStart1 = shadingStart2 = shadingEnd1 = shadingEnd2 = pvBackSurfaceShadeFraction = 0;
@@ -1438,25 +2193,20 @@ void irrad::getGroundShadeFactors(double rowToRow, double verticalHeight, double
 		}
 
 	}
-	double x = -deltaInterval / 2.0;
-	for (size_t i = 0; i != intervals; i++)
+	// mark the shaded ground intervals, both the rear and front ground see the same shadow
+	const double *x = &viewFactors.groundPosition[0];
+	int *rearGroundShade = &viewFactors.rearGroundShade[0];
+	int *frontGroundShade = &viewFactors.frontGroundShade[0];
+	for (size_t i = 0; i != bifacial_view_factors::intervals; i++)
 	{
-		x += deltaInterval;
-		if ((x >= shadingStart1 && x < shadingEnd1) || (x >= shadingStart2 && x < shadingEnd2))
-		{
-			rearGroundShade.push_back(1);
-			frontGroundShade.push_back(1);
-		}
-		else
-		{
-			rearGroundShade.push_back(0);
-			frontGroundShade.push_back(0);
-		}
+		int shaded = ((x[i] >= shadingStart1 && x[i] < shadingEnd1) || (x[i] >= shadingStart2 && x[i] < shadingEnd2)) ? 1 : 0;
+		rearGroundShade[i] = shaded;
+		frontGroundShade[i] = shaded;
 	}
 	maxShadow = fmax(shadingStart1, shadingEnd1);
 }
 
-void irrad::getGroundGHI(double transmissionFactor, std::vector<double> rearSkyConfigFactors, std::vector<double> frontSkyConfigFactors, std::vector<int> rearGroundShade, std::vector<int> frontGroundShade, std::vector<double> & rearGroundGHI, std::vector<double> & frontGroundGHI)
+void irrad::calc_ground_ghi(double transmissionFactor, const double *rearSkyConfigFactors, const double *frontSkyConfigFactors, const int *rearGroundShade, const int *frontGroundShade, double *rearGroundGHI, double *frontGroundGHI)
 {
 	// Calculate the diffuse components of irradiance
 	perez(0, calculatedDirectNormal, calculatedDiffuseHorizontal,albedo, sunAnglesRadians[1], 0.0, sunAnglesRadians[1], planeOfArrayIrradianceRear, diffuseIrradianceRear);
@@ -1464,49 +2214,51 @@ void irrad::getGroundGHI(double transmissionFactor, std::vector<double> rearSkyC
 	double isotropicDiffuse = diffuseIrradianceRear[0];
 	double circumsolarDiffuse = diffuseIrradianceRear[1];
 
+	// Beam and circumsolar component reaching unshaded ground, and transmitted thru module spacing to shaded ground
+	double direct = incidentBeam + circumsolarDiffuse;
+	double transmitted = direct * transmissionFactor;
+
 	// Sum the irradiance components for each of the ground segments to the front and rear of the front of the PV row
-	for (size_t i = 0; i != 100; i++)
+	for (size_t i = 0; i != bifacial_view_factors::intervals; i++)
 	{
 		// Add diffuse sky component viewed by ground
-		rearGroundGHI.push_back(rearSkyConfigFactors[i] * isotropicDiffuse);
-		frontGroundGHI.push_back(frontSkyConfigFactors[i] * isotropicDiffuse);
-
-		if (rearGroundShade[i] == 0)
-		{
-			// Add beam and circumsolar component if not shaded
-			rearGroundGHI[i] += incidentBeam + circumsolarDiffuse;
-		}
-		else
-		{
-			// Add beam and circumsolar component transmitted thru module spacing if shaded
-			rearGroundGHI[i] += (incidentBeam + circumsolarDiffuse) * transmissionFactor;
-		}
-		if (frontGroundShade[i] == 0)
-		{
-			frontGroundGHI[i] += incidentBeam + circumsolarDiffuse;
-		}
-		else
-		{
-			frontGroundGHI[i] += (incidentBeam + circumsolarDiffuse) * transmissionFactor;
-		}
+		rearGroundGHI[i] = rearSkyConfigFactors[i] * isotropicDiffuse + (rearGroundShade[i] == 0 ? direct : transmitted);
+		frontGroundGHI[i] = frontSkyConfigFactors[i] * isotropicDiffuse + (frontGroundShade[i] == 0 ? direct : transmitted);
 	}
 }
 
-void irrad::getFrontSurfaceIrradiances(double pvFrontShadeFraction, double rowToRow, double verticalHeight, double clearanceGround, double distanceBetweenRows, double horizontalLength, std::vector<double> frontGroundGHI, std::vector<double> & frontIrradiance, double & frontAverageIrradiance, std::vector<double> & frontReflected)
+/// Fraction of the field of view between degrees j and j+1 of a cell row, 0.5 * (cos(j) - cos(j+1)), for j in [0, 180)
+struct view_factor_per_degree
+{
+	double factors[180];
+	view_factor_per_degree()
+	{
+		for (size_t j = 0; j < 180; j++)
+			factors[j] = 0.5 * (cos(j * DTOR) - cos((j + 1) * DTOR));
+	}
+};
+static const view_factor_per_degree viewFactorPerDegree;
+
+void irrad::calc_front_surface(bifacial_view_factors &viewFactors, double pvFrontShadeFraction, double rowToRow, double verticalHeight, double clearanceGround, double distanceBetweenRows, double horizontalLength, const double *frontGroundGHI, double *frontIrradiance, double & frontAverageIrradiance, double *frontReflected)
 {
 	// front surface assumed to be glass
 	double n2 = 1.526;
+	double reflectanceNormalIncidence = pow((n2 - 1.0) / (n2 + 1.0), 2.0);
 
-	size_t intervals = 100;
+	const size_t intervals = bifacial_view_factors::intervals;
+	const size_t cellRows = bifacial_view_factors::cellRows;
 	double solarAzimuthRadians = sunAnglesRadians[0];
 	double solarZenithRadians = sunAnglesRadians[1];
 	double tiltRadians = surfaceAnglesRadians[1]; 
 	double surfaceAzimuthRadians = surfaceAnglesRadians[2];
+	const double *viewFactor = viewFactorPerDegree.factors;
+
+	viewFactors.set_front_view(rowToRow, verticalHeight, clearanceGround, distanceBetweenRows, horizontalLength, tiltRadians);
 
 	// Average GHI on ground under PV array for cases when x projection exceed 2*rtr
 	double averageGroundGHI = 0.0;
-	for (size_t i = 0; i != frontGroundGHI.size(); i++)
-		averageGroundGHI += frontGroundGHI[i] / frontGroundGHI.size();
+	for (size_t i = 0; i != intervals; i++)
+		averageGroundGHI += frontGroundGHI[i] / intervals;
 
 	// Calculate diffuse isotropic irradiance for a horizontal surface
 	double * poa = planeOfArrayIrradianceRear;
@@ -1520,74 +2272,52 @@ void irrad::getFrontSurfaceIrradiances(double pvFrontShadeFraction, double rowTo
 	perez(0, calculatedDirectNormal, calculatedDiffuseHorizontal, albedo, angleTmp[0], angleTmp[1], solarZenithRadians, poa, diffc);
 	double horizonDiffuse = diffc[2];
 
-	// Calculate x,y coordinates of bottom and top edges of PV row in back of desired PV row so that portions of sky and ground viewed by the 
-	// PV cell may be determined. Origin of x-y axis is the ground point below the lower front edge of the desired PV row. The row in back of 
-	// the desired row is in the positive x direction.
-	double PbotX = -rowToRow;                        // x value for point on bottom edge of PV module/panel of row in front of (in PV panel slope lengths)
-	double PbotY = clearanceGround;                  // y value for point on bottom edge of PV module/panel of row in front of (in PV panel slope lengths)
-	double PtopX = -distanceBetweenRows;			 // x value for point on top edge of PV module/panel of row in front of (in PV panel slope lengths)
-	double PtopY = verticalHeight + clearanceGround; // y value for point on top edge of PV module/panel of row in front of (in PV panel slope lengths)
+	// Calculate direct and circumsolar irradiance components, the same for every cell row
+	incidence(0, tiltRadians * RTOD, surfaceAzimuthRadians * RTOD, 45.0, solarZenithRadians, solarAzimuthRadians, this->enableBacktrack, this->groundCoverageRatio, surfaceAnglesRadians);
+	perez(0, calculatedDirectNormal, calculatedDiffuseHorizontal, albedo, surfaceAnglesRadians[0], surfaceAnglesRadians[1], solarZenithRadians, poa, diffc);
 
 	// Calculate diffuse and direct component irradiances for each cell row (assuming 6 rows)
-	size_t cellRows = 6;
+	frontAverageIrradiance = 0;
 	for (size_t i = 0; i != cellRows; i++)
 	{
-		// Calculate diffuse irradiances and reflected amounts for each cell row over its field of view of 180 degrees, 
-		// beginning with the angle providing the upper most view of the sky (j=0)
-		double PcellX = horizontalLength * (i + 0.5) / ((double)cellRows);				   // x value for location of PV cell with OFFSET FOR SARA REFERENCE CELLS     4/26/2016
-		double PcellY = clearanceGround + verticalHeight * (i + 0.5) / ((double)cellRows); // y value for location of PV cell with OFFSET FOR SARA REFERENCE CELLS     4/26/2016
-		double elevationAngleUp = atan((PtopY - PcellY) / (PcellX - PtopX));          // Elevation angle up from PV cell to top of PV module/panel, radians
-		double elevationAngleDown = atan((PcellY - PbotY) / (PcellX - PbotX));        // Elevation angle down from PV cell to bottom of PV module/panel, radians
-		size_t iStopIso = (size_t)round((M_PI - tiltRadians - elevationAngleUp) / DTOR);							   // Last whole degree in arc range that sees sky, first is 0
-		size_t iHorBright = (size_t)round(fmax(0.0, 6.0 - elevationAngleUp / DTOR));	   			       // Number of whole degrees for which horizon brightening occurs
-		size_t iStartGrd = (size_t)round((M_PI - tiltRadians + elevationAngleDown) / DTOR);                          // First whole degree in arc range that sees ground, last is 180
+		const bifacial_view_factors::cell_row_view &row = viewFactors.front.rows[i];
+		size_t iStopIso = row.iStopIso;
+		size_t iHorBright = row.iHorBright;
+		size_t iStartGrd = row.iStartGrd;
 
-		frontIrradiance.push_back(0.);
-		frontReflected.push_back(0.);
-		double reflectanceNormalIncidence = pow((n2 - 1.0) / (n2 + 1.0), 2.0);
+		frontIrradiance[i] = 0.;
+		frontReflected[i] = 0.;
 
 		// Add sky diffuse component and horizon brightening if present
 		for (size_t j = 0; j != iStopIso; j++)
 		{
-			frontIrradiance[i] += 0.5 * (cos(j * DTOR) - cos((j + 1)*DTOR)) * MarionAOICorrectionFactorsGlass[j] * isotropicSkyDiffuse;
-			frontReflected[i] += 0.5 * (cos(j * DTOR) - cos((j + 1)*DTOR)) * isotropicSkyDiffuse * (1.0 - MarionAOICorrectionFactorsGlass[j] * (1.0 - reflectanceNormalIncidence));
+			frontIrradiance[i] += viewFactor[j] * MarionAOICorrectionFactorsGlass[j] * isotropicSkyDiffuse;
+			frontReflected[i] += viewFactor[j] * isotropicSkyDiffuse * (1.0 - MarionAOICorrectionFactorsGlass[j] * (1.0 - reflectanceNormalIncidence));
 
 			if ((iStopIso - j) <= iHorBright)
 			{
-				frontIrradiance[i] += 0.5 * (cos(j * DTOR) - cos((j + 1) * DTOR)) * MarionAOICorrectionFactorsGlass[j] * horizonDiffuse / 0.052246; // 0.052246 = 0.5 * [cos(84) - cos(90)]
-				frontReflected[i] += 0.5 * (cos(j * DTOR) - cos((j + 1) * DTOR)) * (horizonDiffuse / 0.052246) * (1.0 - MarionAOICorrectionFactorsGlass[j] * (1.0 - reflectanceNormalIncidence));
+				frontIrradiance[i] += viewFactor[j] * MarionAOICorrectionFactorsGlass[j] * horizonDiffuse / 0.052246; // 0.052246 = 0.5 * [cos(84) - cos(90)]
+				frontReflected[i] += viewFactor[j] * (horizonDiffuse / 0.052246) * (1.0 - MarionAOICorrectionFactorsGlass[j] * (1.0 - reflectanceNormalIncidence));
 			}
 		}
 
-
 		// Add ground reflected component
 		for (size_t j = iStartGrd; j < 180; j++)
 		{
-			double startElevationDown = (j - iStartGrd) * DTOR + elevationAngleDown;
-			double stopElevationDown = (j + 1 - iStartGrd) * DTOR + elevationAngleDown;
-			double projectedX1 = PcellX - PcellY / tan(startElevationDown);
-			double projectedX2 = PcellX - PcellY / tan(stopElevationDown);
+			const bifacial_view_factors::ground_view &view = row.ground[j];
 			double actualGroundGHI = 0.0;
 
-			if (fabs(projectedX1 - projectedX2) > 0.99 * rowToRow)
+			if (view.average)
 			{
 				// Use average value if projection approximates the rtr      
 				actualGroundGHI = averageGroundGHI;
 			}
 			else
 			{
-				projectedX1 = intervals * projectedX1 / rowToRow;
-				projectedX2 = intervals * projectedX2 / rowToRow;
-
-				// offset so array indexes are positive
-				while (projectedX1 < 0.0 || projectedX2 < 0.0)
-				{
-					projectedX1 += intervals;
-					projectedX2 += intervals;
-				}
-				
-				size_t index1 = static_cast<size_t>(projectedX1);
-				size_t index2 = static_cast<size_t>(projectedX2);
+				double projectedX1 = view.projectedX1;
+				double projectedX2 = view.projectedX2;
+				size_t index1 = (size_t)view.index1;
+				size_t index2 = (size_t)view.index2;
 
 				if (index1 == index2)
 				{
@@ -1625,12 +2355,9 @@ void irrad::getFrontSurfaceIrradiances(double pvFrontShadeFraction, double rowTo
 					actualGroundGHI /= projectedX2 - projectedX1;
 				}
 			}
-			frontIrradiance[i] += 0.5 * (cos(j * DTOR) - cos((j + 1) * DTOR)) * MarionAOICorrectionFactorsGlass[j] * actualGroundGHI * this->albedo;
-			frontReflected[i] += 0.5 * (cos(j * DTOR) - cos((j + 1) * DTOR)) * actualGroundGHI * this->albedo * (1.0 - MarionAOICorrectionFactorsGlass[j] * (1.0 - reflectanceNormalIncidence));
+			frontIrradiance[i] += viewFactor[j] * MarionAOICorrectionFactorsGlass[j] * actualGroundGHI * this->albedo;
+			frontReflected[i] += viewFactor[j] * actualGroundGHI * this->albedo * (1.0 - MarionAOICorrectionFactorsGlass[j] * (1.0 - reflectanceNormalIncidence));
 		}
-		// Calculate and add direct and circumsolar irradiance components
-		incidence(0, tiltRadians * RTOD, surfaceAzimuthRadians * RTOD, 45.0, solarZenithRadians, solarAzimuthRadians, this->enableBacktrack, this->groundCoverageRatio, surfaceAnglesRadians);
-		perez(0, calculatedDirectNormal, calculatedDiffuseHorizontal, albedo, surfaceAnglesRadians[0], surfaceAnglesRadians[1], solarZenithRadians, poa, diffc);
 
 		double cellShade = pvFrontShadeFraction * cellRows - i;
 
@@ -1652,21 +2379,25 @@ void irrad::getFrontSurfaceIrradiances(double pvFrontShadeFraction, double rowTo
 	}
 }
 
-void irrad::getBackSurfaceIrradiances(double pvBackShadeFraction, double rowToRow, double verticalHeight, double clearanceGround, double , double horizontalLength, std::vector<double> rearGroundGHI, std::vector<double> frontGroundGHI, std::vector<double> frontReflected, std::vector<double> & rearIrradiance, double & rearAverageIrradiance)
+void irrad::calc_back_surface(bifacial_view_factors &viewFactors, double pvBackShadeFraction, double rowToRow, double verticalHeight, double clearanceGround, double distanceBetweenRows, double horizontalLength, const double *rearGroundGHI, const double *frontGroundGHI, const double *frontReflected, double *rearIrradiance, double & rearAverageIrradiance)
 {
 	// front surface assumed to be glass
 	double n2 = 1.526;
 
-	size_t intervals = 100;
+	const size_t intervals = bifacial_view_factors::intervals;
+	const size_t cellRows = bifacial_view_factors::cellRows;
 	double solarAzimuthRadians = sunAnglesRadians[0];
 	double solarZenithRadians = sunAnglesRadians[1];
 	double tiltRadians = surfaceAnglesRadians[1];
 	double surfaceAzimuthRadians = surfaceAnglesRadians[2];
+	const double *viewFactor = viewFactorPerDegree.factors;
+
+	viewFactors.set_rear_view(rowToRow, verticalHeight, clearanceGround, distanceBetweenRows, horizontalLength, tiltRadians);
 
 	// Average GHI on ground under PV array for cases when x projection exceed 2*rtr
 	double averageGroundGHI = 0.0;          
-	for (size_t i = 0; i != rearGroundGHI.size(); i++)
-		averageGroundGHI += rearGroundGHI[i] / rearGroundGHI.size();
+	for (size_t i = 0; i != intervals; i++)
+		averageGroundGHI += rearGroundGHI[i] / intervals;
 
 	// Calculate diffuse isotropic irradiance for a horizontal surface
 	perez(0, calculatedDirectNormal, calculatedDiffuseHorizontal, albedo, solarZenithRadians, 0, solarZenithRadians, planeOfArrayIrradianceRear, diffuseIrradianceRear);
@@ -1678,114 +2409,58 @@ void irrad::getBackSurfaceIrradiances(double pvBackShadeFraction, double rowToRo
 	perez(0, calculatedDirectNormal, calculatedDiffuseHorizontal, albedo, surfaceAnglesRadians90[0], surfaceAnglesRadians90[1], solarZenithRadians, planeOfArrayIrradianceRear, diffuseIrradianceRear);
 	double horizonDiffuse = diffuseIrradianceRear[2];
 
-	// Calculate x,y coordinates of bottom and top edges of PV row in back of desired PV row so that portions of sky and ground viewed by the 
-	// PV cell may be determined. Origin of x-y axis is the ground point below the lower front edge of the desired PV row. The row in back of 
-	// the desired row is in the positive x direction.
-	double PbotX = rowToRow;                         // x value for point on bottom edge of PV module/panel of row in back of (in PV panel slope lengths)
-	double PbotY = clearanceGround;                  // y value for point on bottom edge of PV module/panel of row in back of (in PV panel slope lengths)
-	double PtopX = rowToRow + horizontalLength;      // x value for point on top edge of PV module/panel of row in back of (in PV panel slope lengths)
-	double PtopY = verticalHeight + clearanceGround; // y value for point on top edge of PV module/panel of row in back of (in PV panel slope lengths)
+	// Calculate direct and circumsolar irradiance components, the same for every cell row
+	incidence(0, 180.0 - tiltRadians * RTOD, (surfaceAzimuthRadians * RTOD - 180.0), 45.0, solarZenithRadians, solarAzimuthRadians, this->enableBacktrack, this->groundCoverageRatio, surfaceAnglesRadians);
+	perez(0, calculatedDirectNormal, calculatedDiffuseHorizontal, albedo, surfaceAnglesRadians[0], surfaceAnglesRadians[1], solarZenithRadians, planeOfArrayIrradianceRear, diffuseIrradianceRear);
 
 	// Calculate diffuse and direct component irradiances for each cell row (assuming 6 rows)
-	size_t cellRows = 6;
+	rearAverageIrradiance = 0;
 	for (size_t i = 0; i != cellRows; i++)
 	{
-		// Calculate diffuse irradiances and reflected amounts for each cell row over its field of view of 180 degrees, 
-		// beginning with the angle providing the upper most view of the sky (j=0)
-		double PcellX = horizontalLength * (i + 0.5) / ((double)cellRows);				   // x value for location of PV cell with OFFSET FOR SARA REFERENCE CELLS     4/26/2016
-		double PcellY = clearanceGround + verticalHeight * (i + 0.5) / ((double)cellRows); // y value for location of PV cell with OFFSET FOR SARA REFERENCE CELLS     4/26/2016
-		double elevationAngleUp = atan((PtopY - PcellY) / (PtopX - PcellX));          // Elevation angle up from PV cell to top of PV module/panel, radians
-		double elevationAngleDown = atan((PcellY - PbotY) / (PbotX - PcellX));        // Elevation angle down from PV cell to bottom of PV module/panel, radians
-		size_t iStopIso = (size_t)round((tiltRadians - elevationAngleUp) / DTOR);							   // Last whole degree in arc range that sees sky, first is 0
-		size_t iHorBright = (size_t)round(fmax(0.0, 6.0 - elevationAngleUp / DTOR));	   			       // Number of whole degrees for which horizon brightening occurs
-		size_t iStartGrd = (size_t)round((tiltRadians + elevationAngleDown) / DTOR);                          // First whole degree in arc range that sees ground, last is 180
+		const bifacial_view_factors::cell_row_view &row = viewFactors.rear.rows[i];
+		size_t iStopIso = row.iStopIso;
+		size_t iHorBright = row.iHorBright;
+		size_t iStartGrd = row.iStartGrd;
 
-		rearIrradiance.push_back(0);
+		rearIrradiance[i] = 0;
 		for (size_t j = 0; j != iStopIso; j++)
 		{
-			rearIrradiance[i] += 0.5 * (cos(j * DTOR) - cos((j + 1)*DTOR)) * MarionAOICorrectionFactorsGlass[j]* isotropicSkyDiffuse;
+			rearIrradiance[i] += viewFactor[j] * MarionAOICorrectionFactorsGlass[j]* isotropicSkyDiffuse;
 			if ((iStopIso - j) <= iHorBright)
 			{
-				rearIrradiance[i] += 0.5 * (cos(j * DTOR) - cos((j + 1) * DTOR)) * MarionAOICorrectionFactorsGlass[j]* horizonDiffuse / 0.052264; // 0.052246 = 0.5 * [cos(84) - cos(90)]
+				rearIrradiance[i] += viewFactor[j] * MarionAOICorrectionFactorsGlass[j]* horizonDiffuse / 0.052264; // 0.052246 = 0.5 * [cos(84) - cos(90)]
 			}
 		}
 
 		// Add relections from PV module front surfaces
 		for (size_t j = iStopIso; j < iStartGrd; j++)
 		{
-			double diagonalDistance = (PbotX - PcellX) / cos(elevationAngleDown);
-			double startAlpha = -(double)(j - iStopIso) * DTOR + elevationAngleUp + elevationAngleDown;
-			double stopAlpha = -(double)(j + 1 - iStopIso) * DTOR + elevationAngleUp + elevationAngleDown;
-			double m = diagonalDistance * sin(startAlpha);
-			double theta = M_PI - elevationAngleDown - (M_PI / 2.0 - startAlpha) - tiltRadians;
-			double projectedX2 = m / cos(theta);
-
-			m = diagonalDistance * sin(stopAlpha);
-			theta = M_PI - elevationAngleDown - (M_PI / 2.0 - stopAlpha) - tiltRadians;
-			double projectedX1 = m / cos(theta);
-			projectedX1 = fmax(0.0, projectedX1);
-
+			const double *cellLengthsSeen = &row.reflected[j * (cellRows + 1)];
 			double PVreflectedIrradiance = 0.0;
-			double deltaCell = 1.0 / cellRows;
-			double tolerance = 0.0001;
 			for (size_t k = 0; k < cellRows; k++)
-			{
-				double cellBottom = k * deltaCell;
-				double cellTop = (k + 1) * deltaCell;
-				double cellLengthSeen = 0.0;
-
-				if (cellBottom >= projectedX1 - tolerance && cellTop <= projectedX2 + tolerance) {
-					cellLengthSeen = cellTop - cellBottom;
-				}
-				else if (cellBottom <= projectedX1 + tolerance && cellTop >= projectedX2 - tolerance) {
-					cellLengthSeen = projectedX2 - projectedX1;
-				}
-				else if (cellBottom >= projectedX1 - tolerance && projectedX2 > cellBottom - tolerance && cellTop >= projectedX2 - tolerance) {
-					cellLengthSeen = projectedX2 - cellBottom;
-				}
-				else if (cellBottom <= projectedX1 + tolerance && projectedX1 < cellTop + tolerance && cellTop <= projectedX2 + tolerance) {
-					cellLengthSeen = cellTop - projectedX1;
-				}
-
-				PVreflectedIrradiance += cellLengthSeen * frontReflected[k];
-			}
-			PVreflectedIrradiance /= projectedX2 - projectedX1;
-			rearIrradiance[i] += 0.5 * (cos(j * DTOR) - cos((j + 1) * DTOR)) * MarionAOICorrectionFactorsGlass[j] * PVreflectedIrradiance;
+				PVreflectedIrradiance += cellLengthsSeen[k] * frontReflected[k];
+			PVreflectedIrradiance /= cellLengthsSeen[cellRows];
+			rearIrradiance[i] += viewFactor[j] * MarionAOICorrectionFactorsGlass[j] * PVreflectedIrradiance;
 		}
 
 
 		// Add ground reflected component
 		for (size_t j = iStartGrd; j < 180; j++)
 		{
-			double startElevationDown = (double)(j - iStartGrd) * DTOR + elevationAngleDown;
-			double stopElevationDown = (double)(j + 1 - iStartGrd) * DTOR + elevationAngleDown;
-			double projectedX2 = PcellX + PcellY / tan(startElevationDown);
-			double projectedX1 = PcellX + PcellY / tan(stopElevationDown);
+			const bifacial_view_factors::ground_view &view = row.ground[j];
 			double actualGroundGHI = 0.0;
 
-			if (fabs(projectedX1 - projectedX2) > 0.99 * rowToRow)
+			if (view.average)
 			{
 				// Use average value if projection approximates the rtr      
 				actualGroundGHI = averageGroundGHI;
 			}
 			else
 			{
-				projectedX1 = intervals * projectedX1 / rowToRow;
-				projectedX2 = intervals * projectedX2 / rowToRow;
-
-				// offset so array indexed are less than number of intervals
-				while (projectedX1 >= intervals || projectedX2 >= intervals)
-				{
-					projectedX1 -= intervals;
-					projectedX2 -= intervals;
-				}
-				while (projectedX1 < -(int)intervals || projectedX2 < -(int)intervals)
-				{
-					projectedX1 += intervals;
-					projectedX2 += intervals;
-				}
-				int index1 = static_cast<int>(projectedX1 + intervals) - (int)intervals;
-				int index2 = static_cast<int>(projectedX2 + intervals) - (int)intervals;
+				double projectedX1 = view.projectedX1;
+				double projectedX2 = view.projectedX2;
+				int index1 = view.index1;
+				int index2 = view.index2;
 
 				if (index1 == index2)
 				{
@@ -1833,11 +2508,8 @@ void irrad::getBackSurfaceIrradiances(double pvBackShadeFraction, double rowToRo
 					actualGroundGHI /= projectedX2 - projectedX1;
 				}
 			}
-			rearIrradiance[i] += 0.5 * (cos(j * DTOR) - cos((j + 1) * DTOR)) * MarionAOICorrectionFactorsGlass[j] * actualGroundGHI * this->albedo;
+			rearIrradiance[i] += viewFactor[j] * MarionAOICorrectionFactorsGlass[j] * actualGroundGHI * this->albedo;
 		}
-		// Calculate and add direct and circumsolar irradiance components
-		incidence(0, 180.0 - tiltRadians * RTOD, (surfaceAzimuthRadians * RTOD - 180.0), 45.0, solarZenithRadians, solarAzimuthRadians, this->enableBacktrack, this->groundCoverageRatio, surfaceAnglesRadians);
-		perez(0, calculatedDirectNormal, calculatedDiffuseHorizontal, albedo, surfaceAnglesRadians[0], surfaceAnglesRadians[1], solarZenithRadians, planeOfArrayIrradianceRear, diffuseIrradianceRear);
 
 		double cellShade = pvBackShadeFraction * cellRows - i;
 		
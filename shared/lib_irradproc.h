@@ -50,7 +50,10 @@
 #ifndef __irradproc_h
 #define __irradproc_h
 
+#include <atomic>
 #include <memory>
+#include <mutex>
+#include <unordered_map>
 
 #include "lib_weatherfile.h"
 
@@ -188,6 +191,76 @@ void isotropic( double hextra, double dn, double df, double alb, double inc, dou
 */
 void hdkr( double hextra, double dn, double df, double alb, double inc, double tilt, double zen, double poa[3], double diffc[3] /* can be NULL */ );
 
+/**
+* Batch versions of solarpos(), incidence(), perez(), isotropic() and hdkr() process a whole timeseries in one call.
+* Inputs and outputs are structure-of-arrays: one array of n values per quantity, where element i of each output
+* array holds what the scalar function returns in the corresponding array element for the inputs at i.
+* incidence_batch() for fixed and azimuth-axis surfaces and perez_batch() are vector kernels: libm evaluates the
+* trigonometric and power terms of a block of steps first, and the rest is branch-free arithmetic that the compiler
+* vectorizes. On x86-64 Linux builds with GCC they are compiled for AVX-512, AVX2 and the baseline instruction set,
+* and the variant used is chosen at run time for the processor; other builds use the baseline variant.
+* solarpos_batch(), isotropic_batch(), hdkr_batch() and incidence_batch() for tracking surfaces call the scalar
+* function for each element, and exist so that callers can use one structure-of-arrays interface.
+* The kernels evaluate the same expressions as the scalar functions, so results match them to within a relative
+* tolerance of 1e-9 (IRRADPROC_BATCH_TOLERANCE), the difference allowed for a compiler that fuses multiply-adds.
+*/
+#define IRRADPROC_BATCH_TOLERANCE 1e-9
+
+/**
+* solarpos_batch calculates the sun position for n time stamps at one location, see solarpos().
+*
+* \param[in] n number of time stamps
+* \param[in] year, month, day, hour, minute arrays of n local standard time stamps
+* \param[in] lat latitude in degrees, north positive
+* \param[in] lng longitude in degrees, east positive
+* \param[in] tz time zone, west longitudes negative
+* \param[out] sunn nine arrays of n values, in the order of the solarpos() sunn elements
+*/
+void solarpos_batch(size_t n, const int *year, const int *month, const int *day, const int *hour, const double *minute,
+	double lat, double lng, double tz, double *sunn[9]);
+
+/**
+* incidence_batch calculates the incident angle and surface orientation for n sun positions, see incidence().
+*
+* \param[in] n number of sun positions
+* \param[in] zen, azm arrays of n sun zenith and azimuth angles in radians
+* \param[out] angle five arrays of n values, in the order of the incidence() angle elements
+*/
+void incidence_batch(size_t n, int mode, double tilt, double sazm, double rlim, const double *zen, const double *azm,
+	bool en_backtrack, double gcr, double *angle[5]);
+
+/**
+* Batch versions of the sky models for n time steps, see perez(), isotropic() and hdkr().
+*
+* \param[in] n number of time steps
+* \param[in] hextra, dn, df, alb, inc, tilt, zen arrays of n inputs, as for the scalar sky model
+* \param[out] poa three arrays of n plane-of-array irradiances (beam, sky diffuse, ground diffuse) (W/m2)
+* \param[out] diffc three arrays of n diffuse components (isotropic, circumsolar, horizon), or NULL
+*/
+void perez_batch(size_t n, const double *hextra, const double *dn, const double *df, const double *alb, const double *inc,
+	const double *tilt, const double *zen, double *poa[3], double *diffc[3] /* can be NULL */);
+void isotropic_batch(size_t n, const double *hextra, const double *dn, const double *df, const double *alb, const double *inc,
+	const double *tilt, const double *zen, double *poa[3], double *diffc[3] /* can be NULL */);
+void hdkr_batch(size_t n, const double *hextra, const double *dn, const double *df, const double *alb, const double *inc,
+	const double *tilt, const double *zen, double *poa[3], double *diffc[3] /* can be NULL */);
+
+/**
+* sun_position_batch calculates the sun position that irrad::calc() uses for n weather time steps at one location,
+* including the shift to the middle of the daylight part of time steps that contain sunrise or sunset.
+*
+* \param[in] n number of time steps
+* \param[in] year, month, day, hour, minute arrays of n local standard time stamps
+* \param[in] delt time step in hours, or IRRADPROC_NO_INTERPOLATE_SUNRISE_SUNSET to use the time stamps as given
+* \param[in] lat latitude in degrees, north positive
+* \param[in] lng longitude in degrees, east positive
+* \param[in] tz time zone, west longitudes negative
+* \param[out] sunn nine arrays of n values, in the order of the solarpos() sunn elements
+* \param[out] sunpos three arrays of n values: hour and minute used for the sun position, and whether the sun is up
+*  (0=no, 1=midday, 2=sunrise, 3=sunset)
+*/
+void sun_position_batch(size_t n, const int *year, const int *month, const int *day, const int *hour, const double *minute,
+	double delt, double lat, double lng, double tz, double *sunn[9], int *sunpos[3]);
+
 
 /**
 * poaDecomp is a function to decompose input plane-of-array irradiance into direct normal, diffuse horizontal, and global horizontal.
@@ -206,6 +279,54 @@ void hdkr( double hextra, double dn, double df, double alb, double inc, double t
 */
 int poaDecomp( double wfPOA, double angle[], double sun[], double alb, poaDecompReq* pA, double &dn, double &df, double &gh, double poa[3], double diffc[3]);
 
+/**
+* poa_decomp_stats counts the work done by poaDecomp_batch()
+*/
+struct poa_decomp_stats
+{
+	poa_decomp_stats() : steps(0), night(0), clearSky(0), skyChanges(0), firstPass(0), warmStarts(0), coldRestarts(0), iterations(0), errors(0) {}
+	size_t steps;			///< time steps decomposed
+	size_t night;			///< time steps skipped because the sun is down
+	size_t clearSky;		///< time steps with a steady sky following a clear sky step, one with a Kt prime of at least 0.7
+	size_t skyChanges;		///< time steps not warm started because the sky changed from the previous step
+	size_t firstPass;		///< time steps whose first model evaluation matched the measured POA within 1 W/m2
+	size_t warmStarts;		///< time steps started from the previous step's solution
+	size_t coldRestarts;	///< warm starts that did not converge and were repeated from the measured POA
+	size_t iterations;		///< model evaluations over all time steps
+	size_t errors;			///< time steps returning a nonzero error code
+};
+
+/**
+* poaDecomp_batch decomposes a run of consecutive time steps of the plane-of-array irradiance in pA, as poaDecomp() does for each
+* time step, filling in the current index, day start, day of year and dew point of pA as pvsamv1 does.
+*
+* With warmStart, the GTI-DIRINT iteration of a time step starts from the correction to the measured POA that solved the previous
+* time step, which usually converges in fewer model evaluations for subhourly data. A warm start that does not converge within
+* 1 W/m2 in five evaluations is repeated from the measured POA, so the decomposition is as accurate as poaDecomp(); without
+* warmStart the results are identical to it. Time steps with the sun down (incidence angle -999 in pA) return zero without any model evaluation.
+*
+* The sky is told apart from the measured POA alone, without a model evaluation: a change in the clearness of the POA on the plane
+* (the POA over the extraterrestrial irradiance on the plane) of more than 0.15 from the previous time step is a passing cloud, whose
+* correction has little to do with the previous one, so that time step starts from the measured POA instead. A steady sky after a
+* time step with a clear sky Kt prime is counted as clear sky.
+*
+* \param[in] pA POA data for the whole year, as set up for poaDecomp()
+* \param[in] start index of the first time step in pA
+* \param[in] n number of time steps
+* \param[in] tDew dew point temperature of each time step (C)
+* \param[in] alb albedo (0-1)
+* \param[in] warmStart start each time step from the previous solution
+* \param[out] dn Direct Normal Irradiance (W/m2)
+* \param[out] df Diffuse Horizontal Irradiance (W/m2)
+* \param[out] gh Global Horizontal Irradiance (W/m2)
+* \param[out] poa calculated plane-of-array irradiances (beam, sky diffuse, ground diffuse) (W/m2)
+* \param[out] errorcode 0 if successful, otherwise 40, 41, or 42 if the decomposed dni, dhi, or ghi was negative, as poaDecomp()
+* \param[out] stats iteration statistics, if not null
+* \return the number of time steps with a nonzero error code
+*/
+int poaDecomp_batch( poaDecompReq &pA, size_t start, size_t n, const double *tDew, double alb, bool warmStart,
+	double *dn, double *df, double *gh, double *poa[3], int *errorcode, poa_decomp_stats *stats = 0);
+
 /**
 * ModifiedDISC calculates direct normal (beam) radiation from global horizontal radiation.
 *  This function uses a disc beam model to calculate the beam irradiance returned. 
@@ -276,6 +397,121 @@ double shadeFraction1x(double solazi, double solzen, double tilt, double azimuth
 double backtrack(double solazi, double solzen, double tilt, double azimuth, double rotlim, double gcr, double rotation);
 
 
+/**
+* \class sun_position_cache
+*
+*  Stores the sun position that irrad::calc() computes for each time step of a weather file at one location,
+*  so that irradiance processors for other subarrays, or for later simulation years over the same weather data,
+*  reuse it instead of calling solarpos() again. Sunrise and sunset hours are stored once per day.
+*  Different time steps may be calculated on different threads at once, but each time step only on one thread at a time.
+*/
+class sun_position_cache
+{
+public:
+	/// Create an empty cache for the location, with room for the given number of time steps
+	sun_position_cache(double latitudeDegrees, double longitudeDegrees, double timezone, size_t numberOfSteps);
+
+	/// Return true if the cache applies to the location
+	bool at_location(double latitudeDegrees, double longitudeDegrees, double timezone) const;
+
+	/// Return the number of sun position and sunrise/sunset calculations avoided so far
+	size_t hits() const { return numberOfHits.load(); }
+
+	/// Fill the cache for every record of the weather data with sun_position_batch(), returning false if a record could not be read
+	bool precompute(weather_data_provider &weatherData, double delt);
+
+private:
+	friend class irrad;
+
+	struct step {
+		step() : valid(false) {}
+		bool valid;
+		int year, month, day, hour;
+		double minute, delt;
+		double sunAnglesRadians[9];
+		int timeStepSunPosition[3];
+	};
+
+	double latitudeDegrees, longitudeDegrees, timezone;
+	std::vector<step> steps;
+	std::unordered_map<int, std::pair<double, double> > sunriseSunset;	///< keyed by year * 10000 + month * 100 + day
+	std::mutex sunriseSunsetLock;	///< time steps of the same day can be calculated on different threads
+	std::atomic<size_t> numberOfHits;
+};
+
+/**
+* \class bifacial_view_factors
+*
+*  Holds the parts of the rear-side irradiance model in irrad::calc_rear_side() that depend only on the row geometry:
+*  the sky configuration factors of the ground, and which part of the ground or of the next row each cell row of the
+*  module sees in each degree of its field of view. It also holds the working arrays used at each time step.
+*  Keep one per subarray, so that a fixed-tilt subarray calculates the geometry once; a tracked subarray recalculates
+*  it when the tilt changes, into the same storage.
+*/
+class bifacial_view_factors
+{
+public:
+	/// Create empty view factors, with storage for the ground intervals and module cell rows
+	bifacial_view_factors();
+
+	/// Return the number of time steps that reused the view factors calculated for a previous time step
+	size_t hits() const { return numberOfHits; }
+
+private:
+	friend class irrad;
+
+	static const size_t intervals = 100;	///< number of ground intervals between rows
+	static const size_t cellRows = 6;		///< number of cell rows along the module slope
+	static const size_t degrees = 180;		///< field of view of a cell row, in one degree steps
+
+	/* the ground seen by a cell row within one degree */
+	struct ground_view {
+		bool average;					// the projection spans the row spacing, so the average ground irradiance applies
+		int index1, index2;				// ground intervals at the ends of the projection
+		double projectedX1, projectedX2;	// ends of the projection, in ground intervals
+	};
+
+	/* a cell row's view of the sky, the ground and (rear side) the front of the next row */
+	struct cell_row_view {
+		size_t iStopIso;				// last whole degree that sees the sky
+		size_t iHorBright;				// number of whole degrees with horizon brightening
+		size_t iStartGrd;				// first whole degree that sees the ground
+		std::vector<ground_view> ground;	// for degrees iStartGrd to 179
+		std::vector<double> reflected;		// rear side, for degrees iStopIso to iStartGrd - 1: length of each front cell row seen, then the total length seen
+	};
+
+	/* the cell rows of one side of the module, and the geometry they were calculated for */
+	struct side_view {
+		side_view() : valid(false) {}
+		bool valid;
+		double rowToRow, verticalHeight, clearanceGround, distanceBetweenRows, horizontalLength, tiltRadians;
+		cell_row_view rows[cellRows];
+
+		bool same_geometry(double rowToRow, double verticalHeight, double clearanceGround, double distanceBetweenRows, double horizontalLength, double tiltRadians) const;
+	};
+
+	/* calculate the ground positions and sky configuration factors, unless they apply to the geometry already */
+	void set_ground(double rowToRow, double verticalHeight, double clearanceGround, double distanceBetweenRows, double horizontalLength);
+
+	/* calculate the view of each cell row on the front or rear side, unless it applies to the geometry already */
+	void set_front_view(double rowToRow, double verticalHeight, double clearanceGround, double distanceBetweenRows, double horizontalLength, double tiltRadians);
+	void set_rear_view(double rowToRow, double verticalHeight, double clearanceGround, double distanceBetweenRows, double horizontalLength, double tiltRadians);
+
+	// geometry of the ground between rows
+	bool groundValid;
+	double groundRowToRow, groundVerticalHeight, groundClearanceGround, groundDistanceBetweenRows, groundHorizontalLength;
+	std::vector<double> groundPosition;		///< center of each ground interval, measured from the front of the row
+	std::vector<double> skyConfigFactors;		///< sky configuration factor of each ground interval, for both the front and rear ground
+	side_view front, rear;
+
+	// working arrays for one time step
+	std::vector<int> rearGroundShade, frontGroundShade;
+	std::vector<double> rearGroundGHI, frontGroundGHI;
+	std::vector<double> frontIrradiance, frontReflected, rearIrradiance;
+
+	size_t numberOfHits;
+};
+
 /**
 * \class irrad
 *
@@ -329,6 +565,28 @@ protected:
 	int timeStepSunPosition[3];				///< [0] effective hour of day used for sun position, [1] effective minute of hour used for sun position, [2] is sun up?  (0=no, 1=midday, 2=sunup, 3=sundown)
 	double planeOfArrayIrradianceRearAverage; ///< Average rear side plane-of-array irradiance (W/m2)
 
+	// Sun position cache
+	sun_position_cache * sunPositionCache;	///< Optional cache of sun positions shared between irradiance processors
+	size_t sunPositionIndex;				///< Time step index in the sun position cache
+
+	/// Calculate sunAnglesRadians and timeStepSunPosition for the current time step, using the cache if set
+	void calc_sun_position();
+
+	/// Calculate the sunrise and sunset hours in local standard time for the current day
+	void calc_sunrise_sunset(double *sunrise, double *sunset);
+
+	/// Calculate which ground intervals are shaded into the view factors' ground shade arrays, and the shaded fractions of the module
+	void calc_ground_shade(bifacial_view_factors &viewFactors, double rowToRow, double verticalHeight, double clearanceGround, double distanceBetweenRows, double horizontalLength, double solarAzimuthRadians, double solarElevationRadians, double & maxShadow, double & pvBackShadeFraction, double & pvFrontShadeFraction);
+
+	/// Calculate the global horizontal irradiance of each ground interval from its sky configuration factor and shading
+	void calc_ground_ghi(double transmissionFactor, const double *rearSkyConfigFactors, const double *frontSkyConfigFactors, const int *rearGroundShade, const int *frontGroundShade, double *rearGroundGHI, double *frontGroundGHI);
+
+	/// Calculate the front surface irradiance and reflected irradiance of each cell row
+	void calc_front_surface(bifacial_view_factors &viewFactors, double pvFrontShadeFraction, double rowToRow, double verticalHeight, double clearanceGround, double distanceBetweenRows, double horizontalLength, const double *frontGroundGHI, double *frontIrradiance, double & frontAverageIrradiance, double *frontReflected);
+
+	/// Calculate the rear surface irradiance of each cell row
+	void calc_back_surface(bifacial_view_factors &viewFactors, double pvBackShadeFraction, double rowToRow, double verticalHeight, double clearanceGround, double distanceBetweenRows, double horizontalLength, const double *rearGroundGHI, const double *frontGroundGHI, const double *frontReflected, double *rearIrradiance, double & rearAverageIrradiance);
+
 public:
 
 	/// Directive to indicate that if delt_hr is less than zero, do not interpolate sunrise and sunset hours
@@ -342,7 +600,7 @@ public:
 		int skyModel, int radiationModeIn, int trackModeIn,
 		bool useWeatherFileAlbedo, bool instantaneousWeather, bool backtrackingEnabled,
 		double dtHour, double tiltDegrees, double azimuthDegrees, double trackerRotationLimitDegrees, double groundCoverageRatio,
-		std::vector<double> monthlyTiltDegrees, std::vector<double> userSpecifiedAlbedo,
+		const std::vector<double> &monthlyTiltDegrees, const std::vector<double> &userSpecifiedAlbedo,
 		poaDecompReq * poaAllIn);
 
 	/// Construct the irrad class with an Irradiance_IO() object and Subarray_IO() object
@@ -381,14 +639,17 @@ public:
 	/// Set the plane-of-array irradiance from a pyronometer
 	void set_poa_pyranometer( double poa, poaDecompReq* );
 
+	/// Use a sun position cache for the time step with the given index in the weather data
+	void set_sun_position_cache(sun_position_cache * cache, size_t index);
+
 	/// Function to overwrite internally calculated sun position values, primarily to enable testing against other libraries using different sun position calculations
 	void set_sun_component(size_t index, double value);
 
 	/// Run the irradiance processor and calculate the plane-of-array irradiance and diffuse components of irradiance
 	int calc();
 
-	/// Run the irradiance processor for the rear-side of the surface to calculate rear-side plane-of-array irradiance
-	int calc_rear_side(double transmissionFactor, double groundClearanceHeight, double slopeLength);
+	/// Run the irradiance processor for the rear-side of the surface to calculate rear-side plane-of-array irradiance, reusing the view factors of the subarray if given
+	int calc_rear_side(double transmissionFactor, double groundClearanceHeight, double slopeLength, bifacial_view_factors * viewFactors = 0);
 	
 	/// Return the calculated sun angles, some of which are converted to degrees
 	void get_sun( double *solazi,
@@ -435,13 +696,13 @@ public:
 	void getGroundShadeFactors(double rowToRow, double verticalHeight, double clearanceGround, double distanceBetweenRows, double horizontalLength, double solarAzimuthRadians, double solarElevationRadians, std::vector<int> & rearGroundFactors, std::vector<int> & frontGroundFactors, double & maxShadow, double & pvBackShadeFraction, double & pvFrontShadeFraction);
 
 	/// Return the ground global-horizonal irradiance, used by \link calc_rear_side()
-	void getGroundGHI(double transmissionFactor, std::vector<double> rearSkyConfigFactors, std::vector<double> frontSkyConfigFactors, std::vector<int> rearGroundShadeFactors, std::vector<int> frontGroundShadeFactors, std::vector<double> & rearGroundGHI, std::vector<double> & frontGroundGHI);
+	void getGroundGHI(double transmissionFactor, const std::vector<double> & rearSkyConfigFactors, const std::vector<double> & frontSkyConfigFactors, const std::vector<int> & rearGroundShadeFactors, const std::vector<int> & frontGroundShadeFactors, std::vector<double> & rearGroundGHI, std::vector<double> & frontGroundGHI);
 
 	/// Return the back surface irradiances, used by \link calc_rear_side()
-	void getBackSurfaceIrradiances(double pvBackShadeFraction, double rowToRow, double verticalHeight, double clearanceGround, double distanceBetweenRows, double horizontalLength, std::vector<double> rearGroundGHI, std::vector<double> frontGroundGHI, std::vector<double> frontReflected, std::vector<double> & rearIrradiance, double & rearAverageIrradiance);
+	void getBackSurfaceIrradiances(double pvBackShadeFraction, double rowToRow, double verticalHeight, double clearanceGround, double distanceBetweenRows, double horizontalLength, const std::vector<double> & rearGroundGHI, const std::vector<double> & frontGroundGHI, const std::vector<double> & frontReflected, std::vector<double> & rearIrradiance, double & rearAverageIrradiance);
 
 	/// Return the front surface irradiances, used by \link calc_rear_side()
-	void getFrontSurfaceIrradiances(double pvBackShadeFraction, double rowToRow, double verticalHeight, double clearanceGround, double distanceBetweenRows, double horizontalLength, std::vector<double> frontGroundGHI, std::vector<double> & frontIrradiance, double & frontAverageIrradiance, std::vector<double> & frontReflected);
+	void getFrontSurfaceIrradiances(double pvBackShadeFraction, double rowToRow, double verticalHeight, double clearanceGround, double distanceBetweenRows, double horizontalLength, const std::vector<double> & frontGroundGHI, std::vector<double> & frontIrradiance, double & frontAverageIrradiance, std::vector<double> & frontReflected);
 
 	enum RADMODE { DN_DF, DN_GH, GH_DF, POA_R, POA_P };
 	enum SKYMODEL { ISOTROPIC, HDKR, PEREZ };
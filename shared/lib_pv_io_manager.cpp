@@ -92,19 +92,29 @@ Irradiance_IO::Irradiance_IO(compute_module* cm, std::string cmName)
 	radiationMode = cm->as_integer("irrad_mode");
 	skyModel = cm->as_integer("sky_model");
 
-	if (cm->is_assigned("solar_resource_file")) {
+	compute_module::perf_timer weather_timer(cm, "weather_read");
+	if (cm->is_assigned("solar_resource_file") && cm->is_assigned("solar_resource_stream") && cm->as_boolean("solar_resource_stream")) {
+		weatherDataProvider = std::unique_ptr<weather_data_provider>(new weatherfile_stream(cm->as_string("solar_resource_file")));
+		if (!weatherDataProvider->ok()) {
+			// no binary cache could be written, so read the whole file instead
+			cm->log("weather file is not streamed: " + weatherDataProvider->message(), SSC_WARNING);
+			weatherDataProvider.reset();
+		}
+	}
+	if (!weatherDataProvider && cm->is_assigned("solar_resource_file")) {
 		weatherDataProvider = std::unique_ptr<weather_data_provider>(new weatherfile(cm->as_string("solar_resource_file")));
 		weatherfile *weatherFile = dynamic_cast<weatherfile*>(weatherDataProvider.get());
 		if (!weatherFile->ok()) throw compute_module::exec_error(cmName, weatherFile->message());
 		if (weatherFile->has_message()) cm->log(weatherFile->message(), SSC_WARNING);
 	}
-	else if (cm->is_assigned("solar_resource_data")) {
+	else if (!weatherDataProvider && cm->is_assigned("solar_resource_data")) {
 		weatherDataProvider = std::unique_ptr<weather_data_provider>(new weatherdata(cm->lookup("solar_resource_data")));
 		if (weatherDataProvider->has_message()) cm->log(weatherDataProvider->message(), SSC_WARNING);
 	}
-	else {
+	else if (!weatherDataProvider) {
 		throw compute_module::exec_error(cmName, "No weather data supplied");
 	}
+	weather_timer.stop();
 
 	// assumes instantaneous values, unless hourly file with no minute column specified
 	tsShiftHours = 0.0;
@@ -237,18 +247,18 @@ void Irradiance_IO::checkWeatherFile(compute_module * cm, std::string cmName)
 void Irradiance_IO::AllocateOutputs(compute_module* cm)
 {
 	p_weatherFileGHI = cm->allocate("gh", numberOfWeatherFileRecords);
-	p_weatherFileDNI = cm->allocate("dn", numberOfWeatherFileRecords);
-	p_weatherFileDHI = cm->allocate("df", numberOfWeatherFileRecords);
-	p_sunPositionTime = cm->allocate("sunpos_hour", numberOfWeatherFileRecords);
-	p_weatherFileWindSpeed = cm->allocate("wspd", numberOfWeatherFileRecords);
-	p_weatherFileAmbientTemp = cm->allocate("tdry", numberOfWeatherFileRecords);
-	p_weatherFileAlbedo = cm->allocate("alb", numberOfWeatherFileRecords);
-	p_weatherFileSnowDepth = cm->allocate("snowdepth", numberOfWeatherFileRecords);
+	p_weatherFileDNI = cm->allocate_output("dn", numberOfWeatherFileRecords);
+	p_weatherFileDHI = cm->allocate_output("df", numberOfWeatherFileRecords);
+	p_sunPositionTime = cm->allocate_output("sunpos_hour", numberOfWeatherFileRecords);
+	p_weatherFileWindSpeed = cm->allocate_output("wspd", numberOfWeatherFileRecords);
+	p_weatherFileAmbientTemp = cm->allocate_output("tdry", numberOfWeatherFileRecords);
+	p_weatherFileAlbedo = cm->allocate_output("alb", numberOfWeatherFileRecords);
+	p_weatherFileSnowDepth = cm->allocate_output("snowdepth", numberOfWeatherFileRecords);
 
 	// If using input POA, must have POA for every subarray or assume POA applies to each subarray
 	for (size_t subarray = 0; subarray != numberOfSubarrays; subarray++) {
 		std::string wfpoa = "wfpoa" + util::to_string(static_cast<int>(subarray + 1));
-		p_weatherFilePOA.push_back(cm->allocate(wfpoa, numberOfWeatherFileRecords));
+		p_weatherFilePOA.push_back(cm->allocate_output(wfpoa, numberOfWeatherFileRecords));
 	}
 
 	//set up the calculated components of irradiance such that they aren't reported if they aren't assigned
@@ -258,11 +268,11 @@ void Irradiance_IO::AllocateOutputs(compute_module* cm)
 	if (radiationMode == irrad::GH_DF || radiationMode == irrad::POA_R || radiationMode == irrad::POA_P) p_IrradianceCalculated[2] = cm->allocate("dn_calc", numberOfWeatherFileRecords);
 
 	//output arrays for solar position calculations- same for all four subarrays
-	p_sunZenithAngle = cm->allocate("sol_zen", numberOfWeatherFileRecords);
-	p_sunAltitudeAngle = cm->allocate("sol_alt", numberOfWeatherFileRecords);
-	p_sunAzimuthAngle = cm->allocate("sol_azi", numberOfWeatherFileRecords);
-	p_absoluteAirmass = cm->allocate("airmass", numberOfWeatherFileRecords);
-	p_sunUpOverHorizon = cm->allocate("sunup", numberOfWeatherFileRecords);
+	p_sunZenithAngle = cm->allocate_output("sol_zen", numberOfWeatherFileRecords);
+	p_sunAltitudeAngle = cm->allocate_output("sol_alt", numberOfWeatherFileRecords);
+	p_sunAzimuthAngle = cm->allocate_output("sol_azi", numberOfWeatherFileRecords);
+	p_absoluteAirmass = cm->allocate_output("airmass", numberOfWeatherFileRecords);
+	p_sunUpOverHorizon = cm->allocate_output("sunup", numberOfWeatherFileRecords);
 }
 
 void Irradiance_IO::AssignOutputs(compute_module* cm)
@@ -717,6 +727,8 @@ PVSystem_IO::PVSystem_IO(compute_module* cm, std::string cmName, Simulation_IO *
 	}
 	if (enableMismatchVoltageCalc && numberOfSubarrays <= 1)
 		throw compute_module::exec_error(cmName, "Subarray voltage mismatch calculation requires more than one subarray. Please check your inputs.");
+	mismatchVoltageMethod = cm->as_integer("mismatch_vmax_method");
+	mismatchVoltageTolerance = cm->as_double("mismatch_vmax_tolerance");
 
 	// Setup POA inputs if needed 
 	SetupPOAInput();
@@ -733,50 +745,50 @@ void PVSystem_IO::AllocateOutputs(compute_module* cm)
 		if (Subarrays[subarray]->enable)
 		{
 			std::string prefix = Subarrays[subarray]->prefix;
-			p_angleOfIncidence.push_back(cm->allocate(prefix + "aoi", numberOfWeatherFileRecords));
-			p_angleOfIncidenceModifier.push_back(cm->allocate(prefix + "aoi_modifier", numberOfWeatherFileRecords));
-			p_surfaceTilt.push_back(cm->allocate(prefix + "surf_tilt", numberOfWeatherFileRecords));
-			p_surfaceAzimuth.push_back(cm->allocate(prefix + "surf_azi", numberOfWeatherFileRecords));
-			p_axisRotation.push_back(cm->allocate(prefix + "axisrot", numberOfWeatherFileRecords));
-			p_idealRotation.push_back(cm->allocate(prefix + "idealrot", numberOfWeatherFileRecords));
-			p_poaNominalFront.push_back(cm->allocate(prefix + "poa_nom", numberOfWeatherFileRecords));
-			p_poaShadedFront.push_back(cm->allocate(prefix + "poa_shaded", numberOfWeatherFileRecords));
-			p_poaShadedSoiledFront.push_back(cm->allocate(prefix + "poa_shaded_soiled", numberOfWeatherFileRecords));
-			p_poaBeamFront.push_back(cm->allocate(prefix + "poa_eff_beam", numberOfWeatherFileRecords));
-			p_poaDiffuseFront.push_back(cm->allocate(prefix + "poa_eff_diff", numberOfWeatherFileRecords));
-			p_poaTotal.push_back(cm->allocate(prefix + "poa_eff", numberOfWeatherFileRecords));
-			p_poaRear.push_back(cm->allocate(prefix + "poa_rear", numberOfWeatherFileRecords));
-			p_poaFront.push_back(cm->allocate(prefix + "poa_front", numberOfWeatherFileRecords));
-			p_derateSoiling.push_back(cm->allocate(prefix + "soiling_derate", numberOfWeatherFileRecords));
-			p_beamShadingFactor.push_back(cm->allocate(prefix + "beam_shading_factor", numberOfWeatherFileRecords));
-			p_temperatureCell.push_back(cm->allocate(prefix + "celltemp", numberOfWeatherFileRecords));
-			p_moduleEfficiency.push_back(cm->allocate(prefix + "modeff", numberOfWeatherFileRecords));
-			p_dcStringVoltage.push_back(cm->allocate(prefix + "dc_voltage", numberOfWeatherFileRecords));
-			p_voltageOpenCircuit.push_back(cm->allocate(prefix + "voc", numberOfWeatherFileRecords));
-			p_currentShortCircuit.push_back(cm->allocate(prefix + "isc", numberOfWeatherFileRecords));
-			p_dcPowerGross.push_back(cm->allocate(prefix + "dc_gross", numberOfWeatherFileRecords));
-			p_derateLinear.push_back(cm->allocate(prefix + "linear_derate", numberOfWeatherFileRecords));
-			p_derateSelfShading.push_back(cm->allocate(prefix + "ss_derate", numberOfWeatherFileRecords));
-			p_derateSelfShadingDiffuse.push_back(cm->allocate(prefix + "ss_diffuse_derate", numberOfWeatherFileRecords));
-			p_derateSelfShadingReflected.push_back(cm->allocate(prefix + "ss_reflected_derate", numberOfWeatherFileRecords));
+			p_angleOfIncidence.push_back(cm->allocate_output(prefix + "aoi", numberOfWeatherFileRecords));
+			p_angleOfIncidenceModifier.push_back(cm->allocate_output(prefix + "aoi_modifier", numberOfWeatherFileRecords));
+			p_surfaceTilt.push_back(cm->allocate_output(prefix + "surf_tilt", numberOfWeatherFileRecords));
+			p_surfaceAzimuth.push_back(cm->allocate_output(prefix + "surf_azi", numberOfWeatherFileRecords));
+			p_axisRotation.push_back(cm->allocate_output(prefix + "axisrot", numberOfWeatherFileRecords));
+			p_idealRotation.push_back(cm->allocate_output(prefix + "idealrot", numberOfWeatherFileRecords));
+			p_poaNominalFront.push_back(cm->allocate_output(prefix + "poa_nom", numberOfWeatherFileRecords));
+			p_poaShadedFront.push_back(cm->allocate_output(prefix + "poa_shaded", numberOfWeatherFileRecords));
+			p_poaShadedSoiledFront.push_back(cm->allocate_output(prefix + "poa_shaded_soiled", numberOfWeatherFileRecords));
+			p_poaBeamFront.push_back(cm->allocate_output(prefix + "poa_eff_beam", numberOfWeatherFileRecords));
+			p_poaDiffuseFront.push_back(cm->allocate_output(prefix + "poa_eff_diff", numberOfWeatherFileRecords));
+			p_poaTotal.push_back(cm->allocate_output(prefix + "poa_eff", numberOfWeatherFileRecords));
+			p_poaRear.push_back(cm->allocate_output(prefix + "poa_rear", numberOfWeatherFileRecords));
+			p_poaFront.push_back(cm->allocate_output(prefix + "poa_front", numberOfWeatherFileRecords));
+			p_derateSoiling.push_back(cm->allocate_output(prefix + "soiling_derate", numberOfWeatherFileRecords));
+			p_beamShadingFactor.push_back(cm->allocate_output(prefix + "beam_shading_factor", numberOfWeatherFileRecords));
+			p_temperatureCell.push_back(cm->allocate_output(prefix + "celltemp", numberOfWeatherFileRecords));
+			p_moduleEfficiency.push_back(cm->allocate_output(prefix + "modeff", numberOfWeatherFileRecords));
+			p_dcStringVoltage.push_back(cm->allocate_output(prefix + "dc_voltage", numberOfWeatherFileRecords));
+			p_voltageOpenCircuit.push_back(cm->allocate_output(prefix + "voc", numberOfWeatherFileRecords));
+			p_currentShortCircuit.push_back(cm->allocate_output(prefix + "isc", numberOfWeatherFileRecords));
+			p_dcPowerGross.push_back(cm->allocate_output(prefix + "dc_gross", numberOfWeatherFileRecords));
+			p_derateLinear.push_back(cm->allocate_output(prefix + "linear_derate", numberOfWeatherFileRecords));
+			p_derateSelfShading.push_back(cm->allocate_output(prefix + "ss_derate", numberOfWeatherFileRecords));
+			p_derateSelfShadingDiffuse.push_back(cm->allocate_output(prefix + "ss_diffuse_derate", numberOfWeatherFileRecords));
+			p_derateSelfShadingReflected.push_back(cm->allocate_output(prefix + "ss_reflected_derate", numberOfWeatherFileRecords));
 
 			if (enableSnowModel) {
-				p_snowLoss.push_back(cm->allocate(prefix + "snow_loss", numberOfWeatherFileRecords));
-				p_snowCoverage.push_back(cm->allocate(prefix + "snow_coverage", numberOfWeatherFileRecords));
+				p_snowLoss.push_back(cm->allocate_output(prefix + "snow_loss", numberOfWeatherFileRecords));
+				p_snowCoverage.push_back(cm->allocate_output(prefix + "snow_coverage", numberOfWeatherFileRecords));
 			}
 
 			if (Subarrays[subarray]->enableSelfShadingOutputs)
 			{
 				// ShadeDB validation
-				p_shadeDB_GPOA.push_back(cm->allocate("shadedb_" + prefix + "gpoa", numberOfWeatherFileRecords));
-				p_shadeDB_DPOA.push_back(cm->allocate("shadedb_" + prefix + "dpoa", numberOfWeatherFileRecords));
-				p_shadeDB_temperatureCell.push_back(cm->allocate("shadedb_" + prefix + "pv_cell_temp", numberOfWeatherFileRecords));
-				p_shadeDB_modulesPerString.push_back(cm->allocate("shadedb_" + prefix + "mods_per_str", numberOfWeatherFileRecords));
-				p_shadeDB_voltageMaxPowerSTC.push_back(cm->allocate("shadedb_" + prefix + "str_vmp_stc", numberOfWeatherFileRecords));
-				p_shadeDB_voltageMPPTLow.push_back(cm->allocate("shadedb_" + prefix + "mppt_lo", numberOfWeatherFileRecords));
-				p_shadeDB_voltageMPPTHigh.push_back(cm->allocate("shadedb_" + prefix + "mppt_hi", numberOfWeatherFileRecords));
+				p_shadeDB_GPOA.push_back(cm->allocate_output("shadedb_" + prefix + "gpoa", numberOfWeatherFileRecords));
+				p_shadeDB_DPOA.push_back(cm->allocate_output("shadedb_" + prefix + "dpoa", numberOfWeatherFileRecords));
+				p_shadeDB_temperatureCell.push_back(cm->allocate_output("shadedb_" + prefix + "pv_cell_temp", numberOfWeatherFileRecords));
+				p_shadeDB_modulesPerString.push_back(cm->allocate_output("shadedb_" + prefix + "mods_per_str", numberOfWeatherFileRecords));
+				p_shadeDB_voltageMaxPowerSTC.push_back(cm->allocate_output("shadedb_" + prefix + "str_vmp_stc", numberOfWeatherFileRecords));
+				p_shadeDB_voltageMPPTLow.push_back(cm->allocate_output("shadedb_" + prefix + "mppt_lo", numberOfWeatherFileRecords));
+				p_shadeDB_voltageMPPTHigh.push_back(cm->allocate_output("shadedb_" + prefix + "mppt_hi", numberOfWeatherFileRecords));
 			}
-			p_shadeDBShadeFraction.push_back(cm->allocate("shadedb_" + prefix + "shade_frac", numberOfWeatherFileRecords));
+			p_shadeDBShadeFraction.push_back(cm->allocate_output("shadedb_" + prefix + "shade_frac", numberOfWeatherFileRecords));
 		}
 	}
 
@@ -786,9 +798,9 @@ void PVSystem_IO::AllocateOutputs(compute_module* cm)
 		p_dcPowerNetPerMppt.push_back(cm->allocate("inverterMppt" + std::to_string(mppt_input + 1) + "_NetDCPower", numberOfLifetimeRecords));
 	}
 
-	p_transformerNoLoadLoss = cm->allocate("xfmr_nll_ts", numberOfWeatherFileRecords);
-	p_transformerLoadLoss = cm->allocate("xfmr_ll_ts", numberOfWeatherFileRecords);
-	p_transformerLoss = cm->allocate("xfmr_loss_ts", numberOfWeatherFileRecords);
+	p_transformerNoLoadLoss = cm->allocate_output("xfmr_nll_ts", numberOfWeatherFileRecords);
+	p_transformerLoadLoss = cm->allocate_output("xfmr_ll_ts", numberOfWeatherFileRecords);
+	p_transformerLoss = cm->allocate_output("xfmr_loss_ts", numberOfWeatherFileRecords);
 
 	p_poaFrontNominalTotal = cm->allocate("poa_nom", numberOfWeatherFileRecords);
 	p_poaFrontBeamNominalTotal = cm->allocate("poa_beam_nom", numberOfWeatherFileRecords);
@@ -801,17 +813,17 @@ void PVSystem_IO::AllocateOutputs(compute_module* cm)
 
 	p_snowLossTotal = cm->allocate("dc_snow_loss", numberOfWeatherFileRecords);
 
-	p_inverterEfficiency = cm->allocate("inv_eff", numberOfWeatherFileRecords);
+	p_inverterEfficiency = cm->allocate_output("inv_eff", numberOfWeatherFileRecords);
 	p_inverterClipLoss = cm->allocate("inv_cliploss", numberOfWeatherFileRecords);
 	p_inverterMPPTLoss = cm->allocate("dc_invmppt_loss", numberOfWeatherFileRecords);
 
 	p_inverterPowerConsumptionLoss = cm->allocate("inv_psoloss", numberOfWeatherFileRecords);
 	p_inverterNightTimeLoss = cm->allocate("inv_pntloss", numberOfWeatherFileRecords);
 	p_inverterThermalLoss = cm->allocate("inv_tdcloss", numberOfWeatherFileRecords);
-	p_inverterTotalLoss = cm->allocate("inv_total_loss", numberOfWeatherFileRecords);
+	p_inverterTotalLoss = cm->allocate_output("inv_total_loss", numberOfWeatherFileRecords);
 
-	p_acWiringLoss = cm->allocate("ac_wiring_loss", numberOfWeatherFileRecords);
-	p_transmissionLoss = cm->allocate("ac_transmission_loss", numberOfWeatherFileRecords);
+	p_acWiringLoss = cm->allocate_output("ac_wiring_loss", numberOfWeatherFileRecords);
+	p_transmissionLoss = cm->allocate_output("ac_transmission_loss", numberOfWeatherFileRecords);
 	p_systemDCPower = cm->allocate("dc_net", numberOfLifetimeRecords);
 	p_systemACPower = cm->allocate("gen", numberOfLifetimeRecords);
 
@@ -25,6 +25,7 @@
 
 enum modulePowerModelList { MODULE_SIMPLE_EFFICIENCY, MODULE_CEC_DATABASE, MODULE_CEC_USER_INPUT, MODULE_SANDIA, MODULE_IEC61853, MODULE_PVYIELD };
 enum inverterTypeList { INVERTER_CEC_DATABASE, INVERTER_DATASHEET, INVERTER_PARTLOAD, INVERTER_COEFFICIENT_GEN, INVERTER_PVYIELD };
+enum mismatchVoltageMethodList { MISMATCH_VOLTAGE_SWEEP, MISMATCH_VOLTAGE_GOLDEN_SECTION };
 
 /// Structure containing data relevent at the SimulationManager level
 struct Simulation_IO;
@@ -264,6 +265,8 @@ struct PVSystem_IO
 	flag clipMpptWindow;
 	std::vector<std::vector<int> > mpptMapping;	///< vector to hold the mapping between subarrays and mppt inputs
 	flag enableMismatchVoltageCalc;		///< Whether or not to compute mismatch between multiple subarrays attached to the same mppt input
+	int mismatchVoltageMethod;			///< How to find the string voltage of maximum power for mismatch, from mismatchVoltageMethodList
+	double mismatchVoltageTolerance;	///< String voltage tolerance of the golden-section search for mismatch (V)
 
 	std::vector<double> dcDegradationFactor; 
 	std::vector<double> dcLifetimeLosses;
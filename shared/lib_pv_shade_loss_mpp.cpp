@@ -24,7 +24,7 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <functional>   // std::greater
 #include <algorithm>    // std::sort
 #include <math.h> // logarithm function
-#include <cstring> // memcpy
+#include <memory>
 
 #include "lib_miniz.h" // decompression
 #include "DB8_vmpp_impp_uint8_bin.h" // char* of binary compressed file
@@ -38,8 +38,54 @@ typedef unsigned char uint8;
 typedef unsigned short uint16;
 typedef unsigned int uint;
 
+static const size_t vmpp_uint8_size = 12091680; // uint8 size from matlab
+static const size_t impp_uint8_size = 12091680; // uint8 size from matlab
+static const size_t compressed_size = 3133517; // from modified example5.c in miniz project
+
+// the decompressed vmpp table followed by the impp table, shared by every ShadeDB8_mpp
+struct db8_tables
+{
+	std::unique_ptr<uint8[]> data;
+	std::string error;
+
+	db8_tables() : data(new uint8[vmpp_uint8_size + impp_uint8_size])
+	{
+		// decompress straight into the final buffer
+		size_t status = tinfl_decompress_mem_to_mem((void *)data.get(), vmpp_uint8_size + impp_uint8_size, pCmp_data, compressed_size, TINFL_FLAG_PARSE_ZLIB_HEADER);
+		if (status == TINFL_DECOMPRESS_MEM_TO_MEM_FAILED)
+		{
+			std::stringstream outm;
+			outm << "tinfl_decompress_mem_to_mem() failed with status " << (int)status;
+			error = outm.str();
+			data.reset();
+		}
+	}
+};
+
+// initialization of a function local static is thread-safe, so the first caller decompresses and any others wait for it
+static const db8_tables &shared_db8_tables()
+{
+	static const db8_tables tables;
+	return tables;
+}
+
+bool ShadeDB8_mpp::load_tables()
+{
+	const db8_tables &tables = shared_db8_tables();
+	if (!tables.data)
+	{
+		p_error_msg = tables.error;
+		return false;
+	}
+	p_vmpp = tables.data.get();
+	p_impp = tables.data.get() + vmpp_uint8_size;
+	return true;
+}
+
 short ShadeDB8_mpp::get_vmpp(size_t i)
 {
+	if (!p_vmpp && !load_tables())
+		return -1;
 	if (i < 6045840) // uint16 check
 		return (short)((p_vmpp[2 * i + 1] << 8) | p_vmpp[2 * i]); 
 	else 
@@ -48,6 +94,8 @@ short ShadeDB8_mpp::get_vmpp(size_t i)
 
 short ShadeDB8_mpp::get_impp(size_t i)
 { 
+	if (!p_impp && !load_tables())
+		return -1;
 	if (i < 6045840) // uint16 check
 		return (short)((p_impp[2 * i + 1] << 8) | p_impp[2 * i]); 
 	else 
@@ -161,50 +209,48 @@ void ShadeDB8_mpp::init()
 {
 	p_error_msg = "";
 	p_warning_msg = "";
-	p_vmpp_uint8_size = 12091680; // uint8 size from matlab
-	p_impp_uint8_size = 12091680; // uint8 size from matlab
-	p_vmpp = (unsigned char *)malloc(p_vmpp_uint8_size);//malloc(12091680); uint8 size
-	p_impp = (unsigned char *)malloc(p_impp_uint8_size);//malloc(12091680); uint8 size
-	p_compressed_size = 3133517; // from modified example5.c in miniz project
-	decompress_file_to_uint8();
+	// the shared tables are decompressed on the first read, so runs that never use the database do not pay for it
 }
 
-ShadeDB8_mpp::~ShadeDB8_mpp()
+size_t ShadeDB8_mpp::get_pattern_index(const int *str_shade, size_t num_strings)
 {
-	if (p_vmpp)
-		free(p_vmpp);
-	if (p_impp)
-		free(p_impp);
+	// rank of the pattern among the non-increasing patterns with the same number of strings and the same maximum,
+	// ordered from the second string on. There are C(x + r, r) non-increasing tails of length r with values up to x,
+	// so the patterns that first differ at string j with a smaller value number C(str_shade[j] + r, r + 1).
+	// The original search kept counting to the end of its innermost loop after a match, so with three or more
+	// strings the last string takes the value of the one before it; that row is kept so results do not change.
+	size_t S = 1;
+	for (size_t j = 1; j < num_strings; j++)
+	{
+		int shade = ((j == num_strings - 1) && (num_strings > 2)) ? str_shade[j - 1] : str_shade[j];
+		size_t r = num_strings - j - 1;
+		S += n_choose_k((size_t)shade + r, r + 1);
+	}
+	return S;
 }
 
-
-
-bool ShadeDB8_mpp::decompress_file_to_uint8()
+bool ShadeDB8_mpp::get_row(const size_t &N, const size_t &d, const size_t &t, const size_t &S, const row_cache_entry **row)
 {
-	size_t status;
-	uint8 *pTmp_data;
-
-	size_t mem_size = p_vmpp_uint8_size + p_impp_uint8_size;
-
-	pTmp_data = (uint8 *)malloc(mem_size);
-
-	status = tinfl_decompress_mem_to_mem((void *)pTmp_data, mem_size, pCmp_data, p_compressed_size, TINFL_FLAG_PARSE_ZLIB_HEADER);
-
-	memcpy(p_vmpp, pTmp_data, p_vmpp_uint8_size);
-	memcpy(p_impp, pTmp_data + p_vmpp_uint8_size, p_impp_uint8_size);
-
-	free(pTmp_data);
-
-	if (status == TINFL_DECOMPRESS_MEM_TO_MEM_FAILED)
+	// hourly shade patterns repeat often, so the decoded rows are kept in a small direct mapped cache
+	row_cache_entry &entry = p_row_cache[(S * 131 + t * 17 + d * 7 + N) % row_cache_size];
+	if ((entry.N != N) || (entry.d != d) || (entry.t != t) || (entry.S != S))
 	{
-		std::stringstream outm;
-		outm << "tinfl_decompress_mem_to_mem() failed with status " << (int)status;
-		p_error_msg = outm.str();
-		return EXIT_FAILURE;
+		size_t ndx;
+		if (!get_index(N, d, t, S, VMPP, &ndx))
+			return false;
+		for (size_t i = 0; i < row_length; i++)
+		{
+			entry.vmpp[i] = (double)get_vmpp(ndx + i) / 1000.0;
+			entry.impp[i] = (double)get_impp(ndx + i) / 1000.0;
+		}
+		entry.N = N;
+		entry.d = d;
+		entry.t = t;
+		entry.S = S;
 	}
-
+	*row = &entry;
 	return true;
-};
+}
 
 double ShadeDB8_mpp::get_shade_loss(double &gpoa, double &dpoa, std::vector<double> &shade_frac, bool use_pv_cell_temp, double pv_cell_temp, int mods_per_str, double str_vmp_stc, double mppt_lo, double mppt_hi)
 {
@@ -221,186 +267,50 @@ double ShadeDB8_mpp::get_shade_loss(double &gpoa, double &dpoa, std::vector<doub
 		//Need to round them to 10s (note should be integer)
 		for (size_t i = 0; i < num_strings; i++)
 			shade_frac[i] /= 10.0;
-		std::vector<int> str_shade;
-		for (size_t i = 0; i < num_strings; i++)
-			str_shade.push_back((int)round(shade_frac[i]));
+		int str_shade[8];
 		int s_max = -1; // = str_shade[0]
 		int s_sum = 0; // = str_shade[0] that is if first element zero then sum should be zero
 		for (size_t i = 0; i < num_strings; i++)
 		{
-			if (str_shade[i] > s_max) s_max = str_shade[i];
-			s_sum += str_shade[i];
+			int shade = (int)round(shade_frac[i]);
+			if (i < 8) str_shade[i] = shade;
+			if (shade > s_max) s_max = shade;
+			s_sum += shade;
 		}
 		//Now get the indices for the DB
 		if ((s_sum > 0) && (gpoa > 0))
 		{
 			int diffuse_frac = (int)round(dpoa * 10.0 / gpoa);
 			if (diffuse_frac < 1) diffuse_frac = 1;
-			int counter = 1;
-			bool found = false;
-			if (num_strings > 1)
-			{
-				counter = 0;
-				for (int i2 = 0; i2 <= s_max; i2++)
-				{
-					if (num_strings == 2)
-					{
-						counter++;
-						std::vector<int> cur_case; // not on OS X { s_max, i2 };
-						cur_case.push_back(s_max);
-						cur_case.push_back(i2);
-						if (str_shade == cur_case)
-							found = true;
-					}
-					else
-					{
-						for (int i3 = 0; i3 <= i2; i3++)
-						{
-							if (num_strings == 3)
-							{
-								counter++;
-								std::vector<int> cur_case; //{ s_max, i2, i3 };
-								cur_case.push_back(s_max);
-								cur_case.push_back(i2);
-								cur_case.push_back(i3);
-								if (str_shade == cur_case)
-									found = true;
-							}
-							else
-							{
-								for (int i4 = 0; i4 <= i3; i4++)
-								{
-									if (num_strings == 4)
-									{
-										counter++;
-										std::vector<int> cur_case;// { s_max, i2, i3, i4 };
-										cur_case.push_back(s_max);
-										cur_case.push_back(i2);
-										cur_case.push_back(i3);
-										cur_case.push_back(i4);
-										if (str_shade == cur_case)
-											found = true;
-									}
-									else
-									{
-										for (int i5 = 0; i5 <= i4; i5++)
-										{
-											if (num_strings == 5)
-											{
-												counter++;
-												std::vector<int> cur_case;// { s_max, i2, i3, i4, i5 };
-												cur_case.push_back(s_max);
-												cur_case.push_back(i2);
-												cur_case.push_back(i3);
-												cur_case.push_back(i4);
-												cur_case.push_back(i5);
-												if (str_shade == cur_case)
-													found = true;
-											}
-											else
-											{
-												for (int i6 = 0; i6 <= i5; i6++)
-												{
-													if (num_strings == 6)
-													{
-														counter++;
-														std::vector<int> cur_case;// { s_max, i2, i3, i4, i5, i6 };
-														cur_case.push_back(s_max);
-														cur_case.push_back(i2);
-														cur_case.push_back(i3);
-														cur_case.push_back(i4);
-														cur_case.push_back(i5);
-														cur_case.push_back(i6);
-														if (str_shade == cur_case)
-															found = true;
-													}
-													else
-													{
-														for (int i7 = 0; i7 <= i6; i7++)
-														{
-															if (num_strings == 7)
-															{
-																counter++;
-																std::vector<int> cur_case;// { s_max, i2, i3, i4, i5, i6, i7 };
-																cur_case.push_back(s_max);
-																cur_case.push_back(i2);
-																cur_case.push_back(i3);
-																cur_case.push_back(i4);
-																cur_case.push_back(i5);
-																cur_case.push_back(i6);
-																cur_case.push_back(i7);
-																if (str_shade == cur_case)
-																	found = true;
-															}
-															else
-															{
-																for (int i8 = 0; i8 <= i7; i8++)
-																{
-																	if (num_strings == 8)
-																	{
-																		counter++;
-																		std::vector<int> cur_case; // { s_max, i2, i3, i4, i5, i6, i7, i8 };
-																		cur_case.push_back(s_max);
-																		cur_case.push_back(i2);
-																		cur_case.push_back(i3);
-																		cur_case.push_back(i4);
-																		cur_case.push_back(i5);
-																		cur_case.push_back(i6);
-																		cur_case.push_back(i7);
-																		cur_case.push_back(i8);
-																		if (str_shade == cur_case)
-																			found = true;
-																	}
-																	else
-																	{
-																		// error message or throw error
-																		counter = 0;
-																	}
-																} // for i7
-																if (found) break;
-
-															}
-														} // for i7
-														if (found) break;
-													}
-												} // for i6
-												if (found) break;
-											}
-										} // for i5
-										if (found) break;
-									}
-								} // for i4
-								if (found) break;
-							}
-						} // for i3
-						if (found) break;
-					}
-					if (found) break;
-				} // for i2
-			} // (num_strings > 1)
-
-
-
-			std::vector<double>vmpp = get_vector(num_strings, diffuse_frac, s_max, counter, ShadeDB8_mpp::VMPP);
-			std::vector<double>impp = get_vector(num_strings, diffuse_frac, s_max, counter, ShadeDB8_mpp::IMPP);
+			// the database covers up to 8 strings with shading up to 10
+			size_t counter = 0;
+			if ((num_strings <= 8) && (s_max <= 10))
+				counter = get_pattern_index(str_shade, num_strings);
+
+			const row_cache_entry *row = NULL;
+			size_t n_points = 0;
+			if (get_row(num_strings, diffuse_frac, s_max, counter, &row))
+				n_points = row_length;
+			const double *vmpp = (row != NULL) ? row->vmpp : NULL;
+			const double *impp = (row != NULL) ? row->impp : NULL;
 			double p_max_frac = 0;
 
 			// temp correction and out of global MPP
 			int p_max_ind = 0;
-			std::vector<double> pmp_fracs;
+			double pmp_fracs[row_length];
 
-			for (size_t i = 0; i < vmpp.size() && i < impp.size(); i++)
+			for (size_t i = 0; i < n_points; i++)
 			{
 				double pmp = vmpp[i] * impp[i];
-				if (use_pv_cell_temp) pmp_fracs.push_back(pmp);
+				pmp_fracs[i] = pmp;
 				if (pmp > p_max_frac)
 				{
 					p_max_frac = pmp;
-					if (use_pv_cell_temp) p_max_ind = (int)i;
+					p_max_ind = (int)i;
 				}
 			}
 
-			if (use_pv_cell_temp)
+			if (use_pv_cell_temp && (n_points > 0))
 			{
 				/*
 				%Try scaling the voltages using the Sandia model.Taking numbers from
@@ -419,13 +329,14 @@ double ShadeDB8_mpp::get_shade_loss(double &gpoa, double &dpoa, std::vector<doub
 				double deltaTc = n*k*(Tc + 273.15) / q; //Thermal voltage
 				double VMaxSTCStrUnshaded = str_vmp_stc;
 				double scale_g = gpoa / 1000.0;
+				double log_g = ::log(scale_g);
 //				double TcVmpMax = vmpp[p_max_ind] * VMaxSTCStrUnshaded + C2*Ns*deltaTc*::log(scale_g) + C3*Ns*pow((deltaTc*::log(scale_g)), 2) + BetaVmp*(Tc - 25);
 //				double TcVmpScale = TcVmpMax / vmpp[p_max_ind] / VMaxSTCStrUnshaded;
 
-				std::vector<double> TcVmps;
+				double TcVmps[row_length];
 
-				for (size_t i = 0; i < vmpp.size(); i++)
-					TcVmps.push_back(vmpp[i] * VMaxSTCStrUnshaded + C2*Ns*deltaTc*::log(scale_g) + C3*Ns*pow((deltaTc*::log(scale_g)), 2) + BetaVmp*(Tc - 25));
+				for (size_t i = 0; i < n_points; i++)
+					TcVmps[i] = vmpp[i] * VMaxSTCStrUnshaded + C2*Ns*deltaTc*log_g + C3*Ns*pow((deltaTc*log_g), 2) + BetaVmp*(Tc - 25);
 				/*
 				%Now want to choose the point with a V in range and highest power
 				%First, figure out which max power point gives lowest loss
@@ -438,7 +349,7 @@ double ShadeDB8_mpp::get_shade_loss(double &gpoa, double &dpoa, std::vector<doub
 				{
 					//	The global max power point is NOT in range
 					double p_frac = 0;
-					for (size_t i = 0; i < TcVmps.size() && i < pmp_fracs.size(); i++)
+					for (size_t i = 0; i < n_points; i++)
 					{
 						if ((TcVmps[i] >= mppt_lo) && (TcVmps[i] <= mppt_hi))
 						{
@@ -454,7 +365,7 @@ double ShadeDB8_mpp::get_shade_loss(double &gpoa, double &dpoa, std::vector<doub
 #ifdef SHADE_DB_DEBUG
 				std::stringstream outm;
 				outm << "\ni,Vmpp,Impp,pmp_fracs,TcVmps\n";
-				for (size_t i = 0; i < TcVmps.size() && i < pmp_fracs.size(); i++)
+				for (size_t i = 0; i < n_points; i++)
 				{
 					outm << i << "," << vmpp[i] << "," << impp[i] << "," << pmp_fracs[i] << "," << TcVmps[i] << "\n";
 				}
@@ -32,6 +32,8 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 extern const unsigned char pCmp_data[3133517];
 // shading database with up to 8 strings
+// the database tables are decompressed once per process, the first time any instance reads them, and shared
+// read-only by all instances, so instances are cheap to create and can be used on different threads
 class ShadeDB8_mpp
 {
 public:
@@ -40,7 +42,6 @@ public:
 		p_vmpp = NULL;
 		p_impp=NULL ;
 	};
-	~ShadeDB8_mpp();
 	void init();
 	short vmpp(size_t ndx){
 		return get_vmpp(ndx);
@@ -51,6 +52,8 @@ public:
 	std::vector<double> get_vector(const size_t &N, const size_t &d, const size_t &t, const size_t &S, const db_type &DB_TYPE);
 	size_t n_choose_k(size_t n, size_t k);
 	bool get_index(const size_t &N, const size_t &d, const size_t &t, const size_t &S, const db_type &DB_TYPE, size_t* ret_ndx);
+	// S argument of get_vector for a string shade pattern sorted in descending order, with values up to 10 and up to 8 strings
+	size_t get_pattern_index(const int *str_shade, size_t num_strings);
 
 	double get_shade_loss(double &gpoa, double &dpoa, std::vector<double> &shade_frac, bool use_pv_cell_temp = false, double pv_cell_temp = 0, int mods_per_str = 0, double str_vmp_stc = 0, double mppt_lo = 0, double mppt_hi = 0);
 	std::string get_warning() { return p_warning_msg; }
@@ -58,14 +61,25 @@ public:
 
 
 private:
-	unsigned char *p_vmpp;
-	unsigned char *p_impp;
+	static const size_t row_length = 8;
+	static const size_t row_cache_size = 64;
+	// decoded vmpp and impp values of one database row, keyed on number of strings, diffuse fraction, maximum shade and pattern
+	struct row_cache_entry
+	{
+		size_t N = 0;
+		size_t d = 0;
+		size_t t = 0;
+		size_t S = 0;
+		double vmpp[row_length];
+		double impp[row_length];
+	};
+	row_cache_entry p_row_cache[row_cache_size];
+	bool get_row(const size_t &N, const size_t &d, const size_t &t, const size_t &S, const row_cache_entry **row);
+	const unsigned char *p_vmpp;
+	const unsigned char *p_impp;
 	short get_vmpp(size_t i);
 	short get_impp(size_t i);
-	bool decompress_file_to_uint8();
-	size_t p_vmpp_uint8_size;
-	size_t p_impp_uint8_size;
-	size_t p_compressed_size;
+	bool load_tables();
 	std::string p_warning_msg;
 	std::string p_error_msg;
 };
@@ -67,10 +67,11 @@ double mask_angle_func(double x, double R, double B, double tilt_eff)
 #define K 5
 #define FUNC(x,R,B,tilt) ((*func)(x,R,B,tilt))
 
-double trapzd(double (*func)(double,double,double,double), double a, double b, double R, double B, double tilt, int n)
+// 's' carries the running estimate between successive refinements; it is owned by the
+// caller rather than held in a function static so that concurrent integrations do not interfere
+double trapzd(double (*func)(double,double,double,double), double a, double b, double R, double B, double tilt, int n, double &s)
 {
 	double x,tnm,sum,del;
-	static double s;
 	int it,j;
 	if (n == 1) 
 	{
@@ -133,15 +134,15 @@ void polint(double xa[], double ya[], int n, double x, double *y, double *dy)
 double qromb(double (*func)(double,double,double,double), double a, double b, double R, double B, double tilt)
 {
 	void polint(double xa[], double ya[], int n, double x, double *y, double *dy);
-	double trapzd(double (*func)(double,double,double,double), double a, double b, double R, double B, double tilt, int n);
+	double trapzd(double (*func)(double,double,double,double), double a, double b, double R, double B, double tilt, int n, double &s);
 	void nrerror(char error_text[]);
-	double ss,dss;
+	double ss,dss,st=0.0;
 	double s[JMAXP],h[JMAXP+1];
 	int j;
 	h[1]=1.0;
 	for (j=1;j<=JMAX;j++) 
 	{
-		s[j]=trapzd(func,a,b,R,B,tilt,j);
+		s[j]=trapzd(func,a,b,R,B,tilt,j,st);
 		if (j >= K) 
 		{
 			polint(&h[j-K],&s[j-K],K,0.0,&ss,&dss);
@@ -178,7 +179,10 @@ void diffuse_reduce(
 	double Gd_poa = poa_sky + poa_gnd;
 	if (Gd_poa < 0.1)
 	{
+		// no derate, so the reduced irradiance is what arrives on the array rather than the previous time step's values
 		Fskydiff = Fgnddiff = 1.0;
+		reduced_skydiff = poa_sky;
+		reduced_gnddiff = poa_gnd;
 		return;
 	}
 
@@ -27,6 +27,11 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <limits>
 #include <numeric>
 #include <algorithm>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
 
 #ifdef _WIN32
 #include <direct.h>
@@ -234,6 +239,27 @@ bool util::remove_file( const char *path )
 	return 0 == ::remove( path );
 }
 
+bool util::replace_file( const char *from, const char *to )
+{
+#ifdef _WIN32
+	return 0 != ::MoveFileExA( from, to, MOVEFILE_REPLACE_EXISTING );
+#else
+	return 0 == ::rename( from, to );
+#endif
+}
+
+std::string util::unique_file_name( const std::string &path )
+{
+	static std::atomic<unsigned long> count( 0 );
+#ifdef _WIN32
+	unsigned long pid = (unsigned long)::GetCurrentProcessId();
+#else
+	unsigned long pid = (unsigned long)::getpid();
+#endif
+	size_t tid = std::hash<std::thread::id>()( std::this_thread::get_id() );
+	return path + "." + std::to_string( pid ) + "." + std::to_string( (unsigned long long)tid ) + "." + std::to_string( count++ );
+}
+
 #ifdef _WIN32
 #define make_dir(x) ::mkdir(x)
 #else
@@ -1177,4 +1203,90 @@ std::vector<double> util::frequency_table(double* values, size_t n_vals, double
         f /= n_vals;
     }
     return freq;
-}
\ No newline at end of file
+}
+
+size_t util::hardware_threads()
+{
+	unsigned int n = std::thread::hardware_concurrency();
+	return n > 0 ? (size_t)n : 1;
+}
+
+void util::parallel_for( size_t n, int n_threads, const std::function<void(size_t)> &f )
+{
+	if (n == 0) return;
+
+	size_t nt = (n_threads < 1) ? hardware_threads() : (size_t)n_threads;
+	if (nt > n) nt = n;
+
+	std::atomic<size_t> next(0);
+	std::atomic<bool> failed(false);
+	std::exception_ptr first_error;
+	std::mutex error_lock;
+
+	auto worker = [&]()
+	{
+		size_t i;
+		while (!failed.load() && (i = next++) < n)
+		{
+			try
+			{
+				f(i);
+			}
+			catch (...)
+			{
+				std::lock_guard<std::mutex> lock(error_lock);
+				if (!first_error) first_error = std::current_exception();
+				failed = true;
+			}
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for (size_t t = 1; t < nt; t++)
+		threads.push_back(std::thread(worker));
+	worker();
+	for (size_t t = 0; t < threads.size(); t++)
+		threads[t].join();
+
+	if (first_error) std::rethrow_exception(first_error);
+}
+
+double util::golden_section_max( const std::function<double(double)> &f, double a, double b, double tolerance, double &f_max, size_t *evaluations )
+{
+	const double invphi = 0.5 * (sqrt(5.0) - 1.0);
+	double c = b - invphi * (b - a);
+	double d = a + invphi * (b - a);
+	double fc = f(c);
+	double fd = f(d);
+	size_t n = 2;
+
+	while (fabs(b - a) > tolerance)
+	{
+		if (fc > fd)
+		{
+			b = d;
+			d = c;
+			fd = fc;
+			c = b - invphi * (b - a);
+			fc = f(c);
+		}
+		else
+		{
+			a = c;
+			c = d;
+			fc = fd;
+			d = a + invphi * (b - a);
+			fd = f(d);
+		}
+		n++;
+	}
+
+	if (evaluations != 0) *evaluations += n;
+	if (fc > fd)
+	{
+		f_max = fc;
+		return c;
+	}
+	f_max = fd;
+	return d;
+}
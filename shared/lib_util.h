@@ -27,6 +27,7 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <string>
 #include <vector>
 #include <cassert>
+#include <functional>
 
 #include <unordered_map>
 using std::unordered_map;
@@ -133,6 +134,8 @@ namespace util
 	bool file_exists( const char *file );
 	bool dir_exists( const char *path );
 	bool remove_file( const char *path );
+	bool replace_file( const char *from, const char *to ); // rename, replacing an existing 'to' in one step
+	std::string unique_file_name( const std::string &path ); // 'path' with a suffix unique to this process, thread and call
 	bool mkdir( const char *path, bool make_full = false); 
 	std::string path_only( const std::string &path );
 	std::string name_only( const std::string &path );
@@ -162,6 +165,20 @@ namespace util
 			v[i] *= scalar;
 	}
 
+	/* number of threads the hardware can run concurrently, at least 1 */
+	size_t hardware_threads();
+
+	/* calls f(i) for every i in [0,n) on up to n_threads worker threads (n_threads < 1 uses hardware_threads()).
+	   the calling thread takes part in the work. workers claim the next unclaimed index as soon as they finish
+	   their current one, so uneven items balance themselves across threads. if any call throws, no new items
+	   are started and the first exception is rethrown on the calling thread once all workers have stopped */
+	void parallel_for( size_t n, int n_threads, const std::function<void(size_t)> &f );
+
+	/* finds the maximum of f on [a,b] by golden-section search, assuming f increases then decreases on the interval.
+	   stops when the bracket is narrower than tolerance and returns the best point evaluated, with its value in f_max.
+	   evaluations, if not null, is incremented by the number of calls to f */
+	double golden_section_max( const std::function<double(double)> &f, double a, double b, double tolerance, double &f_max, size_t *evaluations = 0 );
+
 	class sync_piped_process
 	{
 	public:
@@ -265,33 +282,83 @@ namespace util
 	protected:
 		T *t_array;
 		size_t n_rows, n_cols;
+
+		// storage not allocated by this matrix, see assign_external()
+		bool t_external;
+		void (*t_release)( T *, void * );
+		void *t_release_data;
+
+		void init_storage()
+		{
+			t_array = NULL;
+			n_rows = n_cols = 0;
+			t_external = false;
+			t_release = NULL;
+			t_release_data = NULL;
+		}
+
+		void free_storage()
+		{
+			if (t_array)
+			{
+				if (!t_external) delete [] t_array;
+				else if (t_release) (*t_release)( t_array, t_release_data );
+			}
+			t_array = NULL;
+			t_external = false;
+			t_release = NULL;
+			t_release_data = NULL;
+		}
+
+		// called before the whole matrix is overwritten, so external memory is never written by copy, assign or fill
+		void detach_external()
+		{
+			if (t_external)
+			{
+				free_storage();
+				n_rows = n_cols = 0;
+			}
+		}
+
+		// moves external memory into storage owned by the matrix, keeping the values
+		void own_external()
+		{
+			if (t_external)
+			{
+				size_t nn = n_rows*n_cols;
+				T *p = new T[ nn ];
+				for (size_t i=0;i<nn;i++)
+					p[i] = t_array[i];
+				free_storage();
+				t_array = p;
+			}
+		}
+
 	public:
 
 		matrix_t()
 		{
+			init_storage();
 			t_array = new T[1];
 			n_rows = n_cols = 1;
 		}
 
 		matrix_t( const matrix_t &cc )
 		{
-			n_rows = n_cols = 0;
-			t_array = NULL;
+			init_storage();
 			copy( cc );
 		}
 		
 		matrix_t(size_t len)
 		{
-			n_rows = n_cols = 0;
-			t_array = NULL;
+			init_storage();
 			if (len < 1) len = 1;
 			resize( 1, len );
 		}
 
 		matrix_t(size_t nr, size_t nc)
 		{
-			n_rows = n_cols = 0;
-			t_array = NULL;
+			init_storage();
 			if (nr < 1) nr = 1;
 			if (nc < 1) nc = 1;
 			resize(nr,nc);
@@ -299,8 +366,7 @@ namespace util
 		
 		matrix_t(size_t nr, size_t nc, const T &val)
 		{
-			n_rows = n_cols = 0;
-			t_array = NULL;
+			init_storage();
 			if (nr < 1) nr = 1;
 			if (nc < 1) nc = 1;
 			resize(nr,nc);
@@ -308,8 +374,7 @@ namespace util
 		}
 		matrix_t(size_t nr, size_t nc, const std::vector<T> *val)
 		{
-			n_rows = n_cols = 0;
-			t_array = NULL;
+			init_storage();
 			if (nr < 1) nr = 1;
 			if (nc < 1) nc = 1;
 			resize(nr, nc);
@@ -321,12 +386,12 @@ namespace util
 
 		virtual ~matrix_t()
 		{
-			if (t_array) delete [] t_array;
+			free_storage();
 		}
 		
 		void clear()
 		{
-			if (t_array) delete [] t_array;
+			free_storage();
 			n_rows = n_cols = 1;
 			t_array = new T[1];
 		}
@@ -335,6 +400,7 @@ namespace util
 		{
 			if (this != &rhs)
 			{
+				detach_external();
 				resize( rhs.nrows(), rhs.ncols() );
 				size_t nn = n_rows*n_cols;
 				for (size_t i=0;i<nn;i++)
@@ -344,6 +410,7 @@ namespace util
 
 		void assign( const T *pvalues, size_t len )
 		{
+			detach_external();
 			resize( len );
 			if ( n_cols == len && n_rows == 1 )
 				for (size_t i=0;i<len;i++)
@@ -352,6 +419,7 @@ namespace util
 		
 		void assign( const T *pvalues, size_t nr, size_t nc )
 		{
+			detach_external();
 			resize( nr, nc );
 			if ( n_rows == nr && n_cols == nc )
 			{
@@ -369,8 +437,49 @@ namespace util
 			return *this;
 		}
 		
+		/* uses memory supplied by the caller as storage, without copying it.  if 'release' is given,
+		   ownership moves to this matrix and 'release' is called with 'release_data' once the memory
+		   is no longer used.  otherwise the memory is only borrowed: it must outlive the matrix and
+		   is never freed here.  element writes go to the external memory, but copy(), assign(), fill()
+		   and resizing, even to the same size, always switch back to storage owned by the matrix */
+		void assign_external( T *pvalues, size_t nr, size_t nc, void (*release)( T *, void * ) = NULL, void *release_data = NULL )
+		{
+			if (!pvalues || nr < 1 || nc < 1) return;
+			free_storage();
+			t_array = pvalues;
+			n_rows = nr;
+			n_cols = nc;
+			t_external = true;
+			t_release = release;
+			t_release_data = release_data;
+		}
+
+		inline bool is_external() const
+		{
+			return t_external;
+		}
+
+		/* hands the storage to the caller, who must free it with delete[], and leaves a 1x1 matrix behind.
+		   external memory is copied first, since it was not allocated with new[] */
+		T *release_data()
+		{
+			T *p = t_array;
+			if (t_external)
+			{
+				size_t nn = n_rows*n_cols;
+				p = new T[ nn ];
+				for (size_t i=0;i<nn;i++)
+					p[i] = t_array[i];
+				free_storage();
+			}
+			t_array = new T[1];
+			n_rows = n_cols = 1;
+			return p;
+		}
+
 		matrix_t &operator=(const T &val)
 		{
+			detach_external();
 			resize(1,1);
 			t_array[0] = val;
 			return *this;
@@ -406,6 +515,12 @@ namespace util
 		
 		void fill( const T &val )
 		{
+			if (t_external)
+			{
+				size_t nr = n_rows, nc = n_cols;
+				detach_external();
+				resize( nr, nc );
+			}
 			size_t ncells = n_rows*n_cols;
 			for (size_t i=0;i<ncells;i++)
 				t_array[i] = val;
@@ -413,9 +528,13 @@ namespace util
 		void resize(size_t nr, size_t nc)
 		{
 			if (nr < 1 || nc < 1) return;
-			if (nr == n_rows && nc == n_cols) return;
+			if (nr == n_rows && nc == n_cols)
+			{
+				own_external();
+				return;
+			}
 			
-			if (t_array) delete [] t_array;
+			free_storage();
 			t_array = new T[ nr * nc ];
 			n_rows = nr;
 			n_cols = nc;
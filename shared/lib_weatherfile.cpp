@@ -28,9 +28,16 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <ctype.h>
 #include <numeric>
 #include <limits>
+#include <cfloat>
+#include <cstdint>
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <sys/stat.h>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
 
 #if defined(__WINDOWS__)||defined(WIN32)||defined(_WIN32)
 #define CASECMP(a,b) _stricmp(a,b)
@@ -108,6 +115,180 @@ static float col_or_nan(const std::string &s)
 		return std::numeric_limits<float>::quiet_NaN();;
 }
 
+/* the weather file is read into memory in one call, and its lines are handed out from the buffer
+   with the same contents and end of file behavior as std::getline on a text mode std::ifstream:
+   a read after the last line fails, and once the end is reached, later reads fail and leave
+   the previous line in place */
+class weather_text
+{
+public:
+	weather_text() : m_pos(0), m_eof(false), m_last(0), m_last_len(0) {  }
+
+	bool load( const std::string &file )
+	{
+		std::ifstream ifs( file );
+		if (!ifs.is_open()) return false;
+
+		ifs.seekg( 0, std::ios::end );
+		std::streamoff size = ifs.tellg();
+		ifs.seekg( 0, std::ios::beg );
+		if (size < 0) return false;
+
+		// in text mode the read may return fewer characters than the file size
+		m_text.resize( (size_t)size + 1 );
+		ifs.read( &m_text[0], size );
+		m_text.resize( (size_t)ifs.gcount() );
+		rewind();
+		return true;
+	}
+
+	bool getline( const char *&begin, const char *&end )
+	{
+		if (m_eof)
+		{
+			begin = m_text.data() + m_last;
+			end = begin + m_last_len;
+			return false;
+		}
+
+		if (m_pos >= m_text.size())
+		{
+			m_eof = true;
+			m_last = m_pos;
+			m_last_len = 0;
+			begin = end = m_text.data() + m_pos;
+			return false;
+		}
+
+		const char *p = m_text.data() + m_pos;
+		const char *nl = (const char*)memchr( p, '\n', m_text.size() - m_pos );
+		m_last = m_pos;
+		if (nl)
+		{
+			m_last_len = (size_t)(nl - p);
+			m_pos += m_last_len + 1;
+		}
+		else
+		{
+			m_last_len = m_text.size() - m_pos;
+			m_pos = m_text.size();
+			m_eof = true;
+		}
+		begin = p;
+		end = p + m_last_len;
+		return true;
+	}
+
+	bool getline( std::string &buf )
+	{
+		if (m_eof) return false;
+		const char *begin, *end;
+		bool ok = getline( begin, end );
+		buf.assign( begin, end );
+		return ok;
+	}
+
+	bool eof() const { return m_eof; }
+	void rewind() { m_pos = 0; m_eof = false; m_last = m_last_len = 0; }
+
+private:
+	std::vector<char> m_text;
+	size_t m_pos;
+	bool m_eof;
+	size_t m_last, m_last_len; // offset and length of the last line read
+};
+
+typedef std::pair<const char*, const char*> text_field;
+
+/* splits a line the way split(..) does, without copying the fields: a trailing empty field is dropped */
+static void split_fields( const char *begin, const char *end, std::vector<text_field> &fields, char delim = ',' )
+{
+	fields.clear();
+	const char *p = begin;
+	for (;;)
+	{
+		const char *q = (const char*)memchr( p, delim, (size_t)(end - p) );
+		if (!q)
+		{
+			if (p < end) fields.push_back( text_field( p, end ) );
+			return;
+		}
+		fields.push_back( text_field( p, q ) );
+		p = q + 1;
+	}
+}
+
+/* parses digits with an optional decimal point and nothing else.  a mantissa up to 2^24 and a
+   power of ten up to 10^10 are both exact in a float, so one correctly rounded division gives the
+   same value as strtof, without its locale lookup.  returns false for anything else, including
+   numbers that need more digits, which are left to strtof */
+static bool parse_plain_float( const char *p, const char *end, float *value )
+{
+#if FLT_EVAL_METHOD == 0
+	static const float pow10[] = { 1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f };
+	unsigned long mantissa = 0;
+	int ndigits = 0, nfrac = 0;
+	bool point = false;
+	for ( ; p < end; p++ )
+	{
+		if (*p >= '0' && *p <= '9')
+		{
+			mantissa = mantissa * 10 + (unsigned long)(*p - '0');
+			if (mantissa > 16777216ul) return false;
+			ndigits++;
+			if (point) nfrac++;
+		}
+		else if (*p == '.' && !point)
+			point = true;
+		else
+			return false;
+	}
+	if (ndigits == 0 || nfrac > 10) return false;
+	*value = (float)mantissa / pow10[nfrac];
+	return true;
+#else
+	return false;
+#endif
+}
+
+/* same result as col_or_nan( std::string(begin, end) ) */
+static float field_or_nan( const char *begin, const char *end )
+{
+	float value;
+	if (begin < end)
+	{
+		if (::isdigit(*begin))
+		{
+			if (parse_plain_float( begin, end, &value )) return value;
+		}
+		else if (parse_plain_float( begin + 1, end, &value ))
+			return (*begin == '-') ? (float)(0.0 - value) : value;
+	}
+	return col_or_nan( std::string( begin, end ) );
+}
+
+/* same result as col_or_nan( trimboth( std::string(begin, end) ) ) */
+static float trimmed_field_or_nan( const char *begin, const char *end )
+{
+	while (begin < end && (*begin == ' ' || *begin == '\t')) begin++;
+	while (end > begin && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r' || end[-1] == '\n')) end--;
+	return field_or_nan( begin, end );
+}
+
+/* same result as stoi( std::string(begin, end) ) */
+static int field_to_int( const char *begin, const char *end )
+{
+	if (begin < end && end - begin < 10)
+	{
+		int value = 0;
+		const char *p = begin;
+		while (p < end && *p >= '0' && *p <= '9')
+			value = value * 10 + (*p++ - '0');
+		if (p == end) return value;
+	}
+	return stoi( std::string( begin, end ) );
+}
+
 static double conv_deg_min_sec(double degrees,
 	double minutes,
 	double seconds,
@@ -410,6 +591,86 @@ void weather_record::reset()
 }
 
 
+double weather_data_provider::prefix_sum::average(size_t start, size_t count) const
+{
+	if (nans[start + count] > nans[start])
+		return std::numeric_limits<double>::quiet_NaN();
+
+	return (sum[start + count] - sum[start]) / count;
+}
+
+void weather_data_provider::clear_averages()
+{
+	for (size_t i = 0; i < _MAXCOL_; i++)
+		m_prefix[i] = prefix_sum();
+}
+
+bool weather_data_provider::average_window(size_t index, size_t num_timesteps, size_t n, size_t *start)
+{
+	if (index >= n || num_timesteps == 0 || num_timesteps >= n)
+		return false;
+
+	// center the window on index, shifted to stay within the data
+	*start = (index > num_timesteps / 2) ? index - num_timesteps / 2 : 0;
+	if (*start + num_timesteps > n)
+		*start = n - num_timesteps;
+	return true;
+}
+
+double weather_data_provider::record_value(const weather_record &r, int col)
+{
+	switch (col)
+	{
+	case YEAR: return r.year;
+	case MONTH: return r.month;
+	case DAY: return r.day;
+	case HOUR: return r.hour;
+	case MINUTE: return r.minute;
+	case GHI: return r.gh;
+	case DNI: return r.dn;
+	case DHI: return r.df;
+	case POA: return r.poa;
+	case TDRY: return r.tdry;
+	case TWET: return r.twet;
+	case TDEW: return r.tdew;
+	case WSPD: return r.wspd;
+	case WDIR: return r.wdir;
+	case RH: return r.rhum;
+	case PRES: return r.pres;
+	case SNOW: return r.snow;
+	case ALB: return r.alb;
+	case AOD: return r.aod;
+	default: return std::numeric_limits<double>::quiet_NaN();
+	}
+}
+
+void weather_data_provider::set_record_value(weather_record *r, int col, double value)
+{
+	switch (col)
+	{
+	case YEAR: r->year = (int)value; break;
+	case MONTH: r->month = (int)value; break;
+	case DAY: r->day = (int)value; break;
+	case HOUR: r->hour = (int)value; break;
+	case MINUTE: r->minute = value; break;
+	case GHI: r->gh = value; break;
+	case DNI: r->dn = value; break;
+	case DHI: r->df = value; break;
+	case POA: r->poa = value; break;
+	case TDRY: r->tdry = value; break;
+	case TWET: r->twet = value; break;
+	case TDEW: r->tdew = value; break;
+	case WSPD: r->wspd = value; break;
+	case WDIR: r->wdir = value; break;
+	case RH: r->rhum = value; break;
+	case PRES: r->pres = value; break;
+	case SNOW: r->snow = value; break;
+	case ALB: r->alb = value; break;
+	case AOD: r->aod = value; break;
+	default: break;
+	}
+}
+
 
 #define NBUF 2048
 
@@ -446,6 +707,7 @@ void weatherfile::reset()
 	m_startYear = 1900;
 
 	m_hdr.reset();
+	m_fromBinary = false;
 	//m_rec.reset();
 }
 
@@ -550,6 +812,36 @@ bool weatherfile::timeStepChecks(int hdr_step_sec) {
 }
 
 bool weatherfile::open(const std::string &file, bool header_only)
+{
+	m_shared.reset();
+	clear_averages();
+	if (header_only || file.empty() || cache_limit() == 0)
+		return parse(file, header_only);
+
+	std::shared_ptr<const weatherfile> data = cache_open(file);
+	m_type = data->m_type;
+	m_file = data->m_file;
+	m_startYear = data->m_startYear;
+	m_startSec = data->m_startSec;
+	m_stepSec = data->m_stepSec;
+	m_nRecords = data->m_nRecords;
+	m_hasLeapYear = data->m_hasLeapYear;
+	m_hdr = data->m_hdr;
+	m_message = data->m_message;
+	m_fromBinary = data->m_fromBinary;
+	if (!data->m_ok)
+		return false;
+
+	for (size_t i = 0; i < _MAXCOL_; i++)
+	{
+		m_columns[i].index = -1;
+		m_columns[i].data.clear();
+	}
+	m_shared = data;
+	return true;
+}
+
+bool weatherfile::parse(const std::string &file, bool header_only)
 {
 	if (file.empty())
 	{
@@ -557,6 +849,14 @@ bool weatherfile::open(const std::string &file, bool header_only)
 		return false;
 	}
 
+	m_fromBinary = false;
+	if (cmp_ext(file, "wfbin"))
+		return read_binary(file, header_only, std::string());
+
+	if (!header_only && util::file_exists(binary_cache_file(file).c_str())
+		&& read_binary(binary_cache_file(file), false, file))
+		return true;
+
 	if (cmp_ext(file, "tm2") || cmp_ext(file, "tmy2"))
 		m_type = TMY2;
 	else if (cmp_ext(file, "tm3") || cmp_ext(file, "tmy3"))
@@ -574,9 +874,11 @@ bool weatherfile::open(const std::string &file, bool header_only)
 	}
 
 	std::string buf, buf1;
-	std::ifstream ifs(file);
+	const char *line, *line_end;
+	std::vector<text_field> fields;
+	weather_text text;
 
-	if (!ifs.is_open())
+	if (!text.load(file))
 	{
 		m_message = "could not open file for reading: " + file;
 		m_type = INVALID;
@@ -587,16 +889,15 @@ bool weatherfile::open(const std::string &file, bool header_only)
 	{
 		// if we opened a csv file, it could be SAM/WFCSV format or TMY3
 		// try to autodetect a TMY3
-		getline(ifs, buf);
-		getline(ifs, buf1);
+		text.getline(buf);
+		text.getline(buf1);
 		int ncols = (int)split(buf).size();
 		int ncols1 = (int)split(buf1).size();
 
 		if (ncols == 7 && (ncols1 == 68 || ncols1 == 71))
 			m_type = TMY3;
 
-		ifs.clear();
-		ifs.seekg(0);
+		text.rewind();
 	}
 
 
@@ -611,7 +912,7 @@ bool weatherfile::open(const std::string &file, bool header_only)
 		char pl[256], pc[256], ps[256];
 		int dlat, mlat, dlon, mlon, ielv;
 
-		getline(ifs, buf);
+		text.getline(buf);
 		sscanf(buf.c_str(),
 			"%s %s %s %lg %s %d %d %s %d %d %d",
 			pl, pc, ps,
@@ -633,7 +934,7 @@ bool weatherfile::open(const std::string &file, bool header_only)
 	else if (m_type == TMY3)
 	{
 		/*  724699,"BROOMFIELD/JEFFCO [BOULDER - SURFRAD]",CO,-7.0,40.130,-105.240,1689 */
-		getline(ifs, buf);
+		text.getline(buf);
 		auto cols = split(buf);
 		if (cols.size() != 7)
 		{
@@ -654,24 +955,23 @@ bool weatherfile::open(const std::string &file, bool header_only)
 		m_stepSec = 3600;
 		m_nRecords = 8760;
 
-		getline(ifs, buf); // skip over labels line
+		text.getline(buf); // skip over labels line
 	}
 	else if (m_type == EPW)
 	{
 		m_nRecords = 0; 
 
-		while (getline(ifs, buf) && buf.length() > 0)
+		while (text.getline(line, line_end) && line_end > line)
 			m_nRecords++;
 
 		m_nRecords -= 8;	// remove header lines
-		ifs.clear();
-		ifs.seekg(0);
+		text.rewind();
 
 		if (!timeStepChecks()) return false;
 
 		/*  LOCATION,Cairo Intl Airport,Al Qahirah,EGY,ETMY,623660,30.13,31.40,2.0,74.0 */
 		/*  LOCATION,Alice Springs Airport,NT,AUS,RMY,943260,-23.80,133.88,9.5,547.0 */
-		getline(ifs, buf);
+		text.getline(buf);
 		auto cols = split(buf);
 
 		if (cols.size() != 10)
@@ -693,18 +993,18 @@ bool weatherfile::open(const std::string &file, bool header_only)
 
 		/* skip over excess header lines */
 
-		getline(ifs, buf);  // DESIGN CONDITIONS
-		getline(ifs, buf);  // TYPICAL/EXTREME PERIODS
-		getline(ifs, buf);  // GROUND TEMPERATURES
-		getline(ifs, buf);  // HOLIDAY/DAYLIGHT SAVINGS
-		getline(ifs, buf);  // COMMENTS 1
-		getline(ifs, buf);  // COMMENTS 2
-		getline(ifs, buf);  // DATA PERIODS
+		text.getline(buf);  // DESIGN CONDITIONS
+		text.getline(buf);  // TYPICAL/EXTREME PERIODS
+		text.getline(buf);  // GROUND TEMPERATURES
+		text.getline(buf);  // HOLIDAY/DAYLIGHT SAVINGS
+		text.getline(buf);  // COMMENTS 1
+		text.getline(buf);  // COMMENTS 2
+		text.getline(buf);  // DATA PERIODS
 
 	}
 	else if (m_type == SMW)
 	{
-		getline(ifs, buf);
+		text.getline(buf);
 		auto cols = split(buf);
 
 		if (cols.size() != 10)
@@ -747,12 +1047,11 @@ bool weatherfile::open(const std::string &file, bool header_only)
 			m_startSec = (size_t)m_time;
 
 			m_nRecords = 0;
-			while (getline(ifs, buf))
+			while (text.getline(line, line_end))
 				m_nRecords++;
 
-			ifs.clear();
-			ifs.seekg(0);
-			getline(ifs, buf);
+			text.rewind();
+			text.getline(buf);
 
 			if (m_nRecords % 8784 == 0)
 			{
@@ -766,10 +1065,10 @@ bool weatherfile::open(const std::string &file, bool header_only)
 	}
 	else if (m_type == WFCSV)
 	{
-		getline(ifs, buf);
+		text.getline(buf);
 		auto cols = split(buf);
 		int ncols = (int)cols.size();
-		getline(ifs, buf1);
+		text.getline(buf1);
 		auto cols1 = split(buf1);
 		int ncols1 = (int)split(buf1).size();
 
@@ -865,21 +1164,20 @@ bool weatherfile::open(const std::string &file, bool header_only)
 			m_stepSec = 3600;
 			m_nRecords = 8760;
 
-			getline(ifs, buf);  // col names
+			text.getline(buf);  // col names
 			if (m_hdr.hasunits)
-				getline(ifs, buf);  // col units
+				text.getline(buf);  // col units
 
 			m_nRecords = 0; // figure out how many records there are
 
-			while (getline(ifs, buf) && buf.length() > 0)
+			while (text.getline(line, line_end) && line_end > line)
 				m_nRecords++;
 
 
 			// reposition to where we were
-			ifs.clear();
-			ifs.seekg(0);
-			getline(ifs, buf);  // header names
-			getline(ifs, buf);  // header values
+			text.rewind();
+			text.getline(buf);  // header names
+			text.getline(buf);  // header values
 
 			if (!timeStepChecks(hdr_step_sec)) return false;
 		}
@@ -906,8 +1204,8 @@ bool weatherfile::open(const std::string &file, bool header_only)
 	if (m_type == WFCSV)
 	{
 		// if it's a WFCSV format file, we need to determine which columns of data exist
-		getline(ifs, buf);  // read column names
-		if (ifs.eof())
+		text.getline(buf);  // read column names
+		if (text.eof())
 		{
 			m_message = "could not read column names";
 			return false;
@@ -918,8 +1216,8 @@ bool weatherfile::open(const std::string &file, bool header_only)
 
 		if (m_hdr.hasunits)
 		{
-			getline(ifs, buf);  // read column units
-			if (ifs.eof())
+			text.getline(buf);  // read column units
+			if (text.eof())
 			{
 				m_message = "could not read column units";
 				return false;
@@ -1062,7 +1360,7 @@ bool weatherfile::open(const std::string &file, bool header_only)
 
 			for (;;)
 			{
-				getline(ifs, buf);
+				text.getline(buf);
 				nread = sscanf(buf.c_str(),
 					"%2d%2d%2d%2d"
 					"%4d%4d"
@@ -1130,7 +1428,7 @@ bool weatherfile::open(const std::string &file, bool header_only)
 			}
 
 
-			if (nread != 79 || ifs.eof())
+			if (nread != 79 || text.eof())
 			{
 				m_message = "TMY2: data line does not have at exactly 79 characters at record " + util::to_string(i);
 				return false;
@@ -1141,15 +1439,16 @@ bool weatherfile::open(const std::string &file, bool header_only)
 		{
 			for (;;)
 			{
-				getline(ifs, buf);
-				auto cols = split(buf);
-				//				if (cols.size() < 68)
+				text.getline(line, line_end);
+				split_fields(line, line_end, fields);
+				//				if (fields.size() < 68)
 				//				{
 				//					m_message = "TMY3: data line does not have at least 68 fields at record " + util::to_string(i);
 				//					return false;
 				//				}
 
-				const char *p = cols[0].c_str();
+				const std::string date(fields[0].first, fields[0].second);
+				const char *p = date.c_str();
 
 				int month = stoi(p);
 				p = strchr(p, '/');
@@ -1169,7 +1468,7 @@ bool weatherfile::open(const std::string &file, bool header_only)
 				p++;
 				int year = stoi(p);
 
-				int hour = stoi(cols[1]) - tmy3_hour_shift;  // hour goes 0-23, not 1-24
+				int hour = field_to_int(fields[1].first, fields[1].second) - tmy3_hour_shift;  // hour goes 0-23, not 1-24
 				if (i == 0 && hour < 0)
 				{
 					// this was a TMY3 file but with hours going 0-23 (against the tmy3 spec)
@@ -1189,21 +1488,21 @@ bool weatherfile::open(const std::string &file, bool header_only)
 				m_columns[DAY].data[i] = (float)day;
 				m_columns[HOUR].data[i] = (float)hour;
 				m_columns[MINUTE].data[i] = 30;
-				m_columns[GHI].data[i] = col_or_nan(cols[4]);
-				m_columns[DNI].data[i] = col_or_nan(cols[7]);
-				m_columns[DHI].data[i] = col_or_nan(cols[10]);
+				m_columns[GHI].data[i] = field_or_nan(fields[4].first, fields[4].second);
+				m_columns[DNI].data[i] = field_or_nan(fields[7].first, fields[7].second);
+				m_columns[DHI].data[i] = field_or_nan(fields[10].first, fields[10].second);
 				m_columns[POA].data[i] = (float)(-999);       /* No POA in TMY3 */
 
-				m_columns[TDRY].data[i] = col_or_nan(cols[31]);
-				m_columns[TDEW].data[i] = col_or_nan(cols[34]);
+				m_columns[TDRY].data[i] = field_or_nan(fields[31].first, fields[31].second);
+				m_columns[TDEW].data[i] = field_or_nan(fields[34].first, fields[34].second);
 
-				m_columns[WSPD].data[i] = col_or_nan(cols[46]);
-				m_columns[WDIR].data[i] = col_or_nan(cols[43]);
+				m_columns[WSPD].data[i] = field_or_nan(fields[46].first, fields[46].second);
+				m_columns[WDIR].data[i] = field_or_nan(fields[43].first, fields[43].second);
 
-				m_columns[RH].data[i] = col_or_nan(cols[37]);
-				m_columns[PRES].data[i] = col_or_nan(cols[40]);
+				m_columns[RH].data[i] = field_or_nan(fields[37].first, fields[37].second);
+				m_columns[PRES].data[i] = field_or_nan(fields[40].first, fields[40].second);
 				m_columns[SNOW].data[i] = -999.0; // no snowfall in TMY3
-				m_columns[ALB].data[i] = col_or_nan(cols[61]);
+				m_columns[ALB].data[i] = field_or_nan(fields[61].first, fields[61].second);
 				m_columns[AOD].data[i] = -999; /* no AOD in TMY3 */
 
 				m_columns[TWET].data[i]
@@ -1215,7 +1514,7 @@ bool weatherfile::open(const std::string &file, bool header_only)
 				break;
 			}
 
-			if (ifs.eof() && i < ((int)m_nRecords - 1))
+			if (text.eof() && i < ((int)m_nRecords - 1))
 			{
 				m_message = "TMY3: data line formatting error at record " + util::to_string(i);
 				return false;
@@ -1225,17 +1524,17 @@ bool weatherfile::open(const std::string &file, bool header_only)
 		{
 			for (;;)
 			{
-				getline(ifs, buf);
-				auto cols = split(buf);
+				text.getline(line, line_end);
+				split_fields(line, line_end, fields);
 
-				if (cols.size() < 32)
+				if (fields.size() < 32)
 				{
 					m_message = "EPW: data line does not have at least 32 fields at record " + util::to_string(i);
 					return false;
 				}
 
-				int month = stoi(cols[1]);
-				int day = stoi(cols[2]);
+				int month = field_to_int(fields[1].first, fields[1].second);
+				int day = field_to_int(fields[2].first, fields[2].second);
 
 				if (month == 2 && day == 29)
 				{
@@ -1243,27 +1542,27 @@ bool weatherfile::open(const std::string &file, bool header_only)
 					continue;
 				}
 
-				m_columns[YEAR].data[i] = (float)stoi(cols[0]);
-				m_columns[MONTH].data[i] = (float)stoi(cols[1]);
-				m_columns[DAY].data[i] = (float)stoi(cols[2]);
-				m_columns[HOUR].data[i] = (float)stoi(cols[3]) - 1;  // hour goes 0-23, not 1-24;
-				m_columns[MINUTE].data[i] = (float)stoi(cols[4]);
+				m_columns[YEAR].data[i] = (float)field_to_int(fields[0].first, fields[0].second);
+				m_columns[MONTH].data[i] = (float)field_to_int(fields[1].first, fields[1].second);
+				m_columns[DAY].data[i] = (float)field_to_int(fields[2].first, fields[2].second);
+				m_columns[HOUR].data[i] = (float)field_to_int(fields[3].first, fields[3].second) - 1;  // hour goes 0-23, not 1-24;
+				m_columns[MINUTE].data[i] = (float)field_to_int(fields[4].first, fields[4].second);
 
-				m_columns[GHI].data[i] = check_missing(col_or_nan(cols[13]), 9999.);
-				m_columns[DNI].data[i] = check_missing(col_or_nan(cols[14]), 9999.);
-				m_columns[DHI].data[i] = check_missing(col_or_nan(cols[15]), 9999.);
+				m_columns[GHI].data[i] = check_missing(field_or_nan(fields[13].first, fields[13].second), 9999.);
+				m_columns[DNI].data[i] = check_missing(field_or_nan(fields[14].first, fields[14].second), 9999.);
+				m_columns[DHI].data[i] = check_missing(field_or_nan(fields[15].first, fields[15].second), 9999.);
 				m_columns[POA].data[i] = (float)(-999);       /* No POA in EPW */
 
-				m_columns[WSPD].data[i] = check_missing(col_or_nan(cols[21]), 999.);
-				m_columns[WDIR].data[i] = check_missing(col_or_nan(cols[20]), 999.);
+				m_columns[WSPD].data[i] = check_missing(field_or_nan(fields[21].first, fields[21].second), 999.);
+				m_columns[WDIR].data[i] = check_missing(field_or_nan(fields[20].first, fields[20].second), 999.);
 
-				m_columns[TDRY].data[i] = check_missing(col_or_nan(cols[6]), 99.9);
+				m_columns[TDRY].data[i] = check_missing(field_or_nan(fields[6].first, fields[6].second), 99.9);
 
-				m_columns[TDEW].data[i] = check_missing(col_or_nan(cols[7]), 99.9);
+				m_columns[TDEW].data[i] = check_missing(field_or_nan(fields[7].first, fields[7].second), 99.9);
 
-				m_columns[RH].data[i] = check_missing(col_or_nan(cols[8]), 999.);
-				m_columns[PRES].data[i] = check_missing(col_or_nan(cols[9]) * 0.01, 999999.*0.01);
-				m_columns[SNOW].data[i] = check_missing(col_or_nan(cols[30]), 999.); // snowfall
+				m_columns[RH].data[i] = check_missing(field_or_nan(fields[8].first, fields[8].second), 999.);
+				m_columns[PRES].data[i] = check_missing(field_or_nan(fields[9].first, fields[9].second) * 0.01, 999999.*0.01);
+				m_columns[SNOW].data[i] = check_missing(field_or_nan(fields[30].first, fields[30].second), 999.); // snowfall
 				m_columns[ALB].data[i] = -999; /* no albedo in EPW file */
 				m_columns[AOD].data[i] = -999; /* no AOD in EPW */
 
@@ -1272,7 +1571,7 @@ bool weatherfile::open(const std::string &file, bool header_only)
 				break;
 			}
 
-			if (ifs.eof() && i < ((int)m_nRecords - 1))
+			if (text.eof() && i < ((int)m_nRecords - 1))
 			{
 				m_message = "EPW: data line formatting error at record " + util::to_string(i);
 				return false;
@@ -1280,10 +1579,10 @@ bool weatherfile::open(const std::string &file, bool header_only)
 		}
 		else if (m_type == SMW)
 		{
-			getline(ifs, buf);
-			auto cols = split(buf);
+			text.getline(line, line_end);
+			split_fields(line, line_end, fields);
 
-			if (cols.size() < 12)
+			if (fields.size() < 12)
 			{
 				m_message = "SMW: data line does not have at least 12 fields at record " + util::to_string(i);
 				return false;
@@ -1299,25 +1598,25 @@ bool weatherfile::open(const std::string &file, bool header_only)
 
 			m_time += m_stepSec; // increment by step
 
-			m_columns[GHI].data[i] = col_or_nan(cols[7]);
-			m_columns[DNI].data[i] = col_or_nan(cols[8]);
-			m_columns[DHI].data[i] = col_or_nan(cols[9]);
+			m_columns[GHI].data[i] = field_or_nan(fields[7].first, fields[7].second);
+			m_columns[DNI].data[i] = field_or_nan(fields[8].first, fields[8].second);
+			m_columns[DHI].data[i] = field_or_nan(fields[9].first, fields[9].second);
 			m_columns[POA].data[i] = (double)(-999);       /* No POA in SMW */
 
-			m_columns[WSPD].data[i] = col_or_nan(cols[4]);
-			m_columns[WDIR].data[i] = col_or_nan(cols[5]);
+			m_columns[WSPD].data[i] = field_or_nan(fields[4].first, fields[4].second);
+			m_columns[WDIR].data[i] = field_or_nan(fields[5].first, fields[5].second);
 
-			m_columns[TDRY].data[i] = col_or_nan(cols[0]);
-			m_columns[TDEW].data[i] = col_or_nan(cols[1]);
-			m_columns[TWET].data[i] = col_or_nan(cols[2]);
+			m_columns[TDRY].data[i] = field_or_nan(fields[0].first, fields[0].second);
+			m_columns[TDEW].data[i] = field_or_nan(fields[1].first, fields[1].second);
+			m_columns[TWET].data[i] = field_or_nan(fields[2].first, fields[2].second);
 
-			m_columns[RH].data[i] = col_or_nan(cols[3]);
-			m_columns[PRES].data[i] = col_or_nan(cols[6]);
-			m_columns[SNOW].data[i] = col_or_nan(cols[11]);
-			m_columns[ALB].data[i] = col_or_nan(cols[10]);
+			m_columns[RH].data[i] = field_or_nan(fields[3].first, fields[3].second);
+			m_columns[PRES].data[i] = field_or_nan(fields[6].first, fields[6].second);
+			m_columns[SNOW].data[i] = field_or_nan(fields[11].first, fields[11].second);
+			m_columns[ALB].data[i] = field_or_nan(fields[10].first, fields[10].second);
 			m_columns[AOD].data[i] = -999; /* no AOD in SMW */
 
-			if (ifs.eof())
+			if (text.eof())
 			{
 				m_message = "SMW: data line formatting error at record " + util::to_string(i);
 				return false;
@@ -1328,16 +1627,17 @@ bool weatherfile::open(const std::string &file, bool header_only)
 
 			for (;;)
 			{
-				getline(ifs, buf);
-				buf = trimboth(buf);
-				if (buf.length() == 0)
+				text.getline(line, line_end);
+				while (line < line_end && (*line == ' ' || *line == '\t')) line++;
+				while (line_end > line && (line_end[-1] == ' ' || line_end[-1] == '\t' || line_end[-1] == '\r' || line_end[-1] == '\n')) line_end--;
+				if (line_end == line)
 				{
 					m_message = "CSV: data line formatting error at record " + util::to_string(i);
 					return false;
 				}
 
-				auto cols = split(buf);
-				int ncols = (int)cols.size();
+				split_fields(line, line_end, fields);
+				int ncols = (int)fields.size();
 				for (size_t k = 0; k < _MAXCOL_; k++)
 				{
 					if (m_columns[k].index >= 0
@@ -1345,14 +1645,14 @@ bool weatherfile::open(const std::string &file, bool header_only)
 					{
 						if (k == YEAR) {
 							try {
-								m_columns[k].data[i] = col_or_nan(trimboth(cols[m_columns[k].index]));
+								m_columns[k].data[i] = trimmed_field_or_nan(fields[m_columns[k].index].first, fields[m_columns[k].index].second);
 							}
 							catch (const std::exception& ) {
 								m_columns[k].data[i] = 1990;
 							}
 						}
 						else
-							m_columns[k].data[i] = col_or_nan(trimboth(cols[m_columns[k].index]));
+							m_columns[k].data[i] = trimmed_field_or_nan(fields[m_columns[k].index].first, fields[m_columns[k].index].second);
 					}
 				}
 
@@ -1484,151 +1784,51 @@ bool weatherfile::open(const std::string &file, bool header_only)
 
 bool weatherfile::read_average(weather_record *r, std::vector<int> &cols, size_t &num_timesteps)
 {
-	if (r && m_index < m_nRecords && num_timesteps > 0 && num_timesteps < m_nRecords)
-	{
-		r->year = (int)m_columns[YEAR].data[m_index];
-		r->month = (int)m_columns[MONTH].data[m_index];
-		r->day = (int)m_columns[DAY].data[m_index];
-		r->hour = (int)m_columns[HOUR].data[m_index];
-		r->minute = m_columns[MINUTE].data[m_index];
-		r->gh = m_columns[GHI].data[m_index];
-		r->dn = m_columns[DNI].data[m_index];
-		r->df = m_columns[DHI].data[m_index];
-		r->poa = m_columns[POA].data[m_index];
-		r->wspd = m_columns[WSPD].data[m_index];
-		r->wdir = m_columns[WDIR].data[m_index];
-		r->tdry = m_columns[TDRY].data[m_index];
-		r->twet = m_columns[TWET].data[m_index];
-		r->tdew = m_columns[TDEW].data[m_index];
-		r->rhum = m_columns[RH].data[m_index];
-		r->pres = m_columns[PRES].data[m_index];
-		r->snow = m_columns[SNOW].data[m_index];
-		r->alb = m_columns[ALB].data[m_index];
-		r->aod = m_columns[AOD].data[m_index];
-
-		// average columns requested
-		int start = (int)m_index - (int)num_timesteps / 2;
-		if (start < 0) 
-			start = 0;
-		if ((size_t)start + num_timesteps > m_nRecords)
-			start = (int)m_nRecords - (int)num_timesteps;
-		if (start < 0) 
-			start = 0;
-
-	
-		for (size_t i = 0; i < cols.size(); i++)
-		{
-			double col_val = 0;
-			int n_vals = 0;
-			if (cols[i] >= YEAR && cols[i] < _MAXCOL_)
-			{
-				for (size_t j = (size_t)start; j < num_timesteps && j < m_nRecords; j++)
-				{
-					col_val += m_columns[cols[i]].data[start];
-					n_vals++;
-				}
-				if (n_vals > 0)
-					col_val /= n_vals;
-			}
-			switch (cols[i])
-			{
-			case YEAR:
-				r->year = (int)col_val;
-				break;
-			case MONTH:
-				r->month = (int)col_val;
-				break;
-			case DAY:
-				r->day = (int)col_val;
-				break;
-			case HOUR:
-				r->hour = (int)col_val;
-				break;
-			case MINUTE:
-				r->minute = col_val;
-				break;
-			case GHI:
-				r->gh = col_val;
-				break;
-			case DNI:
-				r->dn = col_val;
-				break;
-			case DHI:
-				r->df = col_val;
-				break;
-			case POA:
-				r->poa = col_val;
-				break;
-			case TDRY:
-				r->tdry = col_val;
-				break;
-			case TWET: 
-				r->twet = col_val;
-				break;
-			case TDEW:
-				r->tdew = col_val;
-				break;
-			case WSPD:
-				r->wspd = col_val;
-				break;
-			case WDIR:
-				r->wdir = col_val;
-				break;
-			case RH:
-				r->rhum = col_val;
-				break;
-			case PRES:
-				r->pres = col_val;
-				break;
-			case SNOW:
-				r->snow = col_val;
-				break;
-			case ALB:
-				r->alb = col_val;
-				break;
-			case AOD:
-				r->aod = col_val;
-				break;
-			default:
-				break;
-			}
-		}
+	size_t start = 0;
+	if (!r || !average_window(m_index, num_timesteps, m_nRecords, &start) || !read(r))
+		return false;
 
+	// average the requested columns over the window, building each column's sums on first use
+	const column *col = columns();
+	for (size_t i = 0; i < cols.size(); i++)
+	{
+		if (cols[i] < YEAR || cols[i] >= _MAXCOL_)
+			continue;
 
-		m_index++;
+		prefix_sum &ps = m_prefix[cols[i]];
+		if (!ps.built())
+			ps.build(&col[cols[i]].data[0], m_nRecords);
 
-		return true;
+		set_record_value(r, cols[i], ps.average(start, num_timesteps));
 	}
-	else
-		return false;
 
+	return true;
 }
 
-
-
 bool weatherfile::read( weather_record *r )
 {
+	const column *col = columns();
 	if ( r && m_index < m_nRecords)
 	{
-		r->year = (int)m_columns[YEAR].data[m_index];
-		r->month = (int)m_columns[MONTH].data[m_index];
-		r->day = (int)m_columns[DAY].data[m_index];
-		r->hour = (int)m_columns[HOUR].data[m_index];
-		r->minute = m_columns[MINUTE].data[m_index];
-		r->gh = m_columns[GHI].data[m_index];
-		r->dn = m_columns[DNI].data[m_index];
-		r->df = m_columns[DHI].data[m_index];
-		r->poa = m_columns[POA].data[m_index];
-		r->wspd = m_columns[WSPD].data[m_index];
-		r->wdir = m_columns[WDIR].data[m_index];
-		r->tdry = m_columns[TDRY].data[m_index];
-		r->twet = m_columns[TWET].data[m_index];
-		r->tdew = m_columns[TDEW].data[m_index];
-		r->rhum = m_columns[RH].data[m_index];
-		r->pres = m_columns[PRES].data[m_index];
-		r->snow = m_columns[SNOW].data[m_index];
-		r->alb = m_columns[ALB].data[m_index];
-		r->aod = m_columns[AOD].data[m_index];
+		r->year = (int)col[YEAR].data[m_index];
+		r->month = (int)col[MONTH].data[m_index];
+		r->day = (int)col[DAY].data[m_index];
+		r->hour = (int)col[HOUR].data[m_index];
+		r->minute = col[MINUTE].data[m_index];
+		r->gh = col[GHI].data[m_index];
+		r->dn = col[DNI].data[m_index];
+		r->df = col[DHI].data[m_index];
+		r->poa = col[POA].data[m_index];
+		r->wspd = col[WSPD].data[m_index];
+		r->wdir = col[WDIR].data[m_index];
+		r->tdry = col[TDRY].data[m_index];
+		r->twet = col[TWET].data[m_index];
+		r->tdew = col[TDEW].data[m_index];
+		r->rhum = col[RH].data[m_index];
+		r->pres = col[PRES].data[m_index];
+		r->snow = col[SNOW].data[m_index];
+		r->alb = col[ALB].data[m_index];
+		r->aod = col[AOD].data[m_index];
 
 		m_index++;
 		return true;
@@ -1639,7 +1839,7 @@ bool weatherfile::read( weather_record *r )
 
 bool weatherfile::has_data_column( size_t id )
 {
-	return m_columns[id].index >= 0;
+	return columns()[id].index >= 0;
 }
 
 bool weatherfile::convert_to_wfcsv( const std::string &input, const std::string &output )
@@ -1718,3 +1918,613 @@ bool weatherfile::convert_to_wfcsv( const std::string &input, const std::string
 
 }
 
+
+/* binary column cache layout: a fixed header, the seven header strings as
+   (uint32 length, bytes), padding to an 8 byte boundary, then _MAXCOL_ columns
+   of nrecords floats each. the byte order marker rejects caches written on a
+   machine with a different endianness. */
+
+static const char wfbin_magic[8] = { 'S', 'S', 'C', 'W', 'F', 'B', 'I', 'N' };
+static const uint32_t wfbin_version = 1;
+static const uint32_t wfbin_byte_order = 0x01020304;
+
+struct wfbin_header
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t byte_order;
+	uint64_t source_size;
+	int64_t source_mtime;
+	uint64_t source_hash;
+	int32_t type;
+	int32_t start_year;
+	uint64_t start_sec;
+	uint64_t step_sec;
+	uint64_t nrecords;
+	int32_t has_leap_year;
+	int32_t hasunits;
+	double tz;
+	double lat;
+	double lon;
+	double elev;
+	int32_t ncols;
+	int32_t col_index[weather_data_provider::_MAXCOL_];
+};
+
+static bool wfbin_source_stat(const std::string &file, uint64_t *size, int64_t *mtime)
+{
+	struct stat st;
+	if (::stat(file.c_str(), &st) != 0) return false;
+	*size = (uint64_t)st.st_size;
+	*mtime = (int64_t)st.st_mtime;
+	return true;
+}
+
+// 64 bit FNV-1a over the raw bytes of the file
+static bool wfbin_source_hash(const std::string &file, uint64_t *hash)
+{
+	std::ifstream ifs(file.c_str(), std::ios::in | std::ios::binary);
+	if (!ifs.is_open()) return false;
+
+	uint64_t h = 14695981039346656037ull;
+	std::vector<char> buf(1 << 16);
+	while (ifs.read(&buf[0], buf.size()) || ifs.gcount() > 0)
+	{
+		const unsigned char *p = (const unsigned char*)&buf[0];
+		const unsigned char *end = p + ifs.gcount();
+		for (; p < end; p++)
+		{
+			h ^= *p;
+			h *= 1099511628211ull;
+		}
+	}
+	*hash = h;
+	return true;
+}
+
+static void wfbin_write_string(std::ostream &os, const std::string &s)
+{
+	uint32_t len = (uint32_t)s.size();
+	os.write((const char*)&len, sizeof(len));
+	os.write(s.c_str(), len);
+}
+
+static bool wfbin_read_string(std::istream &is, std::string &s)
+{
+	uint32_t len = 0;
+	if (!is.read((char*)&len, sizeof(len)) || len > 65536) return false;
+	s.resize(len);
+	return len == 0 || (bool)is.read(&s[0], len);
+}
+
+std::string weatherfile::binary_cache_file(const std::string &input)
+{
+	return input + ".wfbin";
+}
+
+bool weatherfile::write_binary(const std::string &file, const std::string &source)
+{
+	wfbin_header h;
+	memset(&h, 0, sizeof(h));
+	memcpy(h.magic, wfbin_magic, sizeof(h.magic));
+	h.version = wfbin_version;
+	h.byte_order = wfbin_byte_order;
+	if (!wfbin_source_stat(source, &h.source_size, &h.source_mtime)
+		|| !wfbin_source_hash(source, &h.source_hash))
+		return false;
+
+	h.type = m_type;
+	h.start_year = m_startYear;
+	h.start_sec = m_startSec;
+	h.step_sec = m_stepSec;
+	h.nrecords = m_nRecords;
+	h.has_leap_year = m_hasLeapYear ? 1 : 0;
+	h.hasunits = m_hdr.hasunits ? 1 : 0;
+	h.tz = m_hdr.tz;
+	h.lat = m_hdr.lat;
+	h.lon = m_hdr.lon;
+	h.elev = m_hdr.elev;
+	const column *col = columns();
+	h.ncols = _MAXCOL_;
+	for (int i = 0; i < _MAXCOL_; i++)
+	{
+		if (col[i].data.size() != m_nRecords) return false;
+		h.col_index[i] = col[i].index;
+	}
+
+	// write to a temporary file of this writer first, so that concurrent readers never see a partial
+	// cache and concurrent writers of the same cache never write to the same file
+	std::string tmp = util::unique_file_name(file) + ".tmp";
+	{
+		std::ofstream ofs(tmp.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+		if (!ofs.is_open()) return false;
+
+		ofs.write((const char*)&h, sizeof(h));
+		const std::string *strs[] = { &m_hdr.location, &m_hdr.city, &m_hdr.state, &m_hdr.country,
+			&m_hdr.source, &m_hdr.description, &m_hdr.url };
+		for (size_t i = 0; i < sizeof(strs) / sizeof(strs[0]); i++)
+			wfbin_write_string(ofs, *strs[i]);
+
+		static const char pad[8] = { 0 };
+		ofs.write(pad, (8 - (std::streamoff)ofs.tellp() % 8) % 8);
+
+		for (int i = 0; i < _MAXCOL_; i++)
+			if (m_nRecords > 0)
+				ofs.write((const char*)&col[i].data[0], m_nRecords * sizeof(float));
+
+		if (!ofs.good())
+		{
+			ofs.close();
+			util::remove_file(tmp.c_str());
+			return false;
+		}
+	}
+
+	// replace any existing cache in one step, so that it is always either the old or the new file
+	if (util::replace_file(tmp.c_str(), file.c_str()))
+		return true;
+	util::remove_file(tmp.c_str());
+	return false;
+}
+
+/* reads the fixed header and header strings of a binary weather file and leaves the stream at
+   the first column. with a source file given, the cache must also match its size, modification
+   time and content hash. returns an error message, empty on success. */
+static std::string wfbin_read_header(std::istream &is, const std::string &file, const std::string &source,
+	wfbin_header &h, weather_header &hdr)
+{
+	if (!is.read((char*)&h, sizeof(h))
+		|| memcmp(h.magic, wfbin_magic, sizeof(h.magic)) != 0
+		|| h.version != wfbin_version
+		|| h.byte_order != wfbin_byte_order
+		|| h.ncols != weather_data_provider::_MAXCOL_)
+		return "invalid binary weather file: " + file;
+
+	if (!source.empty())
+	{
+		uint64_t size = 0, hash = 0;
+		int64_t mtime = 0;
+		if (!wfbin_source_stat(source, &size, &mtime)
+			|| size != h.source_size || mtime != h.source_mtime
+			|| !wfbin_source_hash(source, &hash) || hash != h.source_hash)
+			return "binary weather file is out of date: " + file;
+	}
+
+	std::string *strs[] = { &hdr.location, &hdr.city, &hdr.state, &hdr.country,
+		&hdr.source, &hdr.description, &hdr.url };
+	for (size_t i = 0; i < sizeof(strs) / sizeof(strs[0]); i++)
+		if (!wfbin_read_string(is, *strs[i]))
+			return "invalid binary weather file header: " + file;
+
+	hdr.hasunits = h.hasunits != 0;
+	hdr.tz = h.tz;
+	hdr.lat = h.lat;
+	hdr.lon = h.lon;
+	hdr.elev = h.elev;
+
+	is.seekg((8 - (std::streamoff)is.tellg() % 8) % 8, std::ios::cur);
+	return std::string();
+}
+
+bool weatherfile::read_binary(const std::string &file, bool header_only, const std::string &source)
+{
+	// for a sidecar cache (source given) any mismatch silently falls back to the text file
+	bool sidecar = !source.empty();
+
+	std::ifstream ifs(file.c_str(), std::ios::in | std::ios::binary);
+	if (!ifs.is_open())
+	{
+		if (!sidecar) m_message = "could not open file for reading: " + file;
+		return false;
+	}
+
+	wfbin_header h;
+	weather_header hdr;
+	std::string err = wfbin_read_header(ifs, file, source, h, hdr);
+	if (!err.empty())
+	{
+		if (!sidecar) m_message = err;
+		return false;
+	}
+
+	std::vector<float> data[_MAXCOL_];
+	if (!header_only)
+	{
+		for (int i = 0; i < _MAXCOL_; i++)
+		{
+			data[i].resize((size_t)h.nrecords);
+			if (h.nrecords > 0 && !ifs.read((char*)&data[i][0], (std::streamsize)(h.nrecords * sizeof(float))))
+			{
+				if (!sidecar) m_message = "binary weather file is truncated: " + file;
+				return false;
+			}
+		}
+	}
+
+	m_type = h.type;
+	m_startYear = h.start_year;
+	m_startSec = (size_t)h.start_sec;
+	m_stepSec = (size_t)h.step_sec;
+	m_nRecords = (size_t)h.nrecords;
+	m_hasLeapYear = h.has_leap_year != 0;
+	m_hdr = hdr;
+	m_fromBinary = true;
+
+	if (!header_only)
+	{
+		for (int i = 0; i < _MAXCOL_; i++)
+		{
+			m_columns[i].index = h.col_index[i];
+			m_columns[i].data.swap(data[i]);
+		}
+	}
+
+	return true;
+}
+
+bool weatherfile::convert_to_binary(const std::string &input, const std::string &output)
+{
+	weatherfile wf(input);
+	if (!wf.ok()) return false;
+
+	return wf.write_binary(output, input);
+}
+
+std::string weatherfile::temp_binary_cache_file(const std::string &input)
+{
+#ifdef _WIN32
+	const char *dir = getenv("TEMP");
+#else
+	const char *dir = getenv("TMPDIR");
+	if (!dir || !*dir) dir = "/tmp";
+#endif
+	if (!dir || !*dir) return std::string();
+
+	// the path is hashed so that files of the same name in different folders get their own cache
+	uint64_t h = 14695981039346656037ull;
+	for (size_t i = 0; i < input.length(); i++)
+	{
+		h ^= (unsigned char)input[i];
+		h *= 1099511628211ull;
+	}
+	char hex[17];
+	sprintf(hex, "%016llx", (unsigned long long)h);
+	return std::string(dir) + "/" + util::name_only(input) + "." + hex + ".wfbin";
+}
+
+static bool wfbin_cache_current(const std::string &cache, const std::string &source)
+{
+	std::ifstream is(cache.c_str(), std::ios::in | std::ios::binary);
+	wfbin_header h;
+	weather_header hdr;
+	return is.is_open() && wfbin_read_header(is, cache, source, h, hdr).empty();
+}
+
+std::string weatherfile::binary_cache_for(const std::string &input, std::string *error)
+{
+	std::string caches[2] = { binary_cache_file(input), temp_binary_cache_file(input) };
+	for (size_t i = 0; i < 2; i++)
+		if (!caches[i].empty() && wfbin_cache_current(caches[i], input))
+			return caches[i];
+
+	weatherfile wf(input);
+	if (!wf.ok())
+	{
+		if (error) *error = wf.message();
+		return std::string();
+	}
+	for (size_t i = 0; i < 2; i++)
+		if (!caches[i].empty() && wf.write_binary(caches[i], input))
+			return caches[i];
+
+	if (error) *error = "could not write a binary weather file for " + input + " next to it or in the temporary folder";
+	return std::string();
+}
+
+struct weatherfile_cache_entry
+{
+	uint64_t size;
+	int64_t mtime;
+	uint64_t hash;
+	uint64_t last_use;
+	std::shared_ptr<const weatherfile> data;
+};
+
+static std::mutex wfcache_mutex;
+static std::map<std::string, weatherfile_cache_entry> wfcache_entries;
+static size_t wfcache_limit = 0;
+static uint64_t wfcache_clock = 0;
+
+void weatherfile::set_cache_limit(size_t max_files)
+{
+	std::lock_guard<std::mutex> lock(wfcache_mutex);
+	wfcache_limit = max_files;
+	if (max_files == 0)
+		wfcache_entries.clear();
+}
+
+size_t weatherfile::cache_limit()
+{
+	std::lock_guard<std::mutex> lock(wfcache_mutex);
+	return wfcache_limit;
+}
+
+bool weatherfile::source_stamp(const std::string &file, uint64_t *size, int64_t *mtime, uint64_t *hash)
+{
+	return wfbin_source_stat(file, size, mtime) && wfbin_source_hash(file, hash);
+}
+
+std::shared_ptr<const weatherfile> weatherfile::cache_open(const std::string &file)
+{
+	// stamp the file outside the lock, since hashing reads the whole file
+	weatherfile_cache_entry stamp;
+	bool stamped = source_stamp(file, &stamp.size, &stamp.mtime, &stamp.hash);
+
+	if (stamped)
+	{
+		std::lock_guard<std::mutex> lock(wfcache_mutex);
+		std::map<std::string, weatherfile_cache_entry>::iterator it = wfcache_entries.find(file);
+		if (it != wfcache_entries.end() && it->second.size == stamp.size
+			&& it->second.mtime == stamp.mtime && it->second.hash == stamp.hash)
+		{
+			it->second.last_use = ++wfcache_clock;
+			return it->second.data;
+		}
+	}
+
+	// two threads missing on the same file both parse it, and the later one replaces the entry
+	std::shared_ptr<weatherfile> wf(new weatherfile);
+	wf->m_ok = wf->parse(file, false);
+	if (!wf->m_ok || !stamped)
+		return wf;
+
+	std::lock_guard<std::mutex> lock(wfcache_mutex);
+	if (wfcache_limit == 0)
+		return wf;
+
+	stamp.last_use = ++wfcache_clock;
+	stamp.data = wf;
+	wfcache_entries[file] = stamp;
+	while (wfcache_entries.size() > wfcache_limit)
+	{
+		std::map<std::string, weatherfile_cache_entry>::iterator oldest = wfcache_entries.begin();
+		for (std::map<std::string, weatherfile_cache_entry>::iterator it = wfcache_entries.begin(); it != wfcache_entries.end(); ++it)
+			if (it->second.last_use < oldest->second.last_use)
+				oldest = it;
+		wfcache_entries.erase(oldest);
+	}
+	return wf;
+}
+
+struct weatherfile_stream::prefetcher
+{
+	prefetcher() : request(std::string::npos), loading(false), failed(false), quit(false) { }
+
+	std::ifstream in; // read by the prefetch thread
+	std::ifstream direct; // read by the reader for single values outside the current chunk
+	std::thread thread;
+	std::mutex mutex;
+	std::condition_variable cv;
+	size_t request; // first record of the chunk to load next, npos if none
+	bool loading;
+	bool failed;
+	bool quit;
+};
+
+weatherfile_stream::weatherfile_stream(const std::string &file, size_t chunk_records)
+	: m_type(weatherfile::INVALID), m_chunkRecords(chunk_records > 0 ? chunk_records : 1), m_dataOffset(0),
+	m_prefetch(new prefetcher)
+{
+	m_ok = false;
+	m_startYear = 1900;
+	m_time = 0;
+	m_startSec = m_stepSec = m_nRecords = m_index = 0;
+	for (size_t i = 0; i < _MAXCOL_; i++)
+		m_colIndex[i] = -1;
+
+	m_binFile = file;
+	if (!cmp_ext(file, "wfbin"))
+	{
+		// stream a text file from its binary cache, writing the cache if it is not current
+		m_binFile = weatherfile::binary_cache_for(file, &m_message);
+		if (m_binFile.empty())
+			return;
+	}
+
+	prefetcher &pf = *m_prefetch;
+	pf.in.open(m_binFile.c_str(), std::ios::in | std::ios::binary);
+	pf.direct.open(m_binFile.c_str(), std::ios::in | std::ios::binary);
+	if (!pf.in.is_open() || !pf.direct.is_open())
+	{
+		m_message = "could not open file for reading: " + m_binFile;
+		return;
+	}
+
+	wfbin_header h;
+	m_message = wfbin_read_header(pf.in, m_binFile, std::string(), h, m_hdr);
+	if (!m_message.empty())
+		return;
+
+	m_dataOffset = (long long)pf.in.tellg();
+	pf.in.seekg(0, std::ios::end);
+	if ((long long)pf.in.tellg() < m_dataOffset + (long long)(h.nrecords * _MAXCOL_ * sizeof(float)))
+	{
+		m_message = "binary weather file is truncated: " + m_binFile;
+		return;
+	}
+
+	m_type = h.type;
+	m_startYear = h.start_year;
+	m_startSec = (size_t)h.start_sec;
+	m_stepSec = (size_t)h.step_sec;
+	m_nRecords = (size_t)h.nrecords;
+	m_hasLeapYear = h.has_leap_year != 0;
+	for (size_t i = 0; i < _MAXCOL_; i++)
+		m_colIndex[i] = h.col_index[i];
+	m_ok = true;
+
+	// start loading the first chunk right away
+	pf.request = 0;
+	pf.thread = std::thread(&weatherfile_stream::prefetch_loop, this);
+}
+
+weatherfile_stream::~weatherfile_stream()
+{
+	prefetcher &pf = *m_prefetch;
+	if (pf.thread.joinable())
+	{
+		{
+			std::lock_guard<std::mutex> lock(pf.mutex);
+			pf.quit = true;
+		}
+		pf.cv.notify_all();
+		pf.thread.join();
+	}
+}
+
+void weatherfile_stream::prefetch_loop()
+{
+	prefetcher &pf = *m_prefetch;
+	std::unique_lock<std::mutex> lock(pf.mutex);
+	for (;;)
+	{
+		pf.cv.wait(lock, [&pf]() { return pf.quit || pf.request != std::string::npos; });
+		if (pf.quit)
+			break;
+
+		size_t first = pf.request;
+		pf.request = std::string::npos;
+		pf.loading = true;
+		lock.unlock();
+
+		bool ok = load_chunk(first, m_back, pf.in);
+
+		lock.lock();
+		pf.loading = false;
+		pf.failed = !ok;
+		pf.cv.notify_all();
+	}
+}
+
+bool weatherfile_stream::load_chunk(size_t first, chunk &c, std::istream &is)
+{
+	size_t count = std::min(m_chunkRecords, m_nRecords - first);
+	c.count = 0;
+	c.data.resize(_MAXCOL_ * m_chunkRecords);
+
+	// columns are stored one after another, so each is a single contiguous read
+	is.clear();
+	for (size_t col = 0; col < _MAXCOL_; col++)
+	{
+		is.seekg(m_dataOffset + (long long)((col * m_nRecords + first) * sizeof(float)));
+		if (!is.read((char*)&c.data[col * m_chunkRecords], (std::streamsize)(count * sizeof(float))))
+			return false;
+	}
+
+	c.first = first;
+	c.count = count;
+	return true;
+}
+
+bool weatherfile_stream::fetch(size_t index)
+{
+	prefetcher &pf = *m_prefetch;
+	std::unique_lock<std::mutex> lock(pf.mutex);
+	auto idle = [&pf]() { return !pf.loading && pf.request == std::string::npos; };
+	pf.cv.wait(lock, idle);
+
+	if (!m_back.contains(index))
+	{
+		// not the prefetched chunk, after a seek: have it loaded now and wait for it
+		pf.request = index - index % m_chunkRecords;
+		pf.cv.notify_all();
+		pf.cv.wait(lock, idle);
+		if (pf.failed || !m_back.contains(index))
+		{
+			m_message = "could not read binary weather file: " + m_binFile;
+			return false;
+		}
+	}
+
+	std::swap(m_front, m_back);
+
+	if (m_front.first + m_front.count < m_nRecords)
+	{
+		pf.request = m_front.first + m_front.count;
+		pf.cv.notify_all();
+	}
+	return true;
+}
+
+float weatherfile_stream::value(int col, size_t index)
+{
+	if (m_front.contains(index))
+		return m_front.data[col * m_chunkRecords + index - m_front.first];
+
+	float x = std::numeric_limits<float>::quiet_NaN();
+	std::ifstream &is = m_prefetch->direct;
+	is.clear();
+	is.seekg(m_dataOffset + (long long)((col * m_nRecords + index) * sizeof(float)));
+	is.read((char*)&x, sizeof(x));
+	return x;
+}
+
+bool weatherfile_stream::read(weather_record *r)
+{
+	if (!r || m_index >= m_nRecords)
+		return false;
+
+	if (!m_front.contains(m_index) && !fetch(m_index))
+		return false;
+
+	const float *d = &m_front.data[m_index - m_front.first];
+	size_t n = m_chunkRecords;
+	r->year = (int)d[YEAR * n];
+	r->month = (int)d[MONTH * n];
+	r->day = (int)d[DAY * n];
+	r->hour = (int)d[HOUR * n];
+	r->minute = d[MINUTE * n];
+	r->gh = d[GHI * n];
+	r->dn = d[DNI * n];
+	r->df = d[DHI * n];
+	r->poa = d[POA * n];
+	r->wspd = d[WSPD * n];
+	r->wdir = d[WDIR * n];
+	r->tdry = d[TDRY * n];
+	r->twet = d[TWET * n];
+	r->tdew = d[TDEW * n];
+	r->rhum = d[RH * n];
+	r->pres = d[PRES * n];
+	r->snow = d[SNOW * n];
+	r->alb = d[ALB * n];
+	r->aod = d[AOD * n];
+
+	m_index++;
+	return true;
+}
+
+bool weatherfile_stream::read_average(weather_record *r, std::vector<int> &cols, size_t &num_timesteps)
+{
+	size_t start = 0;
+	if (!r || !average_window(m_index, num_timesteps, m_nRecords, &start) || !read(r))
+		return false;
+
+	// whole-file prefix sums would defeat streaming, so the window is summed directly
+	for (size_t i = 0; i < cols.size(); i++)
+	{
+		if (cols[i] < YEAR || cols[i] >= _MAXCOL_)
+			continue;
+
+		double sum = 0;
+		for (size_t j = start; j < start + num_timesteps; j++)
+			sum += value(cols[i], j);
+		set_record_value(r, cols[i], sum / num_timesteps);
+	}
+
+	return true;
+}
+
+bool weatherfile_stream::has_data_column(size_t id)
+{
+	return id < _MAXCOL_ && m_colIndex[id] >= 0;
+}
@@ -26,6 +26,8 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <string>
 #include <vector>  // needed to compile in typelib_vc2012
 #include <cmath>
+#include <cstdint>
+#include <memory>
 
 
 
@@ -153,6 +155,35 @@ protected:
 	weather_header m_hdr;
 	bool m_hdrInitialized;
 
+	/* running sums over one column, so that read_average can average any window in constant
+	time. nan values are counted separately so they only affect the windows that contain them. */
+	struct prefix_sum
+	{
+		std::vector<double> sum;
+		std::vector<size_t> nans;
+
+		bool built() const { return !sum.empty(); }
+		template<typename T> void build(const T *p, size_t n)
+		{
+			sum.assign(n + 1, 0.0);
+			nans.assign(n + 1, 0);
+			for (size_t i = 0; i < n; i++)
+			{
+				bool nan = p[i] != p[i];
+				sum[i + 1] = sum[i] + (nan ? 0.0 : (double)p[i]);
+				nans[i + 1] = nans[i] + (nan ? 1 : 0);
+			}
+		}
+		double average(size_t start, size_t count) const;
+	};
+	prefix_sum m_prefix[_MAXCOL_];
+
+	void clear_averages();
+	/// first index of the num_timesteps long window centered on index, or false if there is none
+	static bool average_window(size_t index, size_t num_timesteps, size_t n, size_t *start);
+	static double record_value(const weather_record &r, int col);
+	static void set_record_value(weather_record *r, int col, double value);
+
 public:
 	weather_data_provider() : m_hdrInitialized( false ) { }
 	virtual ~weather_data_provider() { }
@@ -192,6 +223,9 @@ public:
 	/// reads one more record
 	virtual bool read( weather_record *r ) = 0; 
 
+	/// reads one more record, with the columns in cols averaged over the num_timesteps records centered on it
+	virtual bool read_average( weather_record *r, std::vector<int> &cols, size_t &num_timesteps ) = 0;
+
 
 	// some helper methods for ease of use of this class
 	virtual weather_header &header()  {
@@ -214,6 +248,16 @@ private:
 		std::vector<float> data;
 	};
 	column m_columns[_MAXCOL_];
+	bool m_fromBinary;
+
+	// data set shared through the process-wide cache, in which case m_columns is unused
+	std::shared_ptr<const weatherfile> m_shared;
+	const column *columns() const { return m_shared ? m_shared->m_columns : m_columns; }
+
+	bool parse( const std::string &file, bool header_only );
+	static std::shared_ptr<const weatherfile> cache_open( const std::string &file );
+	bool read_binary( const std::string &file, bool header_only, const std::string &source );
+	bool write_binary( const std::string &file, const std::string &source );
 
 public:
 	weatherfile();
@@ -242,9 +286,80 @@ public:
 	
 	static std::string normalize_city( const std::string &in );
 	static bool convert_to_wfcsv( const std::string &input, const std::string &output );
+
+	/* binary column cache: open() reads a .wfbin file directly, and for text files uses
+	the sidecar file named by binary_cache_file() when its recorded source size, modification
+	time and content hash still match the text file. */
+	static bool convert_to_binary( const std::string &input, const std::string &output );
+	static std::string binary_cache_file( const std::string &input );
+
+	/* cache file for 'input' in the temporary folder, for text files in folders that cannot be written */
+	static std::string temp_binary_cache_file( const std::string &input );
+	/* path of a current binary cache of the text file 'input': the sidecar file, or the temporary
+	folder cache when the sidecar is out of date and cannot be written. a missing cache is written
+	first, which parses the whole text file. returns an empty string and sets 'error' on failure. */
+	static std::string binary_cache_for( const std::string &input, std::string *error = 0 );
+	bool from_binary() { return m_fromBinary; }
+
+	/* process-wide cache of parsed weather files, off by default. while the limit is nonzero, full
+	opens share one immutable data set per file (validated by size, modification time and content
+	hash) and each weatherfile keeps only its own read position. the least recently used files
+	beyond the limit are dropped; data sets still in use stay alive until their last reader closes.
+	setting the limit to zero clears the cache. */
+	static void set_cache_limit( size_t max_files );
+	static size_t cache_limit();
+	bool from_cache() { return m_shared != 0; }
+	/// size, modification time and content hash of a file, with which cached copies of it are validated
+	static bool source_stamp( const std::string &file, uint64_t *size, int64_t *mtime, uint64_t *hash );
 	
 };
 
+/* reads weather data from a binary weather file (see weatherfile::convert_to_binary) a chunk
+of records at a time instead of loading whole columns. a background thread loads the chunk after
+the one being read, so memory use stays at two chunks however long the file is. set_counter_to()
+and rewind() work as for weatherfile, the next read seeks to the chunk holding the new position.
+a text weather file is streamed from its binary cache (see weatherfile::binary_cache_for), which
+is written first if it is missing or out of date, so that first run loads the whole file once. */
+class weatherfile_stream : public weather_data_provider
+{
+public:
+	weatherfile_stream( const std::string &file, size_t chunk_records = 65536 );
+	virtual ~weatherfile_stream();
+
+	int type() { return m_type; }
+	size_t chunk_records() { return m_chunkRecords; }
+
+	bool read( weather_record *r );
+	bool read_average( weather_record *r, std::vector<int> &cols, size_t &num_timesteps );
+	bool has_data_column( size_t id );
+
+private:
+	struct chunk
+	{
+		chunk() : first(0), count(0) { }
+		size_t first;
+		size_t count;
+		std::vector<float> data; // column id * chunk size + record offset
+		bool contains( size_t i ) const { return count > 0 && i >= first && i < first + count; }
+	};
+
+	bool load_chunk( size_t first, chunk &c, std::istream &is );
+	bool fetch( size_t index );
+	float value( int col, size_t index );
+	void prefetch_loop();
+
+	int m_type;
+	std::string m_binFile;
+	size_t m_chunkRecords;
+	long long m_dataOffset;
+	int m_colIndex[_MAXCOL_];
+
+	chunk m_front; // chunk being read, touched only by the reader
+	chunk m_back; // chunk being prefetched, guarded by m_prefetch
+	struct prefetcher;
+	std::unique_ptr<prefetcher> m_prefetch;
+};
+
 
 
 #endif
@@ -31,6 +31,8 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <sstream>
 #include <typeinfo>
 #include <stdio.h>
+#include <map>
+#include <mutex>
 
 #if defined(__WINDOWS__)||defined(WIN32)||defined(_WIN32)
 #define CASECMP(a,b) _stricmp(a,b)
@@ -41,6 +43,7 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #endif
 
 #include "lib_util.h"
+#include "lib_weatherfile.h"
 #include "lib_windfile.h"
 
 #ifdef _MSC_VER
@@ -254,6 +257,7 @@ windfile::windfile()
 	: winddata_provider()
 {
 	m_nrec = 0;
+	m_index = 0;
 	close();
 }
 
@@ -261,6 +265,7 @@ windfile::windfile( const std::string &file )
 	: winddata_provider()
 {
 	m_nrec = 0;
+	m_index = 0;
 	close();
 	open( file );
 }
@@ -272,7 +277,7 @@ windfile::~windfile()
 
 bool windfile::ok()
 {
-  	return m_ifs.good();
+  	return m_shared != 0 || m_ifs.good();
 }
 
 
@@ -285,7 +290,35 @@ bool windfile::open( const std::string &file )
 {
 	close();
 	if (file.empty()) return false;
-	
+	if (cache_limit() == 0)
+		return parse(file);
+
+	std::shared_ptr<const windfile> data = cache_open(file);
+	if (data->m_file.empty())
+	{
+		m_errorMsg = data->m_errorMsg;
+		return false;
+	}
+
+	locid = data->locid;
+	city = data->city;
+	state = data->state;
+	country = data->country;
+	desc = data->desc;
+	year = data->year;
+	lat = data->lat;
+	lon = data->lon;
+	elev = data->elev;
+	m_dataid = data->m_dataid;
+	m_heights = data->m_heights;
+	m_nrec = data->m_nrec;
+	m_file = data->m_file;
+	m_shared = data;
+	return true;
+}
+
+bool windfile::parse( const std::string &file )
+{
 	/*  // don't be strict about requiring .srw extensions for now
 	if ( !cmp_ext(file.c_str(), "srw") )
 		return false;
@@ -400,6 +433,9 @@ bool windfile::open( const std::string &file )
 void windfile::close()
 {
   	m_ifs.close();
+	m_shared.reset();
+	m_records.clear();
+	m_index = 0;
 
 	m_file.clear();
 	city.clear();
@@ -419,6 +455,15 @@ size_t windfile::nrecords()
 
 bool windfile::read_line( std::vector<double> &values )
 {
+	if (m_shared)
+	{
+		if (m_index >= m_shared->m_records.size()) return false;
+		const std::vector<double> &record = m_shared->m_records[m_index++];
+		if (record.empty()) return false;
+		values = record;
+		return true;
+	}
+
 	if ( !ok() ) return false;
 
 	std::vector<std::string> cols;
@@ -436,3 +481,79 @@ bool windfile::read_line( std::vector<double> &values )
 	else
 		return false;
 }
+
+struct windfile_cache_entry
+{
+	uint64_t size;
+	int64_t mtime;
+	uint64_t hash;
+	uint64_t last_use;
+	std::shared_ptr<const windfile> data;
+};
+
+static std::mutex windcache_mutex;
+static std::map<std::string, windfile_cache_entry> windcache_entries;
+static size_t windcache_limit = 0;
+static uint64_t windcache_clock = 0;
+
+void windfile::set_cache_limit(size_t max_files)
+{
+	std::lock_guard<std::mutex> lock(windcache_mutex);
+	windcache_limit = max_files;
+	if (max_files == 0)
+		windcache_entries.clear();
+}
+
+size_t windfile::cache_limit()
+{
+	std::lock_guard<std::mutex> lock(windcache_mutex);
+	return windcache_limit;
+}
+
+std::shared_ptr<const windfile> windfile::cache_open(const std::string &file)
+{
+	// stamp the file outside the lock, since hashing reads the whole file
+	windfile_cache_entry stamp;
+	bool stamped = weatherfile::source_stamp(file, &stamp.size, &stamp.mtime, &stamp.hash);
+
+	if (stamped)
+	{
+		std::lock_guard<std::mutex> lock(windcache_mutex);
+		std::map<std::string, windfile_cache_entry>::iterator it = windcache_entries.find(file);
+		if (it != windcache_entries.end() && it->second.size == stamp.size
+			&& it->second.mtime == stamp.mtime && it->second.hash == stamp.hash)
+		{
+			it->second.last_use = ++windcache_clock;
+			return it->second.data;
+		}
+	}
+
+	// read every record up front, keeping a malformed line as an empty record that read_line() rejects
+	std::shared_ptr<windfile> wf(new windfile);
+	if (!wf->parse(file))
+		return wf;
+	std::vector<double> values;
+	wf->m_records.reserve(wf->m_nrec);
+	for (size_t i = 0; i < wf->m_nrec; i++)
+		wf->m_records.push_back(wf->read_line(values) ? values : std::vector<double>());
+	wf->m_ifs.close();
+	if (!stamped)
+		return wf;
+
+	std::lock_guard<std::mutex> lock(windcache_mutex);
+	if (windcache_limit == 0)
+		return wf;
+
+	stamp.last_use = ++windcache_clock;
+	stamp.data = wf;
+	windcache_entries[file] = stamp;
+	while (windcache_entries.size() > windcache_limit)
+	{
+		std::map<std::string, windfile_cache_entry>::iterator oldest = windcache_entries.begin();
+		for (std::map<std::string, windfile_cache_entry>::iterator it = windcache_entries.begin(); it != windcache_entries.end(); ++it)
+			if (it->second.last_use < oldest->second.last_use)
+				oldest = it;
+		windcache_entries.erase(oldest);
+	}
+	return wf;
+}
@@ -25,6 +25,7 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include <string>
 #include <fstream>
+#include <memory>
 #include "lib_util.h"
 
 class winddata_provider
@@ -92,6 +93,14 @@ private:
 	std::string m_file;
 	size_t m_nrec;
 
+	// records shared through the process-wide cache, in which case m_ifs is closed and m_index is the read position
+	std::shared_ptr<const windfile> m_shared;
+	std::vector< std::vector<double> > m_records;
+	size_t m_index;
+
+	bool parse( const std::string &file );
+	static std::shared_ptr<const windfile> cache_open( const std::string &file );
+
 public:
 	windfile();
 	explicit windfile( const std::string &file );
@@ -104,6 +113,12 @@ public:
 	
 	bool read_line(std::vector<double> &values) override;
 	size_t nrecords() override;
+
+	/* process-wide cache of parsed wind resource files, off by default, with the same validation and
+	least recently used policy as weatherfile::set_cache_limit(). setting the limit to zero clears the cache. */
+	static void set_cache_limit( size_t max_files );
+	static size_t cache_limit();
+	bool from_cache() { return m_shared != 0; }
 	
 };
 
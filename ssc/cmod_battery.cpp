@@ -263,6 +263,18 @@ var_info vtab_battery_outputs[] = {
 
 var_info_invalid };
 
+// energy flows are read back for their monthly totals, so they are only streamed when the totals are not requested
+static compute_module::output_stream stream_flow(compute_module &cm, const std::string &name, size_t length, size_t chunk)
+{
+	return cm.stream_output(name, length, cm.is_output_requested("monthly_" + name) ? 0 : chunk);
+}
+
+static void accumulate_flow(compute_module &cm, const std::string &name, double dt_hour, size_t step_per_hour)
+{
+	if (cm.is_output_requested("monthly_" + name))
+		cm.accumulate_monthly_for_year(name, "monthly_" + name, dt_hour, step_per_hour);
+}
+
 battstor::battstor(compute_module &cm, bool setup_model, size_t nrec, double dt_hr, batt_variables *batt_vars_in)
 {
 	make_vars = false;
@@ -617,38 +629,8 @@ battstor::battstor(compute_module &cm, bool setup_model, size_t nrec, double dt_
 	battery_metrics = 0;
 
 	// outputs
-	outTotalCharge = 0;
-	outAvailableCharge = 0;
-	outBoundCharge = 0;
 	outMaxChargeAtCurrent = 0;
-	outMaxChargeThermal = 0;
-	outMaxCharge = 0;
-	outSOC = 0;
-	outDOD = 0;
-	outDODCycleAverage = 0;
-	outCurrent = 0;
-	outCellVoltage = 0;
-	outBatteryVoltage = 0;
-	outCapacityPercent = 0;
-	outCycles = 0;
 	outBatteryBankReplacement = 0;
-	outBatteryTemperature = 0;
-	outCapacityThermalPercent = 0;
-	outBatteryPower = 0;
-	outGridPower = 0;
-	outPVToLoad = 0;
-	outBatteryToLoad = 0;
-	outGridToLoad = 0;
-	outFuelCellToLoad = 0;
-	outGridPowerTarget = 0;
-	outPVToBatt = 0;
-	outGridToBatt = 0;
-	outFuelCellToBatt = 0;
-	outPVToGrid = 0;
-	outBatteryToGrid = 0;
-	outFuelCellToGrid = 0;
-	outBatteryConversionPowerLoss = 0;
-	outBatterySystemLoss = 0;
 	outAverageCycleEfficiency = 0;
 	outPVChargePercent = 0;
 	outAnnualPVChargeEnergy = 0;
@@ -657,11 +639,6 @@ battstor::battstor(compute_module &cm, bool setup_model, size_t nrec, double dt_
 	outAnnualDischargeEnergy = 0;
 	outAnnualGridImportEnergy = 0;
 	outAnnualGridExportEnergy = 0;
-	outCostToCycle = 0;
-	outBenefitCharge = 0;
-	outBenefitGridcharge = 0;
-	outBenefitClipcharge = 0;
-	outBenefitDischarge = 0;
 
 
 	en = setup_model;
@@ -698,67 +675,70 @@ battstor::battstor(compute_module &cm, bool setup_model, size_t nrec, double dt_
 		// only allocate if lead-acid
 		if (chem == 0)
 		{
-			outAvailableCharge = cm.allocate("batt_q1", nrec*nyears);
-			outBoundCharge = cm.allocate("batt_q2", nrec*nyears);
+			outAvailableCharge = cm.stream_output("batt_q1", nrec*nyears, nrec);
+			outBoundCharge = cm.stream_output("batt_q2", nrec*nyears, nrec);
 		}
-		outCellVoltage = cm.allocate("batt_voltage_cell", nrec*nyears);
-		outMaxCharge = cm.allocate("batt_qmax", nrec*nyears);
-		outMaxChargeThermal = cm.allocate("batt_qmax_thermal", nrec*nyears);
-		outBatteryTemperature = cm.allocate("batt_temperature", nrec*nyears);
-		outCapacityThermalPercent = cm.allocate("batt_capacity_thermal_percent", nrec*nyears);
+		outCellVoltage = cm.stream_output("batt_voltage_cell", nrec*nyears, nrec);
+		outMaxCharge = cm.stream_output("batt_qmax", nrec*nyears, nrec);
+		outMaxChargeThermal = cm.stream_output("batt_qmax_thermal", nrec*nyears, nrec);
+		outBatteryTemperature = cm.stream_output("batt_temperature", nrec*nyears, nrec);
+		outCapacityThermalPercent = cm.stream_output("batt_capacity_thermal_percent", nrec*nyears, nrec);
 	}
-	outCurrent = cm.allocate("batt_I", nrec*nyears);
-	outBatteryVoltage = cm.allocate("batt_voltage", nrec*nyears);
-	outTotalCharge = cm.allocate("batt_q0", nrec*nyears);
-	outCycles = cm.allocate("batt_cycles", nrec*nyears);
-	outSOC = cm.allocate("batt_SOC", nrec*nyears);
-	outDOD = cm.allocate("batt_DOD", nrec*nyears);
-	outDODCycleAverage = cm.allocate("batt_DOD_cycle_average", nrec*nyears);
-	outCapacityPercent = cm.allocate("batt_capacity_percent", nrec*nyears);
-	outCapacityPercentCycle = cm.allocate("batt_capacity_percent_cycle", nrec*nyears);
-	outCapacityPercentCalendar = cm.allocate("batt_capacity_percent_calendar", nrec*nyears);
-	outBatteryPower = cm.allocate("batt_power", nrec*nyears);
-	outGridPower = cm.allocate("grid_power", nrec*nyears); // Net grid energy required.  Positive indicates putting energy on grid.  Negative indicates pulling off grid
+	outCurrent = cm.stream_output("batt_I", nrec*nyears, nrec);
+	outBatteryVoltage = cm.stream_output("batt_voltage", nrec*nyears, nrec);
+	outTotalCharge = cm.stream_output("batt_q0", nrec*nyears, nrec);
+	outCycles = cm.stream_output("batt_cycles", nrec*nyears, nrec);
+	outSOC = cm.stream_output("batt_SOC", nrec*nyears, nrec);
+	outDOD = cm.stream_output("batt_DOD", nrec*nyears, nrec);
+	outDODCycleAverage = cm.stream_output("batt_DOD_cycle_average", nrec*nyears, nrec);
+	outCapacityPercent = cm.stream_output("batt_capacity_percent", nrec*nyears, nrec);
+	outCapacityPercentCycle = cm.stream_output("batt_capacity_percent_cycle", nrec*nyears, nrec);
+	outCapacityPercentCalendar = cm.stream_output("batt_capacity_percent_calendar", nrec*nyears, nrec);
+	outBatteryPower = cm.stream_output("batt_power", nrec*nyears, nrec);
+	// pvsamv1 rewrites grid power through update_grid_power in a later pass over the steps of a dc-connected
+	// battery, after those steps were advanced, so it stays whole in the data table
+	size_t grid_power_chunk = (batt_vars->batt_topology == ChargeController::DC_CONNECTED) ? 0 : nrec;
+	outGridPower = cm.stream_output("grid_power", nrec*nyears, grid_power_chunk); // Net grid energy required.  Positive indicates putting energy on grid.  Negative indicates pulling off grid
 	outGenPower = cm.allocate("pv_batt_gen", nrec*nyears);
-	outPVToGrid = cm.allocate("pv_to_grid", nrec*nyears);
+	outPVToGrid = stream_flow(cm, "pv_to_grid", nrec*nyears, nrec);
 
 	if (batt_vars->batt_meter_position == dispatch_t::BEHIND)
 	{
-		outPVToLoad = cm.allocate("pv_to_load", nrec*nyears);
-		outBatteryToLoad = cm.allocate("batt_to_load", nrec*nyears);
-		outGridToLoad = cm.allocate("grid_to_load", nrec*nyears);
+		outPVToLoad = stream_flow(cm, "pv_to_load", nrec*nyears, nrec);
+		outBatteryToLoad = stream_flow(cm, "batt_to_load", nrec*nyears, nrec);
+		outGridToLoad = stream_flow(cm, "grid_to_load", nrec*nyears, nrec);
 
 		if (batt_vars->batt_dispatch != dispatch_t::MANUAL)
 		{
-			outGridPowerTarget = cm.allocate("grid_power_target", nrec*nyears);
-			outBattPowerTarget = cm.allocate("batt_power_target", nrec*nyears);
+			outGridPowerTarget = cm.stream_output("grid_power_target", nrec*nyears, nrec);
+			outBattPowerTarget = cm.stream_output("batt_power_target", nrec*nyears, nrec);
 		}
 	}
 	else if (batt_vars->batt_meter_position == dispatch_t::FRONT)
 	{
-		outBatteryToGrid = cm.allocate("batt_to_grid", nrec*nyears);
+		outBatteryToGrid = stream_flow(cm, "batt_to_grid", nrec*nyears, nrec);
 
 		if (batt_vars->batt_dispatch != dispatch_t::FOM_MANUAL) {
-			outCostToCycle = cm.allocate("batt_cost_to_cycle", nrec*nyears);
-			outBattPowerTarget = cm.allocate("batt_power_target", nrec*nyears);
-			outBenefitCharge = cm.allocate("batt_revenue_charge", nrec*nyears);
-			outBenefitGridcharge = cm.allocate("batt_revenue_gridcharge", nrec*nyears);
-			outBenefitClipcharge = cm.allocate("batt_revenue_clipcharge", nrec*nyears);
-			outBenefitDischarge = cm.allocate("batt_revenue_discharge", nrec*nyears);
+			outCostToCycle = cm.stream_output("batt_cost_to_cycle", nrec*nyears, nrec);
+			outBattPowerTarget = cm.stream_output("batt_power_target", nrec*nyears, nrec);
+			outBenefitCharge = cm.stream_output("batt_revenue_charge", nrec*nyears, nrec);
+			outBenefitGridcharge = cm.stream_output("batt_revenue_gridcharge", nrec*nyears, nrec);
+			outBenefitClipcharge = cm.stream_output("batt_revenue_clipcharge", nrec*nyears, nrec);
+			outBenefitDischarge = cm.stream_output("batt_revenue_discharge", nrec*nyears, nrec);
 		}
 	}
-	outPVToBatt = cm.allocate("pv_to_batt", nrec*nyears);
-	outGridToBatt = cm.allocate("grid_to_batt", nrec*nyears);
+	outPVToBatt = stream_flow(cm, "pv_to_batt", nrec*nyears, nrec);
+	outGridToBatt = stream_flow(cm, "grid_to_batt", nrec*nyears, nrec);
 
 	if (batt_vars->en_fuelcell) {
-		outFuelCellToBatt = cm.allocate("fuelcell_to_batt", nrec*nyears);
-		outFuelCellToGrid = cm.allocate("fuelcell_to_grid", nrec*nyears);
-		outFuelCellToLoad = cm.allocate("fuelcell_to_load", nrec*nyears);
+		outFuelCellToBatt = cm.stream_output("fuelcell_to_batt", nrec*nyears, nrec);
+		outFuelCellToGrid = cm.stream_output("fuelcell_to_grid", nrec*nyears, nrec);
+		outFuelCellToLoad = cm.stream_output("fuelcell_to_load", nrec*nyears, nrec);
 
 	}
 
-	outBatteryConversionPowerLoss = cm.allocate("batt_conversion_loss", nrec*nyears);
-	outBatterySystemLoss = cm.allocate("batt_system_loss", nrec*nyears);
+	outBatteryConversionPowerLoss = cm.stream_output("batt_conversion_loss", nrec*nyears, nrec);
+	outBatterySystemLoss = cm.stream_output("batt_system_loss", nrec*nyears, nrec);
 
 	// annual outputs
 	size_t annual_size = nyears + 1;
@@ -1366,19 +1346,19 @@ void battstor::calculate_monthly_and_annual_outputs( compute_module &cm )
 	cm.assign("batt_bank_installed_capacity", (ssc_number_t)batt_vars->batt_kwh);
 
 	// monthly outputs
-	cm.accumulate_monthly_for_year("pv_to_batt", "monthly_pv_to_batt", _dt_hour, step_per_hour);
-	cm.accumulate_monthly_for_year("grid_to_batt", "monthly_grid_to_batt", _dt_hour, step_per_hour);
-	cm.accumulate_monthly_for_year("pv_to_grid", "monthly_pv_to_grid", _dt_hour, step_per_hour);
+	accumulate_flow(cm, "pv_to_batt", _dt_hour, step_per_hour);
+	accumulate_flow(cm, "grid_to_batt", _dt_hour, step_per_hour);
+	accumulate_flow(cm, "pv_to_grid", _dt_hour, step_per_hour);
 
 	if (batt_vars->batt_meter_position == dispatch_t::BEHIND)
 	{
-		cm.accumulate_monthly_for_year("pv_to_load", "monthly_pv_to_load", _dt_hour, step_per_hour);
-		cm.accumulate_monthly_for_year("batt_to_load", "monthly_batt_to_load", _dt_hour, step_per_hour);
-		cm.accumulate_monthly_for_year("grid_to_load", "monthly_grid_to_load", _dt_hour, step_per_hour);
+		accumulate_flow(cm, "pv_to_load", _dt_hour, step_per_hour);
+		accumulate_flow(cm, "batt_to_load", _dt_hour, step_per_hour);
+		accumulate_flow(cm, "grid_to_load", _dt_hour, step_per_hour);
 	}
 	else if (batt_vars->batt_meter_position == dispatch_t::FRONT)
 	{
-		cm.accumulate_monthly_for_year("batt_to_grid", "monthly_batt_to_grid", _dt_hour, step_per_hour);
+		accumulate_flow(cm, "batt_to_grid", _dt_hour, step_per_hour);
 	}
 }
 void battstor::process_messages(compute_module &cm) 
@@ -1418,12 +1398,16 @@ public:
 		add_var_info( vtab_battery_inputs);
 		add_var_info(vtab_forecast_price_signal);
 		add_var_info(vtab_battery_outputs);
+		add_var_info(vtab_output_selection);
+		add_var_info(vtab_perf_instrumentation);
 	}
 
 	void exec() override
 	{
 		if (as_boolean("en_batt"))
 		{
+			perf_timer input_timer(this, "input_read");
+
 			// System generation output, which is lifetime (if system_lifetime_output == true);
 			std::vector<ssc_number_t> power_input_lifetime = as_vector_ssc_number_t("gen");
 			std::vector<ssc_number_t> load_lifetime, load_year_one;
@@ -1445,7 +1429,11 @@ public:
 
 			// Create battery structure and initialize
 			battstor batt(*this, true, n_rec_single_year, dt_hour_gen);
-			batt.initialize_automated_dispatch(power_input_lifetime, load_lifetime);
+			input_timer.stop();
+			{
+				perf_timer dispatch_timer(this, "battery_dispatch_init");
+				batt.initialize_automated_dispatch(power_input_lifetime, load_lifetime);
+			}
 
 			if (load_lifetime.size() != n_rec_lifetime) {
 				throw exec_error("battery", "Load length does not match system generation length");
@@ -1480,6 +1468,7 @@ public:
 			}
 
 			size_t lifetime_idx = 0;
+			perf_timer loop_timer(this, "timestep_loop");
 			for (size_t year = 0; year != batt.nyears; year++)
 			{
 				for (size_t hour = 0; hour < 8760; hour++)
@@ -1509,6 +1498,10 @@ public:
 					}
 				}
 			}
+			loop_timer.stop();
+			perf_count("timesteps", (double)lifetime_idx);
+
+			perf_timer output_timer(this, "output_aggregation");
 			batt.calculate_monthly_and_annual_outputs(*this);
 
 			// update capacity factor and annual energy
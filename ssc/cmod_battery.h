@@ -317,43 +317,10 @@ struct battstor
 
 	// outputs
 	ssc_number_t
-		*outTotalCharge,
-		*outAvailableCharge,
-		*outBoundCharge,
 		*outMaxChargeAtCurrent,
-		*outMaxCharge,
-		*outMaxChargeThermal,
-		*outSOC,
-		*outDOD,
-		*outCurrent,
-		*outCellVoltage,
-		*outBatteryVoltage,
-		*outCapacityPercent,
-		*outCapacityPercentCycle,
-		*outCapacityPercentCalendar,
-		*outCycles,
-		*outDODCycleAverage,
 		*outBatteryBankReplacement,
-		*outBatteryTemperature,
-		*outCapacityThermalPercent,
 		*outDispatchMode,
-		*outBatteryPower,
 		*outGenPower,
-		*outGridPower,
-		*outPVToLoad,
-		*outBatteryToLoad,
-		*outGridToLoad,
-		*outFuelCellToLoad,
-		*outGridPowerTarget,
-		*outBattPowerTarget,
-		*outPVToBatt,
-		*outGridToBatt,
-		*outFuelCellToBatt,
-		*outPVToGrid,
-		*outBatteryToGrid,
-		*outFuelCellToGrid,
-		*outBatteryConversionPowerLoss,
-		*outBatterySystemLoss,
 		*outAnnualPVChargeEnergy,
 		*outAnnualGridChargeEnergy,
 		*outAnnualChargeEnergy,
@@ -362,12 +329,48 @@ struct battstor
 		*outAnnualGridExportEnergy,
 		*outAnnualEnergySystemLoss,
 		*outAnnualEnergyLoss,
-		*outMarketPrice,
-		*outCostToCycle,
-		*outBenefitCharge,
-		*outBenefitGridcharge,
-		*outBenefitClipcharge,
-		*outBenefitDischarge;
+		*outMarketPrice;
+
+	// time series outputs written once per step, which a handler may stream
+	compute_module::output_stream
+		outTotalCharge,
+		outAvailableCharge,
+		outBoundCharge,
+		outMaxCharge,
+		outMaxChargeThermal,
+		outSOC,
+		outDOD,
+		outCurrent,
+		outCellVoltage,
+		outBatteryVoltage,
+		outCapacityPercent,
+		outCapacityPercentCycle,
+		outCapacityPercentCalendar,
+		outCycles,
+		outDODCycleAverage,
+		outBatteryTemperature,
+		outCapacityThermalPercent,
+		outBatteryPower,
+		outGridPower,
+		outPVToLoad,
+		outBatteryToLoad,
+		outGridToLoad,
+		outFuelCellToLoad,
+		outGridPowerTarget,
+		outBattPowerTarget,
+		outPVToBatt,
+		outGridToBatt,
+		outFuelCellToBatt,
+		outPVToGrid,
+		outBatteryToGrid,
+		outFuelCellToGrid,
+		outBatteryConversionPowerLoss,
+		outBatterySystemLoss,
+		outCostToCycle,
+		outBenefitCharge,
+		outBenefitGridcharge,
+		outBenefitClipcharge,
+		outBenefitDischarge;
 
 	double outAverageCycleEfficiency;
 	double outAverageRoundtripEfficiency;
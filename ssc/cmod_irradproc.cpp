@@ -167,90 +167,134 @@ public:
 		ssc_number_t *p_sunup = allocate("sunup", count);
 		ssc_number_t *p_sunrise = allocate("sunrise", count);
 		ssc_number_t *p_sunset = allocate("sunset", count);
-		
-		for (size_t i = 0; i < count ;i ++ )
+
+		// check every time stamp and irradiance value the way irrad::calc() does before processing the whole series
+		std::vector<int> yr(count), mo(count), dy(count), hr(count);
+		std::vector<double> mn(count);
+		irrad x;
+		x.set_location( lat, lon, tz );
+		x.set_sky_model( sky_model, alb_const );
+		x.set_surface( track_mode, tilt, azimuth, rotlim, en_backtrack, gcr );
+		for (size_t i = 0; i < count; i++)
 		{
-			double t_cur = hour[i] + minute[i]/60.0;
-			double delt = 1.0;
-			if ( i == 0 )
-			{
-				double t_next = hour[i+1] + minute[i+1]/60.0;
-				if (t_cur > t_next) t_next += 24;
-				delt = t_next - t_cur;
-			}
-			else
-			{
-				double t_prev = hour[i-1] + minute[i-1]/60.0;
-				if (t_cur < t_prev) t_cur += 24;
-				delt = t_cur - t_prev;
-			}
+			if ( irrad_mode == 1 ) x.set_global_beam( glob[i], beam[i] );
+			else if (irrad_mode == 2) x.set_global_diffuse(glob[i], diff[i]);
+			else x.set_beam_diffuse( beam[i], diff[i] );
+
+			yr[i] = (int)year[i];
+			mo[i] = (int)month[i];
+			dy[i] = (int)day[i];
+			hr[i] = (int)hour[i];
+			mn[i] = minute[i];
+
+			x.set_time( yr[i], mo[i], dy[i], hr[i], mn[i], IRRADPROC_NO_INTERPOLATE_SUNRISE_SUNSET );
+			int code = x.check();
+			if (code < 0)
+				throw general_error( util::format("irradiance processor issued error code %d", -100 + code ));
+		}
+
+		// sun position for every time stamp
+		std::vector<double> sun(9 * count);
+		std::vector<int> sunpos(3 * count);
+		double *p_sun[9];
+		int *p_sunpos[3];
+		for (size_t k = 0; k < 9; k++) p_sun[k] = &sun[k * count];
+		for (size_t k = 0; k < 3; k++) p_sunpos[k] = &sunpos[k * count];
+		sun_position_batch( count, &yr[0], &mo[0], &dy[0], &hr[0], &mn[0], IRRADPROC_NO_INTERPOLATE_SUNRISE_SUNSET, lat, lon, tz, p_sun, p_sunpos );
+
+		// surface angles and plane-of-array irradiance are only calculated while the sun is up
+		std::vector<size_t> up;
+		for (size_t i = 0; i < count; i++)
+		{
+			p_azm[i] = (ssc_number_t) (p_sun[0][i] * (180/M_PI));
+			p_zen[i] = (ssc_number_t) (p_sun[1][i] * (180/M_PI));
+			p_elv[i] = (ssc_number_t) (p_sun[2][i] * (180/M_PI));
+			p_dec[i] = (ssc_number_t) (p_sun[3][i] * (180/M_PI));
+			p_sunrise[i] = (ssc_number_t) p_sun[4][i];
+			p_sunset[i] = (ssc_number_t) p_sun[5][i];
+			p_sunup[i] = (ssc_number_t) p_sunpos[2][i];
+
+			p_inc[i] = p_surftilt[i] = p_surfazm[i] = p_rot[i] = p_btdiff[i] = 0;
+			p_poa_beam[i] = p_poa_skydiff[i] = p_poa_gnddiff[i] = 0;
+			p_poa_skydiff_iso[i] = p_poa_skydiff_cir[i] = p_poa_skydiff_hor[i] = 0;
+
+			if (p_sunpos[2][i] > 0)
+				up.push_back(i);
+		}
 
-			// double precsion issue (15 digits IEEE 754) encountered by Anthony Lopez 4/29/13 for 
-			// minutes other than 15,30,45 and 60
-			if (fabs(delt-1.0)<1e-14) delt=1.0;
+		size_t nup = up.size();
+		if (nup == 0)
+			return;
 
-			double alb = alb_const;
+		std::vector<double> zen(nup), azm(nup), hextra(nup), dn(nup), df(nup), alb(nup);
+		std::vector<double> angles(5 * nup), poa(3 * nup), diffc(3 * nup);
+		double *p_angle[5], *p_poa[3], *p_diffc[3];
+		for (size_t k = 0; k < 5; k++) p_angle[k] = &angles[k * nup];
+		for (size_t k = 0; k < 3; k++) p_poa[k] = &poa[k * nup];
+		for (size_t k = 0; k < 3; k++) p_diffc[k] = &diffc[k * nup];
+
+		for (size_t k = 0; k < nup; k++)
+		{
+			size_t i = up[k];
+			zen[k] = p_sun[1][i];
+			azm[k] = p_sun[0][i];
+			hextra[k] = p_sun[8][i];
+
+			alb[k] = alb_const;
 			// if we have array of albedo values, use it
 			if ( albvec != 0  && albvec[i] >= 0 && albvec[i] <= (ssc_number_t)1.0)
-				alb = albvec[i];
+				alb[k] = albvec[i];
 
-			irrad x;
+			// compute beam and diffuse inputs on horizontal based on irradiance inputs mode
+			if (irrad_mode == 2) // Total+Diffuse
+			{
+				df[k] = diff[i];
+				dn[k] = (glob[i] - diff[i]) / cos(zen[k]); //compute beam from total, diffuse, and zenith angle
+				if (dn[k] > irrad::irradiationMax) dn[k] = irrad::irradiationMax;
+				if (dn[k] < 0) dn[k] = 0;
+				continue;
+			}
 
-			x.set_time( (int)year[i], (int)month[i], (int)day[i], (int)hour[i], minute[i], IRRADPROC_NO_INTERPOLATE_SUNRISE_SUNSET );
-			x.set_location( lat, lon, tz );
-			x.set_sky_model( sky_model, alb );
-			if ( irrad_mode == 1 ) x.set_global_beam( glob[i], beam[i] );
-			else if (irrad_mode == 2) x.set_global_diffuse(glob[i], diff[i]);
-			else x.set_beam_diffuse( beam[i], diff[i] );
-			x.set_surface( track_mode, tilt, azimuth, rotlim, en_backtrack, gcr );
-			
-			int code = x.calc();
-			if (code < 0)
-				throw general_error( util::format("irradiance processor issued error code %d", code ));
-
-			double solazi, solzen, solelv, soldec, sunrise, sunset;
-			int sunup;
-
-			x.get_sun( &solazi,
-				&solzen,
-				&solelv,
-				&soldec,
-				&sunrise,
-				&sunset,
-				&sunup,
-				0,
-				0,
-				0 );
-			
-			p_azm[i] = (ssc_number_t) solazi;
-			p_zen[i] = (ssc_number_t) solzen;
-			p_elv[i] = (ssc_number_t) solelv;
-			p_dec[i] = (ssc_number_t) soldec;	
-			p_sunrise[i] = (ssc_number_t) sunrise;
-			p_sunset[i] = (ssc_number_t) sunset;
-			p_sunup[i] = (ssc_number_t) sunup;
-			
-			
-			double aoi, stilt, sazi, rot, btd;
-			x.get_angles( &aoi, &stilt, &sazi, &rot, &btd );
-
-			// assign outputs
-			p_inc[i] = (ssc_number_t) aoi;
-			p_surftilt[i] = (ssc_number_t) stilt;
-			p_surfazm[i] = (ssc_number_t) sazi;
-			p_rot[i] = (ssc_number_t) rot;
-			p_btdiff[i] = (ssc_number_t) btd;
-			
-			double beam, skydiff, gnddiff, iso, cir, hor;
-			x.get_poa( &beam, &skydiff, &gnddiff, &iso, &cir, &hor );
-
-			p_poa_beam[i] = (ssc_number_t) beam;
-			p_poa_skydiff[i] = (ssc_number_t) skydiff;
-			p_poa_gnddiff[i] = (ssc_number_t) gnddiff;
-			p_poa_skydiff_iso[i] = (ssc_number_t) iso;
-			p_poa_skydiff_cir[i] = (ssc_number_t) cir;
-			p_poa_skydiff_hor[i] = (ssc_number_t) hor;
-			
+			// check beam irradiance against extraterrestrial irradiance
+			double hbeam = beam[i] * cos( zen[k] );
+			if ( hbeam > hextra[k] )
+				throw general_error( util::format("irradiance processor issued error code %d", -1 ));
+
+			dn[k] = beam[i];
+			if (irrad_mode == 1) // Total+Beam
+			{
+				df[k] = glob[i] - hbeam;
+				if (df[k] < 0) df[k] = 0;
+			}
+			else // Beam+Diffuse
+				df[k] = diff[i];
+		}
+
+		// compute incidence angles onto fixed or tracking surface, then incident irradiance on the tilted surface
+		incidence_batch( nup, track_mode, tilt, azimuth, rotlim, &zen[0], &azm[0], en_backtrack, gcr, p_angle );
+		if (sky_model == 0)
+			isotropic_batch( nup, &hextra[0], &dn[0], &df[0], &alb[0], p_angle[0], p_angle[1], &zen[0], p_poa, p_diffc );
+		else if (sky_model == 1)
+			hdkr_batch( nup, &hextra[0], &dn[0], &df[0], &alb[0], p_angle[0], p_angle[1], &zen[0], p_poa, p_diffc );
+		else
+			perez_batch( nup, &hextra[0], &dn[0], &df[0], &alb[0], p_angle[0], p_angle[1], &zen[0], p_poa, p_diffc );
+
+		// assign outputs
+		for (size_t k = 0; k < nup; k++)
+		{
+			size_t i = up[k];
+			p_inc[i] = (ssc_number_t) (p_angle[0][k] * (180/M_PI));
+			p_surftilt[i] = (ssc_number_t) (p_angle[1][k] * (180/M_PI));
+			p_surfazm[i] = (ssc_number_t) (p_angle[2][k] * (180/M_PI));
+			p_rot[i] = (ssc_number_t) (p_angle[3][k] * (180/M_PI));
+			p_btdiff[i] = (ssc_number_t) (p_angle[4][k] * (180/M_PI));
+
+			p_poa_beam[i] = (ssc_number_t) p_poa[0][k];
+			p_poa_skydiff[i] = (ssc_number_t) p_poa[1][k];
+			p_poa_gnddiff[i] = (ssc_number_t) p_poa[2][k];
+			p_poa_skydiff_iso[i] = (ssc_number_t) p_diffc[0][k];
+			p_poa_skydiff_cir[i] = (ssc_number_t) p_diffc[1][k];
+			p_poa_skydiff_hor[i] = (ssc_number_t) p_diffc[2][k];
 		}
 	}
 };
@@ -30,6 +30,7 @@ static var_info _cm_vtab_pvsamv1[] = {
 /*   VARTYPE            DATATYPE         NAME                                            LABEL                                                   UNITS      META                             GROUP                  REQUIRED_IF                 CONSTRAINTS                      UI_HINTS*/
     {SSC_INPUT, SSC_STRING,   "solar_resource_file",                  "Weather file in TMY2, TMY3, EPW, or SAM CSV",         "",       "",                                                                                                                                                                                      "Solar Resource",                                        "?",                                  "",                    "" },
     {SSC_INPUT, SSC_TABLE,    "solar_resource_data",                  "Weather data",                                        "",       "lat,lon,tz,elev,year,month,hour,minute,gh,dn,df,poa,tdry,twet,tdew,rhum,pres,Snow,alb,aod,wspd,wdir",                                                                                   "Solar Resource",                                        "?",                                  "",                    "" },
+    {SSC_INPUT, SSC_NUMBER,   "solar_resource_stream",                "Stream the weather file in chunks instead of loading it", "0/1",  "Streams a binary cache of solar_resource_file kept next to it, or in the temporary folder if that folder is read-only. The run that writes a missing or outdated cache loads the full file once", "Solar Resource",                                        "?=0",                                "BOOLEAN",             "" },
     
     	// transformer model percent of rated ac output
     {SSC_INPUT, SSC_NUMBER,   "transformer_no_load_loss",             "Power transformer no load loss",                      "%",      "",                                                                                                                                                                                      "Losses",                                                "?=0",                                "",                    "" },
@@ -39,6 +40,7 @@ static var_info _cm_vtab_pvsamv1[] = {
     {SSC_INPUT, SSC_NUMBER,   "system_use_lifetime_output",           "PV lifetime simulation",                              "0/1",    "",                                                                                                                                                                                      "Lifetime",                                              "?=0",                                "INTEGER,MIN=0,MAX=1", "" },
     {SSC_INPUT, SSC_NUMBER,   "analysis_period",                      "Lifetime analysis period",                            "years",  "",                                                                                                                                                                                      "Lifetime",                                              "system_use_lifetime_output=1",       "",                    "" },
     {SSC_INPUT, SSC_ARRAY,    "dc_degradation",                       "Annual DC degradation",                           "%/year", "",                                                                                                                                                                                      "Lifetime",                                              "system_use_lifetime_output=1",       "",                    "" },
+    {SSC_INPUT, SSC_NUMBER,   "system_lifetime_reuse_first_year",     "Replay first year irradiance and module results",     "0/1",    "",                                                                                                                                                                                      "Lifetime",                                              "?=1",                                "BOOLEAN",             "" },
     {SSC_OUTPUT,SSC_ARRAY,    "dc_degrade_factor",                    "Annual DC degradation factor",                        "",       "",                                                                                                                                                                                      "Lifetime",                                              "system_use_lifetime_output=1",       "",                    "" },
     {SSC_INPUT, SSC_NUMBER,   "en_dc_lifetime_losses",                "Enable lifetime daily DC losses",                     "0/1",    "",                                                                                                                                                                                      "Lifetime",                                              "?=0",                                "INTEGER,MIN=0,MAX=1", "" },
     {SSC_INPUT, SSC_ARRAY,    "dc_lifetime_losses",                   "Lifetime daily DC losses",                            "%",      "",                                                                                                                                                                                      "Lifetime",                                              "en_dc_lifetime_losses=1",            "",                    "" },
@@ -52,8 +54,11 @@ static var_info _cm_vtab_pvsamv1[] = {
     {SSC_INPUT, SSC_ARRAY,    "albedo",                               "User specified ground albedo",                        "0..1",   "",                                                                                                                                                                                      "Solar Resource",                                        "*",                                  "LENGTH=12",           "" },
     {SSC_INPUT, SSC_NUMBER,   "irrad_mode",                           "Irradiance input translation mode",                   "",       "0=beam&diffuse,1=total&beam,2=total&diffuse,3=poa_reference,4=poa_pyranometer",                                                                                                         "Solar Resource",                                        "?=0",                                "INTEGER,MIN=0,MAX=4", "" },
     {SSC_INPUT, SSC_NUMBER,   "sky_model",                            "Diffuse sky model",                                   "",       "0=isotropic,1=hkdr,2=perez",                                                                                                                                                            "Solar Resource",                                        "?=2",                                "INTEGER,MIN=0,MAX=2", "" },
+    {SSC_INPUT, SSC_NUMBER,   "irradiance_threads",                   "Worker threads for the irradiance calculations",      "",       "0=one per hardware thread",                                                                                                                                                             "Solar Resource",                                        "?=1",                                "INTEGER,MIN=0",       "" },
     {SSC_INPUT, SSC_NUMBER,   "inverter_count",                       "Number of inverters",                                 "",       "",                                                                                                                                                                                      "System Design",                                         "*",                                  "INTEGER,POSITIVE",    "" },
     {SSC_INPUT, SSC_NUMBER,   "enable_mismatch_vmax_calc",            "Enable mismatched subarray Vmax calculation",         "",       "",                                                                                                                                                                                      "System Design",                                         "?=0",                                "BOOLEAN",             "" },
+    {SSC_INPUT, SSC_NUMBER,   "mismatch_vmax_method",                 "Mismatched subarray Vmax search method",              "",       "0=100-point sweep,1=golden-section search",                                                                                                                                             "System Design",                                         "?=0",                                "INTEGER,MIN=0,MAX=1", "" },
+    {SSC_INPUT, SSC_NUMBER,   "mismatch_vmax_tolerance",              "Mismatched subarray Vmax search tolerance",           "V",      "",                                                                                                                                                                                      "System Design",                                         "?=0.1",                              "POSITIVE",            "" },
     
 	  // subarray 1
     {SSC_INPUT, SSC_NUMBER,   "subarray1_nstrings",                   "Sub-array 1 Number of parallel strings",              "",       "",                                                                                                                                                                                      "System Design",                                         "",                                   "INTEGER",             "" },
@@ -902,6 +907,63 @@ static var_info _cm_vtab_pvsamv1[] = {
 
 var_info_invalid };
 
+/// Results for one subarray at one time step that depend only on the weather, saved in the first year of a lifetime simulation and replayed in later years
+struct first_year_subarray_step
+{
+	double poaBeamFront;				/// POA beam irradiance after shading and soiling [W/m2]
+	double poaDiffuseFront;				/// POA sky diffuse irradiance after shading and soiling [W/m2]
+	double poaGroundFront;				/// POA ground reflected irradiance after shading and soiling [W/m2]
+	double surfaceTiltDegrees;			/// Tilt of the subarray after tracking [degrees]
+	double dcPowerW;					/// DC power of one module at the operating voltage, after the self-shading and shading database derates [W]
+	double dcPowerSubarray;				/// DC power of the subarray before snow [W]
+	double dcVoltage;					/// DC operating voltage of one module [V]
+};
+
+/// Results of irrad::calc() and irrad::calc_rear_side() for one subarray at one time step, calculated ahead of the time step loop
+struct irradiance_step
+{
+	int code;							/// Return code of irrad::calc(), negative if it failed
+	double solazi, solzen, solalt;		/// Sun azimuth, zenith and altitude angles [degrees]
+	int sunup;							/// Sun up flag: 0 = down, 1 = up, 2 = sunrise, 3 = sunset
+	double aoi, stilt, sazi, rot, btd;	/// Incidence angle, surface tilt and azimuth, tracker rotation and backtracking difference [degrees]
+	double ibeam, iskydiff, ignddiff;	/// POA beam, sky diffuse and ground reflected irradiance [W/m2]
+	double gh, dn, df;					/// Global, beam and diffuse irradiance from the POA decomposition [W/m2]
+	double alb;							/// Albedo
+	double sunposHour;					/// Hour at which the sun position was calculated
+	double poaRear;						/// Rear side irradiance of bifacial modules [W/m2]
+	ssc_number_t calculated;			/// Irradiance component calculated from the other two in the first year, before negative values are set to zero [W/m2]
+};
+
+/// Irradiance after shading, self-shading and soiling, and the DC power of one subarray at one time step, calculated ahead of the time step loop
+struct dc_step
+{
+	bool shadingFailed;					/// The shading factor calculation failed
+	bool selfShadingFailed;				/// The self-shading calculation failed
+	bool usePOAFromWF;					/// The module model uses the POA irradiance from the weather file
+	double ipoa;						/// POA irradiance from the weather file after soiling [W/m2]
+	double ibeam, iskydiff, ignddiff;	/// POA beam, sky diffuse and ground reflected irradiance after shading, self-shading and soiling [W/m2]
+	double beamShadeFactor;				/// Beam shading factor from the shading inputs
+	double beamShadingFactor;			/// Beam irradiance derate from shading, self-shading and soiling
+	double dcShadeFactor;				/// DC derate from the shading database
+	double nonlinearDCShadingDerate;	/// DC derate from non-linear self-shading
+	double derateSelfShading;			/// Self-shading DC derate output
+	double derateLinear;				/// Self-shading linear beam derate output
+	double derateSelfShadingDiffuse;	/// Self-shading sky diffuse derate output
+	double derateSelfShadingReflected;	/// Self-shading ground reflected derate output
+	double poaShaded;					/// POA irradiance after shading and self-shading [W/m2]
+	double soilingFactor;				/// Soiling derate
+	double poaFront;					/// Front side POA irradiance after shading, self-shading and soiling [W/m2]
+	double poaRear;						/// Rear side irradiance of bifacial modules [W/m2]
+	double poaRearAfterLosses;			/// Rear side irradiance after the rear irradiance losses [W/m2]
+	double poaTotal;					/// Irradiance used by the module model [W/m2]
+	pvoutput_t out;						/// Module model outputs at the operating voltage, set to zero if not finite
+	double outVoltage;					/// Module voltage before a non-finite result was set to zero [V]
+	bool outNotFinite;					/// The module model returned a non-finite power
+	double mpptVoltageClipping;			/// Power lost to the inverter MPPT voltage limits, after the self-shading derate [W]
+	double dcPowerW;					/// DC power of one module after the self-shading and shading database derates [W]
+	double dcPowerSubarray;				/// DC power of the subarray before snow [W]
+};
+
 cm_pvsamv1::cm_pvsamv1()
 {
 	add_var_info( _cm_vtab_pvsamv1 );
@@ -911,11 +973,14 @@ cm_pvsamv1::cm_pvsamv1()
 	add_var_info(vtab_battery_inputs);
 	add_var_info(vtab_forecast_price_signal);
 	add_var_info(vtab_battery_outputs);
+	add_var_info(vtab_output_selection);
+	add_var_info(vtab_perf_instrumentation);
 }
 
 	
 void cm_pvsamv1::exec( ) throw (compute_module::general_error)
 {
+	perf_timer input_timer(this, "input_read");
 
 	/// Underlying class which parses the compute module structure and sets up model inputs and outputs
 	std::unique_ptr<PVIOManager> IOManager(new PVIOManager(this, "pvsamv1"));
@@ -923,7 +988,6 @@ void cm_pvsamv1::exec( ) throw (compute_module::general_error)
 	Irradiance_IO * Irradiance = IOManager->getIrradianceIO();
 	std::vector<Subarray_IO *> Subarrays = IOManager->getSubarrays();
 	PVSystem_IO * PVSystem = IOManager->getPVSystemIO();
-	ShadeDB8_mpp * shadeDatabase = IOManager->getShadeDatabase();
 	
 	size_t nrec = Simulation->numberOfWeatherFileRecords;
 	size_t nlifetime = Simulation->numberOfSteps;
@@ -971,7 +1035,7 @@ void cm_pvsamv1::exec( ) throw (compute_module::general_error)
 	}
 
 	// Warning workaround
-	static bool is32BitLifetime = (__ARCHBITS__ == 32 && system_use_lifetime_output);
+	bool is32BitLifetime = (__ARCHBITS__ == 32 && system_use_lifetime_output);
 	if (is32BitLifetime)
 		throw exec_error( "pvsamv1", "Lifetime simulation of PV systems is only available in the 64 bit version of SAM.");
 
@@ -1062,11 +1126,622 @@ void cm_pvsamv1::exec( ) throw (compute_module::general_error)
 		std::vector<double> tmp;
 		dcStringVoltage.push_back(tmp);
 	}
+	input_timer.stop();
+	perf_count("timesteps", (double)nlifetime);
+
+	// sun positions depend only on the weather time step, so subarrays and lifetime years share them
+	sun_position_cache sunPositionCache(Irradiance->weatherHeader.lat, Irradiance->weatherHeader.lon, Irradiance->weatherHeader.tz, nrec);
+	sunPositionCache.precompute(*wdprov, Irradiance->instantaneous ? IRRADPROC_NO_INTERPOLATE_SUNRISE_SUNSET : Irradiance->dtHour);
+
+	// everything up to the DC power of each subarray before snow depends only on the weather and the system, so it is calculated for
+	// a block of time steps at a time, ahead of the time step loop, on worker threads: the irradiance, shading, self-shading, soiling,
+	// the module model and the DC derates for self-shading and the shading database. the rest of the loop carries state from one time
+	// step to the next (snow, the golden-section mismatch search that starts from the previous string voltage, log messages) and runs
+	// in order on the results. POA decomposition also carries state between time steps, so weather files with POA input use blocks of one step
+	int irradianceThreads = as_integer("irradiance_threads");
+	size_t irradianceBlockSteps = (radmode == irrad::POA_R || radmode == irrad::POA_P) ? 1 : std::min(nrec, (size_t)8760);
+	std::vector<weather_record> blockWeather(irradianceBlockSteps);
+	std::vector<irradiance_step> blockIrradiance(irradianceBlockSteps * num_subarrays);
+	std::vector<dc_step> blockDC(irradianceBlockSteps * num_subarrays);
+	std::vector<double> blockMpptVoltage(irradianceBlockSteps * PVSystem->Inverter->nMpptInputs);
+	size_t blockStart = 0, blockSteps = 0;
+	std::atomic<size_t> viewFactorsReused(0);
+	std::atomic<size_t> mismatchPowerEvaluations(0);
+
+	// the golden-section search starts from the string voltage found at the previous time step, so it runs in order
+	bool mismatchInOrder = PVSystem->enableMismatchVoltageCalc && PVSystem->mismatchVoltageMethod != MISMATCH_VOLTAGE_SWEEP;
+	if (Subarrays[0]->Module->isBifacial)
+		bifaciality = Subarrays[0]->Module->bifaciality;
+
+	// calculates the irradiance on every subarray for the time steps [first, last) of the current block.
+	// bifacial view factors depend only on each subarray's row geometry, so time steps with the same tilt share them
+	auto calculateBlockIrradiance = [&](size_t first, size_t last, bool firstYear)
+	{
+		std::vector<bifacial_view_factors> rearViewFactors(num_subarrays);
+		for (size_t i = first; i < last; i++)
+		{
+			const weather_record &wf = blockWeather[i];
+			size_t step = blockStart + i;
+			for (size_t nn = 0; nn < num_subarrays; nn++)
+			{
+				if (!Subarrays[nn]->enable
+					|| Subarrays[nn]->nStrings < 1)
+					continue; // skip disabled subarrays
+
+				irradiance_step &r = blockIrradiance[i * num_subarrays + nn];
+				irrad irr(blockWeather[i], Irradiance->weatherHeader,
+					Irradiance->skyModel, Irradiance->radiationMode, Subarrays[nn]->trackMode,
+					Irradiance->useWeatherFileAlbedo, Irradiance->instantaneous, Subarrays[nn]->backtrackingEnabled,
+					Irradiance->dtHour, Subarrays[nn]->tiltDegrees, Subarrays[nn]->azimuthDegrees, Subarrays[nn]->trackerRotationLimitDegrees, Subarrays[nn]->groundCoverageRatio,
+					Subarrays[nn]->monthlyTiltDegrees, Irradiance->userSpecifiedMonthlyAlbedo,
+					Subarrays[nn]->poa.poaAll.get());
+				irr.set_sun_position_cache(&sunPositionCache, step);
+
+				r.code = irr.calc();
+				if (r.code < 0)
+					continue; // reported in order by the time step loop
+
+				r.gh = r.dn = r.df = 0;
+				irr.get_irrad(&r.gh, &r.dn, &r.df);
+				irr.get_sun(&r.solazi, &r.solzen, &r.solalt, 0, 0, 0, &r.sunup, 0, 0, 0);
+				irr.get_angles(&r.aoi, &r.stilt, &r.sazi, &r.rot, &r.btd);
+				irr.get_poa(&r.ibeam, &r.iskydiff, &r.ignddiff, 0, 0, 0);
+				r.alb = irr.getAlbedo();
+				r.sunposHour = irr.get_sunpos_calc_hour();
+
+				// p_irrad_calc is only weather file records long, and the self-shading model reads it at the top of each hour
+				r.calculated = 0;
+				if (firstYear)
+				{
+					if (radmode == irrad::POA_R || radmode == irrad::POA_P) {
+						Irradiance->p_IrradianceCalculated[1][step] = (ssc_number_t)r.df;
+						Irradiance->p_IrradianceCalculated[2][step] = (ssc_number_t)r.dn;
+					}
+
+					// calculate beam if global & diffuse are selected as inputs
+					if (radmode == irrad::GH_DF)
+					{
+						r.calculated = (ssc_number_t)((wf.gh - wf.df) / cos(r.solzen*3.1415926 / 180));
+						Irradiance->p_IrradianceCalculated[2][step] = (r.calculated < -1) ? 0 : r.calculated;
+					}
+
+					// calculate global if beam & diffuse are selected as inputs
+					if (radmode == irrad::DN_DF)
+					{
+						r.calculated = (ssc_number_t)(wf.df + wf.dn * cos(r.solzen*3.1415926 / 180));
+						Irradiance->p_IrradianceCalculated[0][step] = (r.calculated < -1) ? 0 : r.calculated;
+					}
+
+					// calculate diffuse if total & beam are selected as inputs
+					if (radmode == irrad::DN_GH)
+					{
+						r.calculated = (ssc_number_t)(wf.gh - wf.dn * cos(r.solzen*3.1415926 / 180));
+						Irradiance->p_IrradianceCalculated[1][step] = (r.calculated < -1) ? 0 : r.calculated;
+					}
+				}
+
+				// Calculate rear-side irradiance for bifacial modules
+				r.poaRear = 0;
+				if (Subarrays[0]->Module->isBifacial)
+				{
+					double slopeLength = Subarrays[nn]->selfShadingInputs.length * Subarrays[nn]->selfShadingInputs.nmody;
+					if (Subarrays[nn]->selfShadingInputs.mod_orient == 1) {
+						slopeLength = Subarrays[nn]->selfShadingInputs.width * Subarrays[nn]->selfShadingInputs.nmody;
+					}
+					irr.calc_rear_side(Subarrays[0]->Module->bifacialTransmissionFactor, Subarrays[0]->Module->groundClearanceHeight, slopeLength, &rearViewFactors[nn]);
+					r.poaRear = irr.get_poa_rear();
+				}
+			}
+		}
+		for (size_t nn = 0; nn < num_subarrays; nn++)
+			viewFactorsReused += rearViewFactors[nn].hits();
+	};
+
+	// applies shading, self-shading and soiling to the irradiance on subarray nn at step i of the block.
+	// the shading database caches decoded rows, so each caller passes its own. returns false if the shading calculations failed
+	auto calculateSubarrayLosses = [&](size_t i, size_t nn, ShadeDB8_mpp *shadeDatabase)
+	{
+		const weather_record &wf = blockWeather[i];
+		const irradiance_step &irr = blockIrradiance[i * num_subarrays + nn];
+		dc_step &dc = blockDC[i * num_subarrays + nn];
+		size_t step = blockStart + i;
+		size_t stepHour = step / step_per_hour, hourStep = step % step_per_hour;
+
+		// beam, skydiff, and grounddiff IN THE PLANE OF ARRAY (W/m2)
+		double ibeam = irr.ibeam, iskydiff = irr.iskydiff, ignddiff = irr.ignddiff;
+		dc.shadingFailed = dc.selfShadingFailed = false;
+
+		// Ensure that the usePOAFromWF flag is false unless a reference cell has been used.
+		//  This will later get forced to false if any shading has been applied (in any scenario)
+		//  also this will also be forced to false if using the cec mcsp thermal model OR if using the spe module model with a diffuse util. factor < 1.0
+		dc.usePOAFromWF = false;
+		dc.ipoa = 0;
+		if (radmode == irrad::POA_R){
+			dc.ipoa = wf.poa;
+			dc.usePOAFromWF = true;
+		}
+		else if (radmode == irrad::POA_P){
+			dc.ipoa = wf.poa;
+		}
+
+		if (Subarrays[nn]->Module->simpleEfficiencyForceNoPOA && (radmode == irrad::POA_R || radmode == irrad::POA_P))  // only will be true if using a poa model AND spe module model AND spe_fp is < 1
+			dc.usePOAFromWF = false;
+
+		if (Subarrays[nn]->Module->mountingSpecificCellTemperatureForceNoPOA && (radmode == irrad::POA_R || radmode == irrad::POA_P))
+			dc.usePOAFromWF = false;
+
+		// for non-linear shading from shading database
+		dc.dcShadeFactor = Subarrays[nn]->shadeCalculator.dc_shade_factor();
+		if (Subarrays[nn]->shadeCalculator.use_shade_db())
+		{
+			double shadedb_gpoa = ibeam + iskydiff + ignddiff;
+			double shadedb_dpoa = iskydiff + ignddiff;
+
+			// update cell temperature - unshaded value per Sara 1/25/16
+			double tcell = wf.tdry;
+			if (irr.sunup > 0)
+			{
+				// calculate cell temperature using selected temperature model
+				pvinput_t in(ibeam, iskydiff, ignddiff, 0, dc.ipoa,
+					wf.tdry, wf.tdew, wf.wspd, wf.wdir, wf.pres,
+					irr.solzen, irr.aoi, hdr.elev,
+					irr.stilt, irr.sazi,
+					((double)wf.hour) + wf.minute / 60.0,
+					radmode, dc.usePOAFromWF);
+				// voltage set to -1 for max power
+				(*Subarrays[nn]->Module->cellTempModel)(in, *Subarrays[nn]->Module->moduleModel, -1.0, tcell);
+			}
+			double shadedb_str_vmp_stc = Subarrays[nn]->nModulesPerString * Subarrays[nn]->Module->voltageMaxPower;
+			double shadedb_mppt_lo = PVSystem->Inverter->mpptLowVoltage;
+			double shadedb_mppt_hi = PVSystem->Inverter->mpptHiVoltage;
+
+			// shading database if necessary
+			if (!Subarrays[nn]->shadeCalculator.fbeam_shade_db(shadeDatabase, stepHour, irr.solalt, irr.solazi, hourStep, step_per_hour, shadedb_gpoa, shadedb_dpoa, tcell, Subarrays[nn]->nModulesPerString, shadedb_str_vmp_stc, shadedb_mppt_lo, shadedb_mppt_hi, dc.beamShadeFactor, dc.dcShadeFactor))
+			{
+				dc.shadingFailed = true;
+				return false;
+			}
+#ifdef SHADE_DB_OUTPUTS
+			// the weather repeats every year, so later years write the same values
+			p_shadedb_gpoa[nn][step] = (ssc_number_t)shadedb_gpoa;
+			p_shadedb_dpoa[nn][step] = (ssc_number_t)shadedb_dpoa;
+			p_shadedb_pv_cell_temp[nn][step] = (ssc_number_t)tcell;
+			p_shadedb_mods_per_str[nn][step] = (ssc_number_t)Subarrays[nn]->nModulesPerString;
+			p_shadedb_str_vmp_stc[nn][step] = (ssc_number_t)shadedb_str_vmp_stc;
+			p_shadedb_mppt_lo[nn][step] = (ssc_number_t)shadedb_mppt_lo;
+			p_shadedb_mppt_hi[nn][step] = (ssc_number_t)shadedb_mppt_hi;
+#endif
+		}
+		else
+		{
+			if (!Subarrays[nn]->shadeCalculator.fbeam(stepHour, irr.solalt, irr.solazi, hourStep, step_per_hour, dc.beamShadeFactor))
+			{
+				dc.shadingFailed = true;
+				return false;
+			}
+		}
+
+		// apply hourly shading factors to beam (if none enabled, factors are 1.0)
+		// shj 3/21/16 - update to handle negative shading loss
+		if (dc.beamShadeFactor != 1.0){
+			// Sara 1/25/16 - shading database derate applied to dc only
+			// shading loss applied to beam if not from shading database
+			ibeam *= dc.beamShadeFactor;
+			if (radmode == irrad::POA_R || radmode == irrad::POA_P)
+				dc.usePOAFromWF = false;
+		}
+
+		// apply sky diffuse shading factor (specified as constant, nominally 1.0 if disabled in UI)
+		if (Subarrays[nn]->shadeCalculator.fdiff() < 1.0){
+			iskydiff *= Subarrays[nn]->shadeCalculator.fdiff();
+			if (radmode == irrad::POA_R || radmode == irrad::POA_P)
+				dc.usePOAFromWF = false;
+		}
+
+		double beam_shading_factor = dc.beamShadeFactor;
+
+		//self-shading calculations
+		dc.nonlinearDCShadingDerate = 1;
+		if (((Subarrays[nn]->trackMode == 0 || Subarrays[nn]->trackMode == 4) && (Subarrays[nn]->shadeMode == 1 || Subarrays[nn]->shadeMode == 2)) //fixed tilt or timeseries tilt, self-shading (linear or non-linear) OR
+			|| (Subarrays[nn]->trackMode == 1 && (Subarrays[nn]->shadeMode == 1 || Subarrays[nn]->shadeMode == 2))) //one-axis tracking, self-shading (linear or non-linear)
+		{
+			if (radmode == irrad::POA_R || radmode == irrad::POA_P)
+				dc.usePOAFromWF = false;
+
+			// info to be passed to self-shading function
+			bool trackbool = (Subarrays[nn]->trackMode == 1);	// 0 for fixed tilt and timeseries tilt, 1 for one-axis
+			bool linear = (Subarrays[nn]->shadeMode == 2); //0 for full self-shading, 1 for linear self-shading
+
+			//geometric fraction of the array that is shaded for one-axis trackers.
+			//USES A DIFFERENT FUNCTION THAN THE SELF-SHADING BECAUSE SS IS MEANT FOR FIXED ONLY. shadeFraction1x IS FOR TRUE-TRACKING ONE-AXIS TRACKERS ONLY.
+			//used in the non-linear self-shading calculator for one-axis tracking only
+			double shad1xf = 0.0;
+			if (trackbool && (Subarrays[nn]->backtrackingEnabled == false))
+				shad1xf = shadeFraction1x(irr.solazi, irr.solzen, Subarrays[nn]->tiltDegrees, Subarrays[nn]->azimuthDegrees, Subarrays[nn]->groundCoverageRatio, irr.rot);
+
+			//execute self-shading calculations
+			ssc_number_t beam_to_use; //some self-shading calculations require DNI, NOT ibeam (beam in POA). Need to know whether to use DNI from wf or calculated, depending on radmode
+			ssc_number_t dhi_to_use; //some self-shading calculations require DHI, NOT iskydiff (sky diff in POA). Need to know whether to use DHI from wf or calculated, depending on radmode
+			if (radmode == irrad::DN_DF || radmode == irrad::DN_GH) beam_to_use = (ssc_number_t)wf.dn;
+			else beam_to_use = Irradiance->p_IrradianceCalculated[2][stepHour * step_per_hour]; // top of hour in first year
+			if (radmode == irrad::DN_DF || radmode == irrad::GH_DF) dhi_to_use = (ssc_number_t)wf.df;
+			else dhi_to_use = Irradiance->p_IrradianceCalculated[1][stepHour * step_per_hour]; // top of hour in first year
+
+			ssoutputs ss = ssoutputs();
+			if (!ss_exec(Subarrays[nn]->selfShadingInputs, irr.stilt, irr.sazi, irr.solzen, irr.solazi, beam_to_use, dhi_to_use, ibeam, iskydiff, ignddiff, irr.alb, trackbool, linear, shad1xf, ss))
+			{
+				dc.selfShadingFailed = true;
+				return false;
+			}
+
+			dc.derateSelfShadingDiffuse = ss.m_diffuse_derate;
+			dc.derateSelfShadingReflected = ss.m_reflected_derate;
+			if (linear && trackbool) //one-axis linear
+			{
+				ibeam *= (1 - shad1xf); //derate beam irradiance linearly by the geometric shading fraction calculated above per Chris Deline 2/10/16
+				beam_shading_factor *= (1 - shad1xf);
+				dc.derateSelfShading = 1;
+				dc.derateLinear = 1 - shad1xf;
+			}
+			else if (linear) //fixed tilt linear
+			{
+				ibeam *= (1 - ss.m_shade_frac_fixed);
+				beam_shading_factor *= (1 - ss.m_shade_frac_fixed);
+				dc.derateSelfShading = 1;
+				dc.derateLinear = 1 - ss.m_shade_frac_fixed;
+			}
+			else if (trackbool && (Subarrays[nn]->backtrackingEnabled == true)) //non-linear backtracking one-axis
+			{
+				dc.derateSelfShading = 1;
+				dc.derateLinear = 1;
+			}
+			else //non-linear: fixed tilt AND one-axis true-tracking
+			{
+				// Beam is not derated- all beam derate effects (linear and non-linear) are taken into account in the nonlinear_dc_shading_derate
+				dc.nonlinearDCShadingDerate = ss.m_dc_derate;
+				dc.derateSelfShading = ss.m_dc_derate;
+				dc.derateLinear = 1;
+			}
+			// Sky diffuse and ground-reflected diffuse are derated according to C. Deline's algorithm
+			iskydiff *= ss.m_diffuse_derate;
+			ignddiff *= ss.m_reflected_derate;
+		}
+
+		dc.poaShaded = (radmode == irrad::POA_R) ? dc.ipoa : (ibeam + iskydiff + ignddiff);
+
+		// apply soiling derate to all components of irradiance
+		dc.soilingFactor = 1.0;
+		int month_idx = wf.month - 1;
+		if (month_idx >= 0 && month_idx < 12)
+		{
+			dc.soilingFactor = Subarrays[nn]->monthlySoiling[month_idx];
+			ibeam *= dc.soilingFactor;
+			iskydiff *= dc.soilingFactor;
+			ignddiff *= dc.soilingFactor;
+			if (radmode == irrad::POA_R || radmode == irrad::POA_P)
+				dc.ipoa *= dc.soilingFactor;
+			beam_shading_factor *= dc.soilingFactor;
+		}
+
+		// Calculate total front irradiation after soiling added to shading
+		dc.poaFront = ibeam + iskydiff + ignddiff;
+
+		// Calculate rear-side irradiance for bifacial modules
+		dc.poaRear = dc.poaRearAfterLosses = 0;
+		if (Subarrays[0]->Module->isBifacial)
+		{
+			dc.poaRear = irr.poaRear;
+			dc.poaRearAfterLosses = dc.poaRear * (1 - Subarrays[nn]->rearIrradianceLossPercent);
+		}
+
+		// save the required irradiance inputs on array plane for the module output calculations.
+		dc.ibeam = ibeam;
+		dc.iskydiff = iskydiff;
+		dc.ignddiff = ignddiff;
+		dc.beamShadingFactor = beam_shading_factor;
+		dc.poaTotal = (radmode == irrad::POA_R) ? dc.ipoa : (dc.poaFront + dc.poaRearAfterLosses * bifaciality);
+		return true;
+	};
+
+	// finds the operating point of the subarrays on one MPPT input at step i of the block, and their DC power after the self-shading and
+	// shading database derates. the golden-section mismatch search also tries previousV, the string voltage found at the previous time step,
+	// or nothing if it is -1. returns the string voltage found by the mismatch calculation, -1 if it did not run or the sun was down
+	auto calculateMpptInput = [&](size_t i, size_t mpptInput, double previousV, size_t &evaluations)
+	{
+		const weather_record &wf = blockWeather[i];
+		int nSubarraysOnMpptInput = (int)(PVSystem->mpptMapping[mpptInput].size()); //number of subarrays attached to this MPPT input
+		const std::vector<int> &SubarraysOnMpptInput = PVSystem->mpptMapping[mpptInput]; //vector of which subarrays are attached to this MPPT input
+
+		//initalize the pvinput structure for the module model from the irradiance on the array plane
+		auto moduleInput = [&](int nn)
+		{
+			const irradiance_step &irr = blockIrradiance[i * num_subarrays + nn];
+			const dc_step &dc = blockDC[i * num_subarrays + nn];
+			return pvinput_t(dc.ibeam, dc.iskydiff, dc.ignddiff, dc.poaRearAfterLosses, dc.poaTotal,
+				wf.tdry, wf.tdew, wf.wspd, wf.wdir, wf.pres,
+				irr.solzen, irr.aoi, hdr.elev,
+				irr.stilt, irr.sazi,
+				((double)wf.hour) + wf.minute / 60.0,
+				radmode, dc.usePOAFromWF);
+		};
+
+		//string voltage for this MPPT input- if 1 subarray, this will be the string voltage. if >1 subarray and mismatch enabled, this
+		//will be the string voltage found by the mismatch calculation. if >1 subarray and mismatch not enabled, this will be the average
+		//voltage of the strings from all the subarrays on this mppt input.
+		//initialize it as -1 and check for that later
+		double stringVoltage = -1;
+
+		//mismatch calculations assume that the inverter MPPT operates all strings on that MPPT input at the same voltage.
+		//this algorithm searches the range of string voltages, calculating total power for all strings on this MPPT input at each voltage.
+		//it finds the maximum total power of all string voltages tried, then uses that in subsequent power calculations for each subarray.
+		if (PVSystem->enableMismatchVoltageCalc)
+		{
+			double vmax = PVSystem->Inverter->mpptHiVoltage; //the upper MPPT range of the inverter is the high end for string voltages that it will control
+			double vmin = PVSystem->Inverter->mpptLowVoltage; //the lower MPPT range of the inverter is the low end for string voltages that it will control
+
+			//total power of all strings on this MPPT input at a string voltage, calculating current for each subarray
+			auto mismatchPower = [&](double stringV)
+			{
+				double P = 0; //temporary variable to store the total power on this MPPT input at this voltage
+				for (int nSubarray = 0; nSubarray < nSubarraysOnMpptInput; nSubarray++) //sweep across all subarrays connected to this MPPT input
+				{
+					int nn = SubarraysOnMpptInput[nSubarray]; //get the index of the subarray we're checking here
+					double V = stringV / (double)Subarrays[nn]->nModulesPerString; //voltage of an individual module on a string on this subarray
+
+					//initalize pvinput and pvoutput structures for the model
+					pvinput_t in = moduleInput(nn);
+					pvoutput_t out(0, 0, 0, 0, 0, 0, 0, 0);
+
+					//calculate the output power for one module in this subarray at this voltage
+					if (blockIrradiance[i * num_subarrays + nn].sunup)
+					{
+						double tcell = wf.tdry;
+						// calculate cell temperature using selected temperature model
+						(*Subarrays[nn]->Module->cellTempModel)(in, *Subarrays[nn]->Module->moduleModel, V, tcell);
+						// calculate module power output using conversion model previously specified
+						(*Subarrays[nn]->Module->moduleModel)(in, tcell, V, out);
+					}
+					//add the power from this subarray to the total power
+					P += V * out.Current * (double)Subarrays[nn]->nModulesPerString * (double)Subarrays[nn]->nStrings;
+				}
+				return P;
+			};
+
+			//with the sun down on every subarray there is no power at any voltage, and the string voltage stays unset
+			bool sunUpOnMpptInput = false;
+			for (int nSubarray = 0; nSubarray < nSubarraysOnMpptInput; nSubarray++)
+				if (blockIrradiance[i * num_subarrays + SubarraysOnMpptInput[nSubarray]].sunup) sunUpOnMpptInput = true;
+
+			double Pmax = 0; //variable to store the maximum power for comparison between different string voltages
+			if (!sunUpOnMpptInput)
+			{
+			}
+			else if (PVSystem->mismatchVoltageMethod == MISMATCH_VOLTAGE_SWEEP)
+			{
+				const int NP = 100; //number of points in between max and min voltage to sweep
+				// sweep voltage, calculating total power at each voltage
+				for (int n = 0; n < NP; n++)
+				{
+					double stringV = vmin + (vmax - vmin)*n / ((double)NP); //voltage of a string at this point in the voltage sweep
+					double P = mismatchPower(stringV);
+
+					//check if the total power at this voltage is higher than the power values we've calculated before, if so, set it as the new max
+					if (P > Pmax)
+					{
+						Pmax = P;
+						stringVoltage = stringV;
+					}
+				}
+				evaluations += NP;
+			}
+			else
+			{
+				//strings with different orientations can give the total power more than one local maximum, so a coarse sweep
+				//picks the peak to refine. the previous time step's string voltage is kept as a starting point when it beats the sweep
+				const int NC = 10; //number of intervals in the coarse sweep
+				double spacing = (vmax - vmin) / ((double)NC);
+				for (int n = 0; n <= NC; n++)
+				{
+					double stringV = vmin + (vmax - vmin)*n / ((double)NC);
+					double P = mismatchPower(stringV);
+					if (P > Pmax)
+					{
+						Pmax = P;
+						stringVoltage = stringV;
+					}
+				}
+				evaluations += NC + 1;
+
+				if (previousV > 0)
+				{
+					double P = mismatchPower(previousV);
+					evaluations++;
+					if (P > Pmax)
+					{
+						Pmax = P;
+						stringVoltage = previousV;
+					}
+				}
+
+				//narrow the string voltage down to the search tolerance within one coarse interval either side of the best voltage so far
+				if (Pmax > 0)
+				{
+					double lo = fmax(vmin, stringVoltage - spacing), hi = fmin(vmax, stringVoltage + spacing);
+					double P = 0;
+					double stringV = util::golden_section_max(mismatchPower, lo, hi, PVSystem->mismatchVoltageTolerance, P, &evaluations);
+					if (P > Pmax)
+					{
+						Pmax = P;
+						stringVoltage = stringV;
+					}
+				}
+			}
+		} //now we have the string voltage at which the MPPT input will produce max power, to be used in subsequent calcs
+
+		//now calculate power for each subarray on this mppt input. stringVoltage will still be -1 if mismatch calcs aren't enabled, or the value decided by mismatch calcs if they are enabled
+		std::vector<pvinput_t> in{ num_subarrays }; //create arrays for the pv input structures because we have to deal with them in multiple loops to check for MPPT clipping
+		double tcell = wf.tdry;
+		for (int nSubarray = 0; nSubarray < nSubarraysOnMpptInput; nSubarray++) //sweep across all subarrays connected to this MPPT input
+		{
+			int nn = SubarraysOnMpptInput[nSubarray]; //get the index of the subarray we're checking here
+			dc_step &dc = blockDC[i * num_subarrays + nn];
+			in[nn] = moduleInput(nn);
+			dc.out = pvoutput_t(0, 0, 0, 0, 0, 0, 0, 0);
+			dc.mpptVoltageClipping = 0;
+
+			if (blockIrradiance[i * num_subarrays + nn].sunup)
+			{
+				//module voltage value to be passed into module power function.
+				//if -1 is passed in, power will be calculated at max power point.
+				//if a voltage value is passed in, power will be calculated at the specified voltage for all single-diode module models
+				double module_voltage = -1;
+				if (stringVoltage != -1) module_voltage = stringVoltage / (double)Subarrays[nn]->nModulesPerString;
+				// calculate cell temperature using selected temperature model
+				// calculate module power output using conversion model previously specified
+				(*Subarrays[nn]->Module->cellTempModel)(in[nn], *Subarrays[nn]->Module->moduleModel, module_voltage, tcell);
+				(*Subarrays[nn]->Module->moduleModel)(in[nn], tcell, module_voltage, dc.out);
+			}
+		}
+
+		//assign input voltage at this MPPT input
+		//if mismatch was enabled, the voltage already was clipped to the inverter MPPT range as needed and
+		//the string voltage is the same for all subarrays, so the voltage at the MPPT input is the same as the string voltage of any subarray
+		double &mpptVoltage = blockMpptVoltage[i * PVSystem->Inverter->nMpptInputs + mpptInput];
+		if (PVSystem->enableMismatchVoltageCalc) {
+			mpptVoltage = (ssc_number_t)blockDC[i * num_subarrays + SubarraysOnMpptInput[0]].out.Voltage * Subarrays[SubarraysOnMpptInput[0]]->nModulesPerString;
+		}
+		//if mismatch wasn't enabled, we assume the MPPT input voltage is a weighted average of the string voltages on this MPPT input,
+		//and still need to check that average against the inverter MPPT bounds
+		else
+		{
+			//create temporary values to calculate the weighted average string voltage
+			double nStrings = 0;
+			double avgVoltage = 0;
+			for (int nSubarray = 0; nSubarray < nSubarraysOnMpptInput; nSubarray++)
+			{
+				int nn = SubarraysOnMpptInput[nSubarray]; //get the index of the subarray itself
+				nStrings += Subarrays[nn]->nStrings;
+				avgVoltage += blockDC[i * num_subarrays + nn].out.Voltage * Subarrays[nn]->nModulesPerString * Subarrays[nn]->nStrings;
+			}
+			avgVoltage /= nStrings;
+			mpptVoltage = avgVoltage;
+
+			//check the weighted average string voltage against the inverter MPPT bounds
+			bool recalculatePower = false;
+			if (PVSystem->clipMpptWindow)
+			{
+				if (avgVoltage < PVSystem->Inverter->mpptLowVoltage)
+				{
+					avgVoltage = PVSystem->Inverter->mpptLowVoltage;
+					recalculatePower = true;
+				}
+				else if (avgVoltage > PVSystem->Inverter->mpptHiVoltage)
+				{
+					avgVoltage = PVSystem->Inverter->mpptHiVoltage;
+					recalculatePower = true;
+				}
+
+				//if MPPT clipping occurs, we need to recalculate the module power for each subarray
+				if (recalculatePower)
+				{
+					for (int nSubarray = 0; nSubarray < nSubarraysOnMpptInput; nSubarray++) //sweep across all subarrays connected to this MPPT input
+					{
+						int nn = SubarraysOnMpptInput[nSubarray]; //get the index of the subarray we're checking here
+						dc_step &dc = blockDC[i * num_subarrays + nn];
+
+						dc.mpptVoltageClipping = dc.out.Power; //initialize the voltage clipping loss with the power at module MPP, subtract from this later for the actual MPPT clipping loss
+
+						//recalculate power at the correct voltage
+						double module_voltage = avgVoltage / (double)Subarrays[nn]->nModulesPerString;
+						(*Subarrays[nn]->Module->cellTempModel)(in[nn], *Subarrays[nn]->Module->moduleModel, module_voltage, tcell);
+						(*Subarrays[nn]->Module->moduleModel)(in[nn], tcell, module_voltage, dc.out);
+
+						dc.mpptVoltageClipping -= dc.out.Power; //subtract the power that remains after voltage clipping in order to get the total loss. if no power was lost, all the power will be subtracted away again.
+					}
+				}
+			}
+		}
+
+		for (int nSubarray = 0; nSubarray < nSubarraysOnMpptInput; nSubarray++) //sweep across all subarrays connected to this MPPT input
+		{
+			int nn = SubarraysOnMpptInput[nSubarray]; //get the index of the subarray we're checking here
+			dc_step &dc = blockDC[i * num_subarrays + nn];
+
+			//check for weird results, reported in order by the time step loop
+			dc.outVoltage = dc.out.Voltage;
+			dc.outNotFinite = !std::isfinite(dc.out.Power);
+			if (dc.outNotFinite)
+			{
+				dc.out.Power = 0;
+				dc.out.Voltage = 0;
+				dc.out.Current = 0;
+				dc.out.Efficiency = 0;
+				dc.out.CellTemp = tcell;
+			}
+
+			// DC derates for self-shading and the shading database are POWER derates, so they can't be applied before the power calculation
+			// self-shading derate (by default it is 1.0 if disbled)
+			dc.dcPowerW = dc.out.Power;
+			dc.dcPowerW *= dc.nonlinearDCShadingDerate;
+			dc.mpptVoltageClipping *= dc.nonlinearDCShadingDerate;
+
+			// Sara 1/25/16 - shading database derate applied to dc only
+			// shading loss applied to beam if not from shading database
+			dc.dcPowerW *= dc.dcShadeFactor;
+
+			// scale power and mppt voltage clipping to subarray dimensions
+			dc.dcPowerSubarray = dc.dcPowerW * Subarrays[nn]->nModulesPerString * Subarrays[nn]->nStrings;
+			dc.mpptVoltageClipping *= Subarrays[nn]->nModulesPerString* Subarrays[nn]->nStrings;
+		}
+		return stringVoltage;
+	};
+
+	// calculates the DC power of every subarray before snow for the time steps [first, last) of the current block, leaving out
+	// the mismatch search when it has to run in order. steps where a calculation failed are reported in order by the time step loop
+	auto calculateBlockDC = [&](size_t first, size_t last)
+	{
+		ShadeDB8_mpp shadeDatabase;
+		shadeDatabase.init();
+		size_t evaluations = 0;
+		for (size_t i = first; i < last; i++)
+		{
+			bool failed = false;
+			for (size_t nn = 0; nn < num_subarrays && !failed; nn++)
+			{
+				if (!Subarrays[nn]->enable
+					|| Subarrays[nn]->nStrings < 1)
+					continue; // skip disabled subarrays
+
+				if (blockIrradiance[i * num_subarrays + nn].code < 0 || !calculateSubarrayLosses(i, nn, &shadeDatabase))
+					failed = true;
+			}
+			if (failed || mismatchInOrder)
+				continue;
+
+			for (size_t mpptInput = 0; mpptInput < PVSystem->Inverter->nMpptInputs; mpptInput++) //remember that actual named mppt inputs are 1-indexed, and these are 0-indexed
+				calculateMpptInput(i, mpptInput, -1, evaluations);
+		}
+		mismatchPowerEvaluations += evaluations;
+	};
+
+	// string voltage of each MPPT input found by the mismatch calculation at the previous time step, -1 if none
+	std::vector<double> mismatchVoltage(PVSystem->Inverter->nMpptInputs, -1);
+
+	// the weather repeats every year of a lifetime simulation, so everything up to the module DC power is the same each year.
+	// later years replay the first year's results and recompute only snow, degradation and the lifetime losses.
+	// POA decomposition carries day-of-year state across years, so weather files with POA input are always recomputed
+	bool reuseFirstYear = system_use_lifetime_output && nyears > 1 && as_boolean("system_lifetime_reuse_first_year")
+		&& radmode != irrad::POA_R && radmode != irrad::POA_P;
+	std::vector<first_year_subarray_step> firstYearSteps(reuseFirstYear ? nrec * num_subarrays : 0);
+	std::vector<int> firstYearSunUp(reuseFirstYear ? nrec : 0);
+
+	perf_timer dc_timer(this, "dc_loop");
 	for (size_t iyear = 0; iyear < nyears; iyear++)
 	{
+		blockStart = blockSteps = 0;
 		for (hour = 0; hour < 8760; hour++)
 		{
-			// report progress updates to the caller	
+			// report progress updates to the caller
 			ireport++;
 			if (ireport - ireplast > irepfreq)
 			{
@@ -1085,7 +1760,7 @@ void cm_pvsamv1::exec( ) throw (compute_module::general_error)
 			for (size_t jj = 0; jj < step_per_hour; jj++)
 			{
 				// Reset dcPower calculation for new timestep
-				dcPowerNetTotalSystem = 0; 
+				dcPowerNetTotalSystem = 0;
 
 				// electric load is subhourly
 				// if no load profile supplied, load = 0
@@ -1098,10 +1773,21 @@ void cm_pvsamv1::exec( ) throw (compute_module::general_error)
 				//						iyear, hour, jj, cur_load), SSC_WARNING, (float)idx);
 				p_load_full.push_back((ssc_number_t)cur_load);
 
-				if (!wdprov->read(&Irradiance->weatherRecord))
-					throw exec_error("pvsamv1", "could not read data line " + util::to_string((int)(idx + 1)) + " in weather file");
+				size_t step = hour * step_per_hour + jj; // index of this time step within the year
+				bool replayFirstYear = reuseFirstYear && iyear > 0;
 
-				weather_record wf = Irradiance->weatherRecord;
+				// read the weather for the next block of time steps
+				bool newBlock = (step == blockStart + blockSteps);
+				if (newBlock)
+				{
+					blockStart = step;
+					blockSteps = std::min(irradianceBlockSteps, nrec - step);
+					for (size_t i = 0; i < blockSteps; i++)
+						if (!wdprov->read(&blockWeather[i]))
+							throw exec_error("pvsamv1", "could not read data line " + util::to_string((int)(idx + i + 1)) + " in weather file");
+				}
+
+				weather_record wf = blockWeather[step - blockStart];
 
 				//update POA data structure indicies if radmode is POA model is enabled
 				if (radmode == irrad::POA_R || radmode == irrad::POA_P){
@@ -1117,11 +1803,29 @@ void cm_pvsamv1::exec( ) throw (compute_module::general_error)
 
 					}
 				}
-				
+
+				if (newBlock && !replayFirstYear)
+				{
+					// split the block into more chunks than threads, so that chunks of uneven cost balance out across the threads.
+					// the self-shading model reads the irradiance calculated at the top of the hour, so all of it is done first
+					size_t nThreads = (irradianceThreads < 1) ? util::hardware_threads() : (size_t)irradianceThreads;
+					size_t nChunks = std::min(blockSteps, nThreads > 1 ? 8 * nThreads : 1);
+					util::parallel_for(nChunks, (int)nThreads, [&](size_t chunk)
+					{
+						calculateBlockIrradiance(chunk * blockSteps / nChunks, (chunk + 1) * blockSteps / nChunks, iyear == 0);
+					});
+					util::parallel_for(nChunks, (int)nThreads, [&](size_t chunk)
+					{
+						calculateBlockDC(chunk * blockSteps / nChunks, (chunk + 1) * blockSteps / nChunks);
+					});
+				}
+
 				double solazi = 0, solzen = 0, solalt = 0;
 				int sunup = 0;
+				if (replayFirstYear)
+					sunup = firstYearSunUp[step];
 
-				// accumulators for radiation power (W) over this 
+				// accumulators for radiation power (W) over this
 				// timestep from each subarray
 				double ts_accum_poa_front_nom = 0.0;
 				double ts_accum_poa_front_beam_nom = 0.0;
@@ -1149,14 +1853,20 @@ void cm_pvsamv1::exec( ) throw (compute_module::general_error)
 						|| Subarrays[nn]->nStrings < 1)
 						continue; // skip disabled subarrays
 
-					irrad irr(Irradiance->weatherRecord, Irradiance->weatherHeader,
-						Irradiance->skyModel, Irradiance->radiationMode, Subarrays[nn]->trackMode,
-						Irradiance->useWeatherFileAlbedo, Irradiance->instantaneous, Subarrays[nn]->backtrackingEnabled,
-						Irradiance->dtHour, Subarrays[nn]->tiltDegrees, Subarrays[nn]->azimuthDegrees, Subarrays[nn]->trackerRotationLimitDegrees, Subarrays[nn]->groundCoverageRatio,
-						Subarrays[nn]->monthlyTiltDegrees, Irradiance->userSpecifiedMonthlyAlbedo,
-						Subarrays[nn]->poa.poaAll.get());
-											
-					int code = irr.calc();
+					// only the irradiance used by the snow model and the DC derates is needed after the module model
+					if (replayFirstYear)
+					{
+						const first_year_subarray_step &firstYear = firstYearSteps[step * num_subarrays + nn];
+						Subarrays[nn]->poa.poaBeamFront = firstYear.poaBeamFront;
+						Subarrays[nn]->poa.poaDiffuseFront = firstYear.poaDiffuseFront;
+						Subarrays[nn]->poa.poaGroundFront = firstYear.poaGroundFront;
+						Subarrays[nn]->poa.surfaceTiltDegrees = firstYear.surfaceTiltDegrees;
+						continue;
+					}
+
+					const irradiance_step &irr = blockIrradiance[(step - blockStart) * num_subarrays + nn];
+					const dc_step &dc = blockDC[(step - blockStart) * num_subarrays + nn];
+					int code = irr.code;
 
 					if (code < 0) //jmf updated 11/30/18 so that negative numbers are errors, positive numbers are warnings, 0 is everything correct. implemented in patch for POA model only, will be added to develop for other irrad models as well
 						throw exec_error("pvsamv1",
@@ -1172,55 +1882,35 @@ void cm_pvsamv1::exec( ) throw (compute_module::general_error)
 					else if (code == 42)
 						log(util::format("SAM calculated negative global horizontal irradiance in the POA decomposition algorithm at time [y:%d m:%d d:%d h:%d], set to zero.",
 							wf.year, wf.month, wf.day, wf.hour), SSC_WARNING, (float)idx);
-									   					 
-					// p_irrad_calc is only weather file records long...
-					if (iyear == 0)
-					{
-						if (radmode == irrad::POA_R || radmode == irrad::POA_P) {
-							double gh_temp, df_temp, dn_temp;
-							gh_temp = df_temp = dn_temp = 0;
-							irr.get_irrad(&gh_temp, &dn_temp, &df_temp);
-							Irradiance->p_IrradianceCalculated[1][idx] = (ssc_number_t)df_temp;
-							Irradiance->p_IrradianceCalculated[2][idx] = (ssc_number_t)dn_temp;
-						}
-					}
+
 					// beam, skydiff, and grounddiff IN THE PLANE OF ARRAY (W/m2)
-					double ibeam, iskydiff, ignddiff;
-					double aoi, stilt, sazi, rot, btd;
-
-					// Ensure that the usePOAFromWF flag is false unless a reference cell has been used. 
-					//  This will later get forced to false if any shading has been applied (in any scenario)
-					//  also this will also be forced to false if using the cec mcsp thermal model OR if using the spe module model with a diffuse util. factor < 1.0
-					Subarrays[nn]->poa.usePOAFromWF = false;
-					if (radmode == irrad::POA_R){
-						ipoa[nn] = wf.poa;
-						Subarrays[nn]->poa.usePOAFromWF = true;
-					}
-					else if (radmode == irrad::POA_P){
+					double ibeam = irr.ibeam, iskydiff = irr.iskydiff, ignddiff = irr.ignddiff;
+					double aoi = irr.aoi, stilt = irr.stilt, sazi = irr.sazi, rot = irr.rot, btd = irr.btd;
+
+					// the POA irradiance from the weather file is used unless shading, soiling or the module models need it decomposed
+					if (radmode == irrad::POA_R || radmode == irrad::POA_P)
 						ipoa[nn] = wf.poa;
-					}
 
 					if (Subarrays[nn]->Module->simpleEfficiencyForceNoPOA && (radmode == irrad::POA_R || radmode == irrad::POA_P)){  // only will be true if using a poa model AND spe module model AND spe_fp is < 1
-						Subarrays[nn]->poa.usePOAFromWF = false;
 						if (idx == 0)
 							log("The combination of POA irradiance as in input, single point efficiency module model, and module diffuse utilization factor less than one means that SAM must use a POA decomposition model to calculate the incident diffuse irradiance", SSC_WARNING);
 					}
 
 					if (Subarrays[nn]->Module->mountingSpecificCellTemperatureForceNoPOA && (radmode == irrad::POA_R || radmode == irrad::POA_P)){
-						Subarrays[nn]->poa.usePOAFromWF = false;
 						if (idx == 0)
 							log("The combination of POA irradiance as input and heat transfer method for cell temperature means that SAM must use a POA decomposition model to calculate the beam irradiance required by the cell temperature model", SSC_WARNING);
 					}
 
 
 					// Get Incident angles and irradiances
-					irr.get_sun(&solazi, &solzen, &solalt, 0, 0, 0, &sunup, 0, 0, 0);
-					irr.get_angles(&aoi, &stilt, &sazi, &rot, &btd);
-					irr.get_poa(&ibeam, &iskydiff, &ignddiff, 0, 0, 0);
-					alb = irr.getAlbedo();
+					solazi = irr.solazi;
+					solzen = irr.solzen;
+					solalt = irr.solalt;
+					sunup = irr.sunup;
+					alb = irr.alb;
 
 					if (iyear == 0)
-						Irradiance->p_sunPositionTime[idx] = (ssc_number_t)irr.get_sunpos_calc_hour();
+						Irradiance->p_sunPositionTime[idx] = (ssc_number_t)irr.sunposHour;
 
 					// save weather file beam, diffuse, and global for output and for use later in pvsamv1- year 1 only
 					/*jmf 2016: these calculations are currently redundant with calculations in irrad.calc() because ibeam and idiff in that function are DNI and DHI, **NOT** in the plane of array
@@ -1234,41 +1924,16 @@ void cm_pvsamv1::exec( ) throw (compute_module::general_error)
 						Irradiance->p_weatherFileGHI[idx] = (ssc_number_t)(wf.gh);
 						Irradiance->p_weatherFileDHI[idx] = (ssc_number_t)(wf.df);
 
-						// calculate beam if global & diffuse are selected as inputs
-						if (radmode == irrad::GH_DF)
-						{
-							Irradiance->p_IrradianceCalculated[2][idx] = (ssc_number_t)((wf.gh - wf.df) / cos(solzen*3.1415926 / 180));
-							if (Irradiance->p_IrradianceCalculated[2][idx] < -1)
-							{
-								log(util::format("SAM calculated negative direct normal irradiance %lg W/m2 at time [y:%d m:%d d:%d h:%d], set to zero.",
-									Irradiance->p_IrradianceCalculated[2][idx], wf.year, wf.month, wf.day, wf.hour), SSC_WARNING, (float)idx);
-								Irradiance->p_IrradianceCalculated[2][idx] = 0;
-							}
-						}
-
-						// calculate global if beam & diffuse are selected as inputs
-						if (radmode == irrad::DN_DF)
-						{
-							Irradiance->p_IrradianceCalculated[0][idx] = (ssc_number_t)(wf.df + wf.dn * cos(solzen*3.1415926 / 180));
-							if (Irradiance->p_IrradianceCalculated[0][idx] < -1)
-							{
-								log(util::format("SAM calculated negative global horizontal irradiance %lg W/m2 at time [y:%d m:%d d:%d h:%d], set to zero.",
-									Irradiance->p_IrradianceCalculated[0][idx], wf.year, wf.month, wf.day, wf.hour), SSC_WARNING, (float)idx);
-								Irradiance->p_IrradianceCalculated[0][idx] = 0;
-							}
-						}
-
-						// calculate diffuse if total & beam are selected as inputs
-						if (radmode == irrad::DN_GH)
-						{
-							Irradiance->p_IrradianceCalculated[1][idx] = (ssc_number_t)(wf.gh - wf.dn * cos(solzen*3.1415926 / 180));
-							if (Irradiance->p_IrradianceCalculated[1][idx] < -1)
-							{
-								log(util::format("SAM calculated negative diffuse horizontal irradiance %lg W/m2 at time [y:%d m:%d d:%d h:%d], set to zero.",
-									Irradiance->p_IrradianceCalculated[1][idx], wf.year, wf.month, wf.day, wf.hour), SSC_WARNING, (float)idx);
-								Irradiance->p_IrradianceCalculated[1][idx] = 0;
-							}
-						}
+						// the missing component was calculated with the irradiance, and negative values were set to zero
+						if (radmode == irrad::GH_DF && irr.calculated < -1)
+							log(util::format("SAM calculated negative direct normal irradiance %lg W/m2 at time [y:%d m:%d d:%d h:%d], set to zero.",
+								irr.calculated, wf.year, wf.month, wf.day, wf.hour), SSC_WARNING, (float)idx);
+						if (radmode == irrad::DN_DF && irr.calculated < -1)
+							log(util::format("SAM calculated negative global horizontal irradiance %lg W/m2 at time [y:%d m:%d d:%d h:%d], set to zero.",
+								irr.calculated, wf.year, wf.month, wf.day, wf.hour), SSC_WARNING, (float)idx);
+						if (radmode == irrad::DN_GH && irr.calculated < -1)
+							log(util::format("SAM calculated negative diffuse horizontal irradiance %lg W/m2 at time [y:%d m:%d d:%d h:%d], set to zero.",
+								irr.calculated, wf.year, wf.month, wf.day, wf.hour), SSC_WARNING, (float)idx);
 					}
 
 					// record sub-array plane of array output before computing shading and soiling
@@ -1290,271 +1955,120 @@ void cm_pvsamv1::exec( ) throw (compute_module::general_error)
 					// record sub-array contribution to total POA beam power for this time step (W)
 					ts_accum_poa_front_beam_nom += ibeam * ref_area_m2 * Subarrays[nn]->nModulesPerString * Subarrays[nn]->nStrings;
 
-					// for non-linear shading from shading database
-					if (Subarrays[nn]->shadeCalculator.use_shade_db())
-					{
-						double shadedb_gpoa = ibeam + iskydiff + ignddiff;
-						double shadedb_dpoa = iskydiff + ignddiff;
+					// shading, self-shading and soiling were applied with the irradiance
+					if (dc.shadingFailed)
+						throw exec_error("pvsamv1", util::format("Error calculating shading factor for subarray %d", nn));
 
-						// update cell temperature - unshaded value per Sara 1/25/16
-						double tcell = wf.tdry;
-						if (sunup > 0)
-						{
-							// calculate cell temperature using selected temperature model
-							pvinput_t in(ibeam, iskydiff, ignddiff, 0, ipoa[nn],
-								wf.tdry, wf.tdew, wf.wspd, wf.wdir, wf.pres,
-								solzen, aoi, hdr.elev,
-								stilt, sazi,
-								((double)wf.hour) + wf.minute / 60.0,
-								radmode, Subarrays[nn]->poa.usePOAFromWF);
-							// voltage set to -1 for max power
-							(*Subarrays[nn]->Module->cellTempModel)(in, *Subarrays[nn]->Module->moduleModel, -1.0, tcell);
-						}
-						double shadedb_str_vmp_stc = Subarrays[nn]->nModulesPerString * Subarrays[nn]->Module->voltageMaxPower;
-						double shadedb_mppt_lo = PVSystem->Inverter->mpptLowVoltage;
-						double shadedb_mppt_hi = PVSystem->Inverter->mpptHiVoltage;
-						 
-						// shading database if necessary
-						if (!Subarrays[nn]->shadeCalculator.fbeam_shade_db(shadeDatabase, hour, solalt, solazi, jj, step_per_hour, shadedb_gpoa, shadedb_dpoa, tcell, Subarrays[nn]->nModulesPerString, shadedb_str_vmp_stc, shadedb_mppt_lo, shadedb_mppt_hi))
-						{
-							throw exec_error("pvsamv1", util::format("Error calculating shading factor for subarray %d", nn));
-						}
-						if (iyear == 0)
-						{
-#ifdef SHADE_DB_OUTPUTS
-							p_shadedb_gpoa[nn][idx] = (ssc_number_t)shadedb_gpoa;
-							p_shadedb_dpoa[nn][idx] = (ssc_number_t)shadedb_dpoa;
-							p_shadedb_pv_cell_temp[nn][idx] = (ssc_number_t)tcell;
-							p_shadedb_mods_per_str[nn][idx] = (ssc_number_t)Subarrays[nn]->nModulesPerString;
-							p_shadedb_str_vmp_stc[nn][idx] = (ssc_number_t)shadedb_str_vmp_stc;
-							p_shadedb_mppt_lo[nn][idx] = (ssc_number_t)shadedb_mppt_lo;
-							p_shadedb_mppt_hi[nn][idx] = (ssc_number_t)shadedb_mppt_hi;
-							log("shade db hour " + util::to_string((int)hour) +"\n" + shadeCalculator->get_warning());
-#endif
-							// fraction shaded for comparison
-							PVSystem->p_shadeDBShadeFraction[nn][idx] = (ssc_number_t)(Subarrays[nn]->shadeCalculator.dc_shade_factor());
-						} 
-					}
-					else
+					if (Subarrays[nn]->shadeCalculator.use_shade_db() && iyear == 0)
 					{
-						if (!Subarrays[nn]->shadeCalculator.fbeam(hour, solalt, solazi, jj, step_per_hour))
-						{
-							throw exec_error("pvsamv1", util::format("Error calculating shading factor for subarray %d", nn));
-						}
+						// fraction shaded for comparison
+						PVSystem->p_shadeDBShadeFraction[nn][idx] = (ssc_number_t)(dc.dcShadeFactor);
 					}
 
-					// apply hourly shading factors to beam (if none enabled, factors are 1.0) 
-					// shj 3/21/16 - update to handle negative shading loss
-					if (Subarrays[nn]->shadeCalculator.beam_shade_factor() != 1.0){
-						//							if (sa[nn].shad.beam_shade_factor() < 1.0){
-						// Sara 1/25/16 - shading database derate applied to dc only
-						// shading loss applied to beam if not from shading database
-						ibeam *= Subarrays[nn]->shadeCalculator.beam_shade_factor();
-						if (radmode == irrad::POA_R || radmode == irrad::POA_P){
-							Subarrays[nn]->poa.usePOAFromWF = false;
-							if (Subarrays[nn]->poa.poaShadWarningCount == 0){
-								log(util::format("Combining POA irradiance as input with the beam shading losses at time [y:%d m:%d d:%d h:%d] forces SAM to use a POA decomposition model to calculate incident beam irradiance",
-									wf.year, wf.month, wf.day, wf.hour), SSC_WARNING, (float)idx);
-							}
-							else{
-								log(util::format("Combining POA irradiance as input with the beam shading losses at time [y:%d m:%d d:%d h:%d] forces SAM to use a POA decomposition model to calculate incident beam irradiance",
-									wf.year, wf.month, wf.day, wf.hour), SSC_NOTICE, (float)idx);
-							}
-							Subarrays[nn]->poa.poaShadWarningCount++;
+					if (dc.beamShadeFactor != 1.0 && (radmode == irrad::POA_R || radmode == irrad::POA_P)){
+						if (Subarrays[nn]->poa.poaShadWarningCount == 0){
+							log(util::format("Combining POA irradiance as input with the beam shading losses at time [y:%d m:%d d:%d h:%d] forces SAM to use a POA decomposition model to calculate incident beam irradiance",
+								wf.year, wf.month, wf.day, wf.hour), SSC_WARNING, (float)idx);
 						}
-					}
-
-					// apply sky diffuse shading factor (specified as constant, nominally 1.0 if disabled in UI)
-					if (Subarrays[nn]->shadeCalculator.fdiff() < 1.0){
-						iskydiff *= Subarrays[nn]->shadeCalculator.fdiff();
-						if (radmode == irrad::POA_R || radmode == irrad::POA_P){
-							if (idx == 0)
-								log("Combining POA irradiance as input with the diffuse shading losses forces SAM to use a POA decomposition model to calculate incident diffuse irradiance", SSC_WARNING);
-							Subarrays[nn]->poa.usePOAFromWF = false;
+						else{
+							log(util::format("Combining POA irradiance as input with the beam shading losses at time [y:%d m:%d d:%d h:%d] forces SAM to use a POA decomposition model to calculate incident beam irradiance",
+								wf.year, wf.month, wf.day, wf.hour), SSC_NOTICE, (float)idx);
 						}
+						Subarrays[nn]->poa.poaShadWarningCount++;
 					}
 
-					double beam_shading_factor = Subarrays[nn]->shadeCalculator.beam_shade_factor();
+					if (Subarrays[nn]->shadeCalculator.fdiff() < 1.0 && (radmode == irrad::POA_R || radmode == irrad::POA_P)){
+						if (idx == 0)
+							log("Combining POA irradiance as input with the diffuse shading losses forces SAM to use a POA decomposition model to calculate incident diffuse irradiance", SSC_WARNING);
+					}
 
-					//self-shading calculations
 					if (((Subarrays[nn]->trackMode == 0 || Subarrays[nn]->trackMode == 4) && (Subarrays[nn]->shadeMode == 1 || Subarrays[nn]->shadeMode == 2)) //fixed tilt or timeseries tilt, self-shading (linear or non-linear) OR
 						|| (Subarrays[nn]->trackMode == 1 && (Subarrays[nn]->shadeMode == 1 || Subarrays[nn]->shadeMode == 2))) //one-axis tracking, self-shading (linear or non-linear)
 					{
-
 						if (radmode == irrad::POA_R || radmode == irrad::POA_P){
 							if (idx == 0)
 								log("Combining POA irradiance as input with self shading forces SAM to employ a POA decomposition model to calculate incident beam irradiance", SSC_WARNING);
-							Subarrays[nn]->poa.usePOAFromWF = false;
 						}
 
-						// info to be passed to self-shading function
-						bool trackbool = (Subarrays[nn]->trackMode == 1);	// 0 for fixed tilt and timeseries tilt, 1 for one-axis
-						bool linear = (Subarrays[nn]->shadeMode == 2); //0 for full self-shading, 1 for linear self-shading
-
-						//geometric fraction of the array that is shaded for one-axis trackers.
-						//USES A DIFFERENT FUNCTION THAN THE SELF-SHADING BECAUSE SS IS MEANT FOR FIXED ONLY. shadeFraction1x IS FOR TRUE-TRACKING ONE-AXIS TRACKERS ONLY.
-						//used in the non-linear self-shading calculator for one-axis tracking only
-						double shad1xf = 0.0;
-						if (trackbool && (Subarrays[nn]->backtrackingEnabled == false))
-						    shad1xf = shadeFraction1x(solazi, solzen, Subarrays[nn]->tiltDegrees, Subarrays[nn]->azimuthDegrees, Subarrays[nn]->groundCoverageRatio, rot);
-
-						//execute self-shading calculations
-						ssc_number_t beam_to_use; //some self-shading calculations require DNI, NOT ibeam (beam in POA). Need to know whether to use DNI from wf or calculated, depending on radmode
-						ssc_number_t dhi_to_use; //some self-shading calculations require DHI, NOT iskydiff (sky diff in POA). Need to know whether to use DHI from wf or calculated, depending on radmode
-						if (radmode == irrad::DN_DF || radmode == irrad::DN_GH) beam_to_use = (ssc_number_t)wf.dn;
-						else beam_to_use = Irradiance->p_IrradianceCalculated[2][hour * step_per_hour]; // top of hour in first year
-						if (radmode == irrad::DN_DF || radmode == irrad::GH_DF) dhi_to_use = (ssc_number_t)wf.df;
-						else dhi_to_use = Irradiance->p_IrradianceCalculated[1][hour * step_per_hour]; // top of hour in first year
-
-						if (ss_exec(Subarrays[nn]->selfShadingInputs, stilt, sazi, solzen, solazi, beam_to_use, dhi_to_use, ibeam, iskydiff, ignddiff, alb, trackbool, linear, shad1xf, Subarrays[nn]->selfShadingOutputs))
-						{
+						if (dc.selfShadingFailed)
+							throw exec_error("pvsamv1", util::format("Self-shading calculation failed at %d", (int)idx));
 
-						    if (linear && trackbool) //one-axis linear
-						    {
-                                ibeam *= (1 - shad1xf); //derate beam irradiance linearly by the geometric shading fraction calculated above per Chris Deline 2/10/16
-                                beam_shading_factor *= (1 - shad1xf);
-                                // Sky diffuse and ground-reflected diffuse are derated according to C. Deline's algorithm
-                                iskydiff *= Subarrays[nn]->selfShadingOutputs.m_diffuse_derate;
-                                ignddiff *= Subarrays[nn]->selfShadingOutputs.m_reflected_derate;
-
-                                if (iyear == 0)
-                                {
-                                    PVSystem->p_derateSelfShading[nn][idx] = (ssc_number_t)1;
-                                    PVSystem->p_derateLinear[nn][idx] = (ssc_number_t)(1 - shad1xf);
-                                    PVSystem->p_derateSelfShadingDiffuse[nn][idx] = (ssc_number_t)Subarrays[nn]->selfShadingOutputs.m_diffuse_derate;
-                                    PVSystem->p_derateSelfShadingReflected[nn][idx] = (ssc_number_t)Subarrays[nn]->selfShadingOutputs.m_reflected_derate;
-                                }
-                            }
-
-						    else if (linear) //fixed tilt linear
-							{
-								ibeam *= (1 - Subarrays[nn]->selfShadingOutputs.m_shade_frac_fixed);
-								beam_shading_factor *= (1 - Subarrays[nn]->selfShadingOutputs.m_shade_frac_fixed);
-								iskydiff *= Subarrays[nn]->selfShadingOutputs.m_diffuse_derate;
-                                ignddiff *= Subarrays[nn]->selfShadingOutputs.m_reflected_derate;
-
-								if (iyear == 0)
-								{
-									PVSystem->p_derateSelfShading[nn][idx] = (ssc_number_t)1;
-									PVSystem->p_derateLinear[nn][idx] = (ssc_number_t)(1 - Subarrays[nn]->selfShadingOutputs.m_shade_frac_fixed);
-									PVSystem->p_derateSelfShadingDiffuse[nn][idx] = (ssc_number_t)Subarrays[nn]->selfShadingOutputs.m_diffuse_derate;
-								    PVSystem->p_derateSelfShadingReflected[nn][idx] = (ssc_number_t)Subarrays[nn]->selfShadingOutputs.m_reflected_derate;
-								}
-							}
-
-							else if (trackbool && (Subarrays[nn]->backtrackingEnabled == true)) //non-linear backtracking one-axis
-							{
-							    iskydiff *= Subarrays[nn]->selfShadingOutputs.m_diffuse_derate;
-								ignddiff *= Subarrays[nn]->selfShadingOutputs.m_reflected_derate;
-
-								if (iyear == 0)
-								{
-									PVSystem->p_derateSelfShading[nn][idx] = (ssc_number_t)1;
-                                    PVSystem->p_derateLinear[nn][idx] = (ssc_number_t)1;
-									PVSystem->p_derateSelfShadingDiffuse[nn][idx] = (ssc_number_t)Subarrays[nn]->selfShadingOutputs.m_diffuse_derate;
-									PVSystem->p_derateSelfShadingReflected[nn][idx] = (ssc_number_t)Subarrays[nn]->selfShadingOutputs.m_reflected_derate;
-								}
-							}
-
-							else //non-linear: fixed tilt AND one-axis true-tracking
-							{
-                                // Beam is not derated- all beam derate effects (linear and non-linear) are taken into account in the nonlinear_dc_shading_derate
-								Subarrays[nn]->poa.nonlinearDCShadingDerate = Subarrays[nn]->selfShadingOutputs.m_dc_derate;
-
-								iskydiff *= Subarrays[nn]->selfShadingOutputs.m_diffuse_derate;
-								ignddiff *= Subarrays[nn]->selfShadingOutputs.m_reflected_derate;
-
-								if (iyear == 0)
-								{
-									PVSystem->p_derateSelfShadingDiffuse[nn][idx] = (ssc_number_t)Subarrays[nn]->selfShadingOutputs.m_diffuse_derate;
-									PVSystem->p_derateSelfShadingReflected[nn][idx] = (ssc_number_t)Subarrays[nn]->selfShadingOutputs.m_reflected_derate;
-									PVSystem->p_derateSelfShading[nn][idx] = (ssc_number_t)Subarrays[nn]->selfShadingOutputs.m_dc_derate;
-									PVSystem->p_derateLinear[nn][idx] = (ssc_number_t)1;
-								}
-							}
+						if (iyear == 0)
+						{
+							PVSystem->p_derateSelfShading[nn][idx] = (ssc_number_t)dc.derateSelfShading;
+							PVSystem->p_derateLinear[nn][idx] = (ssc_number_t)dc.derateLinear;
+							PVSystem->p_derateSelfShadingDiffuse[nn][idx] = (ssc_number_t)dc.derateSelfShadingDiffuse;
+							PVSystem->p_derateSelfShadingReflected[nn][idx] = (ssc_number_t)dc.derateSelfShadingReflected;
 						}
-						else
-							throw exec_error("pvsamv1", util::format("Self-shading calculation failed at %d", (int)idx));
 					}
 
-					double poashad = (radmode == irrad::POA_R) ? ipoa[nn] : (ibeam + iskydiff + ignddiff);
-
 					// determine sub-array contribution to total shaded plane of array for this hour
-					ts_accum_poa_front_shaded += poashad * ref_area_m2 * Subarrays[nn]->nModulesPerString * Subarrays[nn]->nStrings;
+					ts_accum_poa_front_shaded += dc.poaShaded * ref_area_m2 * Subarrays[nn]->nModulesPerString * Subarrays[nn]->nStrings;
 
-					// apply soiling derate to all components of irradiance
-					double soiling_factor = 1.0;
-					int month_idx = wf.month - 1;
-					if (month_idx >= 0 && month_idx < 12)
-					{
-						soiling_factor = Subarrays[nn]->monthlySoiling[month_idx];
-						ibeam *= soiling_factor;
-						iskydiff *= soiling_factor;
-						ignddiff *= soiling_factor;
-						if (radmode == irrad::POA_R || radmode == irrad::POA_P){
-							ipoa[nn] *= soiling_factor;
-							if (soiling_factor < 1 && idx == 0)
-								log("Soiling may already be accounted for in the input POA data. Please confirm that the input data does not contain soiling effects, or remove the additional losses on the Losses page.", SSC_WARNING);
-						}
-						beam_shading_factor *= soiling_factor;
+					if (radmode == irrad::POA_R || radmode == irrad::POA_P){
+						ipoa[nn] = dc.ipoa;
+						if (dc.soilingFactor < 1 && idx == 0)
+							log("Soiling may already be accounted for in the input POA data. Please confirm that the input data does not contain soiling effects, or remove the additional losses on the Losses page.", SSC_WARNING);
 					}
 
 					// Calculate total front irradiation after soiling added to shading
-					ipoa_front[nn] = ibeam + iskydiff + ignddiff;
+					ipoa_front[nn] = dc.poaFront;
 					ts_accum_poa_front_shaded_soiled += ipoa_front[nn] * ref_area_m2 * Subarrays[nn]->nModulesPerString * Subarrays[nn]->nStrings;
-					
-					// Calculate rear-side irradiance for bifacial modules
+
+					// rear-side irradiance for bifacial modules
 					if (Subarrays[0]->Module->isBifacial)
 					{
-						bifaciality = Subarrays[0]->Module->bifaciality;
-						double slopeLength = Subarrays[nn]->selfShadingInputs.length * Subarrays[nn]->selfShadingInputs.nmody;
-						if (Subarrays[nn]->selfShadingInputs.mod_orient == 1) {
-							slopeLength = Subarrays[nn]->selfShadingInputs.width * Subarrays[nn]->selfShadingInputs.nmody;
-						}
-						irr.calc_rear_side(Subarrays[0]->Module->bifacialTransmissionFactor, Subarrays[0]->Module->groundClearanceHeight, slopeLength);
-						ipoa_rear[nn] = irr.get_poa_rear();
-						ipoa_rear_after_losses[nn] = ipoa_rear[nn] * (1 - Subarrays[nn]->rearIrradianceLossPercent);
+						ipoa_rear[nn] = dc.poaRear;
+						ipoa_rear_after_losses[nn] = dc.poaRearAfterLosses;
 					}
 
 					ts_accum_poa_rear += ipoa_rear[nn] * ref_area_m2 * Subarrays[nn]->nModulesPerString * Subarrays[nn]->nStrings;
 					ts_accum_poa_rear_after_losses = ts_accum_poa_rear * (1 - Subarrays[nn]->rearIrradianceLossPercent);
 
-					if (iyear == 0) 
+					if (iyear == 0)
 					{
-						// save sub-array level outputs			
-						PVSystem->p_poaShadedFront[nn][idx] = (ssc_number_t)poashad;
+						// save sub-array level outputs
+						PVSystem->p_poaShadedFront[nn][idx] = (ssc_number_t)dc.poaShaded;
 						PVSystem->p_poaShadedSoiledFront[nn][idx] = (ssc_number_t)ipoa_front[nn];
-						PVSystem->p_poaBeamFront[nn][idx] = (ssc_number_t)ibeam;
-						PVSystem->p_poaDiffuseFront[nn][idx] = (ssc_number_t)(iskydiff + ignddiff);
+						PVSystem->p_poaBeamFront[nn][idx] = (ssc_number_t)dc.ibeam;
+						PVSystem->p_poaDiffuseFront[nn][idx] = (ssc_number_t)(dc.iskydiff + dc.ignddiff);
 						PVSystem->p_poaRear[nn][idx] = (ssc_number_t)(ipoa_rear_after_losses[nn]);
-						PVSystem->p_beamShadingFactor[nn][idx] = (ssc_number_t)beam_shading_factor;
+						PVSystem->p_beamShadingFactor[nn][idx] = (ssc_number_t)dc.beamShadingFactor;
 						PVSystem->p_axisRotation[nn][idx] = (ssc_number_t)rot;
 						PVSystem->p_idealRotation[nn][idx] = (ssc_number_t)(rot - btd);
 						PVSystem->p_angleOfIncidence[nn][idx] = (ssc_number_t)aoi;
 						PVSystem->p_surfaceTilt[nn][idx] = (ssc_number_t)stilt;
 						PVSystem->p_surfaceAzimuth[nn][idx] = (ssc_number_t)sazi;
-						PVSystem->p_derateSoiling[nn][idx] = (ssc_number_t)soiling_factor;
+						PVSystem->p_derateSoiling[nn][idx] = (ssc_number_t)dc.soilingFactor;
 					}
 
 					// accumulate incident total radiation (W) in this timestep (all subarrays)
-					ts_accum_poa_front_beam_eff += ibeam * ref_area_m2 * Subarrays[nn]->nModulesPerString * Subarrays[nn]->nStrings;
+					ts_accum_poa_front_beam_eff += dc.ibeam * ref_area_m2 * Subarrays[nn]->nModulesPerString * Subarrays[nn]->nStrings;
 
-					// save the required irradiance inputs on array plane for the module output calculations.
-					Subarrays[nn]->poa.poaBeamFront = ibeam;
-					Subarrays[nn]->poa.poaDiffuseFront = iskydiff;
-					Subarrays[nn]->poa.poaGroundFront = ignddiff;
+					// save the irradiance on array plane used by the snow model
+					Subarrays[nn]->poa.poaBeamFront = dc.ibeam;
+					Subarrays[nn]->poa.poaDiffuseFront = dc.iskydiff;
+					Subarrays[nn]->poa.poaGroundFront = dc.ignddiff;
 					Subarrays[nn]->poa.poaRear = ipoa_rear_after_losses[nn];
-					Subarrays[nn]->poa.poaTotal = (radmode == irrad::POA_R) ? ipoa[nn] :(ipoa_front[nn] + ipoa_rear_after_losses[nn] * bifaciality);
+					Subarrays[nn]->poa.poaTotal = dc.poaTotal;
 					Subarrays[nn]->poa.angleOfIncidenceDegrees = aoi;
 					Subarrays[nn]->poa.sunUp = sunup;
 					Subarrays[nn]->poa.surfaceTiltDegrees = stilt;
 					Subarrays[nn]->poa.surfaceAzimuthDegrees = sazi;
-				}
+					Subarrays[nn]->poa.usePOAFromWF = dc.usePOAFromWF;
+					Subarrays[nn]->poa.nonlinearDCShadingDerate = dc.nonlinearDCShadingDerate;
 
-				std::vector<double> mpptVoltageClipping; //a vector to store power that is clipped due to the inverter MPPT low & high voltage limits for each subarray
-				for (size_t nn = 0; nn < PVSystem->numberOfSubarrays; nn++) {
-					mpptVoltageClipping.push_back(0.0);
+					if (reuseFirstYear)
+					{
+						first_year_subarray_step &firstYear = firstYearSteps[step * num_subarrays + nn];
+						firstYear.poaBeamFront = dc.ibeam;
+						firstYear.poaDiffuseFront = dc.iskydiff;
+						firstYear.poaGroundFront = dc.ignddiff;
+						firstYear.surfaceTiltDegrees = stilt;
+					}
 				}
+				if (reuseFirstYear && iyear == 0)
+					firstYearSunUp[step] = sunup;
 
 				//Calculate power of each MPPT input
 				for (size_t mpptInput = 0; mpptInput < PVSystem->Inverter->nMpptInputs; mpptInput++) //remember that actual named mppt inputs are 1-indexed, and these are 0-indexed
@@ -1562,190 +2076,68 @@ void cm_pvsamv1::exec( ) throw (compute_module::general_error)
 					int nSubarraysOnMpptInput = (int)(PVSystem->mpptMapping[mpptInput].size()); //number of subarrays attached to this MPPT input
 					std::vector<int> SubarraysOnMpptInput = PVSystem->mpptMapping[mpptInput]; //vector of which subarrays are attached to this MPPT input
 
-					//string voltage for this MPPT input- if 1 subarray, this will be the string voltage. if >1 subarray and mismatch enabled, this
-					//will be the string voltage found by the mismatch calculation. if >1 subarray and mismatch not enabled, this will be the average
-					//voltage of the strings from all the subarrays on this mppt input.
-					//initialize it as -1 and check for that later
-					double stringVoltage = -1;
-
-					//mismatch calculations assume that the inverter MPPT operates all strings on that MPPT input at the same voltage.
-					//this algorithm sweeps across a range of string voltages, calculating total power for all strings on this MPPT input at each voltage.
-					//it finds the maximum total power of all string voltages swept, then uses that in subsequent power calculations for each subarray. 
-					if (PVSystem->enableMismatchVoltageCalc)
+					//the module operating point was found in the first year, including the mismatch and MPPT clipping calculations
+					if (replayFirstYear)
 					{
-						double vmax = PVSystem->Inverter->mpptHiVoltage; //the upper MPPT range of the inverter is the high end for string voltages that it will control
-						double vmin = PVSystem->Inverter->mpptLowVoltage; //the lower MPPT range of the inverter is the low end for string voltages that it will control
-						const int NP = 100; //number of points in between max and min voltage to sweep
-						double Pmax = 0; //variable to store the maximum power for comparison between different points along the voltage sweep
-						// sweep voltage, calculating current for each subarray, add all subarray currents together at each voltage
-						for (int i = 0; i < NP; i++)
-						{
-							double stringV = vmin + (vmax - vmin)*i / ((double)NP); //voltage of a string at this point in the voltage sweep							
-
-							//if the voltage is ok, continue to calculate total power on this MPPT input at this voltage
-							double P = 0; //temporary variable to store the total power on this MPPT input at this voltage
-							for (int nSubarray = 0; nSubarray < nSubarraysOnMpptInput; nSubarray++) //sweep across all subarrays connected to this MPPT input
-							{
-								int nn = SubarraysOnMpptInput[nSubarray]; //get the index of the subarray we're checking here
-								double V = stringV / (double)Subarrays[nn]->nModulesPerString; //voltage of an individual module on a string on this subarray
-
-								//initalize pvinput and pvoutput structures for the model
-								pvinput_t in(Subarrays[nn]->poa.poaBeamFront, Subarrays[nn]->poa.poaDiffuseFront, Subarrays[nn]->poa.poaGroundFront, Subarrays[nn]->poa.poaRear, Subarrays[nn]->poa.poaTotal,
-									wf.tdry, wf.tdew, wf.wspd, wf.wdir, wf.pres,
-									solzen, Subarrays[nn]->poa.angleOfIncidenceDegrees, hdr.elev,
-									Subarrays[nn]->poa.surfaceTiltDegrees, Subarrays[nn]->poa.surfaceAzimuthDegrees,
-									((double)wf.hour) + wf.minute / 60.0,
-									radmode, Subarrays[nn]->poa.usePOAFromWF);
-								pvoutput_t out(0, 0, 0, 0, 0, 0, 0, 0);
-
-								//calculate the output power for one module in this subarray at this voltage
-								if (Subarrays[nn]->poa.sunUp)
-								{
-									double tcell = wf.tdry;
-									// calculate cell temperature using selected temperature model
-									(*Subarrays[nn]->Module->cellTempModel)(in, *Subarrays[nn]->Module->moduleModel, V, tcell);
-									// calculate module power output using conversion model previously specified
-									(*Subarrays[nn]->Module->moduleModel)(in, tcell, V, out);
-								}
-								//add the power from this subarray to the total power
-								P += V * out.Current * (double)Subarrays[nn]->nModulesPerString * (double)Subarrays[nn]->nStrings;
-							}
-
-							//check if the total power at this voltage is higher than the power values we've calculated before, if so, set it as the new max
-							if (P > Pmax)
-							{
-								Pmax = P;
-								stringVoltage = stringV;
-							}
-						}
-
-					} //now we have the string voltage at which the MPPT input will produce max power, to be used in subsequent calcs
-
-					//now calculate power for each subarray on this mppt input. stringVoltage will still be -1 if mismatch calcs aren't enabled, or the value decided by mismatch calcs if they are enabled
-					std::vector<pvinput_t> in{ num_subarrays }; //create arrays for the pv input and output structures because we have to deal with them in multiple loops to check for MPPT clipping
-					std::vector<pvoutput_t> out{ num_subarrays };
-					double tcell = wf.tdry;
-					for (int nSubarray = 0; nSubarray < nSubarraysOnMpptInput; nSubarray++) //sweep across all subarrays connected to this MPPT input
-					{
-						int nn = SubarraysOnMpptInput[nSubarray]; //get the index of the subarray we're checking here
-						//initalize pvinput and pvoutput structures for the model
-						pvinput_t in_temp(Subarrays[nn]->poa.poaBeamFront, Subarrays[nn]->poa.poaDiffuseFront, Subarrays[nn]->poa.poaGroundFront, Subarrays[nn]->poa.poaRear, Subarrays[nn]->poa.poaTotal,
-							wf.tdry, wf.tdew, wf.wspd, wf.wdir, wf.pres,
-							solzen, Subarrays[nn]->poa.angleOfIncidenceDegrees, hdr.elev,
-							Subarrays[nn]->poa.surfaceTiltDegrees, Subarrays[nn]->poa.surfaceAzimuthDegrees,
-							((double)wf.hour) + wf.minute / 60.0,
-							radmode, Subarrays[nn]->poa.usePOAFromWF);
-						pvoutput_t out_temp(0, 0, 0, 0, 0, 0, 0, 0);
-						in[nn] = in_temp;
-						out[nn] = out_temp;					
-						
-						if (Subarrays[nn]->poa.sunUp)
+						PVSystem->p_mpptVoltage[mpptInput][idx] = PVSystem->p_mpptVoltage[mpptInput][step];
+						for (int nSubarray = 0; nSubarray < nSubarraysOnMpptInput; nSubarray++)
 						{
-							//module voltage value to be passed into module power function. 
-							//if -1 is passed in, power will be calculated at max power point. 
-							//if a voltage value is passed in, power will be calculated at the specified voltage for all single-diode module models
-							double module_voltage = -1;
-							if (stringVoltage != -1) module_voltage = stringVoltage / (double)Subarrays[nn]->nModulesPerString;
-							// calculate cell temperature using selected temperature model
-							// calculate module power output using conversion model previously specified
-							(*Subarrays[nn]->Module->cellTempModel)(in[nn], *Subarrays[nn]->Module->moduleModel, module_voltage, tcell);
-							(*Subarrays[nn]->Module->moduleModel)(in[nn], tcell, module_voltage, out[nn]);
+							int nn = SubarraysOnMpptInput[nSubarray];
+							const first_year_subarray_step &firstYear = firstYearSteps[step * num_subarrays + nn];
+							Subarrays[nn]->Module->dcPowerW = firstYear.dcPowerW;
+							Subarrays[nn]->Module->dcVoltage = firstYear.dcVoltage;
+							Subarrays[nn]->dcPowerSubarray = firstYear.dcPowerSubarray;
+							dcStringVoltage[nn].push_back(Subarrays[nn]->Module->dcVoltage * Subarrays[nn]->nModulesPerString);
 						}
+						continue;
 					}
 
-					//assign input voltage at this MPPT input
-					//if mismatch was enabled, the voltage already was clipped to the inverter MPPT range as needed and  
-					//the string voltage is the same for all subarrays, so the voltage at the MPPT input is the same as the string voltage of any subarray
-					if (PVSystem->enableMismatchVoltageCalc) {
-						PVSystem->p_mpptVoltage[mpptInput][idx] = (ssc_number_t)out[SubarraysOnMpptInput[0]].Voltage * Subarrays[SubarraysOnMpptInput[0]]->nModulesPerString;
-					}
-					//if mismatch wasn't enabled, we assume the MPPT input voltage is a weighted average of the string voltages on this MPPT input,
-					//and still need to check that average against the inverter MPPT bounds
-					else
+					//the golden-section mismatch search starts from the string voltage found at the previous time step
+					if (mismatchInOrder)
 					{
-						//create temporary values to calculate the weighted average string voltage
-						double nStrings = 0;
-						double avgVoltage = 0;
-						for (int nSubarray = 0; nSubarray < nSubarraysOnMpptInput; nSubarray++)
-						{
-							int nn = SubarraysOnMpptInput[nSubarray]; //get the index of the subarray itself
-							nStrings += Subarrays[nn]->nStrings;
-							avgVoltage += out[nn].Voltage * Subarrays[nn]->nModulesPerString * Subarrays[nn]->nStrings;
-						}
-						avgVoltage /= nStrings;
-						PVSystem->p_mpptVoltage[mpptInput][idx] = (ssc_number_t)avgVoltage;
-
-						//check the weighted average string voltage against the inverter MPPT bounds
-						bool recalculatePower = false;
-						if (PVSystem->clipMpptWindow)
-						{
-							if (avgVoltage < PVSystem->Inverter->mpptLowVoltage)
-							{
-								avgVoltage = PVSystem->Inverter->mpptLowVoltage;
-								recalculatePower = true;
-							}
-							else if (avgVoltage > PVSystem->Inverter->mpptHiVoltage)
-							{
-								avgVoltage = PVSystem->Inverter->mpptHiVoltage;
-								recalculatePower = true;
-							}
-							
-							//if MPPT clipping occurs, we need to recalculate the module power for each subarray
-							if (recalculatePower)
-							{
-								for (int nSubarray = 0; nSubarray < nSubarraysOnMpptInput; nSubarray++) //sweep across all subarrays connected to this MPPT input
-								{
-									int nn = SubarraysOnMpptInput[nSubarray]; //get the index of the subarray we're checking here
-
-									if (iyear == 0) mpptVoltageClipping[nn] = out[nn].Power; //initialize the voltage clipping loss with the power at module MPP, subtract from this later for the actual MPPT clipping loss
-
-									//recalculate power at the correct voltage
-									double module_voltage = avgVoltage / (double)Subarrays[nn]->nModulesPerString;
-									(*Subarrays[nn]->Module->cellTempModel)(in[nn], *Subarrays[nn]->Module->moduleModel, module_voltage, tcell);
-									(*Subarrays[nn]->Module->moduleModel)(in[nn], tcell, module_voltage, out[nn]);
-
-									if (iyear == 0)	mpptVoltageClipping[nn] -= out[nn].Power; //subtract the power that remains after voltage clipping in order to get the total loss. if no power was lost, all the power will be subtracted away again.
-								}
-							}
-						}
+						size_t evaluations = 0;
+						mismatchVoltage[mpptInput] = calculateMpptInput(step - blockStart, mpptInput, mismatchVoltage[mpptInput], evaluations);
+						mismatchPowerEvaluations += evaluations;
 					}
+					PVSystem->p_mpptVoltage[mpptInput][idx] = (ssc_number_t)blockMpptVoltage[(step - blockStart) * PVSystem->Inverter->nMpptInputs + mpptInput];
 
-					//now that we have the correct power for all subarrays, subject to inverter MPPT clipping, save outputs 
+					//now that we have the correct power for all subarrays, subject to inverter MPPT clipping, save outputs
 					for (int nSubarray = 0; nSubarray < nSubarraysOnMpptInput; nSubarray++) //sweep across all subarrays connected to this MPPT input
 					{
 						int nn = SubarraysOnMpptInput[nSubarray]; //get the index of the subarray we're checking here
+						const dc_step &dc = blockDC[(step - blockStart) * num_subarrays + nn];
 
 						//check for weird results
-						if (out[nn].Voltage > Subarrays[nn]->Module->moduleModel->VocRef()*1.3)
-							log(util::format("Module voltage is unrealistically high (exceeds 1.3*VocRef) at [mdhm: %d %d %d %lg]: %lg V\n", wf.month, wf.day, wf.hour, wf.minute, out[nn].Voltage), SSC_NOTICE);
-						if (!std::isfinite(out[nn].Power))
-						{
-							out[nn].Power = 0;
-							out[nn].Voltage = 0;
-							out[nn].Current = 0;
-							out[nn].Efficiency = 0;
-							out[nn].CellTemp = tcell;
+						if (dc.outVoltage > Subarrays[nn]->Module->moduleModel->VocRef()*1.3)
+							log(util::format("Module voltage is unrealistically high (exceeds 1.3*VocRef) at [mdhm: %d %d %d %lg]: %lg V\n", wf.month, wf.day, wf.hour, wf.minute, dc.outVoltage), SSC_NOTICE);
+						if (dc.outNotFinite)
 							log(util::format("Non-finite power output calculated at [mdhm: %d %d %d %lg], set to zero.\n"
 								"could be due to anomolous equation behavior at very low irradiances (poa: %lg W/m2)",
-								wf.month, wf.day, wf.hour, wf.minute, Subarrays[nn]->poa.poaTotal), SSC_NOTICE);
+								wf.month, wf.day, wf.hour, wf.minute, dc.poaTotal), SSC_NOTICE);
+
+						// save DC module outputs for this subarray, after the self-shading and shading database derates
+						Subarrays[nn]->Module->dcPowerW = dc.dcPowerW;
+						Subarrays[nn]->Module->dcEfficiency = dc.out.Efficiency * 100;
+						Subarrays[nn]->Module->dcVoltage = dc.out.Voltage;
+						Subarrays[nn]->Module->temperatureCellCelcius = dc.out.CellTemp;
+						Subarrays[nn]->Module->currentShortCircuit = dc.out.Isc_oper;
+						Subarrays[nn]->Module->voltageOpenCircuit = dc.out.Voc_oper;
+						Subarrays[nn]->Module->angleOfIncidenceModifier = dc.out.AOIModifier;
+						Subarrays[nn]->dcPowerSubarray = dc.dcPowerSubarray;
+						if (reuseFirstYear)
+						{
+							firstYearSteps[step * num_subarrays + nn].dcPowerW = Subarrays[nn]->Module->dcPowerW;
+							firstYearSteps[step * num_subarrays + nn].dcVoltage = Subarrays[nn]->Module->dcVoltage;
+							firstYearSteps[step * num_subarrays + nn].dcPowerSubarray = Subarrays[nn]->dcPowerSubarray;
 						}
 
-						// save DC module outputs for this subarray
-						Subarrays[nn]->Module->dcPowerW = out[nn].Power;
-						Subarrays[nn]->Module->dcEfficiency = out[nn].Efficiency * 100;
-						Subarrays[nn]->Module->dcVoltage = out[nn].Voltage;
-						Subarrays[nn]->Module->temperatureCellCelcius = out[nn].CellTemp;
-						Subarrays[nn]->Module->currentShortCircuit = out[nn].Isc_oper;
-						Subarrays[nn]->Module->voltageOpenCircuit = out[nn].Voc_oper;
-						Subarrays[nn]->Module->angleOfIncidenceModifier = out[nn].AOIModifier;
-						
 						// Lifetime dcStringVoltage
 						dcStringVoltage[nn].push_back(Subarrays[nn]->Module->dcVoltage * Subarrays[nn]->nModulesPerString);
 
 						// Output front-side irradiance after the reflection (IAM) loss - needs to be after the module model for now because reflection effects are part of the module model
 						if (iyear == 0)
 						{
-							ipoa_front[nn] *= out[nn].AOIModifier;
+							ipoa_front[nn] *= dc.out.AOIModifier;
 							PVSystem->p_poaFront[nn][idx] = (radmode == irrad::POA_R) ? (ssc_number_t)ipoa[nn] : (ssc_number_t)(ipoa_front[nn]);
 							PVSystem->p_poaTotal[nn][idx] = (radmode == irrad::POA_R) ? (ssc_number_t)ipoa[nn] : (ssc_number_t)(ipoa_front[nn] + ipoa_rear_after_losses[nn] * bifaciality);
 
@@ -1760,22 +2152,11 @@ void cm_pvsamv1::exec( ) throw (compute_module::general_error)
 
 				// sum up all DC power from the whole array
 				PVSystem->p_systemDCPower[idx] = 0;
+				std::vector<double> mpptVoltageClipping(num_subarrays, 0.0); //power that is clipped due to the inverter MPPT low & high voltage limits for each subarray, first year only
 				for (size_t nn = 0; nn < num_subarrays; nn++)
 				{
-					// DC derates for snow and shading must be applied first
-					// these can't be applied before the power calculation because they are POWER derates
-
-					// self-shading derate (by default it is 1.0 if disbled)
-					Subarrays[nn]->Module->dcPowerW *= Subarrays[nn]->poa.nonlinearDCShadingDerate;
-					if (iyear == 0) mpptVoltageClipping[nn] *= Subarrays[nn]->poa.nonlinearDCShadingDerate;
-
-					// Sara 1/25/16 - shading database derate applied to dc only
-					// shading loss applied to beam if not from shading database
-					Subarrays[nn]->Module->dcPowerW *= Subarrays[nn]->shadeCalculator.dc_shade_factor();
-
-					// scale power and mppt voltage clipping to subarray dimensions
-					Subarrays[nn]->dcPowerSubarray = Subarrays[nn]->Module->dcPowerW * Subarrays[nn]->nModulesPerString * Subarrays[nn]->nStrings;
-					if (iyear == 0) mpptVoltageClipping[nn] *= Subarrays[nn]->nModulesPerString* Subarrays[nn]->nStrings;
+					// the self-shading and shading database DC derates were applied with the module model
+					if (iyear == 0) mpptVoltageClipping[nn] = blockDC[(step - blockStart) * num_subarrays + nn].mpptVoltageClipping;
 
 					// Calculate and apply snow coverage losses if activated
 					if (PVSystem->enableSnowModel)
@@ -1917,9 +2298,18 @@ void cm_pvsamv1::exec( ) throw (compute_module::general_error)
 		}
 	}
 
+	dc_timer.stop();
+	perf_count("sun_positions_reused", (double)sunPositionCache.hits());
+	perf_count("bifacial_view_factors_reused", (double)viewFactorsReused.load());
+	if (PVSystem->enableMismatchVoltageCalc)
+		perf_count("mismatch_power_evaluations", (double)mismatchPowerEvaluations);
+
 	// Initialize DC battery predictive controller
 	if (en_batt && (batt_topology == ChargeController::DC_CONNECTED))
+	{
+		perf_timer dispatch_timer(this, "battery_dispatch_init");
 		batt.initialize_automated_dispatch(util::array_to_vector<ssc_number_t>(PVSystem->p_systemDCPower, nlifetime), p_load_full, p_invcliploss_full);
+	}
 
 	/* *********************************************************************************************
 	PV AC calculation
@@ -1930,7 +2320,7 @@ void cm_pvsamv1::exec( ) throw (compute_module::general_error)
 
 	double annual_dc_loss_ond = 0, annual_ac_loss_ond = 0; // (TR)
 
-
+	perf_timer ac_timer(this, "ac_loop");
 	for (size_t iyear = 0; iyear < nyears; iyear++)
 	{
 		for (hour = 0; hour < 8760; hour++)
@@ -2065,15 +2455,21 @@ void cm_pvsamv1::exec( ) throw (compute_module::general_error)
 		}
 	}
 
+	ac_timer.stop();
+
 	// Initialize AC connected battery predictive control
 	if (en_batt && batt_topology == ChargeController::AC_CONNECTED)
+	{
+		perf_timer dispatch_timer(this, "battery_dispatch_init");
 		batt.initialize_automated_dispatch(util::array_to_vector<ssc_number_t>(PVSystem->p_systemACPower, nlifetime), p_load_full);
+	}
 
 	/* *********************************************************************************************
 	Post PV AC 
 	*********************************************************************************************** */
 	idx = 0; ireport = 0; ireplast = 0; percent_baseline = percent_complete;
 	double annual_energy_pre_battery = 0.; 
+	perf_timer post_ac_timer(this, "post_ac_loop");
 	for (size_t iyear = 0; iyear < nyears; iyear++)
 	{
 		for (hour = 0; hour < 8760; hour++)
@@ -2129,6 +2525,9 @@ void cm_pvsamv1::exec( ) throw (compute_module::general_error)
 		} 
 
 	} 
+	post_ac_timer.stop();
+	perf_timer output_timer(this, "output_aggregation");
+
 	// Check the snow models and if neccessary report a warning
 	//  *This only needs to be done for subarray1 since all of the activated subarrays should 
 	//   have the same number of bad values
@@ -219,9 +219,11 @@ public:
 
 
     int process_irradiance(int year, int month, int day, int hour, double minute, double ts_hour,
-                           double lat, double lon, double tz, double dn, double df, double alb)
+                           double lat, double lon, double tz, double dn, double df, double alb,
+                           sun_position_cache *sunPositions = 0, size_t sunPositionIndex = 0)
     {
         irrad irr;
+        irr.set_sun_position_cache(sunPositions, sunPositionIndex);
         irr.set_time(year, month, day, hour, minute, ts_hour);
         irr.set_location(lat, lon, tz);
         irr.set_sky_model(2, alb);
@@ -474,6 +476,10 @@ public:
 
         initialize_cell_temp(ts_hour);
 
+        // sun positions for the whole weather file, reused for every year of a lifetime simulation
+        sun_position_cache sunPositions(hdr.lat, hdr.lon, hdr.tz, nrec);
+        sunPositions.precompute(*wdprov, instantaneous ? IRRADPROC_NO_INTERPOLATE_SUNRISE_SUNSET : ts_hour);
+
         double annual_kwh = 0;
 
         size_t idx_life = 0;
@@ -512,7 +518,7 @@ public:
 
                     int code = process_irradiance(wf.year, wf.month, wf.day, wf.hour, wf.minute,
                                                   instantaneous ? IRRADPROC_NO_INTERPOLATE_SUNRISE_SUNSET : ts_hour,
-                                                  hdr.lat, hdr.lon, hdr.tz, wf.dn, wf.df, alb);
+                                                  hdr.lat, hdr.lon, hdr.tz, wf.dn, wf.df, alb, &sunPositions, idx);
 
                     if (-1 == code)
                     {
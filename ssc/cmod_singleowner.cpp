@@ -20,6 +20,7 @@ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE
 OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
+#include "common.h"
 #include "common_financial.h"
 #include "lib_financial.h"
 using namespace libfin;
@@ -1076,6 +1077,7 @@ public:
 		add_var_info(vtab_fuelcell_replacement_cost);
 		add_var_info(vtab_financial_capacity_payments);
 		add_var_info(vtab_financial_grid);
+		add_var_info(vtab_perf_instrumentation);
 	}
 
 	void exec( )
@@ -1544,7 +1546,8 @@ public:
 
 		double recapitalization_cost = as_double("system_recapitalization_cost");
 		double recapitalization_escalation = 0.01*as_double("system_recapitalization_escalation");
-		if (as_integer("system_use_recapitalization"))
+		var_handle use_recapitalization = handle("system_use_recapitalization");
+		if (use_recapitalization.as_integer())
 		{
 			size_t recap_boolean_count;
 			ssc_number_t *recap_boolean = 0;
@@ -1585,7 +1588,7 @@ public:
 			cf.at(CF_property_tax_expense,i) = cf.at(CF_property_tax_assessed_value,i) * property_tax_rate;
 			cf.at(CF_insurance_expense,i) = cost_prefinancing * insurance_rate * pow( 1 + inflation_rate, i-1 );
 
-			if (as_integer("system_use_recapitalization"))
+			if (use_recapitalization.as_integer())
 			{
 				cf.at(CF_Recapitalization,i) = cf.at(CF_Recapitalization_boolean,i) * recapitalization_cost
 					 *  pow((1 + inflation_rate + recapitalization_escalation ), i-1 );
@@ -1730,19 +1733,23 @@ public:
 			( as_boolean("ibi_oth_percent_tax_fed") ? ibi_oth_per : 0 );
 
 
+		var_handle pbi_fed_tax_sta = handle("pbi_fed_tax_sta"), pbi_fed_tax_fed = handle("pbi_fed_tax_fed"), pbi_fed_for_ds = handle("pbi_fed_for_ds");
+		var_handle pbi_sta_tax_sta = handle("pbi_sta_tax_sta"), pbi_sta_tax_fed = handle("pbi_sta_tax_fed"), pbi_sta_for_ds = handle("pbi_sta_for_ds");
+		var_handle pbi_uti_tax_sta = handle("pbi_uti_tax_sta"), pbi_uti_tax_fed = handle("pbi_uti_tax_fed"), pbi_uti_for_ds = handle("pbi_uti_for_ds");
+		var_handle pbi_oth_tax_sta = handle("pbi_oth_tax_sta"), pbi_oth_tax_fed = handle("pbi_oth_tax_fed"), pbi_oth_for_ds = handle("pbi_oth_for_ds");
 		for (i=1;i<=nyears;i++)
 		{
 			cf.at(CF_pbi_statax_total,i) =
-				(( as_boolean("pbi_fed_tax_sta") && (!as_boolean("pbi_fed_for_ds"))) ? cf.at(CF_pbi_fed,i) : 0 ) +
-				(( as_boolean("pbi_sta_tax_sta") && (!as_boolean("pbi_sta_for_ds"))) ? cf.at(CF_pbi_sta,i) : 0 ) +
-				(( as_boolean("pbi_uti_tax_sta") && (!as_boolean("pbi_uti_for_ds"))) ? cf.at(CF_pbi_uti,i) : 0 ) +
-				(( as_boolean("pbi_oth_tax_sta") && (!as_boolean("pbi_oth_for_ds"))) ? cf.at(CF_pbi_oth,i) : 0 ) ;
+				(( pbi_fed_tax_sta.as_boolean() && (!pbi_fed_for_ds.as_boolean())) ? cf.at(CF_pbi_fed,i) : 0 ) +
+				(( pbi_sta_tax_sta.as_boolean() && (!pbi_sta_for_ds.as_boolean())) ? cf.at(CF_pbi_sta,i) : 0 ) +
+				(( pbi_uti_tax_sta.as_boolean() && (!pbi_uti_for_ds.as_boolean())) ? cf.at(CF_pbi_uti,i) : 0 ) +
+				(( pbi_oth_tax_sta.as_boolean() && (!pbi_oth_for_ds.as_boolean())) ? cf.at(CF_pbi_oth,i) : 0 ) ;
 
 			cf.at(CF_pbi_fedtax_total,i) =
-				(( as_boolean("pbi_fed_tax_fed") && (!as_boolean("pbi_fed_for_ds"))) ? cf.at(CF_pbi_fed,i) : 0 ) +
-				(( as_boolean("pbi_sta_tax_fed") && (!as_boolean("pbi_sta_for_ds"))) ? cf.at(CF_pbi_sta,i) : 0 ) +
-				(( as_boolean("pbi_uti_tax_fed") && (!as_boolean("pbi_uti_for_ds"))) ? cf.at(CF_pbi_uti,i) : 0 ) +
-				(( as_boolean("pbi_oth_tax_fed") && (!as_boolean("pbi_oth_for_ds"))) ? cf.at(CF_pbi_oth,i) : 0 ) ;
+				(( pbi_fed_tax_fed.as_boolean() && (!pbi_fed_for_ds.as_boolean())) ? cf.at(CF_pbi_fed,i) : 0 ) +
+				(( pbi_sta_tax_fed.as_boolean() && (!pbi_sta_for_ds.as_boolean())) ? cf.at(CF_pbi_sta,i) : 0 ) +
+				(( pbi_uti_tax_fed.as_boolean() && (!pbi_uti_for_ds.as_boolean())) ? cf.at(CF_pbi_uti,i) : 0 ) +
+				(( pbi_oth_tax_fed.as_boolean() && (!pbi_oth_for_ds.as_boolean())) ? cf.at(CF_pbi_oth,i) : 0 ) ;
 		}
 		// 5/1/11
 		for (i=1;i<=nyears;i++)
@@ -2255,6 +2262,7 @@ public:
 
 /***************** begin iterative solution *********************************************************************/
 
+	perf_timer ppa_timer(this, "ppa_solve");
 	do
 	{
 
@@ -2899,6 +2907,8 @@ public:
 
 	}	// target tax investor return in target year
 	while (!solved && !irr_is_minimally_met  && (its < ppa_soln_max_iteations) && (ppa >= 0) );
+	ppa_timer.stop();
+	perf_count("ppa_iterations", its);
 
 
 		// 12/14/12 - address issue from Eric Lantz - ppa solution when target mode and ppa < 0
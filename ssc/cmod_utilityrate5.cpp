@@ -21,6 +21,7 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
 #include "core.h"
+#include "common.h"
 #include <algorithm>
 #include <sstream>
 
@@ -397,10 +398,21 @@ private:
 	std::vector<std::vector<int> >  m_dc_flat_tiers; // tier numbers for each month of flat demand charge
 	size_t m_num_rec_yearly;
 
+	// inputs read for every year and record of the bill calculations
+	var_handle m_lifetime_output;
+	var_handle m_metering_option;
+	var_handle m_dc_enable;
+	var_handle m_tou_demand_single_peak;
+	var_handle m_annual_min_charge;
+	var_handle m_monthly_min_charge;
+	var_handle m_monthly_fixed_charge;
+	var_handle m_nm_yearend_sell_rate;
+
 public:
 	cm_utilityrate5()
 	{
 		add_var_info( vtab_utility_rate5 );
+		add_var_info( vtab_perf_instrumentation );
 	}
 
 	void exec( )
@@ -413,6 +425,17 @@ public:
 			}
 		}
 
+		perf_timer input_timer(this, "input_read");
+
+		m_lifetime_output = handle("system_use_lifetime_output");
+		m_metering_option = handle("ur_metering_option");
+		m_dc_enable = handle("ur_dc_enable");
+		m_tou_demand_single_peak = handle("TOU_demand_single_peak");
+		m_annual_min_charge = handle("ur_annual_min_charge");
+		m_monthly_min_charge = handle("ur_monthly_min_charge");
+		m_monthly_fixed_charge = handle("ur_monthly_fixed_charge");
+		m_nm_yearend_sell_rate = handle("ur_nm_yearend_sell_rate");
+
 		ssc_number_t *parr = 0;
 		size_t count, i, j; 
 
@@ -425,7 +448,7 @@ public:
 		// degradation
 		// degradation starts in year 2 for single value degradation - no degradation in year 1 - degradation =1.0
 		// lifetime degradation applied in technology compute modules
-		if (as_integer("system_use_lifetime_output") == 1)
+		if (m_lifetime_output.as_integer() == 1)
 		{
 			for (i = 0; i<nyears; i++)
 				sys_scale[i] = 1.0;
@@ -490,7 +513,7 @@ public:
 		pgen = as_array("gen", &nrec_gen);
 		// for lifetime analysis
 		size_t nrec_gen_per_year = nrec_gen;
-		if (as_integer("system_use_lifetime_output") == 1)
+		if (m_lifetime_output.as_integer() == 1)
 			nrec_gen_per_year = nrec_gen / nyears;
 		step_per_hour_gen = nrec_gen_per_year / 8760;
 		if (step_per_hour_gen < 1 || step_per_hour_gen > 60 || step_per_hour_gen * 8760 != nrec_gen_per_year)
@@ -734,11 +757,14 @@ public:
 		3=Single meter with monthly rollover credits in $ (Net Billing $)
 		4=Two meters with all generation sold and all load purchaseded
 		*/
-		int metering_option = as_integer("ur_metering_option");
+		int metering_option = m_metering_option.as_integer();
 		bool two_meter = (metering_option == 4 );
 		bool timestep_reconciliation = (metering_option == 2 || metering_option == 3 || metering_option == 4);
 
 
+		input_timer.stop();
+
+		perf_timer rate_timer(this, "rate_calc");
 		idx = 0;
 		for (i=0;i<nyears;i++)
 		{
@@ -771,7 +797,7 @@ public:
 
 
 				// update e_sys per year if lifetime output
-				if ((as_integer("system_use_lifetime_output") == 1) && ( idx < nrec_gen ))
+				if ((m_lifetime_output.as_integer() == 1) && ( idx < nrec_gen ))
 				{
 //					e_sys[j] = p_sys[j] = 0.0;
 //					ts_power = (idx < nrec_gen) ? pgen[idx] : 0;
@@ -1298,6 +1324,7 @@ public:
 
 
 		}
+		rate_timer.stop();
 
 		assign("elec_cost_with_system_year1", annual_elec_cost_w_sys[1]);
 		assign("elec_cost_without_system_year1", annual_elec_cost_wo_sys[1]);
@@ -1379,7 +1406,7 @@ public:
 		m_ec_ts_buy_rate.clear();
 
 		bool ec_enabled = true; // per 2/25/16 meeting
-		bool dc_enabled = as_boolean("ur_dc_enable");
+		bool dc_enabled = m_dc_enable.as_boolean();
 		bool en_ts_sell_rate = as_boolean("ur_en_ts_sell_rate");
 
 		if (en_ts_sell_rate)
@@ -1877,6 +1904,7 @@ public:
 		ssc_number_t rate_esc, size_t year, bool include_fixed=true, bool include_min=true, bool gen_only=false) 
 
 	{
+		perf_count("bill_calcs");
 		int i;
 
 		for (i=0;i<(int)m_num_rec_yearly;i++)
@@ -1906,15 +1934,15 @@ public:
 		3=Two meters with all generation sold and all load purchaseded
 		4=Single meter with monthly rollover credits in $ (Net Billing $)
 		*/
-		int metering_option = as_integer("ur_metering_option");
+		int metering_option = m_metering_option.as_integer();
 		bool enable_nm = (metering_option == 0 || metering_option == 1);
 
 		bool ec_enabled = true; // per 2/25/16 meeting
-		bool dc_enabled = as_boolean("ur_dc_enable");
+		bool dc_enabled = m_dc_enable.as_boolean();
 
-		bool excess_monthly_dollars = (as_integer("ur_metering_option") == 1);
+		bool excess_monthly_dollars = (m_metering_option.as_integer() == 1);
 
-		bool tou_demand_single_peak = (as_integer("TOU_demand_single_peak") == 1);
+		bool tou_demand_single_peak = (m_tou_demand_single_peak.as_integer() == 1);
 
 
 		size_t steps_per_hour = m_num_rec_yearly / 8760;
@@ -2553,9 +2581,9 @@ public:
 		// compute revenue ( = income - payment ) and monthly bill ( = payment - income) and apply fixed and minimum charges
 		c = 0;
 		ssc_number_t mon_bill = 0, ann_bill = 0;
-		ssc_number_t ann_min_charge = as_number("ur_annual_min_charge")*rate_esc;
-		ssc_number_t mon_min_charge = as_number("ur_monthly_min_charge")*rate_esc;
-		ssc_number_t mon_fixed = as_number("ur_monthly_fixed_charge")*rate_esc;
+		ssc_number_t ann_min_charge = m_annual_min_charge.as_number()*rate_esc;
+		ssc_number_t mon_min_charge = m_monthly_min_charge.as_number()*rate_esc;
+		ssc_number_t mon_fixed = m_monthly_fixed_charge.as_number()*rate_esc;
 
 		// process one month at a time
 		for (m = 0; m < 12; m++)
@@ -2603,7 +2631,7 @@ public:
 									// monthly rollover with year end sell at reduced rate
 									if (!excess_monthly_dollars && (monthly_cumulative_excess_energy[11] > 0))
 									{
-										ssc_number_t year_end_dollars = monthly_cumulative_excess_energy[11] * as_number("ur_nm_yearend_sell_rate")*rate_esc;
+										ssc_number_t year_end_dollars = monthly_cumulative_excess_energy[11] * m_nm_yearend_sell_rate.as_number()*rate_esc;
 										income[8759] += year_end_dollars;
 										monthly_cumulative_excess_dollars[11] = year_end_dollars;
 										excess_dollars_earned[11] += year_end_dollars;
@@ -2644,6 +2672,7 @@ public:
 		ssc_number_t rate_esc, bool include_fixed = true, bool include_min = true, bool gen_only = false)
 
 	{
+		perf_count("bill_calcs");
 		int i;
 		for (i = 0; i<(int)m_num_rec_yearly; i++)
 			revenue[i] = payment[i] = income[i] = demand_charge[i] = dc_hourly_peak[i] = energy_charge[i] = 0.0;
@@ -2674,7 +2703,7 @@ public:
 		ssc_number_t monthly_deficit_energy;
 
 		bool ec_enabled = true; // per 2/25/16 meeting
-		bool dc_enabled = as_boolean("ur_dc_enable");
+		bool dc_enabled = m_dc_enable.as_boolean();
 
 		/*
 		0=Single meter with monthly rollover credits in kWh
@@ -2684,9 +2713,9 @@ public:
 		4=Two meters with all generation sold and all load purchaseded
 		*/
 		//int metering_option = as_integer("ur_metering_option");
-		bool excess_monthly_dollars = (as_integer("ur_metering_option") == 3);
+		bool excess_monthly_dollars = (m_metering_option.as_integer() == 3);
 
-		bool tou_demand_single_peak = (as_integer("TOU_demand_single_peak") == 1);
+		bool tou_demand_single_peak = (m_tou_demand_single_peak.as_integer() == 1);
 
 
 		size_t steps_per_hour = m_num_rec_yearly / 8760;
@@ -3162,9 +3191,9 @@ public:
 		// compute revenue ( = income - payment ) and monthly bill ( = payment - income) and apply fixed and minimum charges
 		c = 0;
 		ssc_number_t mon_bill = 0, ann_bill = 0;
-		ssc_number_t ann_min_charge = as_number("ur_annual_min_charge")*rate_esc;
-		ssc_number_t mon_min_charge = as_number("ur_monthly_min_charge")*rate_esc;
-		ssc_number_t mon_fixed = as_number("ur_monthly_fixed_charge")*rate_esc;
+		ssc_number_t ann_min_charge = m_annual_min_charge.as_number()*rate_esc;
+		ssc_number_t mon_min_charge = m_monthly_min_charge.as_number()*rate_esc;
+		ssc_number_t mon_fixed = m_monthly_fixed_charge.as_number()*rate_esc;
 
 		// process one month at a time
 		for (m = 0; m < 12; m++)
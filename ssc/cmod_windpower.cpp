@@ -210,6 +210,7 @@ cm_windpower::cm_windpower(){
 	add_var_info(vtab_technology_outputs);
 	// wind PRUF
 	add_var_info(vtab_p50p90);
+	add_var_info(vtab_output_selection);
 }
 
 // wind PRUF loss framework. Can replace numerical loss percentages by calculated losses in future model
@@ -476,10 +477,11 @@ void cm_windpower::exec()
 
 	// allocate output data
 	ssc_number_t *farmpwr = allocate("gen", nstep);
-	ssc_number_t *wspd = allocate("wind_speed", nstep);
-	ssc_number_t *wdir = allocate("wind_direction", nstep);
-	ssc_number_t *air_temp = allocate("temp", nstep);
-	ssc_number_t *air_pres = allocate("pressure", nstep);
+	ssc_number_t *wspd = allocate_output("wind_speed", nstep);
+	ssc_number_t *wdir = allocate_output("wind_direction", nstep);
+	ssc_number_t *air_temp = allocate_output("temp", nstep);
+	ssc_number_t *air_pres = allocate_output("pressure", nstep);
+	double wsp_avg = 0.; // summed as the steps are written, since the wind speed series may not be kept
 
 	std::vector<double> Power(wpc.nTurbines, 0.), Thrust(wpc.nTurbines, 0.),
 		Eff(wpc.nTurbines, 0.), Wind(wpc.nTurbines, 0.), Turb(wpc.nTurbines, 0.),
@@ -584,6 +586,7 @@ void cm_windpower::exec()
 
 			farmpwr[i] = (ssc_number_t)farmp*haf(hr); //adjustment factors are constrained to be hourly, not sub-hourly, so it's correct for this to be indexed on the hour
 			wspd[i] = (ssc_number_t)wind;
+			wsp_avg += (ssc_number_t)wind;
 			wdir[i] = (ssc_number_t)dir;
 			air_temp[i] = (ssc_number_t)temp;
 			air_pres[i] = (ssc_number_t)pres;
@@ -606,9 +609,6 @@ void cm_windpower::exec()
 	assign("cutoff_losses", var_data((ssc_number_t)((withoutCutOffLosses - annual) / withoutCutOffLosses)));
 	assign("annual_gross_energy", annual_gross);
 
-    double wsp_avg = 0.;
-    for (size_t i = 0; i < nstep; i++)
-        wsp_avg += wspd[i];
     wsp_avg /= nstep;
     assign("wind_speed_average", wsp_avg);
 
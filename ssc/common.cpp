@@ -317,6 +317,15 @@ var_info vtab_technology_outputs[] = {
 { SSC_OUTPUT, SSC_ARRAY , "gen"                                  , "System power generated"                                         , "kW"                                     , ""                                      , "Time Series"          , "*"              , ""                      , ""},
 	var_info_invalid };
 
+var_info vtab_output_selection[] = {
+{ SSC_INPUT, SSC_STRING, "outputs_requested"                    , "Outputs to report, comma separated names or patterns"           , ""                                       , "* and ? wildcards, all outputs if not assigned", "Outputs"      , "?"              , ""                      , ""},
+	var_info_invalid };
+
+var_info vtab_perf_instrumentation[] = {
+{ SSC_INPUT, SSC_NUMBER, "perf_outputs"                         , "Report phase timings and solver counters as perf_* outputs"     , ""                                       , "0/1, off if not assigned"                      , "Outputs"      , "?"              , "BOOLEAN"               , ""},
+{ SSC_INPUT, SSC_STRING, "perf_trace_file"                      , "Chrome trace event file for phase timings"                       , ""                                       , "reports perf_* outputs when assigned"          , "Outputs"      , "?"              , ""                      , ""},
+	var_info_invalid };
+
 var_info vtab_p50p90[] = {
         { SSC_INPUT, SSC_NUMBER ,  "total_uncert"                 , "Total uncertainty in energy production as percent of annual energy", "%"                                   , ""                                      , "Uncertainty"          , ""              , "MIN=0,MAX=100"         , ""},
         { SSC_OUTPUT, SSC_NUMBER , "annual_energy_p75"            , "Annual energy with 75% probability of exceedance"                  , "kWh"                                 , ""                                      , "Uncertainty"          , ""              , ""                      , ""},
@@ -835,12 +844,12 @@ std::string shading_factor_calculator::get_error(size_t i)
 }
 
 
-bool shading_factor_calculator::use_shade_db()
+bool shading_factor_calculator::use_shade_db() const
 {
 	return (m_enTimestep && (m_string_option == 0)); // determine which fbeam function to call
 }
 
-size_t shading_factor_calculator::get_row_index_for_input(size_t hour, size_t hour_step, size_t steps_per_hour)
+size_t shading_factor_calculator::get_row_index_for_input(size_t hour, size_t hour_step, size_t steps_per_hour) const
 {
 	// handle different simulation timesteps and shading input timesteps
 	size_t ndx = hour * m_steps_per_hour; // m_beam row index for input hour
@@ -854,6 +863,15 @@ size_t shading_factor_calculator::get_row_index_for_input(size_t hour, size_t ho
 }
 
 bool shading_factor_calculator::fbeam(size_t hour, double solalt, double solazi, size_t hour_step, size_t steps_per_hour)
+{
+	double factor = 1.0;
+	if (!fbeam(hour, solalt, solazi, hour_step, steps_per_hour, factor))
+		return false;
+	m_beam_shade_factor = factor;
+	return true;
+}
+
+bool shading_factor_calculator::fbeam(size_t hour, double solalt, double solazi, size_t hour_step, size_t steps_per_hour, double &beam_factor) const
 {
 	bool ok = false;
 	double factor = 1.0;
@@ -868,7 +886,7 @@ bool shading_factor_calculator::fbeam(size_t hour, double solalt, double solazi,
 		if (m_enAzAlt)
 			factor *= util::bilinear(solalt, solazi, m_azaltvals);
 
-		m_beam_shade_factor = factor;
+		beam_factor = factor;
 
 		ok = true;
 	}
@@ -877,10 +895,18 @@ bool shading_factor_calculator::fbeam(size_t hour, double solalt, double solazi,
 
 
 bool shading_factor_calculator::fbeam_shade_db(ShadeDB8_mpp * p_shadedb, size_t hour, double solalt, double solazi, size_t hour_step, size_t steps_per_hour, double gpoa, double dpoa, double pv_cell_temp, int mods_per_str, double str_vmp_stc, double mppt_lo, double mppt_hi)
+{
+	double beam_factor = 1.0, dc_factor = 1.0;
+	if (!fbeam_shade_db(p_shadedb, hour, solalt, solazi, hour_step, steps_per_hour, gpoa, dpoa, pv_cell_temp, mods_per_str, str_vmp_stc, mppt_lo, mppt_hi, beam_factor, dc_factor))
+		return false;
+	m_dc_shade_factor = dc_factor;
+	m_beam_shade_factor = beam_factor;
+	return true;
+}
+
+bool shading_factor_calculator::fbeam_shade_db(ShadeDB8_mpp * p_shadedb, size_t hour, double solalt, double solazi, size_t hour_step, size_t steps_per_hour, double gpoa, double dpoa, double pv_cell_temp, int mods_per_str, double str_vmp_stc, double mppt_lo, double mppt_hi, double &beam_factor, double &dc_factor) const
 {
 	bool ok = false;
-	double dc_factor = 1.0;
-	double beam_factor = 1.0;
 	size_t irow = get_row_index_for_input(hour, hour_step, steps_per_hour);
 	if (irow < m_beamFactors.nrows())
 	{
@@ -888,6 +914,7 @@ bool shading_factor_calculator::fbeam_shade_db(ShadeDB8_mpp * p_shadedb, size_t
 		for (size_t icol = 0; icol < m_beamFactors.ncols(); icol++)
 			shad_fracs.push_back(m_beamFactors.at(irow, icol));
 		dc_factor = 1.0 - p_shadedb->get_shade_loss(gpoa, dpoa, shad_fracs, true, pv_cell_temp, mods_per_str, str_vmp_stc, mppt_lo, mppt_hi);
+		beam_factor = 1.0;
 		// apply mxh factor
 		if (m_enMxH && (irow < m_mxhFactors.nrows()))
 			beam_factor *= m_mxhFactors(irow, 0);
@@ -895,16 +922,13 @@ bool shading_factor_calculator::fbeam_shade_db(ShadeDB8_mpp * p_shadedb, size_t
 		if (m_enAzAlt)
 			beam_factor *= util::bilinear(solalt, solazi, m_azaltvals);
 
-		m_dc_shade_factor = dc_factor;
-		m_beam_shade_factor = beam_factor;
-
 		ok = true;
 	}
 	return ok;
 }
 
 
-double shading_factor_calculator::fdiff()
+double shading_factor_calculator::fdiff() const
 {
 	return m_diffFactor;
 }
@@ -912,14 +936,14 @@ double shading_factor_calculator::fdiff()
 
 
 
-double shading_factor_calculator::beam_shade_factor()
+double shading_factor_calculator::beam_shade_factor() const
 {
 	// Sara 1/25/16 - shading database derate applied to dc only
 	// shading loss applied to beam if not from shading database
 	return (m_beam_shade_factor);
 }
 
-double shading_factor_calculator::dc_shade_factor()
+double shading_factor_calculator::dc_shade_factor() const
 {
 	// Sara 1/25/16 - shading database derate applied to dc only
 	// shading loss applied to beam if not from shading database
@@ -928,8 +952,13 @@ double shading_factor_calculator::dc_shade_factor()
 
 weatherdata::weatherdata( var_data *data_table )
 {
-	m_startSec = m_stepSec = m_nRecords = 0;
+	m_startSec = m_stepSec = m_nRecords = m_nData = 0;
 	m_index = 0;
+	for (size_t i = 0; i < _MAXCOL_; i++)
+	{
+		m_vec[i].p = 0;
+		m_vec[i].len = 0;
+	}
 	m_ok = true;
 
 	if ( data_table->type != SSC_TABLE ) 
@@ -1031,77 +1060,83 @@ weatherdata::weatherdata( var_data *data_table )
 
 	if ( nrec > 0 && nmult >= 1 )
 	{
-		m_data.resize( nrec );
-		for( size_t i=0;i<nrec;i++ )
+		vec *cols[_MAXCOL_] = { &year, &month, &day, &hour, &minute, &gh, &dn, &df, &poa,
+			&tdry, &twet, &tdew, &wspd, &wdir, &rhum, &pres, &snow, &alb, &aod };
+		for (size_t i = 0; i < _MAXCOL_; i++)
+			m_vec[i] = *cols[i];
+		m_nData = nrec;
+
+		// calculate twet using calc_twet if tdry & rh & pres are available
+		if ( twet.len == 0 && tdry.len > 0 && rhum.len > 0 && pres.len > 0 )
 		{
-			weather_record *r = new weather_record;
-
-			if ( i < year.len ) r->year = (int)year.p[i]; 
-			else r->year = 2000;
+			m_twet.resize( nrec );
+			for( size_t i=0;i<nrec;i++ )
+				m_twet[i] = (float)calc_twet(tdry.p[i], rhum.p[i], pres.p[i]);
+		}
 
-			if ( i < month.len ) r->month = (int)month.p[i];
-			else if ( m_stepSec == 3600 && m_nRecords == 8760 ) {
-				r->month = util::month_of((double)i);
-			}
+		// calculate tdew using wiki_dew_calc if tdry & rh are available
+		if ( tdew.len == 0 && tdry.len > 0 && rhum.len > 0 )
+		{
+			m_tdew.resize( nrec );
+			for( size_t i=0;i<nrec;i++ )
+				m_tdew[i] = (float)wiki_dew_calc(tdry.p[i], rhum.p[i]);
+		}
+	}
+}
 
-			if ( i < day.len ) r->day = (int)day.p[i];
-			else if ( m_stepSec == 3600 && m_nRecords == 8760 ) {
-				int month = util::month_of( (double)i );
-				r->day = util::day_of_month( month, (double)i );
-			}
+weatherdata::~weatherdata()
+{
+	// table arrays are borrowed, nothing to free
+}
 
-			if ( i < hour.len ) r->hour = (int)hour.p[i];
-			else if ( m_stepSec == 3600 && m_nRecords == 8760 ) {
-				size_t day = i / 24;
-				size_t start_of_day = day * 24;
-				r->hour = (int)(i - start_of_day);
-			}
+void weatherdata::get_record( size_t i, weather_record *r )
+{
+	r->reset();
 
-			if ( i < minute.len ) r->minute = minute.p[i];
-			else r->minute = (double)((m_stepSec / 2) / 60);
-
-			r->gh = r->dn = r->df = r->poa = r->wspd = r->wdir = r->tdry = r->twet = r->tdew 
-				= r->rhum = r->pres = r->snow = r->alb = r->aod = std::numeric_limits<double>::quiet_NaN();
-			if ( i < gh.len ) r->gh = gh.p[i];
-			if ( i < dn.len ) r->dn = dn.p[i];
-			if ( i < df.len ) r->df = df.p[i];
-			if (i < poa.len ) r->poa = poa.p[i];
-
-			if ( i < wspd.len ) r->wspd = wspd.p[i];
-			if ( i < wdir.len ) r->wdir = wdir.p[i];
-
-			if ( i < tdry.len ) r->tdry = tdry.p[i];
-			if ( i < twet.len ) r->twet = twet.p[i];
-			else{
-				// calculate twet using calc_twet if tdry & rh & pres are available
-				if ((i < tdry.len) && (i < rhum.len) && (i < pres.len)){
-					r->twet = (float)calc_twet(tdry.p[i], rhum.p[i], pres.p[i]);
-				}
-			}
-			if ( i < tdew.len ) r->tdew = tdew.p[i];
-			else{
-				// calculate tdew using wiki_dew_calc if tdry & rh are available
-				if ((i < tdry.len) && (i < rhum.len)){
-					r->tdew = (float)wiki_dew_calc(tdry.p[i], rhum.p[i]);
-				}
-			}
+	if ( i < m_vec[YEAR].len ) r->year = (int)m_vec[YEAR].p[i];
+	else r->year = 2000;
 
-			if ( i < rhum.len ) r->rhum = rhum.p[i];
-			if ( i < pres.len ) r->pres = pres.p[i];
+	if ( i < m_vec[MONTH].len ) r->month = (int)m_vec[MONTH].p[i];
+	else if ( m_stepSec == 3600 && m_nRecords == 8760 ) {
+		r->month = util::month_of((double)i);
+	}
 
-			if ( i < snow.len ) r->snow = snow.p[i];
-			if ( i < alb.len ) r->alb = alb.p[i];
-			if ( i < aod.len ) r->aod = aod.p[i];
+	if ( i < m_vec[DAY].len ) r->day = (int)m_vec[DAY].p[i];
+	else if ( m_stepSec == 3600 && m_nRecords == 8760 ) {
+		int month = util::month_of( (double)i );
+		r->day = util::day_of_month( month, (double)i );
+	}
 
-			m_data[i] = r;
-		}
+	if ( i < m_vec[HOUR].len ) r->hour = (int)m_vec[HOUR].p[i];
+	else if ( m_stepSec == 3600 && m_nRecords == 8760 ) {
+		size_t day = i / 24;
+		size_t start_of_day = day * 24;
+		r->hour = (int)(i - start_of_day);
 	}
-}
 
-weatherdata::~weatherdata()
-{
-	for( size_t i=0;i<m_data.size();i++ )
-		delete m_data[i];
+	if ( i < m_vec[MINUTE].len ) r->minute = m_vec[MINUTE].p[i];
+	else r->minute = (double)((m_stepSec / 2) / 60);
+
+	if ( i < m_vec[GHI].len ) r->gh = m_vec[GHI].p[i];
+	if ( i < m_vec[DNI].len ) r->dn = m_vec[DNI].p[i];
+	if ( i < m_vec[DHI].len ) r->df = m_vec[DHI].p[i];
+	if ( i < m_vec[POA].len ) r->poa = m_vec[POA].p[i];
+
+	if ( i < m_vec[WSPD].len ) r->wspd = m_vec[WSPD].p[i];
+	if ( i < m_vec[WDIR].len ) r->wdir = m_vec[WDIR].p[i];
+
+	if ( i < m_vec[TDRY].len ) r->tdry = m_vec[TDRY].p[i];
+	if ( i < m_vec[TWET].len ) r->twet = m_vec[TWET].p[i];
+	else if ( i < m_twet.size() ) r->twet = m_twet[i];
+	if ( i < m_vec[TDEW].len ) r->tdew = m_vec[TDEW].p[i];
+	else if ( i < m_tdew.size() ) r->tdew = m_tdew[i];
+
+	if ( i < m_vec[RH].len ) r->rhum = m_vec[RH].p[i];
+	if ( i < m_vec[PRES].len ) r->pres = m_vec[PRES].p[i];
+
+	if ( i < m_vec[SNOW].len ) r->snow = m_vec[SNOW].p[i];
+	if ( i < m_vec[ALB].len ) r->alb = m_vec[ALB].p[i];
+	if ( i < m_vec[AOD].len ) r->aod = m_vec[AOD].p[i];
 }
 
 
@@ -1171,33 +1206,58 @@ ssc_number_t weatherdata::get_number( var_data *v, const char *name )
 }
 
 void weatherdata::set_counter_to(size_t cur_index){
-	if (cur_index < m_data.size()) {
+	if (cur_index < m_nData) {
 		m_index = cur_index;
 	}
 }
 
 bool weatherdata::read( weather_record *r )
 {
-	if (m_index < m_data.size())
+	if (m_index < m_nData)
 	{
-		*r = *m_data[m_index++];
+		get_record( m_index++, r );
 		return true;
 	}
 	else
 		return false;
 }
 
-bool weatherdata::read_average(weather_record *r, std::vector<int> &, size_t &)
+bool weatherdata::read_average(weather_record *r, std::vector<int> &cols, size_t &num_timesteps)
 {
-	// finish per bool weatherfile::read_average(weather_record *r, std::vector<int> &cols, size_t &num_timesteps)
-	if (m_index < m_data.size())
+	size_t start = 0;
+	if (!r || !average_window(m_index, num_timesteps, m_nData, &start) || !read(r))
+		return false;
+
+	// average the requested columns over the window, building each column's sums on first use
+	for (size_t i = 0; i < cols.size(); i++)
 	{
-		*r = *m_data[m_index++];
-		return true;
+		int id = cols[i];
+		if (id < YEAR || id >= _MAXCOL_)
+			continue;
+
+		prefix_sum &ps = m_prefix[id];
+		if (!ps.built())
+		{
+			if (m_vec[id].len == m_nData)
+				ps.build(m_vec[id].p, m_nData);
+			else
+			{
+				// calculated or missing column: take values from the records
+				std::vector<double> values(m_nData);
+				weather_record rec;
+				for (size_t j = 0; j < m_nData; j++)
+				{
+					get_record(j, &rec);
+					values[j] = record_value(rec, id);
+				}
+				ps.build(&values[0], m_nData);
+			}
+		}
+
+		set_record_value(r, id, ps.average(start, num_timesteps));
 	}
-	else
-		return false;
 
+	return true;
 }
 
 
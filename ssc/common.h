@@ -42,6 +42,8 @@ extern var_info vtab_adjustment_factors[];
 extern var_info vtab_dc_adjustment_factors[];
 extern var_info vtab_sf_adjustment_factors[];
 extern var_info vtab_technology_outputs[];
+extern var_info vtab_output_selection[];
+extern var_info vtab_perf_instrumentation[];
 extern var_info vtab_grid_curtailment[];
 extern var_info vtab_p50p90[];
 extern var_info vtab_forecast_price_signal[];
@@ -115,34 +117,43 @@ public:
 	bool setup(compute_module *cm, const std::string &prefix = "");
 	std::string get_error(size_t i = 0);
 
-	size_t get_row_index_for_input(size_t hour, size_t hour_step, size_t steps_per_hour);
-	bool use_shade_db();
+	size_t get_row_index_for_input(size_t hour, size_t hour_step, size_t steps_per_hour) const;
+	bool use_shade_db() const;
 
 	// beam and diffuse loss factors (0: full loss, 1: no loss )
 	bool fbeam(size_t hour, double solalt, double solazi, size_t hour_step = 0, size_t steps_per_hour = 1);
 	// shading database instantiated once outside of shading factor calculator
 	bool fbeam_shade_db(ShadeDB8_mpp * p_shadedb, size_t hour, double solalt, double solazi, size_t hour_step = 0, size_t steps_per_hour = 1, double gpoa = 0.0, double dpoa = 0.0, double pv_cell_temp = 0.0, int mods_per_str = 0, double str_vmp_stc = 0.0, double mppt_lo = 0.0, double mppt_hi = 0.0);
 
-	double fdiff();
+	// the same factors returned in the last arguments instead of kept by the calculator, so that several threads can share it
+	bool fbeam(size_t hour, double solalt, double solazi, size_t hour_step, size_t steps_per_hour, double &beam_factor) const;
+	bool fbeam_shade_db(ShadeDB8_mpp * p_shadedb, size_t hour, double solalt, double solazi, size_t hour_step, size_t steps_per_hour, double gpoa, double dpoa, double pv_cell_temp, int mods_per_str, double str_vmp_stc, double mppt_lo, double mppt_hi, double &beam_factor, double &dc_factor) const;
 
-	double beam_shade_factor();
-	double dc_shade_factor();
+	double fdiff() const;
+
+	double beam_shade_factor() const;
+	double dc_shade_factor() const;
 };
 
 class weatherdata : public weather_data_provider
 {
-	std::vector< weather_record* > m_data;
-	std::vector<size_t> m_columns;
-
 	struct vec {
 		ssc_number_t *p;
 		size_t len;
 	};
 
+	// arrays borrowed from the data table by column id, empty where the table has no such field
+	vec m_vec[_MAXCOL_];
+	// wet bulb and dew point temperatures calculated when the table does not provide them
+	std::vector<float> m_twet, m_tdew;
+	size_t m_nData;
+	std::vector<size_t> m_columns;
+
 	vec get_vector(var_data *v, const char *name, size_t *len = nullptr);
 	ssc_number_t get_number(var_data *v, const char *name);
 
 	int name_to_id(const char *name);
+	void get_record(size_t i, weather_record *r);
 
 public:
 	/* Detects file format, read header information, detects which data columns are available and at what index
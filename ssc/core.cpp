@@ -24,13 +24,14 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <fstream>
 #include <cstring>
 #include <algorithm>
+#include <mutex>
 
 #include "core.h"
 
 const var_info var_info_invalid = {	0, 0, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL };
 
 compute_module::compute_module( )
-	:  m_infomap(NULL), m_handler(NULL), m_vartab(NULL)
+	:  m_select_outputs(false), m_perf(false), m_infomap(NULL), m_handler(NULL), m_vartab(NULL)
 {
 	/* nothing to do */
 }
@@ -64,16 +65,60 @@ bool compute_module::compute( handler_interface *handler, var_table *data )
 		log("no variables defined for computation engine", SSC_ERROR);
 		return false;
 	}
+
+	// layered tables check every inherited lookup against the variable list
+	if (data->parent() && !has_info_map())
+		build_info_map();
+
+	m_select_outputs = false;
+	m_outputs_requested.clear();
+	m_output_scratch.clear();
+	m_streams.clear();
+	m_streamed.clear();
+	if (var_data *sel = lookup("outputs_requested"))
+	{
+		if (sel->type == SSC_STRING)
+		{
+			m_select_outputs = true;
+			m_outputs_requested = util::split( util::lower_case(sel->str), ", \t\r\n" );
+		}
+	}
+
+	m_perf = false;
+	m_perf_trace_file.clear();
+	m_perf_phases.clear();
+	m_perf_counters.clear();
+	m_perf_events.clear();
+	if (var_data *perf = lookup("perf_outputs"))
+		m_perf = (perf->type == SSC_NUMBER && perf->num.value() != 0);
+	if (var_data *trace = lookup("perf_trace_file"))
+	{
+		if (trace->type == SSC_STRING && !trace->str.empty())
+		{
+			m_perf = true;
+			m_perf_trace_file = trace->str;
+		}
+	}
 	
 	try { // catch any 'general_error' that can be thrown during precheck, exec, and postcheck
 
 		if (!verify("precheck input", SSC_INPUT)) return false;
+		if (m_perf) m_perf_start = std::chrono::steady_clock::now();
 		exec();
+		finish_streams();
+		if (m_perf) finish_perf();
 		if (!verify("postcheck output", SSC_OUTPUT)) return false;
 
 	} catch ( general_error &e )	{
 		log( e.err_text, SSC_ERROR, e.time );
+		abort_streams();
+		if (m_perf) finish_perf();
 		return false;
+	} catch ( ... ) {
+		// any other exception is left to the caller, but the handler still learns the streams are incomplete
+		abort_streams();
+		if (m_perf) finish_perf();
+		throw;
 	}
 	
 	return true;
@@ -81,14 +126,19 @@ bool compute_module::compute( handler_interface *handler, var_table *data )
 
 bool compute_module::verify(const std::string &phase, int check_var_type)
 {
-	std::vector< var_info* >::iterator it;
-	for (it=m_varlist.begin();it!=m_varlist.end();++it)
+	if (m_checks.size() != m_varlist.size())
+		resolve_checks();
+
+	for (size_t i=0;i<m_varlist.size();i++)
 	{
-		var_info *vi = *it;
+		var_info *vi = m_varlist[i];
+		if ( vi->var_type == SSC_OUTPUT && (!is_output_requested( vi->name ) || is_streamed( vi->name )) )
+			continue;
+
 		if ( vi->var_type == check_var_type
 			|| vi->var_type == SSC_INOUT )
 		{
-			if ( check_required( vi->name ) )
+			if ( check_required( vi->name, *m_checks[i] ) )
 			{
 				// if the variable is required, make sure it exists
 				// and that it is of the correct data type
@@ -106,7 +156,7 @@ bool compute_module::verify(const std::string &phase, int check_var_type)
 
 				// now check constraints on it
 				std::string fail_text;
-				if (!check_constraints( vi->name, fail_text ))
+				if (!check_constraints( vi->name, *m_checks[i], fail_text ))
 				{
 					log(fail_text, SSC_ERROR);
 					return false;
@@ -127,6 +177,7 @@ void compute_module::add_var_info( var_info vi[] )
 		m_varlist.push_back( &vi[i] );
 		i++;
 	}
+	m_checks.clear();
 }
 
 void compute_module::remove_var_info(var_info vi[])
@@ -138,6 +189,7 @@ void compute_module::remove_var_info(var_info vi[])
 		m_varlist.erase(std::remove(m_varlist.begin(), m_varlist.end(), &vi[i]), m_varlist.end());
 		i++;
 	}
+	m_checks.clear();
 }
 
 void compute_module::build_info_map()
@@ -149,6 +201,8 @@ void compute_module::build_info_map()
 	std::vector<var_info*>::iterator it;
 	for (it = m_varlist.begin(); it != m_varlist.end(); ++it)
 		(*m_infomap)[ (*it)->name ] = *it;
+
+	m_checks.clear();
 }
 
 bool compute_module::update( const std::string &current_action, float percent_done, float time )
@@ -246,9 +300,31 @@ bool compute_module::is_ssc_array_output( const std::string &name )
 var_data *compute_module::lookup( const std::string &name )
 {
 	if (!m_vartab) throw general_error("invalid data container object reference");
+
+	// inputs that a layered table inherits are read in place from its shared parent,
+	// so compute modules must never write through a pointer to SSC_INPUT data
+	if (m_vartab->parent() && !m_vartab->is_local(name) && is_input_only(name))
+		return const_cast<var_data*>( m_vartab->lookup_const(name) );
+
 	return m_vartab->lookup(name);
 }
 
+bool compute_module::is_input_only( const std::string &name )
+{
+	if (m_infomap != NULL)
+	{
+		unordered_map<std::string, var_info*>::iterator pos = m_infomap->find(name);
+		return pos != m_infomap->end() && pos->second->var_type == SSC_INPUT;
+	}
+
+	std::vector< var_info* >::iterator it;
+	for (it = m_varlist.begin(); it != m_varlist.end(); ++it)
+		if ( (*it)->name == name )
+			return (*it)->var_type == SSC_INPUT;
+
+	return false;
+}
+
 var_data *compute_module::assign( const std::string &name, const var_data &value )
 {
 	if (!m_vartab) throw general_error("invalid data container object reference");
@@ -271,6 +347,44 @@ ssc_number_t *compute_module::allocate( const std::string &name, size_t nrows, s
 	return v->num.data();
 }
 
+static bool wildcard_match( const char *pattern, const char *text )
+{
+	// '*' matches any run of characters, '?' any single character
+	const char *star = NULL, *resume = NULL;
+	while (*text)
+	{
+		if (*pattern == '?' || *pattern == *text) { pattern++; text++; }
+		else if (*pattern == '*') { star = pattern++; resume = text; }
+		else if (star) { pattern = star+1; text = ++resume; }
+		else return false;
+	}
+	while (*pattern == '*') pattern++;
+	return *pattern == 0;
+}
+
+bool compute_module::is_output_requested( const std::string &name )
+{
+	if (!m_select_outputs) return true;
+
+	std::string lcname( util::lower_case(name) );
+	for ( size_t i=0;i<m_outputs_requested.size();i++ )
+		if ( wildcard_match( m_outputs_requested[i].c_str(), lcname.c_str() ) )
+			return true;
+
+	return false;
+}
+
+ssc_number_t *compute_module::allocate_output( const std::string &name, size_t length )
+{
+	if (is_output_requested(name))
+		return allocate( name, length );
+
+	std::vector<ssc_number_t> &scratch = m_output_scratch[length];
+	if (scratch.size() != length)
+		scratch.assign( length, 0.0 );
+	return length > 0 ? &scratch[0] : NULL;
+}
+
 util::matrix_t<ssc_number_t>& compute_module::allocate_matrix( const std::string &name, size_t nrows, size_t ncols )
 {
 	var_data *v = assign(name, var_data());
@@ -288,6 +402,167 @@ var_data &compute_module::value( const std::string &name )
 	return (*v);
 }
 
+compute_module::var_handle compute_module::handle( const std::string &name )
+{
+	return var_handle( name, lookup( name ) );
+}
+
+void compute_module::stream_buffer::advance( size_t index )
+{
+	if (index >= length)
+		throw general_error(util::format("index %d is past the end of output '%s' (%d values)", (int)index, name.c_str(), (int)length));
+	if (index < start)
+		throw general_error(util::format("output '%s' is written in order, index %d was already sent", name.c_str(), (int)index));
+
+	while (index >= start + count)
+	{
+		send();
+		start += count;
+		count = std::min( chunk, length - start );
+		std::fill( window.begin(), window.begin() + count, 0.0 );
+	}
+}
+
+void compute_module::stream_buffer::send()
+{
+	if (handler && !handler->on_output_chunk( name, start, values, count ))
+		throw general_error("output stream '" + name + "' cancelled by the handler");
+}
+
+compute_module::output_stream compute_module::stream_output( const std::string &name, size_t length, size_t chunk )
+{
+	std::unique_ptr<stream_buffer> buf( new stream_buffer );
+	buf->name = name;
+	buf->length = buf->chunk = buf->count = length;
+	buf->start = 0;
+	buf->handler = NULL;
+
+	if (length > 0 && chunk > 0 && m_handler && is_output_requested(name) && m_handler->stream_output(name, length))
+	{
+		if (chunk < length) buf->chunk = buf->count = chunk;
+		buf->window.assign( buf->chunk, 0.0 );
+		buf->values = &buf->window[0];
+		buf->handler = m_handler;
+		m_streamed.push_back( util::lower_case(name) );
+
+		// a value left from an earlier run on the same data would look like this run's result
+		m_vartab->unassign( name );
+	}
+	else
+		buf->values = chunk > 0 ? allocate_output( name, length ) : allocate( name, length );
+
+	m_streams.push_back( std::move(buf) );
+	return output_stream( m_streams.back().get() );
+}
+
+void compute_module::finish_streams()
+{
+	for ( size_t i=0;i<m_streams.size();i++ )
+	{
+		stream_buffer &buf = *m_streams[i];
+		if (buf.handler)
+		{
+			buf.advance( buf.length-1 );
+			buf.send();
+			buf.handler = NULL; // complete, nothing to abort if a later stream fails
+		}
+	}
+	m_streams.clear();
+}
+
+void compute_module::stream_buffer::abort()
+{
+	if (handler) handler->on_output_abort( name, start );
+	handler = NULL;
+}
+
+void compute_module::abort_streams()
+{
+	for ( size_t i=0;i<m_streams.size();i++ )
+		m_streams[i]->abort();
+	m_streams.clear();
+}
+
+bool compute_module::is_streamed( const std::string &name )
+{
+	if (m_streamed.empty()) return false;
+	return std::find( m_streamed.begin(), m_streamed.end(), util::lower_case(name) ) != m_streamed.end();
+}
+
+compute_module::perf_timer::perf_timer( compute_module *cm, const char *name )
+	: m_cm( cm->m_perf ? cm : NULL ), m_name(name)
+{
+	if (m_cm) m_start = std::chrono::steady_clock::now();
+}
+
+void compute_module::perf_timer::stop()
+{
+	if (!m_cm) return;
+
+	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+	double start = std::chrono::duration<double, std::micro>( m_start - m_cm->m_perf_start ).count();
+	double duration = std::chrono::duration<double, std::micro>( end - m_start ).count();
+	perf_add( m_cm->m_perf_phases, m_name, duration * 1e-6 );
+
+	// phases timed inside a loop are still totalled once the trace is full
+	if (m_cm->m_perf_events.size() < 100000)
+	{
+		perf_event ev = { m_name, start, duration };
+		m_cm->m_perf_events.push_back( ev );
+	}
+	m_cm = NULL;
+}
+
+void compute_module::perf_add( std::vector< std::pair<std::string, double> > &list, const char *name, double n )
+{
+	for ( size_t i=0;i<list.size();i++ )
+	{
+		if (list[i].first == name)
+		{
+			list[i].second += n;
+			return;
+		}
+	}
+	list.push_back( std::make_pair( std::string(name), n ) );
+}
+
+void compute_module::finish_perf()
+{
+	double exec_time = std::chrono::duration<double>( std::chrono::steady_clock::now() - m_perf_start ).count();
+	assign( "perf_exec", var_data( (ssc_number_t)exec_time ) );
+	for ( size_t i=0;i<m_perf_phases.size();i++ )
+		assign( "perf_" + m_perf_phases[i].first, var_data( (ssc_number_t)m_perf_phases[i].second ) );
+	for ( size_t i=0;i<m_perf_counters.size();i++ )
+		assign( "perf_" + m_perf_counters[i].first, var_data( (ssc_number_t)m_perf_counters[i].second ) );
+
+	if (m_perf_trace_file.empty()) return;
+
+	std::ofstream trace( m_perf_trace_file.c_str() );
+	if (!trace.is_open())
+	{
+		log( "could not write performance trace file: " + m_perf_trace_file, SSC_WARNING );
+		return;
+	}
+
+	trace.precision(15);
+	trace << "{\"traceEvents\":[\n";
+	trace << "{\"name\":\"exec\",\"cat\":\"ssc\",\"ph\":\"X\",\"ts\":0,\"dur\":" << exec_time * 1e6 << ",\"pid\":1,\"tid\":1}";
+	for ( size_t i=0;i<m_perf_events.size();i++ )
+	{
+		const perf_event &ev = m_perf_events[i];
+		trace << ",\n{\"name\":\"" << ev.name << "\",\"cat\":\"ssc\",\"ph\":\"X\",\"ts\":" << ev.start
+			<< ",\"dur\":" << ev.duration << ",\"pid\":1,\"tid\":1}";
+	}
+	if (!m_perf_counters.empty())
+	{
+		trace << ",\n{\"name\":\"counters\",\"cat\":\"ssc\",\"ph\":\"C\",\"ts\":" << exec_time * 1e6 << ",\"pid\":1,\"tid\":1,\"args\":{";
+		for ( size_t i=0;i<m_perf_counters.size();i++ )
+			trace << (i > 0 ? "," : "") << "\"" << m_perf_counters[i].first << "\":" << m_perf_counters[i].second;
+		trace << "}}";
+	}
+	trace << "\n],\"displayTimeUnit\":\"ms\"}\n";
+}
+
 bool compute_module::is_assigned( const std::string &name )
 {
 	return (lookup(name) != 0);
@@ -491,54 +766,307 @@ bool compute_module::get_matrix(const std::string &name, util::matrix_t<ssc_numb
 
 
 
-ssc_number_t compute_module::get_operand_value( const std::string &input, const std::string &cur_var_name)
-{	
-	if (input.length() < 1) throw check_error(cur_var_name, "input is null to get_operand_value", input);
+/* the required_if and constraints strings of each var_info entry are parsed once into
+   the structures below, and kept for the life of the process.  var_info tables are static
+   arrays, so the address of an entry identifies the module variable it belongs to.
+   anything wrong with a spec is recorded rather than thrown, so the error is still reported
+   at the same point of the check, and only when that part of the check is reached */
+
+struct compute_module::operand
+{
+	operand() : is_var(false), ok(false), value(0) {  }
+	std::string text;
+	bool is_var; // 'text' names a variable whose value is looked up
+	bool ok; // constant converted to a number
+	ssc_number_t value;
+};
+
+struct compute_module::var_check
+{
+	struct term
+	{
+		enum { AND, OR, TEST, INVALID_TERM };
+		enum { NUMERIC, NA, A, ABT, ABF, NAOF };
+		term() : kind(TEST), op(0), builtin(NUMERIC) {  }
+
+		int kind;
+		char op; // '=', '~', '<', '>', or ':' for the built-in tests
+		int builtin;
+		std::string expr; // lower case sub expression, for error messages
+		std::string error; // set for kind INVALID_TERM
+		operand lhs, rhs;
+	};
+
+	struct test
+	{
+		enum { TMYEPW, LOCAL_FILE, MXH_SCHEDULE, BOOLEAN_VALUE, INTEGER_VALUE, TOUSCHED, POSITIVE, PERCENT, FACTOR, TS_M,
+			MIN_VALUE, MAX_VALUE, LENGTH, LENGTH_EQUAL, LENGTH_MULTIPLE_OF, ROWS, COLS, UNCHECKED, INVALID };
+		test() : kind(INVALID), rhs_ok(false), number(0), integer(0) {  }
+
+		int kind;
+		std::string expr; // lower case expression, for error messages
+		std::string rhs; // variable name for length_equal
+		bool rhs_ok; // right hand side converted (and in range, where a range applies)
+		double number;
+		int integer;
+	};
+
+	enum { NEVER, ALWAYS, DEFAULT, EXPRESSION };
+	var_check( const var_info *vi );
+
+	const var_info *source;
+	const char *required_if;
+	const char *constraints;
+
+	int required;
+	std::string reqexpr;
+	var_data default_value;
+	bool default_ok;
+	std::vector< term > terms;
+
+	std::vector< test > tests;
+
+private:
+	static operand compile_operand( const std::string &input );
+	void compile_required();
+	void compile_constraints();
+};
+
+compute_module::var_check::var_check( const var_info *vi )
+	: source(vi), required_if(vi->required_if), constraints(vi->constraints), required(NEVER), default_ok(false)
+{
+	compile_required();
+	compile_constraints();
+}
 
+compute_module::operand compute_module::var_check::compile_operand( const std::string &input )
+{
+	operand op;
+	op.text = input;
 	if (isalpha(input[0]))
+		op.is_var = true;
+	else
+	{
+		double x = 0;
+		op.ok = util::to_double( input, &x );
+		op.value = (ssc_number_t) x;
+	}
+	return op;
+}
+
+void compute_module::var_check::compile_required()
+{
+	if (required_if == NULL || strlen(required_if)==0)
+		return;
+
+	reqexpr = required_if;
+
+	if (reqexpr == "*")
+		required = ALWAYS;
+	else if (reqexpr == "?")
+		required = NEVER;
+	else if (reqexpr.length() > 2 && reqexpr[0] == '?' && reqexpr[1] == '=')
+	{
+		required = DEFAULT;
+		default_ok = var_data::parse( source->data_type, reqexpr.substr(2), default_value );
+	}
+	else
 	{
-		var_data *v = lookup(input);
-		if (!v) throw check_error(cur_var_name, "unassigned referenced",  input );
-		if (v->type != SSC_NUMBER) throw check_error(cur_var_name, "number type required", input );
+		required = EXPRESSION;
+
+		std::string::size_type pos = std::string::npos;
+		std::vector< std::string > expr_list = util::split(util::lower_case(reqexpr), "&|", true, true );
+		for ( std::vector< std::string >::iterator it = expr_list.begin(); it != expr_list.end(); ++it )
+		{
+			term t;
+			t.expr = *it;
+			const std::string &expr = t.expr;
+			if (expr == "&") t.kind = term::AND;
+			else if (expr == "|") t.kind = term::OR;
+			else
+			{
+				if ( (pos=expr.find('=')) != std::string::npos ) t.op = '=';
+				else if ( (pos=expr.find('~')) != std::string::npos) t.op = '~';
+				else if ( (pos=expr.find('<')) != std::string::npos ) t.op = '<';
+				else if ( (pos=expr.find('>')) != std::string::npos ) t.op = '>';
+				else if ( (pos=expr.find(':')) != std::string::npos ) t.op = ':';
+
+				std::string lhs, rhs;
+				if (t.op)
+				{
+					lhs = expr.substr(0, pos);
+					rhs = expr.substr(pos+1);
+				}
+
+				if (!t.op)
+				{
+					t.kind = term::INVALID_TERM;
+					t.error = "invalid operator";
+				}
+				else if (lhs.length() < 1 || rhs.length() < 1)
+				{
+					t.kind = term::INVALID_TERM;
+					t.error = "null lhs or rhs in subexpr";
+				}
+				else if (t.op == ':')
+				{
+					t.rhs.text = rhs;
+					if (lhs == "na") t.builtin = term::NA;
+					else if (lhs == "a") t.builtin = term::A;
+					else if (lhs == "abt") t.builtin = term::ABT;
+					else if (lhs == "abf") t.builtin = term::ABF;
+					else if (lhs == "naof") t.builtin = term::NAOF;
+					else
+					{
+						t.kind = term::INVALID_TERM;
+						t.error = "invalid built-in test";
+					}
+				}
+				else
+				{
+					t.lhs = compile_operand( lhs );
+					t.rhs = compile_operand( rhs );
+				}
+			}
+			terms.push_back( t );
+		}
+	}
+}
+
+void compute_module::var_check::compile_constraints()
+{
+	if (constraints == NULL) return;
+
+	std::vector< std::string > exprlist = util::split( constraints, "," );
+	for ( std::vector<std::string>::iterator it=exprlist.begin(); it!=exprlist.end(); ++it )
+	{
+		test t;
+		t.expr = util::lower_case(*it);
+		const std::string &expr = t.expr;
+		std::string::size_type pos;
+		if (expr == "tmyepw") t.kind = test::TMYEPW;
+		else if (expr == "local_file") t.kind = test::LOCAL_FILE;
+		else if (expr == "mxh_schedule") t.kind = test::MXH_SCHEDULE;
+		else if (expr == "boolean") t.kind = test::BOOLEAN_VALUE;
+		else if (expr == "integer") t.kind = test::INTEGER_VALUE;
+		else if (expr == "tousched") t.kind = test::TOUSCHED;
+		else if (expr == "positive") t.kind = test::POSITIVE;
+		else if (expr == "percent") t.kind = test::PERCENT;
+		else if (expr == "factor") t.kind = test::FACTOR;
+		else if (expr == "ts_m") t.kind = test::TS_M;
+		else if ( (pos=expr.find('=')) != std::string::npos )
+		{
+			std::string name = expr.substr(0, pos);
+			t.rhs = expr.substr(pos+1);
+
+			if (name == "min" || name == "max")
+			{
+				t.kind = (name == "min") ? test::MIN_VALUE : test::MAX_VALUE;
+				t.rhs_ok = util::to_double( t.rhs, &t.number );
+			}
+			else if (name == "length")
+			{
+				t.kind = test::LENGTH;
+				t.rhs_ok = util::to_integer( t.rhs, &t.integer );
+			}
+			else if (name == "length_equal")
+				t.kind = test::LENGTH_EQUAL;
+			else if (name == "length_multiple_of" || name == "rows" || name == "cols")
+			{
+				t.kind = (name == "rows") ? test::ROWS : (name == "cols") ? test::COLS : test::LENGTH_MULTIPLE_OF;
+				t.rhs_ok = util::to_integer( t.rhs, &t.integer ) && t.integer >= 1;
+			}
+			else
+				t.kind = test::UNCHECKED; // other assignments are not tested
+		}
+
+		tests.push_back( t );
+	}
+}
+
+const compute_module::var_check *compute_module::compile_checks( const var_info *vi )
+{
+	static std::mutex cache_lock;
+	static unordered_map< const var_info*, std::unique_ptr<var_check> > cache;
+	static std::vector< std::unique_ptr<var_check> > replaced;
+
+	std::lock_guard<std::mutex> lock( cache_lock );
+	std::unique_ptr<var_check> &chk = cache[vi];
+	if (chk && chk->required_if == vi->required_if && chk->constraints == vi->constraints)
+		return chk.get();
+
+	// an entry whose strings changed since it was compiled gets a new program, while
+	// any module still holding the old one keeps it
+	if (chk) replaced.push_back( std::move(chk) );
+
+	chk.reset( new var_check( vi ) );
+	return chk.get();
+}
+
+void compute_module::resolve_checks()
+{
+	// checks apply the spec that 'info(name)' returns for each variable: the info map entry
+	// if there is one, otherwise the first entry in the list with that name
+	unordered_map< std::string, var_info* > first;
+	for (std::vector<var_info*>::iterator it = m_varlist.begin(); it != m_varlist.end(); ++it)
+		first.insert( std::make_pair( std::string((*it)->name), *it ) );
+
+	m_checks.resize( m_varlist.size() );
+	for (size_t i = 0; i < m_varlist.size(); i++)
+	{
+		const var_info *vi = first[m_varlist[i]->name];
+		if (m_infomap != NULL)
+		{
+			unordered_map<std::string, var_info*>::iterator pos = m_infomap->find(m_varlist[i]->name);
+			if (pos != m_infomap->end())
+				vi = pos->second;
+		}
+		m_checks[i] = compile_checks( vi );
+	}
+}
+
+ssc_number_t compute_module::get_operand_value( const operand &input, const std::string &cur_var_name)
+{
+	if (input.is_var)
+	{
+		var_data *v = lookup(input.text);
+		if (!v) throw check_error(cur_var_name, "unassigned referenced",  input.text );
+		if (v->type != SSC_NUMBER) throw check_error(cur_var_name, "number type required", input.text );
 		return v->num;
 	}
 	else
 	{
-		double x = 0;
-		if (!util::to_double( input, &x )) throw check_error(cur_var_name, "number conversion", input );
-		return (ssc_number_t) x;
+		if (!input.ok) throw check_error(cur_var_name, "number conversion", input.text );
+		return input.value;
 	}
 }
 
-bool compute_module::check_required( const std::string &name )
+bool compute_module::check_required( const std::string &name, const var_check &chk )
 {
 	// only check if the variable is required as input to the simulation context
 	// if it is an input or an inout variable
 
-	const var_info &inf = info(name);
-	if (inf.required_if == NULL || strlen(inf.required_if)==0)
-		return false;
-
-	std::string reqexpr = inf.required_if;
-
-	if (reqexpr == "*")
+	if (chk.required == var_check::ALWAYS)
 	{
 		return true; // Always required
 	}
-	else if (reqexpr == "?")
+	else if (chk.required == var_check::NEVER)
 	{
 		return false; // Always optional
 	}
-	else if (reqexpr.length() > 2 && reqexpr[0] == '?' && reqexpr[1] == '=')
+	else if (chk.required == var_check::DEFAULT)
 	{
 		// optional but has a default value that is assigned if variable is unassigned
 		var_data *v = lookup(name);
 		if (!v)
 		{
-			v = assign(name, m_null_value );
+			if (!chk.default_ok)
+			{
+				assign(name, m_null_value );
+				throw check_error(name, "could not parse default value in required_if spec (" + var_data::type_name(chk.source->data_type) + ")", chk.reqexpr);
+			}
 
-			if ( !var_data::parse( inf.data_type, reqexpr.substr(2), *v ) )
-				throw check_error(name, "could not parse default value in required_if spec (" + var_data::type_name(inf.data_type) + ")", reqexpr);
+			assign(name, chk.default_value );
 		}
 
 		return true; // a default value has been assigned, so this variable is effectively always required
@@ -546,15 +1074,12 @@ bool compute_module::check_required( const std::string &name )
 	else
 	{
 		// run tests
-		std::string::size_type pos = std::string::npos;
-		std::vector< std::string > expr_list = util::split(util::lower_case(reqexpr), "&|", true, true );
-		
 		int cur_result = -1;
 		char cur_cond_oper = 0;
-		for ( std::vector< std::string >::iterator it = expr_list.begin(); it != expr_list.end(); ++it )
+		for ( std::vector< var_check::term >::const_iterator it = chk.terms.begin(); it != chk.terms.end(); ++it )
 		{
-			std::string expr = *it;
-			if (expr == "&")
+			const var_check::term &term = *it;
+			if (term.kind == var_check::term::AND)
 			{
 				if (cur_result == 0) // short circuit evaluation
 					break;
@@ -562,7 +1087,7 @@ bool compute_module::check_required( const std::string &name )
 				cur_cond_oper = '&';
 				continue;
 			}
-			else if (expr == "|")
+			else if (term.kind == var_check::term::OR)
 			{
 				if (cur_result > 0) // short circuit evaluation
 					break;
@@ -572,74 +1097,37 @@ bool compute_module::check_required( const std::string &name )
 			}
 			else
 			{
-				int expr_result = 0;
-				char op = 0;
-				if ( (pos=expr.find('=')) != std::string::npos ) op = '=';
-				else if ( (pos=expr.find('~')) != std::string::npos) op = '~';
-				else if ( (pos=expr.find('<')) != std::string::npos ) op = '<';
-				else if ( (pos=expr.find('>')) != std::string::npos ) op = '>';
-				else if ( (pos=expr.find(':')) != std::string::npos ) op = ':';
+				if (term.kind == var_check::term::INVALID_TERM) throw check_error(name, term.error, term.expr);
 
-				if (!op) throw check_error(name, "invalid operator", expr );
-
-				std::string lhs = expr.substr(0, pos);
-				std::string rhs = expr.substr(pos+1);
-				
-				if (lhs.length() < 1 || rhs.length() < 1) throw check_error(name, "null lhs or rhs in subexpr", expr);
-
-				if (op == ':')
+				int expr_result = 0;
+				if (term.op == ':')
 				{
 					/* handle built-in test operators */
-
-					if (lhs == "na") // check if variable name in 'rhs' is not assigned
-					{
-						expr_result = lookup(rhs)==NULL ? 1 : 0;
-					}
-					else if (lhs == "a") // check if variable name in 'rhs' is assigned
-					{
-						expr_result = lookup(rhs)!=NULL ? 1 : 0;
-					}
-					else if (lhs == "abt") // check if variable in 'rhs' is assigned, boolean type, and value true
+					var_data *v = lookup(term.rhs.text);
+					switch(term.builtin)
 					{
-						var_data *v;
-						if ( ((v = lookup(rhs) ) != 0) && v->type == SSC_NUMBER &&  ((int)v->num) != 0)
-							return 1;
-						else
-							return 0;
-					}
-					else if (lhs == "abf") // check if variable in 'rhs' is assigned, boolean type, and value false
-					{
-						var_data *v;
-						if ( ((v = lookup(rhs)) !=0) && v->type == SSC_NUMBER &&  ((int)v->num) == 0)
-							return 1;
-						else
-							return 0;
-					}
-					else if (lhs == "naof") // check if variable is not assigned OR boolean value is 'false'
-					{
-						var_data *v;
-						if ( (v = lookup(rhs)) == 0 ) return 1;
-						if ( v->type == SSC_NUMBER && ((int)v->num)==0 ) return 1;
-
-						return 0;
-					}
-					else
-					{
-						throw check_error(name, "invalid built-in test", expr);
+					case var_check::term::NA: expr_result = v==NULL ? 1 : 0; break; // check if variable name in 'rhs' is not assigned
+					case var_check::term::A: expr_result = v!=NULL ? 1 : 0; break; // check if variable name in 'rhs' is assigned
+					case var_check::term::ABT: // check if variable in 'rhs' is assigned, boolean type, and value true
+						return v != 0 && v->type == SSC_NUMBER && ((int)v->num) != 0;
+					case var_check::term::ABF: // check if variable in 'rhs' is assigned, boolean type, and value false
+						return v != 0 && v->type == SSC_NUMBER && ((int)v->num) == 0;
+					case var_check::term::NAOF: // check if variable is not assigned OR boolean value is 'false'
+						return v == 0 || (v->type == SSC_NUMBER && ((int)v->num)==0);
 					}
 				}
 				else
 				{
-					ssc_number_t lhs_val = get_operand_value(lhs,name);
-					ssc_number_t rhs_val = get_operand_value(rhs,name);
+					ssc_number_t lhs_val = get_operand_value(term.lhs,name);
+					ssc_number_t rhs_val = get_operand_value(term.rhs,name);
 
-					switch(op)
+					switch(term.op)
 					{
 					case '=': expr_result = lhs_val == rhs_val ? 1 : 0 ; break;
 					case '~': expr_result = lhs_val != rhs_val ? 1 : 0; break;
 					case '<': expr_result = lhs_val < rhs_val ? 1 : 0 ; break;
 					case '>': expr_result = lhs_val > rhs_val ? 1 : 0 ; break;
-					default: throw check_error(name, "invalid numerical operator", expr);
+					default: throw check_error(name, "invalid numerical operator", term.expr);
 					}
 				}
 
@@ -657,32 +1145,28 @@ bool compute_module::check_required( const std::string &name )
 				}
 
 				else
-					throw check_error(name, "invalid evaluation sequence", reqexpr);
+					throw check_error(name, "invalid evaluation sequence", chk.reqexpr);
 			}
 		}
 
 		return cur_result != 0 ? true : false;
 	}
-	
-	return false;
 }
 
-bool compute_module::check_constraints( const std::string &name, std::string &fail_text)
+bool compute_module::check_constraints( const std::string &name, const var_check &chk, std::string &fail_text)
 {
 #define fail_constraint( str ) { fail_text = "fail("+name+", "+expr+"): "+std::string(str); return false; }
 
-	const var_info &inf = info(name);
-
-	if (inf.constraints == NULL) return true; // pass if no constraints defined
+	if (chk.tests.empty()) return true; // pass if no constraints defined
 
 	var_data &dat = value(name);
-	
-	std::vector< std::string > exprlist = util::split( inf.constraints, "," );
-	for ( std::vector<std::string>::iterator it=exprlist.begin(); it!=exprlist.end(); ++it )
+
+	for ( std::vector<var_check::test>::const_iterator it=chk.tests.begin(); it!=chk.tests.end(); ++it )
 	{
-		std::string::size_type pos;
-		std::string expr = util::lower_case(*it);
-		if (expr == "tmyepw")
+		const std::string &expr = it->expr;
+		switch( it->kind )
+		{
+		case var_check::test::TMYEPW:
 		{
 			if (dat.type != SSC_STRING || dat.str.length() <= 4)
 				fail_constraint("string data type required with length greater than 4 chars: " + dat.str);
@@ -690,8 +1174,9 @@ bool compute_module::check_constraints( const std::string &name, std::string &fa
 			std::string ext = util::lower_case( dat.str.substr( dat.str.length()-3 ) );
 			if (ext != "tm2" || ext != "tm3" || ext != "epw" || ext != "csv")
 				fail_constraint("file extension was not tm2,tm3,epw,csv: " + ext);
+			break;
 		}
-		else if (expr == "local_file")
+		case var_check::test::LOCAL_FILE:
 		{
 			if (dat.type != SSC_STRING)
 				fail_constraint("string data type required");
@@ -701,20 +1186,20 @@ bool compute_module::check_constraints( const std::string &name, std::string &fa
 				f_in.close();
 			else
 				fail_constraint("could not open for read: '" + dat.str + "'");
+			break;
 		}
-		else if (expr == "mxh_schedule")
-		{
+		case var_check::test::MXH_SCHEDULE:
 			if (dat.type != SSC_STRING)
 				fail_constraint("string data type required");
 
 			if (dat.str.length() != 288)
 				fail_constraint( "288 characters required (24x12) but " + util::to_string((int)dat.str.length()) + " found" );
-			
+
 			for ( std::string::size_type i=0;i<dat.str.length(); i++)
-				if ( dat.str[i] < '0' || dat.str[i] > '9' ) 
+				if ( dat.str[i] < '0' || dat.str[i] > '9' )
 					fail_constraint( util::format("invalid character %c at %d", (char)dat.str[i], (int)i) );
-		}
-		else if (expr == "boolean")
+			break;
+		case var_check::test::BOOLEAN_VALUE:
 		{
 			if (dat.type != SSC_NUMBER)
 				fail_constraint("number data type required");
@@ -722,17 +1207,16 @@ bool compute_module::check_constraints( const std::string &name, std::string &fa
 			int val = (int)dat.num;
 			if (val != 0 && val != 1)
 				fail_constraint("value was not 0 nor 1");
+			break;
 		}
-		else if (expr == "integer")
-		{
+		case var_check::test::INTEGER_VALUE:
 			if (dat.type != SSC_NUMBER)
 				fail_constraint("number data type required");
 
 			if ( ((ssc_number_t)((int)dat.num)) != dat.num )
 				fail_constraint("number could not be interpreted as an integer: " + util::to_string( (double) dat.num ));
-		}
-		else if (expr == "tousched")
-		{
+			break;
+		case var_check::test::TOUSCHED:
 			if (dat.type != SSC_STRING)
 				fail_constraint("string data type required");
 
@@ -741,30 +1225,26 @@ bool compute_module::check_constraints( const std::string &name, std::string &fa
 
 			for (std::string::size_type i=0;i<dat.str.length();i++)
 			{
-//				if ( dat.str[i] < '1' || dat.str[i] > '9' )
 				if ( util::schedule_char_to_int(dat.str[i]) == 0 )
 					fail_constraint("all digits must be between 1 and 9, inclusive");
 			}
-		}
-		else if (expr == "positive")
-		{
+			break;
+		case var_check::test::POSITIVE:
 			if (dat.type != SSC_NUMBER) throw constraint_error(name, "cannot test for positive with non-numeric type", expr);
 			if (dat.num <= 0.0)
 				fail_constraint( util::to_string( (double)dat.num ) );
-		}
-		else if (expr == "percent")
-		{
+			break;
+		case var_check::test::PERCENT:
 			if (dat.type != SSC_NUMBER) throw constraint_error(name, "cannot test for percent (%) constraint with non-numeric type", expr);
 			if (dat.num < 0.0 || dat.num > 100.0)
 				fail_constraint( util::to_string( (double)dat.num ) );
-		}
-		else if (expr == "factor")
-		{
+			break;
+		case var_check::test::FACTOR:
 			if (dat.type != SSC_NUMBER) throw constraint_error(name, "cannot test for factor (0..1) constraint with non-numeric type", expr);
 			if (dat.num < 0.0 || dat.num > 1.0)
 				fail_constraint( util::to_string( (double)dat.num ) );
-		}
-		else if (expr == "ts_m")
+			break;
+		case var_check::test::TS_M:
 		{
 			if (dat.type != SSC_NUMBER)
 				fail_constraint("number data type required");
@@ -780,86 +1260,71 @@ bool compute_module::check_constraints( const std::string &name, std::string &fa
 			{
 				fail_constraint("time step must be 1,5,10,15,30,60 minutes");
 			}
+			break;
 		}
-		else if ( (pos=expr.find('=')) != std::string::npos )
+		case var_check::test::MIN_VALUE:
+			if (dat.type != SSC_NUMBER) throw constraint_error(name, "cannot test for min with non-numeric type", expr);
+			if (!it->rhs_ok) throw constraint_error(name, "test for min requires a number value", expr);
+			if ( dat.num < (ssc_number_t)it->number )
+				fail_constraint( util::to_string( (double)dat.num ) );
+			break;
+		case var_check::test::MAX_VALUE:
+			if (dat.type != SSC_NUMBER) throw constraint_error(name, "cannot test for max with non-numeric type", expr);
+			if (!it->rhs_ok) throw constraint_error(name, "test for max requires a numeric value", expr);
+			if (dat.num > (ssc_number_t)it->number )
+				fail_constraint( util::to_string( (double)dat.num ) );
+			break;
+		case var_check::test::LENGTH:
+			if (dat.type != SSC_ARRAY) throw constraint_error(name, "cannot test for length with non-array type", expr);
+			if (!it->rhs_ok) throw constraint_error(name, "test for length requires an integer value", expr);
+			if (dat.num.length() != (size_t)it->integer)
+				fail_constraint( util::to_string( (int)dat.num.length() ) );
+			break;
+		case var_check::test::LENGTH_EQUAL:
 		{
-			std::string test = expr.substr(0, pos);
-			std::string rhs = expr.substr(pos+1);
-
-			if (test == "min")
+			if (dat.type != SSC_ARRAY) throw constraint_error(name, "cannot test for length_equal with non-array type", expr);
+			var_data *other = lookup( it->rhs );
+			if (!other) throw constraint_error(name, "length_equal cannot find variable to test against", expr);
+			if (other->type == SSC_ARRAY)
 			{
-				if (dat.type != SSC_NUMBER) throw constraint_error(name, "cannot test for min with non-numeric type", expr);
-				double minval = 0;
-				if (!util::to_double( rhs, &minval )) throw constraint_error(name, "test for min requires a number value", expr);
-				if ( dat.num < (ssc_number_t)minval )
-					fail_constraint( util::to_string( (double)dat.num ) );
+				if (dat.num.length() != other->num.length())
+					fail_constraint( util::to_string( (int) other->num.length() ) );
 			}
-			else if (test == "max")
+			else if (other->type == SSC_NUMBER)
 			{
-				if (dat.type != SSC_NUMBER) throw constraint_error(name, "cannot test for max with non-numeric type", expr);
-				double maxval = 0;
-				if (!util::to_double( rhs, &maxval )) throw constraint_error(name, "test for max requires a numeric value", expr);
-				if (dat.num > (ssc_number_t)maxval )
-					fail_constraint( util::to_string( (double)dat.num ) );
-			}
-			else if (test == "length")
-			{
-				if (dat.type != SSC_ARRAY) throw constraint_error(name, "cannot test for length with non-array type", expr);
-				int lenval = 0;
-				if (!util::to_integer( rhs, &lenval )) throw constraint_error(name, "test for length requires an integer value", expr);
-				size_t len = (size_t)lenval;
-				if (dat.num.length() != len)
-					fail_constraint( util::to_string( (int)dat.num.length() ) );
-			}
-			else if (test == "length_equal")
-			{
-				if (dat.type != SSC_ARRAY) throw constraint_error(name, "cannot test for length_equal with non-array type", expr);
-				var_data *other = lookup( rhs );
-				if (!other) throw constraint_error(name, "length_equal cannot find variable to test against", expr);
-				if (other->type == SSC_ARRAY)
-				{
-					if (dat.num.length() != other->num.length())
-						fail_constraint( util::to_string( (int) other->num.length() ) );
-				}
-				else if (other->type == SSC_NUMBER)
-				{
-					if (dat.num.length() != (size_t)(ssc_number_t)other->num)
-						fail_constraint( util::to_string( (int) other->num ) );
-				}
-				else throw constraint_error(name, "length_equal must specify a number or array variable to test against", expr);
-			}
-			else if (test == "length_multiple_of")
-			{
-				if (dat.type != SSC_ARRAY) throw constraint_error(name, "cannot test for length_multiple_of with non-array type", expr);
-				int lenval = 0;
-				if (!util::to_integer( rhs, &lenval ) || lenval < 1) throw constraint_error(name, "test for length_multiple_of requires a positive integer value", expr);
-				size_t len = (size_t)lenval;
-				size_t multiplier = dat.num.length() / len;
-				if ( dat.num.length() < len || len*multiplier != dat.num.length() )
-					fail_constraint( util::to_string( (int)dat.num.length() ) );
-			}
-			else if (test == "rows")
-			{
-				if (dat.type != SSC_MATRIX) throw constraint_error(name, "cannot test for rows with non-matrix type", expr);
-				int nrows = 0;
-				if (!util::to_integer( rhs, &nrows ) || nrows < 1) throw constraint_error(name, "test for rows requires a positive integer value", expr);
-				if ( dat.num.nrows() != (size_t)nrows )
-					fail_constraint( util::to_string( (int)dat.num.nrows() ) );
-			}
-			else if (test == "cols")
-			{
-				if (dat.type != SSC_MATRIX) throw constraint_error(name, "cannot test for cols with non-matrix type", expr);
-				int ncols = 0;
-				if (!util::to_integer( rhs, &ncols) || ncols < 1) throw constraint_error(name, "test for cols requires a positive integer value", expr);
-				if ( dat.num.ncols() != (size_t)ncols )
-					fail_constraint( util::to_string( (int)dat.num.ncols() ) );
+				if (dat.num.length() != (size_t)(ssc_number_t)other->num)
+					fail_constraint( util::to_string( (int) other->num ) );
 			}
+			else throw constraint_error(name, "length_equal must specify a number or array variable to test against", expr);
+			break;
 		}
-		else
+		case var_check::test::LENGTH_MULTIPLE_OF:
 		{
+			if (dat.type != SSC_ARRAY) throw constraint_error(name, "cannot test for length_multiple_of with non-array type", expr);
+			if (!it->rhs_ok) throw constraint_error(name, "test for length_multiple_of requires a positive integer value", expr);
+			size_t len = (size_t)it->integer;
+			size_t multiplier = dat.num.length() / len;
+			if ( dat.num.length() < len || len*multiplier != dat.num.length() )
+				fail_constraint( util::to_string( (int)dat.num.length() ) );
+			break;
+		}
+		case var_check::test::ROWS:
+			if (dat.type != SSC_MATRIX) throw constraint_error(name, "cannot test for rows with non-matrix type", expr);
+			if (!it->rhs_ok) throw constraint_error(name, "test for rows requires a positive integer value", expr);
+			if ( dat.num.nrows() != (size_t)it->integer )
+				fail_constraint( util::to_string( (int)dat.num.nrows() ) );
+			break;
+		case var_check::test::COLS:
+			if (dat.type != SSC_MATRIX) throw constraint_error(name, "cannot test for cols with non-matrix type", expr);
+			if (!it->rhs_ok) throw constraint_error(name, "test for cols requires a positive integer value", expr);
+			if ( dat.num.ncols() != (size_t)it->integer )
+				fail_constraint( util::to_string( (int)dat.num.ncols() ) );
+			break;
+		case var_check::test::UNCHECKED:
+			break;
+		default:
 			throw constraint_error( name, "invalid test or expression", expr );
 		}
-
 	}
 
 	// all constraints passed fine
@@ -33,6 +33,8 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <cmath>
 #include <limits>
 #include <memory>
+#include <map>
+#include <chrono>
 
 /* Macros for C++11 support */
 template <typename T>
@@ -233,6 +235,16 @@ public:
 	ssc_number_t *allocate( const std::string &name, size_t length );
 	ssc_number_t *allocate( const std::string &name, size_t nrows, size_t ncols );
 	util::matrix_t<ssc_number_t>& allocate_matrix( const std::string &name, size_t nrows, size_t ncols );
+
+	/* output selection: when the 'outputs_requested' string input is assigned, it holds a comma
+	   separated list of output names or patterns ('*' and '?' wildcards, case insensitive), and
+	   only matching outputs are required at postcheck.  allocate_output(..) allocates a requested
+	   output like allocate(..), otherwise it returns a scratch buffer shared with every other
+	   unrequested output of the same length, so it may only be used for series that the module
+	   writes but never reads back */
+	bool is_output_requested( const std::string &name );
+	ssc_number_t *allocate_output( const std::string &name, size_t length );
+
 	var_data &value( const std::string &name );
 	bool is_assigned( const std::string &name );
 	size_t as_unsigned_long(const std::string &name);
@@ -263,20 +275,174 @@ public:
 	ssc_number_t accumulate_annual_for_year(const std::string &hourly_var, const std::string &annual_var, double scale, size_t step_per_hour, size_t year = 1, size_t steps = 8760);
 	ssc_number_t *accumulate_monthly_for_year(const std::string &hourly_var, const std::string &annual_var, double scale, size_t step_per_hour, size_t year = 1);
 
+	/* a var_handle is a variable name resolved once to its entry in the data container,
+	   for values that are read inside loops.  var_table keeps each entry at the same address
+	   until it is unassigned, so typed access through a handle needs no string hashing.
+	   a handle is valid for the rest of the call to 'compute(..)' that resolved it, as long
+	   as the variable is not unassigned or renamed in the meantime */
+	class var_handle
+	{
+	public:
+		var_handle() : m_data(NULL) {  }
+
+		bool is_assigned() const { return m_data != NULL; }
+		const std::string &name() const { return m_name; }
+
+		var_data &value() const
+		{
+			if (!m_data) throw general_error("ssc variable does not exist: '" + m_name + "'");
+			return *m_data;
+		}
+
+		int as_integer() const { return (int) number("integer"); }
+		bool as_boolean() const { return number("boolean") != 0; }
+		ssc_number_t as_number() const { return number("ssc_number_t"); }
+		double as_double() const { return (double) number("double"); }
+		ssc_number_t *as_array( size_t *count ) const
+		{
+			var_data &x = value();
+			if (x.type != SSC_ARRAY) throw cast_error("array", x, m_name);
+			if (count) *count = x.num.length();
+			return x.num.data();
+		}
+
+	private:
+		friend class compute_module;
+		var_handle( const std::string &name, var_data *data ) : m_name(name), m_data(data) {  }
+
+		ssc_number_t number( const char *target_type ) const
+		{
+			var_data &x = value();
+			if (x.type != SSC_NUMBER) throw cast_error(target_type, x, m_name);
+			return x.num.value();
+		}
+
+		std::string m_name;
+		var_data *m_data;
+	};
+
+	/* resolves a name to a handle.  the handle of an unassigned variable reports
+	   is_assigned() as false, and throws like 'value(..)' when it is read */
+	var_handle handle( const std::string &name );
+
+	/* an output_stream is a time series output of known length that is written in index order.
+	   when the handler asks to stream the output (see handler_interface::stream_output), only a
+	   window of 'chunk' values is held, and each window is sent to the handler once a later index
+	   is written, so the series is never held whole or put in the data table.  otherwise the stream
+	   writes straight into the array from allocate_output(..).  an index may be written and read
+	   back until an index in a later window is written; going back to an earlier window throws.
+	   the last window is sent when exec() returns.  if exec() fails or throws instead, the window
+	   still held is dropped and the handler is told through on_output_abort(..) */
+	struct stream_buffer
+	{
+		std::string name;
+		size_t length, chunk;
+		size_t start, count; // the window of the series held in 'values'
+		ssc_number_t *values;
+		std::vector< ssc_number_t > window;
+		handler_interface *handler; // NULL unless streamed
+
+		void advance( size_t index );
+		void send();
+		void abort();
+	};
+
+	class output_stream
+	{
+	public:
+		output_stream() : m_buf(NULL) {  }
+
+		bool is_allocated() const { return m_buf != NULL; }
+
+		ssc_number_t &operator[]( size_t index ) const
+		{
+			if (index - m_buf->start >= m_buf->count) m_buf->advance( index );
+			return m_buf->values[ index - m_buf->start ];
+		}
+
+	private:
+		friend class compute_module;
+		output_stream( stream_buffer *buf ) : m_buf(buf) {  }
+		stream_buffer *m_buf;
+	};
+
+	/* 'chunk' is the number of values sent to a streaming handler at a time, for example
+	   the number of steps in a year.  a chunk of 0 always keeps the series in the data table,
+	   for outputs that the module reads back.  the stream is valid for the rest of the call to exec() */
+	output_stream stream_output( const std::string &name, size_t length, size_t chunk );
+
+	/* performance instrumentation: when the 'perf_outputs' input is true or 'perf_trace_file' is
+	   assigned (see vtab_perf_instrumentation), a perf_timer accumulates the wall time of its scope
+	   under a phase name and perf_count(..) accumulates a counter.  after exec, or when it fails, each phase is reported
+	   in seconds and each counter as a number output 'perf_<name>', with the time in exec as 'perf_exec'.
+	   the phases are also written to the trace file as chrome trace events (chrome://tracing or
+	   ui.perfetto.dev).  when instrumentation is off a timer costs a test on construction and destruction */
+	class perf_timer
+	{
+	public:
+		perf_timer( compute_module *cm, const char *name );
+		~perf_timer() { stop(); }
+		void stop();
+	private:
+		compute_module *m_cm; // NULL when off or stopped
+		const char *m_name;
+		std::chrono::steady_clock::time_point m_start;
+	};
+
+	bool perf_enabled() const { return m_perf; }
+	void perf_count( const char *name, double n = 1 ) { if (m_perf) perf_add( m_perf_counters, name, n ); }
+
 private:
 	// called by 'compute' as necessary for precheck and postcheck
 	bool verify(const std::string &phase, int var_types);
+
+	/* the 'required_if' and 'constraints' strings of a var_info entry, parsed once
+	   and shared by every instance of the module (see core.cpp) */
+	struct var_check;
+	static const var_check *compile_checks( const var_info *vi );
+	void resolve_checks();
 	
-	bool check_required( const std::string &name );
-	bool check_constraints( const std::string &name, std::string &fail_text );
+	bool check_required( const std::string &name, const var_check &chk );
+	bool check_constraints( const std::string &name, const var_check &chk, std::string &fail_text );
 
 	// helper functions for check_required
-	ssc_number_t get_operand_value( const std::string &input, const std::string &cur_var_name );
+	struct operand;
+	ssc_number_t get_operand_value( const operand &input, const std::string &cur_var_name );
+
+	// true if the variable is declared as SSC_INPUT only, so it can be read from a shared parent table
+	bool is_input_only( const std::string &name );
 
 	var_data m_null_value;
 	
 	std::vector< var_info* > m_varlist;
+	std::vector< const var_check* > m_checks; // parallel to m_varlist, empty until the next verify when the list changes
 	std::vector< log_item > m_loglist;
+
+	// output selection, set up at the start of each call to 'compute(..)'
+	bool m_select_outputs;
+	std::vector< std::string > m_outputs_requested; // lower case patterns
+	std::map< size_t, std::vector<ssc_number_t> > m_output_scratch;
+
+	// output streams opened during exec, finished and released before postcheck
+	std::vector< std::unique_ptr<stream_buffer> > m_streams;
+	std::vector< std::string > m_streamed; // lower case names of outputs sent to the handler
+	void finish_streams();
+	void abort_streams();
+	bool is_streamed( const std::string &name );
+
+	// performance instrumentation, set up at the start of each call to 'compute(..)'
+	struct perf_event
+	{
+		const char *name;
+		double start, duration; // microseconds from the start of exec
+	};
+	bool m_perf;
+	std::string m_perf_trace_file;
+	std::chrono::steady_clock::time_point m_perf_start;
+	std::vector< std::pair<std::string, double> > m_perf_phases, m_perf_counters; // in order of first use
+	std::vector< perf_event > m_perf_events;
+	static void perf_add( std::vector< std::pair<std::string, double> > &list, const char *name, double n );
+	void finish_perf();
 	
 	unordered_map< std::string, var_info* > *m_infomap;
 
@@ -297,6 +463,17 @@ public:
 	virtual ~handler_interface() {  /* nothing to do */ }
 	virtual void on_log( const std::string &text, int type, float time ) = 0;
 	virtual bool on_update( const std::string &text, float percent_done, float time ) = 0;
+
+	/* output streaming: return true to receive the time series output 'name' of 'length' values
+	   in order through on_output_chunk(..) as the module computes it, instead of finding it in
+	   the data table afterwards.  only outputs that a module writes through an output_stream
+	   are offered.  'offset' is the index of values[0] in the full series, and the values are
+	   only valid during the call.  returning false from on_output_chunk cancels the run.  a series
+	   is complete once its last value is sent; when the run fails first, on_output_abort(..) is
+	   called instead with the number of values that were sent, and no more values follow */
+	virtual bool stream_output( const std::string &, size_t ) { return false; }
+	virtual bool on_output_chunk( const std::string &, size_t, const ssc_number_t *, size_t ) { return true; }
+	virtual void on_output_abort( const std::string &, size_t ) {  }
 //	virtual bool on_exec( const std::string &command, const std::string &workdir ) = 0;
 
 	compute_module *module() { return m_cm; }
@@ -571,6 +571,14 @@ static bool optimize_callback( simulation_info *siminfo, void *data )
     return true;
 }
 
+ssc_number_t *allocate_reported_output(compute_module *cm, const std::string &name, size_t n_steps)
+{
+    if (!cm->is_output_requested(name))
+        return NULL;
+
+    return cm->allocate(name, n_steps);
+}
+
 bool are_values_sig_different(double v1, double v2, double tol)
 {
     if (fabs(v1) < tol || fabs(v2) < tol)
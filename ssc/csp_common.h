@@ -62,6 +62,9 @@ public:
 
 bool are_values_sig_different(double v1, double v2, double tol);
 
+// allocates a reported time series output, or returns NULL so the output is left unreported when 'outputs_requested' excludes it
+ssc_number_t *allocate_reported_output(compute_module *cm, const std::string &name, size_t n_steps);
+
 bool ssc_cmod_solarpilot_callback(simulation_info *siminfo, void *data);
 
 extern var_info vtab_sco2_design[];
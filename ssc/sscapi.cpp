@@ -50,9 +50,13 @@
 #include <stdio.h>
 #include <cstring>
 #include <iostream>
+#include <atomic>
+#include <memory>
 
 #include "core.h"
 #include "sscapi.h"
+#include "lib_weatherfile.h"
+#include "lib_windfile.h"
 
 #pragma warning (disable : 4706 )
 
@@ -286,6 +290,13 @@ SSCEXPORT ssc_data_t ssc_data_create()
 	return static_cast<ssc_data_t>( new var_table );
 }
 
+SSCEXPORT ssc_data_t ssc_data_create_overlay( ssc_data_t p_base )
+{
+	var_table *base = static_cast<var_table*>(p_base);
+	if (!base) return 0;
+	return static_cast<ssc_data_t>( new var_table( base ) );
+}
+
 SSCEXPORT void ssc_data_free( ssc_data_t p_data )
 {
 	var_table *vt = static_cast<var_table*>(p_data);
@@ -337,6 +348,25 @@ SSCEXPORT const char *ssc_data_next( ssc_data_t p_data ) // returns the next nam
 	return vt->next();
 }
 
+SSCEXPORT ssc_bool_t ssc_data_write( ssc_data_t p_data, const char *file )
+{
+	var_table *vt = static_cast<var_table*>(p_data);
+	if (!vt || !file) return 0;
+	return vt->write_binary( file ) ? 1 : 0;
+}
+
+SSCEXPORT ssc_data_t ssc_data_read( const char *file )
+{
+	if (!file) return 0;
+	var_table *vt = new var_table;
+	if (!vt->read_binary( file ))
+	{
+		delete vt;
+		return 0;
+	}
+	return static_cast<ssc_data_t>( vt );
+}
+
 SSCEXPORT void ssc_data_set_string( ssc_data_t p_data, const char *name, const char *value )
 {
 	var_table *vt = static_cast<var_table*>(p_data);
@@ -375,6 +405,54 @@ SSCEXPORT void ssc_data_set_table( ssc_data_t p_data, const char *name, ssc_data
 	dat->table = *value;  // invokes operator= for deep copy
 }
 
+SSCEXPORT void ssc_data_set_array_external( ssc_data_t p_data, const char *name, ssc_number_t *pvalues, int length, void (*pf_release)( ssc_number_t *pvalues, void *user_data ), void *user_data )
+{
+	var_table *vt = static_cast<var_table*>(p_data);
+	if (!vt || !pvalues || length < 1) return;
+	var_data *dat = vt->assign( name, var_data() );
+	dat->type = SSC_ARRAY;
+	dat->num.assign_external( pvalues, 1, (size_t)length, pf_release, user_data );
+}
+
+SSCEXPORT void ssc_data_set_matrix_external( ssc_data_t p_data, const char *name, ssc_number_t *pvalues, int nrows, int ncols, void (*pf_release)( ssc_number_t *pvalues, void *user_data ), void *user_data )
+{
+	var_table *vt = static_cast<var_table*>(p_data);
+	if (!vt || !pvalues || nrows < 1 || ncols < 1) return;
+	var_data *dat = vt->assign( name, var_data() );
+	dat->type = SSC_MATRIX;
+	dat->num.assign_external( pvalues, (size_t)nrows, (size_t)ncols, pf_release, user_data );
+}
+
+SSCEXPORT ssc_number_t *ssc_data_take_array( ssc_data_t p_data, const char *name, int *length )
+{
+	var_table *vt = static_cast<var_table*>(p_data);
+	if (!vt) return 0;
+	var_data *dat = vt->lookup(name);
+	if (!dat || dat->type != SSC_ARRAY) return 0;
+	if (length) *length = (int) dat->num.length();
+	ssc_number_t *p = dat->num.release_data();
+	vt->unassign(name);
+	return p;
+}
+
+SSCEXPORT ssc_number_t *ssc_data_take_matrix( ssc_data_t p_data, const char *name, int *nrows, int *ncols )
+{
+	var_table *vt = static_cast<var_table*>(p_data);
+	if (!vt) return 0;
+	var_data *dat = vt->lookup(name);
+	if (!dat || dat->type != SSC_MATRIX) return 0;
+	if (nrows) *nrows = (int) dat->num.nrows();
+	if (ncols) *ncols = (int) dat->num.ncols();
+	ssc_number_t *p = dat->num.release_data();
+	vt->unassign(name);
+	return p;
+}
+
+SSCEXPORT void ssc_data_free_array( ssc_number_t *pvalues )
+{
+	delete [] pvalues;
+}
+
 SSCEXPORT const char *ssc_data_get_string( ssc_data_t p_data, const char *name )
 {
 	var_table *vt = static_cast<var_table*>(p_data);
@@ -586,7 +664,8 @@ SSCEXPORT ssc_bool_t ssc_module_exec_simple( const char *name, ssc_data_t p_data
 
 SSCEXPORT const char *ssc_module_exec_simple_nothread( const char *name, ssc_data_t p_data )
 {
-static char p_internal_buf[256];
+// one buffer per calling thread, so concurrent callers never see each other's messages
+static thread_local char p_internal_buf[256];
 
 	ssc_module_t p_mod = ssc_module_create( name );
 	if (!p_mod) return 0;
@@ -606,6 +685,7 @@ static char p_internal_buf[256];
 			if (type == SSC_ERROR)
 			{
 				strncpy( p_internal_buf, text, 255 );
+				p_internal_buf[255] = 0;
 				break;
 			}
 			i++;
@@ -616,16 +696,23 @@ static char p_internal_buf[256];
 	return result ? 0 : p_internal_buf;
 }
 
-static int sg_defaultPrint = 1;
+// process-wide setting, read by every ssc_module_exec call from any thread
+static std::atomic<int> sg_defaultPrint( 1 );
 
 SSCEXPORT void ssc_module_exec_set_print( int print )
 {
-	sg_defaultPrint = print;
+	sg_defaultPrint.store( print );
+}
+
+SSCEXPORT void ssc_weather_cache_set_limit( int max_files )
+{
+	weatherfile::set_cache_limit( max_files > 0 ? (size_t)max_files : 0 );
+	windfile::set_cache_limit( max_files > 0 ? (size_t)max_files : 0 );
 }
 
 SSCEXPORT ssc_bool_t ssc_module_exec( ssc_module_t p_mod, ssc_data_t p_data )
 {
-	return ssc_module_exec_with_handler( p_mod, p_data, sg_defaultPrint ? default_internal_handler : default_internal_handler_no_print, 0 );
+	return ssc_module_exec_with_handler( p_mod, p_data, sg_defaultPrint.load() ? default_internal_handler : default_internal_handler_no_print, 0 );
 }
 
 class default_exec_handler : public handler_interface
@@ -684,6 +771,142 @@ SSCEXPORT ssc_bool_t ssc_module_exec_with_handler(
 	return cm->compute( &h, vt ) ? 1 : 0;
 }
 
+class output_sink_handler : public default_exec_handler
+{
+private:
+	ssc_bool_t (*m_sink)( ssc_module_t, const char *, int, int, const ssc_number_t *, void * );
+	void *m_sinkdata;
+
+public:
+	output_sink_handler(
+		compute_module *cm,
+		ssc_bool_t (*f)( ssc_module_t, const char *, int, int, const ssc_number_t *, void * ),
+		void *d )
+		: default_exec_handler( cm, sg_defaultPrint.load() ? default_internal_handler : default_internal_handler_no_print, 0 )
+	{
+		m_sink = f;
+		m_sinkdata = d;
+	}
+
+	virtual bool stream_output( const std::string &name, size_t length )
+	{
+		if (!m_sink) return false;
+		return (*m_sink)( static_cast<ssc_module_t>( module() ), name.c_str(), 0, (int)length, 0, m_sinkdata ) ? true : false;
+	}
+
+	virtual bool on_output_chunk( const std::string &name, size_t offset, const ssc_number_t *values, size_t count )
+	{
+		return (*m_sink)( static_cast<ssc_module_t>( module() ), name.c_str(), (int)offset, (int)count, values, m_sinkdata ) ? true : false;
+	}
+
+	virtual void on_output_abort( const std::string &name, size_t sent )
+	{
+		(*m_sink)( static_cast<ssc_module_t>( module() ), name.c_str(), (int)sent, 0, 0, m_sinkdata );
+	}
+};
+
+SSCEXPORT ssc_bool_t ssc_module_exec_with_output_sink(
+	ssc_module_t p_mod,
+	ssc_data_t p_data,
+	ssc_bool_t (*pf_sink)( ssc_module_t, const char *, int, int, const ssc_number_t *, void * ),
+	void *pf_user_data )
+{
+	compute_module *cm = static_cast<compute_module*>(p_mod);
+	if (!cm) return 0;
+
+	var_table *vt = static_cast<var_table*>(p_data);
+	if (!vt)
+	{
+		cm->log("invalid data object provided", SSC_ERROR);
+		return 0;
+	}
+
+	output_sink_handler h( cm, pf_sink, pf_user_data );
+	return cm->compute( &h, vt ) ? 1 : 0;
+}
+
+class batch_exec_handler : public handler_interface
+{
+private:
+	ssc_bool_t (*m_hfunc)( int, int, float, float, const char *, const char *, void * );
+	void *m_hdata;
+	int m_case;
+
+public:
+	batch_exec_handler(
+		compute_module *cm,
+		int case_index,
+		ssc_bool_t (*f)( int, int, float, float, const char *, const char *, void * ),
+		void *d )
+		: handler_interface(cm)
+	{
+		m_hfunc = f;
+		m_hdata = d;
+		m_case = case_index;
+	}
+
+	virtual void on_log( const std::string &text, int type, float time )
+	{
+		if (!m_hfunc) return;
+		(*m_hfunc)( m_case, SSC_LOG, (float)type, time, text.c_str(), 0, m_hdata );
+	}
+
+	virtual bool on_update( const std::string &text, float percent, float time )
+	{
+		if (!m_hfunc) return true;
+		return (*m_hfunc)( m_case, SSC_UPDATE, percent, time, text.c_str(), 0, m_hdata ) ? 1 : 0;
+	}
+};
+
+SSCEXPORT int ssc_module_exec_batch(
+	const char *name,
+	ssc_data_t *p_data,
+	int n_cases,
+	int n_threads,
+	ssc_bool_t *results,
+	ssc_bool_t (*pf_handler)( int, int, float, float, const char *, const char *, void * ),
+	void *pf_user_data )
+{
+	ssc_module_t p_check = name ? ssc_module_create( name ) : 0;
+	if (!p_check) return -1;
+	ssc_module_free( p_check );
+
+	if (!p_data || n_cases < 1) return 0;
+
+	std::atomic<int> n_success( 0 );
+	util::parallel_for( (size_t)n_cases, n_threads, [&]( size_t i )
+	{
+		ssc_bool_t ok = 0;
+		std::unique_ptr<compute_module> cm( static_cast<compute_module*>( ssc_module_create( name ) ) );
+		var_table *vt = static_cast<var_table*>( p_data[i] );
+		if (cm && vt)
+		{
+			batch_exec_handler h( cm.get(), (int)i, pf_handler, pf_user_data );
+			// one failing case must not take down the rest of the batch, whatever it throws
+			try
+			{
+				ok = cm->compute( &h, vt ) ? 1 : 0;
+			}
+			catch (std::exception &e)
+			{
+				cm->log( std::string("unhandled exception: ") + e.what(), SSC_ERROR );
+				ok = 0;
+			}
+			catch (...)
+			{
+				cm->log( "unhandled exception of unknown type", SSC_ERROR );
+				ok = 0;
+			}
+		}
+		else if (cm && pf_handler)
+			(*pf_handler)( (int)i, SSC_LOG, (float)SSC_ERROR, -1.0f, "invalid data object provided", 0, pf_user_data );
+
+		if (ok) n_success++;
+		if (results) results[i] = ok;
+	});
+
+	return n_success.load();
+}
 
 SSCEXPORT void ssc_module_extproc_output( ssc_handler_t p_handler, const char *output_line )
 {
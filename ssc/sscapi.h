@@ -62,6 +62,16 @@ SSCEXPORT int ssc_version();
 /** Returns information about the build configuration of this particular SSC library binary as a text string that lists the compiler, platform, build date/time and other information. */
 SSCEXPORT const char *ssc_build_info();
 
+/* Thread safety:
+  SSC may be used from multiple threads in one process under the following contract:
+	- Distinct ssc_data_t and ssc_module_t objects may be created, used and freed concurrently from any number of threads. Each simulation should use its own module instance and its own data object.
+	- A single ssc_data_t or ssc_module_t object must not be used by two threads at the same time without external locking. This includes data objects used only as inputs, because a compute module writes default values and outputs into the data object it runs on, and because ssc_data_first/ssc_data_next keep iteration state in the object.
+	- Pointers returned by ssc_data_get_* and ssc_module_log remain owned by the object they came from and are valid only until that object is next modified or freed.
+	- ssc_module_exec_simple_nothread keeps its error text in a per-thread buffer, so the returned string is valid until the next call on the same thread.
+	- ssc_module_exec_set_print changes a process-wide setting that is read at the start of each ssc_module_exec call.
+	- Compute modules that run external executables or load dynamic type libraries (some tcs-based modules) are not guaranteed to be re-entrant.
+*/
+
 /** An opaque reference to a structure that holds a collection of variables.  This structure can contain any number of variables referenced by name, and can hold strings, numbers, arrays, and matrices.  Matrices are stored in row-major order, where the array size is nrows*ncols, and the array index is calculated by r*ncols+c. An ssc_data_t object holds all input and output variables for a simulation. It does not distinguish between input, output, and input variables - that is handled at the model context level. */
 typedef void* ssc_data_t;
 
@@ -86,6 +96,9 @@ typedef int ssc_bool_t;
 /** Creates a new data object in memory.  A data object stores a table of named values, where each value can be of any SSC datatype. */
 SSCEXPORT ssc_data_t ssc_data_create();
 
+/** Creates a new, empty data object layered on top of an existing one. Variables that are not assigned in the layer are looked up in 'p_base', so a parametric case can share the large arrays of a base case and only assign the values that differ. Values are copied into the layer only when they are assigned, or when they are retrieved in a way that allows them to be modified. Unassigning a variable in the layer hides the base value without changing 'p_base'. The base object must stay alive, and must not be modified, while any layer on top of it is in use. The same base may be shared by layers running on different threads. Returns 0 (NULL) if 'p_base' is NULL. */
+SSCEXPORT ssc_data_t ssc_data_create_overlay( ssc_data_t p_base );
+
 /** Frees the memory associated with a data object, where p_data is the data container to free. */
 SSCEXPORT void ssc_data_free( ssc_data_t p_data );
 
@@ -118,6 +131,12 @@ SSCEXPORT const char *ssc_data_first( ssc_data_t p_data );
  */
 SSCEXPORT const char *ssc_data_next( ssc_data_t p_data );
 
+/** Writes all variables in a data object, including nested tables, to a versioned binary file. Returns 1 (true) on success. */
+SSCEXPORT ssc_bool_t ssc_data_write( ssc_data_t p_data, const char *file );
+
+/** Reads a file written by ssc_data_write( ) into a new data object. The file is memory mapped and arrays and matrices refer to the mapping directly, so large files load without being parsed or copied. Files written on a machine with a different byte order are not supported. Returns 0 (NULL) if the file could not be read. */
+SSCEXPORT ssc_data_t ssc_data_read( const char *file );
+
 /** @name Assigning variable values.
 The following functions do not take ownership of the data pointeres for arrays, matrices, and tables. A deep copy is made into the internal SSC engine. You must remember to free the table that you create to pass into 
 ssc_data_set_table( ) for example.
@@ -139,6 +158,35 @@ SSCEXPORT void ssc_data_set_matrix( ssc_data_t p_data, const char *name, ssc_num
 SSCEXPORT void ssc_data_set_table( ssc_data_t p_data, const char *name, ssc_data_t table );
 /**@}*/ 
 
+/** @name Assigning arrays and matrices without copying.
+Large inputs such as weather or load time series can be handed to SSC without the deep copy made by ssc_data_set_array( ) and ssc_data_set_matrix( ).
+If @a pf_release is NULL the buffer is borrowed: SSC uses it directly, never frees it, and the caller must keep it alive and unchanged until the variable is unassigned or the data object is freed.
+If @a pf_release is given, ownership moves to SSC and pf_release( pvalues, user_data ) is called exactly once when the variable no longer needs the buffer.
+Copying the data object, or reassigning the variable, always makes an internal copy, so a borrowed buffer is never written to by SSC itself. Compute modules only read their inputs.
+*/
+/**@{*/
+/** Assigns value of type @a SSC_ARRAY using the caller's buffer as storage. */
+SSCEXPORT void ssc_data_set_array_external( ssc_data_t p_data, const char *name, ssc_number_t *pvalues, int length, void (*pf_release)( ssc_number_t *pvalues, void *user_data ), void *user_data );
+
+/** Assigns value of type @a SSC_MATRIX using the caller's buffer as storage, in row-major order. */
+SSCEXPORT void ssc_data_set_matrix_external( ssc_data_t p_data, const char *name, ssc_number_t *pvalues, int nrows, int ncols, void (*pf_release)( ssc_number_t *pvalues, void *user_data ), void *user_data );
+/**@}*/ 
+
+/** @name Taking arrays and matrices out without copying.
+ssc_data_get_array( ) and ssc_data_get_matrix( ) already return views of the internal storage without copying. The following functions instead move the storage of
+an output to the caller and unassign the variable, so results can outlive the data object. The returned buffer must be freed with ssc_data_free_array( ).
+*/
+/**@{*/
+/** Moves the value of a @a SSC_ARRAY variable out of the data object. Returns 0 (NULL) if the variable does not exist or is not an array. */
+SSCEXPORT ssc_number_t *ssc_data_take_array( ssc_data_t p_data, const char *name, int *length );
+
+/** Moves the value of a @a SSC_MATRIX variable out of the data object, in row-major order. Returns 0 (NULL) if the variable does not exist or is not a matrix. */
+SSCEXPORT ssc_number_t *ssc_data_take_matrix( ssc_data_t p_data, const char *name, int *nrows, int *ncols );
+
+/** Frees a buffer returned by ssc_data_take_array( ) or ssc_data_take_matrix( ). */
+SSCEXPORT void ssc_data_free_array( ssc_number_t *pvalues );
+/**@}*/ 
+
 /** @name Retrieving variable values.
 The following functions return internal references to memory, and the returned string, array, matrix, and tables should not be freed by the user.
 */
@@ -256,13 +304,16 @@ SSCEXPORT const char *ssc_info_constraints( ssc_info_t p_inf );
 /** Returns additional information for use in a target application about how to show the variable to the user. */
 SSCEXPORT const char *ssc_info_uihint( ssc_info_t p_inf );
 
-/** Specify whether the built-in execution handler prints messages and progress updates to the command line console. */
+/** Specify whether the built-in execution handler prints messages and progress updates to the command line console. This is a process-wide setting shared by all threads. */
 SSCEXPORT void ssc_module_exec_set_print( int print );
 
-/** The simplest way to run a computation module over a data set. Simply specify the name of the module, and a data set.  If the whole process succeeded, the function returns 1, otherwise 0.  No error messages are available. This function can be thread-safe, depending on the computation module used. If the computation module requires the execution of external binary executables, it is not thread-safe. However, simpler implementations that do all calculations internally are probably thread-safe.  Unfortunately there is no standard way to report the thread-safety of a particular computation module. */
+/** Enables a process-wide cache of parsed weather and wind resource files when 'max_files' is greater than zero. Modules that open the same weather file repeatedly then share one read-only copy of its data instead of parsing it on every run; a file is parsed again when its size, modification time or contents change. The least recently used files beyond 'max_files' are dropped from the cache. Passing 0, the default, disables the cache and frees it. This is a process-wide setting shared by all threads. */
+SSCEXPORT void ssc_weather_cache_set_limit( int max_files );
+
+/** The simplest way to run a computation module over a data set. Simply specify the name of the module, and a data set.  If the whole process succeeded, the function returns 1, otherwise 0.  No error messages are available. This function may be called concurrently from several threads as long as each call uses its own data object (see the thread safety notes above). If the computation module requires the execution of external binary executables, it is not thread-safe. */
 SSCEXPORT ssc_bool_t ssc_module_exec_simple( const char *name, ssc_data_t p_data );
 
-/** Another very simple way to run a computation module over a data set. The function returns NULL on success.  If something went wrong, the first error message is returned. Because the returned string references a common internal data container, this function is never thread-safe.  */
+/** Another very simple way to run a computation module over a data set. The function returns NULL on success.  If something went wrong, the first error message is returned. The returned string references an internal buffer owned by the calling thread, and is overwritten by the next call to this function on the same thread.  */
 SSCEXPORT const char *ssc_module_exec_simple_nothread( const char *name, ssc_data_t p_data );
 
 /** @name Action/notification types that can be sent to a handler function: 
@@ -287,6 +338,31 @@ SSCEXPORT ssc_bool_t ssc_module_exec_with_handler(
 	ssc_bool_t (*pf_handler)( ssc_module_t, ssc_handler_t, int action, float f0, float f1, const char *s0, const char *s1, void *user_data ),
 	void *pf_user_data );
 
+/** Runs a computation module like ssc_module_exec, but passes time series outputs to 'pf_sink' in chunks while the module runs, instead of keeping them whole in the data set. Only outputs that a module writes step by step can be streamed, currently the battery time series of the battery, battwatts, and pvsamv1 modules; all other outputs are stored in the data set as usual. For each output that can be streamed, 'pf_sink' is first called with 'values' set to NULL and 'count' set to the length of the series: return 1 to stream it, or 0 to store it in the data set. A streamed output is then passed in order, 'count' values at a time starting at index 'offset', typically one simulated year per call. The values are only valid during the call. Returning 0 from a call with values cancels the run. A streamed output is complete once the call with its last value returns. If the run fails or is cancelled before that, 'pf_sink' is called once more for each incomplete output with 'values' set to NULL, 'count' set to 0, and 'offset' set to the number of values already passed; the rest of the series is not sent, and the function returns 0. */
+SSCEXPORT ssc_bool_t ssc_module_exec_with_output_sink(
+	ssc_module_t p_mod,
+	ssc_data_t p_data,
+	ssc_bool_t (*pf_sink)( ssc_module_t, const char *name, int offset, int count, const ssc_number_t *values, void *user_data ),
+	void *pf_user_data );
+
+/** Runs the compute module named 'name' once over each of the 'n_cases' data objects in 'p_data', using a pool of 'n_threads' worker threads (0 uses one thread per hardware core). Each case gets its own module instance, so cases run independently and each data object receives its own outputs. Workers pick up the next unstarted case as soon as they finish one, so cases of uneven cost balance themselves across threads. If 'results' is not NULL it must hold 'n_cases' values, and receives 1 or 0 for each case. The optional handler receives log messages and progress updates tagged with the index of the case that produced them; it is called from the worker threads, possibly concurrently, and must be thread-safe. Returning 0 from the handler on an SSC_UPDATE cancels that case only. The data objects must all be distinct. Returns the number of cases that succeeded, or -1 if the module name is invalid.
+
+	\verbatim
+	ssc_data_t cases[100];
+	ssc_bool_t ok[100];
+	// ... create and fill in each case ...
+	int n_ok = ssc_module_exec_batch( "pvwattsv5", cases, 100, 0, ok, NULL, NULL );
+	\endverbatim
+*/
+SSCEXPORT int ssc_module_exec_batch(
+	const char *name,
+	ssc_data_t *p_data,
+	int n_cases,
+	int n_threads,
+	ssc_bool_t *results,
+	ssc_bool_t (*pf_handler)( int case_index, int action, float f0, float f1, const char *s0, const char *s1, void *user_data ),
+	void *pf_user_data );
+
 /** @name Message types:*/
 /**@{*/ 	
 #define SSC_NOTICE 1
@@ -0,0 +1,185 @@
+/**
+BSD-3-Clause
+Copyright 2019 Alliance for Sustainable Energy, LLC
+Redistribution and use in source and binary forms, with or without modification, are permitted provided
+that the following conditions are met :
+1.	Redistributions of source code must retain the above copyright notice, this list of conditions
+and the following disclaimer.
+2.	Redistributions in binary form must reproduce the above copyright notice, this list of conditions
+and the following disclaimer in the documentation and/or other materials provided with the distribution.
+3.	Neither the name of the copyright holder nor the names of its contributors may be used to endorse
+or promote products derived from this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES,
+INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER, CONTRIBUTORS, UNITED STATES GOVERNMENT OR UNITED STATES
+DEPARTMENT OF ENERGY, NOR ANY OF THEIR EMPLOYEES, BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* sscdata: command line tool for the binary data files written by ssc_data_write( )
+
+	sscdata info <file>            lists the variables in a file
+	sscdata copy <in> <out>        reads a file, writes it back out, and checks the copy reads back identically
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+
+#include "sscapi.h"
+
+static const char *type_names[] = { "invalid", "string", "number", "array", "matrix", "table" };
+
+static void list_table( ssc_data_t data, const std::string &indent )
+{
+	for ( const char *name = ssc_data_first( data ); name; name = ssc_data_next( data ) )
+	{
+		int type = ssc_data_query( data, name );
+		printf( "%s%s : %s", indent.c_str(), name, (type >= 0 && type <= SSC_TABLE) ? type_names[type] : "?" );
+		int nr = 0, nc = 0;
+		ssc_number_t value = 0;
+		switch( type )
+		{
+		case SSC_NUMBER:
+			ssc_data_get_number( data, name, &value );
+			printf( " = %lg\n", (double)value );
+			break;
+		case SSC_STRING:
+			printf( " = '%s'\n", ssc_data_get_string( data, name ) );
+			break;
+		case SSC_ARRAY:
+			ssc_data_get_array( data, name, &nc );
+			printf( " [%d]\n", nc );
+			break;
+		case SSC_MATRIX:
+			ssc_data_get_matrix( data, name, &nr, &nc );
+			printf( " [%d x %d]\n", nr, nc );
+			break;
+		case SSC_TABLE:
+			printf( "\n" );
+			list_table( ssc_data_get_table( data, name ), indent + "    " );
+			break;
+		default:
+			printf( "\n" );
+		}
+	}
+}
+
+static bool same_table( ssc_data_t a, ssc_data_t b, std::string &where )
+{
+	int na = 0, nb = 0;
+	for ( const char *name = ssc_data_first( a ); name; name = ssc_data_next( a ) ) na++;
+	for ( const char *name = ssc_data_first( b ); name; name = ssc_data_next( b ) ) nb++;
+	if ( na != nb )
+	{
+		where = "variable count";
+		return false;
+	}
+
+	for ( const char *p = ssc_data_first( a ); p; p = ssc_data_next( a ) )
+	{
+		std::string name( p );
+		int type = ssc_data_query( a, name.c_str() );
+		if ( type != ssc_data_query( b, name.c_str() ) )
+		{
+			where = name;
+			return false;
+		}
+
+		bool same = true;
+		int nra = 0, nca = 0, nrb = 0, ncb = 0;
+		ssc_number_t va = 0, vb = 0;
+		ssc_number_t *pa = 0, *pb = 0;
+		switch( type )
+		{
+		case SSC_NUMBER:
+			ssc_data_get_number( a, name.c_str(), &va );
+			ssc_data_get_number( b, name.c_str(), &vb );
+			same = memcmp( &va, &vb, sizeof(ssc_number_t) ) == 0;
+			break;
+		case SSC_STRING:
+			same = strcmp( ssc_data_get_string( a, name.c_str() ), ssc_data_get_string( b, name.c_str() ) ) == 0;
+			break;
+		case SSC_ARRAY:
+			pa = ssc_data_get_array( a, name.c_str(), &nca );
+			pb = ssc_data_get_array( b, name.c_str(), &ncb );
+			same = pa && pb && nca == ncb && memcmp( pa, pb, nca * sizeof(ssc_number_t) ) == 0;
+			break;
+		case SSC_MATRIX:
+			pa = ssc_data_get_matrix( a, name.c_str(), &nra, &nca );
+			pb = ssc_data_get_matrix( b, name.c_str(), &nrb, &ncb );
+			same = pa && pb && nra == nrb && nca == ncb && memcmp( pa, pb, nra * nca * sizeof(ssc_number_t) ) == 0;
+			break;
+		case SSC_TABLE:
+		{
+			std::string inner;
+			same = same_table( ssc_data_get_table( a, name.c_str() ), ssc_data_get_table( b, name.c_str() ), inner );
+			if ( !same ) name += ":" + inner;
+			break;
+		}
+		}
+
+		if ( !same )
+		{
+			where = name;
+			return false;
+		}
+	}
+	return true;
+}
+
+int main( int argc, char *argv[] )
+{
+	if ( argc == 3 && strcmp( argv[1], "info" ) == 0 )
+	{
+		ssc_data_t data = ssc_data_read( argv[2] );
+		if ( !data )
+		{
+			printf( "could not read %s\n", argv[2] );
+			return 1;
+		}
+		list_table( data, "" );
+		ssc_data_free( data );
+		return 0;
+	}
+	else if ( argc == 4 && strcmp( argv[1], "copy" ) == 0 )
+	{
+		ssc_data_t data = ssc_data_read( argv[2] );
+		if ( !data )
+		{
+			printf( "could not read %s\n", argv[2] );
+			return 1;
+		}
+
+		int code = 0;
+		ssc_data_t copy = 0;
+		std::string where;
+		if ( !ssc_data_write( data, argv[3] ) )
+		{
+			printf( "could not write %s\n", argv[3] );
+			code = 1;
+		}
+		else if ( !(copy = ssc_data_read( argv[3] )) )
+		{
+			printf( "could not read back %s\n", argv[3] );
+			code = 1;
+		}
+		else if ( !same_table( data, copy, where ) )
+		{
+			printf( "%s differs from %s at '%s'\n", argv[3], argv[2], where.c_str() );
+			code = 1;
+		}
+
+		if ( copy ) ssc_data_free( copy );
+		ssc_data_free( data );
+		return code;
+	}
+
+	printf( "usage: sscdata info <file>\n"
+		"       sscdata copy <in> <out>\n" );
+	return 1;
+}
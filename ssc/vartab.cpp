@@ -20,6 +20,20 @@ WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT(INCLUDING NEGLIGENCE OR OTHERWISE
 OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 #include "lib_util.h"
 #include "vartab.h"
 
@@ -185,7 +199,12 @@ bool var_data::parse( unsigned char type, const std::string &buf, var_data &valu
 	return false;
 }
 
-var_table::var_table() : m_iterator(m_hash.begin())
+var_table::var_table() : m_iterator(m_hash.begin()), m_parent(0), m_keypos(0)
+{
+	/* nothing to do here */
+}
+
+var_table::var_table( const var_table *parent ) : m_iterator(m_hash.begin()), m_parent(parent), m_keypos(0)
 {
 	/* nothing to do here */
 }
@@ -197,12 +216,27 @@ var_table::~var_table()
 
 var_table &var_table::operator=( const var_table &rhs )
 {
+	if (&rhs == this) return *this;
+
 	clear();
 
-	for ( var_hash::const_iterator it = rhs.m_hash.begin();
-		it != rhs.m_hash.end();
-		++it )
-		assign( (*it).first, *((*it).second) );
+	if (!rhs.m_parent)
+	{
+		for ( var_hash::const_iterator it = rhs.m_hash.begin();
+			it != rhs.m_hash.end();
+			++it )
+			assign( (*it).first, *((*it).second) );
+	}
+	else
+	{
+		// flatten a layered table, since the copy may outlive rhs's parent
+		std::vector<std::string> keys;
+		std::unordered_set<std::string> seen;
+		rhs.collect_keys( keys, seen );
+		for (size_t i = 0; i < keys.size(); i++)
+			if (const var_data *v = rhs.find( keys[i] ))
+				assign( keys[i], *v );
+	}
 
 	return *this;
 }
@@ -216,15 +250,35 @@ void var_table::clear()
 		delete it->second; // delete the var_data object
 	}
 	m_hash.clear();
+	m_iterator = m_hash.end();
+
+	// a cleared table is empty, so it no longer sees its parent
+	m_parent = 0;
+	m_hidden.clear();
+	m_keys.clear();
+	m_keypos = 0;
+}
+
+void var_table::set_parent( const var_table *parent )
+{
+	m_parent = parent;
+	m_hidden.clear();
+	m_keys.clear();
+	m_keypos = 0;
 }
 
 var_data *var_table::assign( const std::string &name, const var_data &val )
 {
-	var_data *v = lookup(name);
-	if (!v)
+	std::string lcname( util::lower_case(name) );
+	var_data *v = 0;
+	var_hash::iterator it = m_hash.find( lcname );
+	if ( it != m_hash.end() )
+		v = it->second;
+	else
 	{
 		v = new var_data;
-		m_hash[ util::lower_case(name) ] = v;
+		m_hash[ lcname ] = v;
+		if (m_parent) m_hidden.erase( lcname );
 	}
 	
 	v->copy(val);
@@ -233,18 +287,25 @@ var_data *var_table::assign( const std::string &name, const var_data &val )
 
 void var_table::unassign( const std::string &name )
 {
-	var_hash::iterator it = m_hash.find( util::lower_case(name) );
+	std::string lcname( util::lower_case(name) );
+	var_hash::iterator it = m_hash.find( lcname );
 	if (it != m_hash.end())
 	{
 		delete (*it).second; // delete the associated data
 		m_hash.erase( it );
 	}
+
+	if (m_parent && m_parent->find( lcname ))
+		m_hidden.insert( lcname );
 }
 
 bool var_table::rename( const std::string &oldname, const std::string &newname )
 {
-	
-	var_hash::iterator it = m_hash.find( util::lower_case(oldname) );
+	// make sure an entry that only lives in the parent is copied into this layer first
+	if (m_parent && !lookup( oldname )) return false;
+
+	std::string lcoldname( util::lower_case(oldname) );
+	var_hash::iterator it = m_hash.find( lcoldname );
 	if ( it != m_hash.end() )
 	{
 		std::string lcnewname( util::lower_case(newname) );
@@ -263,23 +324,96 @@ bool var_table::rename( const std::string &oldname, const std::string &newname )
 		else // otherwise, just add a new itme
 			m_hash[ lcnewname ] = data;
 
+		if (m_parent)
+		{
+			m_hidden.erase( lcnewname );
+			if (m_parent->find( lcoldname )) m_hidden.insert( lcoldname );
+		}
+
 		return true;
 	}
 	else
 		return false;
 }
 
+const var_data *var_table::find( const std::string &lcname ) const
+{
+	var_hash::const_iterator it = m_hash.find( lcname );
+	if ( it != m_hash.end() )
+		return (*it).second;
+
+	if ( m_parent && m_hidden.find( lcname ) == m_hidden.end() )
+		return m_parent->find( lcname );
+
+	return NULL;
+}
+
 var_data *var_table::lookup( const std::string &name )
 {
-	var_hash::iterator it = m_hash.find( util::lower_case(name) );
+	std::string lcname( util::lower_case(name) );
+	var_hash::iterator it = m_hash.find( lcname );
 	if ( it != m_hash.end() )
 		return (*it).second;
-	else
-		return NULL;
+
+	if ( m_parent )
+	{
+		// the caller may modify the value, so copy the parent's entry into this layer
+		if ( const var_data *v = find( lcname ) )
+			return assign( lcname, *v );
+	}
+
+	return NULL;
+}
+
+const var_data *var_table::lookup_const( const std::string &name ) const
+{
+	return find( util::lower_case(name) );
+}
+
+bool var_table::is_local( const std::string &name ) const
+{
+	return m_hash.find( util::lower_case(name) ) != m_hash.end();
+}
+
+void var_table::collect_keys( std::vector<std::string> &keys, std::unordered_set<std::string> &seen ) const
+{
+	for ( var_hash::const_iterator it = m_hash.begin(); it != m_hash.end(); ++it )
+		if ( seen.insert( it->first ).second )
+			keys.push_back( it->first );
+
+	if ( m_parent )
+	{
+		// hidden names are marked seen so the parent does not report them
+		for ( std::unordered_set<std::string>::const_iterator it = m_hidden.begin(); it != m_hidden.end(); ++it )
+			seen.insert( *it );
+		m_parent->collect_keys( keys, seen );
+	}
+}
+
+void var_table::update_keys()
+{
+	std::unordered_set<std::string> seen;
+	m_keys.clear();
+	collect_keys( m_keys, seen );
+}
+
+unsigned int var_table::size()
+{
+	if ( !m_parent ) return (unsigned int)m_hash.size();
+
+	update_keys();
+	return (unsigned int)m_keys.size();
 }
 
 const char *var_table::first( )
 {
+	if ( m_parent )
+	{
+		update_keys();
+		m_keypos = 0;
+		return m_keys.empty() ? NULL : m_keys[0].c_str();
+	}
+
 	m_iterator = m_hash.begin();
 	if (m_iterator != m_hash.end())
 		return m_iterator->first.c_str();
@@ -288,6 +422,14 @@ const char *var_table::first( )
 }
 
 const char *var_table::key(int pos){
+	if ( m_parent )
+	{
+		update_keys();
+		if ( pos < 0 || (size_t)pos >= m_keys.size() ) return NULL;
+		m_keypos = (size_t)pos;
+		return m_keys[m_keypos].c_str();
+	}
+
     m_iterator = m_hash.begin();
     if (m_iterator == m_hash.end()) return NULL;
 
@@ -302,6 +444,12 @@ const char *var_table::key(int pos){
 
 const char *var_table::next()
 {
+	if ( m_parent )
+	{
+		if ( m_keypos + 1 >= m_keys.size() ) return NULL;
+		return m_keys[++m_keypos].c_str();
+	}
+
 	if (m_iterator == m_hash.end()) return NULL;
 
 	++m_iterator;
@@ -311,3 +459,324 @@ const char *var_table::next()
 	return NULL;
 }
 
+/* Binary var_table files, version 1.  Every field is 8 byte aligned, so the
+   numbers in arrays and matrices can be used in place from a memory mapping of
+   the file, without parsing or copying them.  Values are stored in the byte
+   order of the machine that wrote them, and files from a machine with the
+   other byte order are rejected.
+
+	header:  char magic[8] "SSCDATA", uint32 version, uint32 byte order mark 0x01020304, uint64 file size
+	table:   uint64 number of entries, followed by the entries
+	entry:   uint32 type, uint32 name length, name with its terminating NUL padded to 8 bytes, then the value
+		SSC_NUMBER            ssc_number_t
+		SSC_STRING            uint64 length, characters with the terminating NUL padded to 8 bytes
+		SSC_ARRAY, SSC_MATRIX uint64 rows, uint64 columns, rows*columns ssc_number_t in row-major order
+		SSC_TABLE             a nested table
+*/
+
+static const char sg_binaryMagic[8] = { 'S', 'S', 'C', 'D', 'A', 'T', 'A', 0 };
+static const unsigned int sg_binaryVersion = 1;
+static const unsigned int sg_binaryByteOrder = 0x01020304;
+static const int sg_binaryMaxDepth = 64;
+
+static size_t pad8( size_t n ) { return (n + 7) & ~((size_t)7); }
+
+// the file contents that arrays and matrices read from a binary file point into.
+// each of them holds a reference, and the memory goes away with the last one.
+struct binary_file_data
+{
+	std::atomic<int> refs;
+	unsigned char *bytes;
+	size_t size;
+	bool mapped;
+
+	binary_file_data() : refs(1), bytes(0), size(0), mapped(false) { }
+
+	bool open( const std::string &file )
+	{
+#ifdef _WIN32
+		HANDLE fh = CreateFileA( file.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+		if ( fh == INVALID_HANDLE_VALUE ) return false;
+		LARGE_INTEGER len;
+		if ( GetFileSizeEx( fh, &len ) && len.QuadPart > 0 )
+		{
+			size = (size_t)len.QuadPart;
+			if ( HANDLE mh = CreateFileMappingA( fh, NULL, PAGE_WRITECOPY, 0, 0, NULL ) )
+			{
+				bytes = (unsigned char*)MapViewOfFile( mh, FILE_MAP_COPY, 0, 0, 0 );
+				mapped = ( bytes != 0 );
+				CloseHandle( mh );
+			}
+		}
+		CloseHandle( fh );
+#else
+		int fd = ::open( file.c_str(), O_RDONLY );
+		if ( fd < 0 ) return false;
+		struct stat st;
+		if ( fstat( fd, &st ) == 0 && st.st_size > 0 )
+		{
+			size = (size_t)st.st_size;
+			// private and writable, so a module that changes an input only changes its own copy of the page
+			void *p = mmap( NULL, size, PROT_READ|PROT_WRITE, MAP_PRIVATE, fd, 0 );
+			if ( p != MAP_FAILED )
+			{
+				bytes = (unsigned char*)p;
+				mapped = true;
+			}
+		}
+		::close( fd );
+#endif
+		if ( mapped || size == 0 ) return mapped;
+
+		// no mapping available, so read the whole file instead
+		FILE *fp = fopen( file.c_str(), "rb" );
+		if ( !fp ) return false;
+		bytes = new unsigned char[size];
+		bool ok = fread( bytes, 1, size, fp ) == size;
+		fclose( fp );
+		return ok;
+	}
+
+	~binary_file_data()
+	{
+		if ( !bytes ) return;
+#ifdef _WIN32
+		if ( mapped ) UnmapViewOfFile( bytes );
+#else
+		if ( mapped ) munmap( bytes, size );
+#endif
+		else delete [] bytes;
+	}
+
+	static void release( ssc_number_t *, void *data )
+	{
+		binary_file_data *fd = static_cast<binary_file_data*>( data );
+		if ( --fd->refs == 0 )
+			delete fd;
+	}
+};
+
+class binary_writer
+{
+	FILE *m_fp;
+	unsigned long long m_size;
+public:
+	binary_writer( FILE *fp ) : m_fp(fp), m_size(0) { }
+	unsigned long long size() const { return m_size; }
+
+	bool bytes( const void *p, size_t n, size_t padded )
+	{
+		static const char zeros[8] = { 0 };
+		if ( n > 0 && fwrite( p, 1, n, m_fp ) != n ) return false;
+		if ( padded > n && fwrite( zeros, 1, padded-n, m_fp ) != padded-n ) return false;
+		m_size += padded;
+		return true;
+	}
+	bool u32( unsigned int v ) { return bytes( &v, sizeof(v), sizeof(v) ); }
+	bool u64( unsigned long long v ) { return bytes( &v, sizeof(v), sizeof(v) ); }
+	bool text( const std::string &s ) { return bytes( s.c_str(), s.length()+1, pad8( s.length()+1 ) ); }
+};
+
+class binary_reader
+{
+	const unsigned char *m_p, *m_end;
+public:
+	binary_reader( const unsigned char *p, size_t n ) : m_p(p), m_end(p+n) { }
+	size_t remaining() const { return (size_t)(m_end - m_p); }
+
+	const unsigned char *bytes( size_t n )
+	{
+		if ( n > remaining() ) return 0;
+		const unsigned char *p = m_p;
+		m_p += n;
+		return p;
+	}
+	bool u32( unsigned int &v )
+	{
+		const unsigned char *p = bytes( sizeof(v) );
+		if ( p ) memcpy( &v, p, sizeof(v) );
+		return p != 0;
+	}
+	bool u64( unsigned long long &v )
+	{
+		const unsigned char *p = bytes( sizeof(v) );
+		if ( p ) memcpy( &v, p, sizeof(v) );
+		return p != 0;
+	}
+	bool text( size_t len, std::string &s )
+	{
+		if ( len >= remaining() ) return false;
+		const unsigned char *p = bytes( pad8( len+1 ) );
+		if ( !p || p[len] != 0 ) return false;
+		s.assign( (const char*)p, len );
+		return true;
+	}
+};
+
+class var_table_binary
+{
+public:
+	static bool write_table( binary_writer &w, const var_table &tab )
+	{
+		std::vector<std::string> keys;
+		std::unordered_set<std::string> seen;
+		tab.collect_keys( keys, seen );
+		std::sort( keys.begin(), keys.end() ); // same table, same file
+		if ( !w.u64( keys.size() ) ) return false;
+		for ( size_t i = 0; i < keys.size(); i++ )
+			if ( !write_value( w, keys[i], *tab.find( keys[i] ) ) )
+				return false;
+		return true;
+	}
+
+	static bool write_value( binary_writer &w, const std::string &name, const var_data &v )
+	{
+		if ( !w.u32( v.type ) || !w.u32( (unsigned int)name.length() ) || !w.text( name ) ) return false;
+		switch( v.type )
+		{
+		case SSC_NUMBER:
+		{
+			ssc_number_t x = v.num.value();
+			return w.bytes( &x, sizeof(x), sizeof(x) );
+		}
+		case SSC_STRING:
+			return w.u64( v.str.length() ) && w.text( v.str );
+		case SSC_ARRAY:
+		case SSC_MATRIX:
+		{
+			size_t n = v.num.nrows() * v.num.ncols() * sizeof(ssc_number_t);
+			return w.u64( v.num.nrows() ) && w.u64( v.num.ncols() ) && w.bytes( &v.num.at(0), n, n );
+		}
+		case SSC_TABLE:
+			return write_table( w, v.table );
+		default:
+			return true;
+		}
+	}
+
+	static bool read_table( binary_reader &r, var_table &tab, binary_file_data *fd, int depth, std::string &err )
+	{
+		unsigned long long count = 0;
+		if ( depth > sg_binaryMaxDepth ) { err = "tables nested too deeply"; return false; }
+		if ( !r.u64( count ) ) { err = "truncated table"; return false; }
+
+		for ( unsigned long long i = 0; i < count; i++ )
+		{
+			unsigned int type = 0, len = 0;
+			std::string name;
+			if ( !r.u32( type ) || !r.u32( len ) || !r.text( len, name ) ) { err = "truncated variable name"; return false; }
+
+			var_data *v = tab.assign( name, var_data() );
+			v->type = (unsigned char)type;
+			switch( type )
+			{
+			case SSC_NUMBER:
+			{
+				const unsigned char *p = r.bytes( sizeof(ssc_number_t) );
+				if ( !p ) { err = "truncated value of " + name; return false; }
+				ssc_number_t x;
+				memcpy( &x, p, sizeof(x) );
+				v->num = x;
+				break;
+			}
+			case SSC_STRING:
+			{
+				unsigned long long slen = 0;
+				if ( !r.u64( slen ) || !r.text( (size_t)slen, v->str ) ) { err = "truncated value of " + name; return false; }
+				break;
+			}
+			case SSC_ARRAY:
+			case SSC_MATRIX:
+			{
+				unsigned long long nr = 0, nc = 0;
+				if ( !r.u64( nr ) || !r.u64( nc ) ) { err = "truncated value of " + name; return false; }
+				size_t max = r.remaining() / sizeof(ssc_number_t);
+				if ( nr < 1 || nc < 1 || nr > max || nc > max / nr )
+				{
+					err = "invalid dimensions of " + name;
+					return false;
+				}
+				ssc_number_t *p = (ssc_number_t*)r.bytes( (size_t)(nr*nc) * sizeof(ssc_number_t) );
+				if ( !p ) { err = "truncated value of " + name; return false; }
+				fd->refs++;
+				v->num.assign_external( p, (size_t)nr, (size_t)nc, binary_file_data::release, fd );
+				break;
+			}
+			case SSC_TABLE:
+				if ( !read_table( r, v->table, fd, depth+1, err ) ) return false;
+				break;
+			case SSC_INVALID:
+				break;
+			default:
+				err = "unknown type of " + name;
+				return false;
+			}
+		}
+		return true;
+	}
+};
+
+bool var_table::write_binary( const std::string &file, std::string *error ) const
+{
+	FILE *fp = fopen( file.c_str(), "wb" );
+	if ( !fp )
+	{
+		if ( error ) *error = "could not open " + file + " for writing";
+		return false;
+	}
+
+	binary_writer w( fp );
+	bool ok = w.bytes( sg_binaryMagic, 8, 8 )
+		&& w.u32( sg_binaryVersion )
+		&& w.u32( sg_binaryByteOrder )
+		&& w.u64( 0 )
+		&& var_table_binary::write_table( w, *this );
+
+	// go back and fill in the file size
+	unsigned long long size = w.size();
+	ok = ok && fseek( fp, 16, SEEK_SET ) == 0
+		&& fwrite( &size, sizeof(size), 1, fp ) == 1;
+
+	if ( fclose( fp ) != 0 ) ok = false;
+	if ( !ok && error ) *error = "could not write " + file;
+	return ok;
+}
+
+bool var_table::read_binary( const std::string &file, std::string *error )
+{
+	clear();
+
+	binary_file_data *fd = new binary_file_data;
+	std::string err;
+	if ( !fd->open( file ) )
+		err = "could not read " + file;
+	else
+	{
+		binary_reader r( fd->bytes, fd->size );
+		const unsigned char *magic = r.bytes( 8 );
+		unsigned int version = 0, order = 0;
+		unsigned long long size = 0;
+		if ( !magic || memcmp( magic, sg_binaryMagic, 8 ) != 0
+			|| !r.u32( version ) || !r.u32( order ) || !r.u64( size ) )
+			err = file + " is not an ssc data file";
+		else if ( order != sg_binaryByteOrder )
+			err = file + " was written with a different byte order";
+		else if ( version != sg_binaryVersion )
+			err = util::format( "%s has unsupported version %d", file.c_str(), (int)version );
+		else if ( size != fd->size )
+			err = file + " is truncated";
+		else
+			var_table_binary::read_table( r, *this, fd, 0, err );
+	}
+
+	// the arrays hold their own references to the file contents
+	binary_file_data::release( 0, fd );
+
+	if ( !err.empty() )
+	{
+		clear();
+		if ( error ) *error = err;
+		return false;
+	}
+	return true;
+}
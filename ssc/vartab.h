@@ -30,6 +30,7 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 
 #include <unordered_map>
+#include <unordered_set>
 using std::unordered_map;
 
 #ifdef _MSC_VER
@@ -40,10 +41,19 @@ class var_data;
 
 typedef unordered_map< std::string, var_data* > var_hash;
 
+/* A var_table may be layered on top of a parent table.  Lookups that miss in
+   the layer fall through to the parent, so a parametric case can share the large
+   arrays of a base case and only hold the values it overrides.  The parent is
+   treated as immutable: it must outlive the layer, must not be modified while
+   the layer is in use, and is never written through the layer.  Any non-const
+   lookup of a parent entry copies it into the layer first, since the caller may
+   change it, while lookup_const() reads the parent in place.  A single parent may
+   be shared by layers that are used concurrently on different threads. */
 class var_table
 {
 public:
 	explicit var_table();
+	explicit var_table( const var_table *parent );
 	virtual ~var_table();
 
 	void clear();
@@ -51,15 +61,36 @@ public:
 	void unassign( const std::string &name );
 	bool rename( const std::string &oldname, const std::string &newname );
 	var_data *lookup( const std::string &name );
+	const var_data *lookup_const( const std::string &name ) const;
+	bool is_local( const std::string &name ) const;
 	const char *first();
 	const char *next();
 	const char *key(int pos);
-	unsigned int size() { return (unsigned int)m_hash.size(); }
+	unsigned int size();
 	var_table &operator=( const var_table &rhs );
 
+	const var_table *parent() const { return m_parent; }
+	void set_parent( const var_table *parent );
+
+	// versioned binary files, see vartab.cpp for the format.  reading maps the
+	// file, and arrays and matrices point into the mapping instead of being copied
+	bool write_binary( const std::string &file, std::string *error = 0 ) const;
+	bool read_binary( const std::string &file, std::string *error = 0 );
+
 private:
+	friend class var_table_binary;
+
+	const var_data *find( const std::string &lcname ) const;
+	void collect_keys( std::vector<std::string> &keys, std::unordered_set<std::string> &seen ) const;
+	void update_keys();
+
 	var_hash m_hash;
 	var_hash::iterator m_iterator;
+
+	const var_table *m_parent;
+	std::unordered_set< std::string > m_hidden; // parent entries unassigned in this layer
+	std::vector< std::string > m_keys; // snapshot of visible names, used to iterate a layered table
+	size_t m_keypos;
 };
 
 
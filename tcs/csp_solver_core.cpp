@@ -555,6 +555,7 @@ void C_csp_solver::Ssimulate(C_csp_solver::S_sim_setup & sim_setup)
 	double wf_step = 3600.0 / step_per_hour;	//[s] Weather file time step - would like to check this against weather file, some day
 	
     m_is_first_timestep = true;
+	ms_sim_counters = S_sim_counters();
 	double step_tolerance = 10.0;		//[s] For adjustable timesteps, if within 10 seconds, assume it equals baseline timestep
 	double baseline_step = wf_step;		//[s] Baseline timestep of the simulation - this should probably be technology/model specific
 	// Check the collector-receiver model for a maximum step
@@ -730,6 +731,8 @@ void C_csp_solver::Ssimulate(C_csp_solver::S_sim_setup & sim_setup)
 
 	while( mc_kernel.mc_sim_info.ms_ts.m_time <= mc_kernel.get_sim_setup()->m_sim_time_end )
 	{
+		ms_sim_counters.m_timesteps++;
+
 		// Report simulation progress
 		double calc_frac_current = (mc_kernel.mc_sim_info.ms_ts.m_time - mc_kernel.get_sim_setup()->m_sim_time_start) / (mc_kernel.get_sim_setup()->m_sim_time_end - mc_kernel.get_sim_setup()->m_sim_time_start);
 		if( calc_frac_current > progress_msg_frac_current )
@@ -982,6 +985,7 @@ void C_csp_solver::Ssimulate(C_csp_solver::S_sim_setup & sim_setup)
                 {
                     
                     //call the optimize method
+                    ms_sim_counters.m_dispatch_optimizations++;
                     opt_complete = dispatch.m_last_opt_successful = 
                         dispatch.optimize();
                     
@@ -1158,6 +1162,8 @@ void C_csp_solver::Ssimulate(C_csp_solver::S_sim_setup & sim_setup)
 
 		while(!are_models_converged)		// Solve for correct operating mode and performance in following loop:
 		{
+			ms_sim_counters.m_mode_iterations++;
+
 			// Reset timestep info for iterations on the operating mode...
 			mc_kernel.mc_sim_info.ms_ts.m_time = mc_kernel.get_baseline_end_time();
 			mc_kernel.mc_sim_info.ms_ts.m_step = mc_kernel.mc_sim_info.ms_ts.m_time - mc_kernel.mc_sim_info.ms_ts.m_time_start;
@@ -1127,6 +1127,20 @@ public:
 
 	void Ssimulate(C_csp_solver::S_sim_setup & sim_setup);
 
+	// Solver effort in the last call to Ssimulate, for performance reporting by the compute modules
+	struct S_sim_counters
+	{
+		int m_timesteps;				//[-] Controller timesteps, including any startup substeps
+		int m_mode_iterations;			//[-] Passes through the operating mode loop
+		int m_dispatch_optimizations;	//[-] Calls to the dispatch optimization
+
+		S_sim_counters()
+		{
+			m_timesteps = m_mode_iterations = m_dispatch_optimizations = 0;
+		}
+	};
+	S_sim_counters ms_sim_counters;
+
 	int steps_per_hour();
 
 	double get_cr_aperture_area();
@@ -212,7 +212,8 @@ bool C_csp_reported_outputs::assign(int index, double *p_reporting_ts_array, siz
 			return false;
 	}
 
-	mvc_outputs[index].assign(p_reporting_ts_array, n_reporting_ts_array);
+	if( p_reporting_ts_array != 0 )
+		mvc_outputs[index].assign(p_reporting_ts_array, n_reporting_ts_array);
 
 	return true;
 }
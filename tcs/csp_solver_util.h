@@ -99,6 +99,7 @@ public:
 
 	void construct(const S_output_info *output_info);
 
+	// a NULL array leaves the output unreported, so it is not collected at each timestep
 	bool assign(int index, double *p_reporting_ts_array, size_t n_reporting_ts_array);
 
 	void send_to_reporting_ts_array(double report_time_start,
@@ -95,6 +95,304 @@ TEST_F(IrradTest, sunriseAndSunsetAtDifferentLocationsTest_lib_irradproc) {
 }
 
 
+/// Irradiance calculated with a shared sun position cache is identical to calculating it from scratch, including for arctic days without sunrise or sunset
+TEST_F(IrradTest, sunPositionCacheTest_lib_irradproc) {
+	vector<double> latitudes = { lat, 66.9 };
+	vector<double> longitudes = { lon, -162.6 };
+	vector<double> time_zones = { tz, -9 };
+
+	for (size_t loc = 0; loc < latitudes.size(); loc++)
+	{
+		lat = latitudes[loc];
+		lon = longitudes[loc];
+		tz = time_zones[loc];
+		sun_position_cache cache(lat, lon, tz, 8760);
+		int mismatches = 0;
+		for (int pass = 0; pass < 2; pass++)
+			for_each_step(1, [&](int m, int d, int h, double minute, size_t index)
+			{
+				for (tilt = 10; tilt <= 40; tilt += 30)
+				{
+					irrad expected, cached;
+					set_up_irrad(expected, m, d, h, minute, 1.0, 500, 100);
+					set_up_irrad(cached, m, d, h, minute, 1.0, 500, 100);
+					cached.set_sun_position_cache(&cache, index);
+					expected.calc();
+					cached.calc();
+
+					double a[16], b[16];
+					for (size_t i = 0; i < 9; i++)
+					{
+						a[i] = expected.get_sun_component(i);
+						b[i] = cached.get_sun_component(i);
+					}
+					expected.get_poa(&a[9], &a[10], &a[11], &a[12], &a[13], &a[14]);
+					cached.get_poa(&b[9], &b[10], &b[11], &b[12], &b[13], &b[14]);
+					a[15] = expected.get_sunpos_calc_hour();
+					b[15] = cached.get_sunpos_calc_hour();
+					mismatches += count_mismatches(b, a, 16);
+				}
+			});
+		EXPECT_EQ(mismatches, 0) << "latitude " << latitudes[loc];
+		EXPECT_EQ(cache.hits(), (size_t)(8760 * 4 - 365));
+	}
+}
+
+/// Rear-side irradiance with view factors kept across time steps is identical to calculating them each time step, for fixed tilt and one-axis tracking
+TEST_F(IrradTest, bifacialViewFactorsTest_lib_irradproc) {
+	tilt = 20;
+	rotlim = 45;
+	gcr = 0.3;
+
+	for (tracking = 0; tracking < 2; tracking++)
+	{
+		bifacial_view_factors viewFactors;
+		int mismatches = 0;
+		size_t sunUpSteps = 0;
+		for_each_step(1, [&](int m, int d, int h, double minute, size_t)
+		{
+			irrad expected, shared;
+			set_up_irrad(expected, m, d, h, minute, 1.0, 500, 100);
+			set_up_irrad(shared, m, d, h, minute, 1.0, 500, 100);
+			expected.calc();
+			shared.calc();
+			expected.calc_rear_side(0.013, 1, 1);
+			shared.calc_rear_side(0.013, 1, 1, &viewFactors);
+			double a = expected.get_poa_rear(), b = shared.get_poa_rear();
+			mismatches += count_mismatches(&b, &a, 1);
+
+			int sunup = 0;
+			expected.get_sun(0, 0, 0, 0, 0, 0, &sunup, 0, 0, 0);
+			if (sunup > 0) sunUpSteps++;
+		});
+		EXPECT_EQ(mismatches, 0) << "tracking mode " << tracking;
+		if (tracking == 0)
+		{
+			EXPECT_EQ(viewFactors.hits(), sunUpSteps - 1);
+		}
+	}
+}
+
+/// Rear irradiance, with and without shared view factors, matches the per-point sky configuration and back surface irradiance model it replaced
+TEST_F(IrradTest, bifacialReferenceTest_lib_irradproc) {
+	// reference values from the getSkyConfigurationFactors() and getBackSurfaceIrradiances() model, Phoenix AZ
+	struct geometry { int tracking; double tilt, gcr, clearance, slope; int m, d, h; double beam, diffuse, rear; };
+	geometry cases[5] = {
+		{ 0, 20, 0.3, 1, 1, 6, 21, 12, 500, 100, 66.224377 },
+		{ 0, 20, 0.3, 1, 1, 12, 21, 9, 500, 100, 30.733245 },
+		{ 0, 35, 0.5, 0.5, 2, 3, 15, 15, 700, 150, 32.698241 },
+		{ 1, 0, 0.3, 1, 1, 6, 21, 8, 500, 100, 43.446286 },
+		{ 1, 0, 0.4, 1.5, 2, 9, 10, 16, 600, 120, 28.280750 } };
+	lat = 33.45;
+	lon = -111.98;
+	tz = -7;
+	rotlim = 45;
+
+	for (size_t i = 0; i < 5; i++)
+	{
+		const geometry &g = cases[i];
+		tracking = g.tracking;
+		tilt = g.tilt;
+		gcr = g.gcr;
+		bifacial_view_factors viewFactors;
+		for (int pass = 0; pass < 2; pass++)
+		{
+			irrad irr;
+			set_up_irrad(irr, g.m, g.d, g.h, 30, 1.0, g.beam, g.diffuse);
+			irr.calc();
+			irr.calc_rear_side(0.013, g.clearance, g.slope, pass == 0 ? 0 : &viewFactors);
+			EXPECT_NEAR(irr.get_poa_rear(), g.rear, e) << "case " << i << " pass " << pass;
+		}
+	}
+}
+
+/// Batch POA decomposition matches poaDecomp() at every time step, and its warm start is as accurate in fewer model evaluations and skips sky changes
+TEST_F(IrradTest, poaDecompBatchTest_lib_irradproc) {
+	size_t stepsPerHour = 4, nrec = 8760 * stepsPerHour;
+	poaDecompReq pA;
+	pA.elev = 200;
+	pA.stepScale = 'm';
+	pA.stepSize = 15;
+	pA.POA.resize(nrec); pA.inc.resize(nrec); pA.tilt.resize(nrec); pA.zen.resize(nrec); pA.exTer.resize(nrec);
+	vector<double> tDew(nrec);
+
+	// measured POA from a sky that clears and clouds over from day to day
+	tilt = 30;
+	gcr = 0.3;
+	for_each_step(stepsPerHour, [&](int m, int d, int h, double minute, size_t idx)
+	{
+		irrad irr;
+		set_up_irrad(irr, m, d, h, minute, 1.0 / stepsPerHour, 0, 0);
+		irr.calc();
+
+		double zen, hextra, aoi, stilt;
+		int sunup;
+		irr.get_sun(0, &zen, 0, 0, 0, 0, &sunup, 0, 0, &hextra);
+		irr.get_angles(&aoi, &stilt, 0, 0, 0);
+		tDew[idx] = 5 + 10 * sin(idx * 0.001);
+		if (sunup == 0)
+		{
+			pA.inc[idx] = pA.tilt[idx] = -999;
+			pA.zen[idx] = zen * DTOR;
+			pA.exTer[idx] = hextra;
+			pA.POA[idx] = -999;
+			return;
+		}
+		pA.inc[idx] = aoi * DTOR;
+		pA.tilt[idx] = stilt * DTOR;
+		pA.zen[idx] = zen * DTOR;
+		pA.exTer[idx] = hextra;
+
+		double clearness = 0.55 + 0.45 * sin(idx * 0.05 / stepsPerHour);
+		double dn = clearness * 900 * pow(fmax(cos(pA.zen[idx]), 0), 0.3);
+		double df = 60 + (1 - clearness) * 200;
+		double poa[3], diffc[3];
+		perez(hextra, dn, df, alb, pA.inc[idx], pA.tilt[idx], pA.zen[idx], poa, diffc);
+		double total = poa[0] + poa[1] + poa[2];
+		pA.POA[idx] = (total > 0) ? total : -999;
+	});
+
+	vector<double> dn[2], df[2], gh[2], poa[2][3];
+	vector<int> errorcode[2];
+	poa_decomp_stats stats[2];
+	for (int warm = 0; warm < 2; warm++)
+	{
+		dn[warm].resize(nrec); df[warm].resize(nrec); gh[warm].resize(nrec); errorcode[warm].resize(nrec);
+		for (size_t j = 0; j < 3; j++) poa[warm][j].resize(nrec);
+		double *poaOut[3] = { &poa[warm][0][0], &poa[warm][1][0], &poa[warm][2][0] };
+		poaDecomp_batch(pA, 0, nrec, &tDew[0], alb, warm == 1, &dn[warm][0], &df[warm][0], &gh[warm][0], poaOut, &errorcode[warm][0], &stats[warm]);
+	}
+
+	// without warm start, identical to poaDecomp() as pvsamv1 calls it
+	int mismatches = 0;
+	for (size_t i = 1; i + 1 < nrec; i++)
+	{
+		if (pA.inc[i] == -999) continue;
+		pA.i = i;
+		pA.dayStart = i - i % (24 * stepsPerHour);
+		pA.doy = (int)(i / (24 * stepsPerHour));
+		pA.tDew = tDew[i];
+		double angle[5] = { pA.inc[i], pA.tilt[i], 0, 0, 0 };
+		double sun[9] = { 0, pA.zen[i], 0, 0, 0, 0, 0, 0, pA.exTer[i] };
+		double expected[7] = { 0, 0, 0, 0 }, diffc[3];
+		expected[0] = poaDecomp(pA.POA[i], angle, sun, alb, &pA, expected[1], expected[2], expected[3], &expected[4], diffc);
+		double batch[7] = { (double)errorcode[0][i], dn[0][i], df[0][i], gh[0][i], poa[0][0][i], poa[0][1][i], poa[0][2][i] };
+		mismatches += count_mismatches(batch, expected, 7);
+	}
+	EXPECT_EQ(mismatches, 0);
+
+	// with warm start, the modeled POA is as close to the measured POA
+	int worse = 0;
+	for (size_t i = 0; i < nrec; i++)
+	{
+		if (pA.inc[i] == -999 || pA.inc[i] >= M_PI / 2) continue;
+		double coldDiff = fabs(poa[0][0][i] + poa[0][1][i] + poa[0][2][i] - pA.POA[i]);
+		double warmDiff = fabs(poa[1][0][i] + poa[1][1][i] + poa[1][2][i] - pA.POA[i]);
+		if (warmDiff > fmax(1.0, coldDiff)) worse++;
+	}
+	EXPECT_EQ(worse, 0);
+	EXPECT_EQ(stats[0].steps, stats[1].steps);
+	EXPECT_EQ(stats[0].night, stats[1].night);
+	EXPECT_GT(stats[1].warmStarts, (size_t)0);
+	EXPECT_LT(stats[1].iterations, stats[0].iterations);
+	EXPECT_GT(stats[1].clearSky, (size_t)0);
+	EXPECT_GT(stats[1].skyChanges, (size_t)0);
+	EXPECT_EQ(stats[0].skyChanges, (size_t)0);
+}
+
+/// The batch sun position, incidence and sky model kernels match irrad::calc() and the scalar functions over a year
+TEST_F(IrradTest, batchKernelsTest_lib_irradproc) {
+	vector<int> y, m, d, h;
+	vector<double> minute;
+	for_each_step(1, [&](int mo, int dy, int hr, double mi, size_t)
+	{
+		y.push_back(year); m.push_back(mo); d.push_back(dy); h.push_back(hr); minute.push_back(mi);
+	});
+	size_t n = y.size();
+	double tolerance = IRRADPROC_BATCH_TOLERANCE;
+
+	vector<double> sun(9 * n);
+	vector<int> pos(3 * n);
+	double *sunn[9];
+	int *sunpos[3];
+	for (size_t k = 0; k < 9; k++) sunn[k] = &sun[k * n];
+	for (size_t k = 0; k < 3; k++) sunpos[k] = &pos[k * n];
+	sun_position_batch(n, &y[0], &m[0], &d[0], &h[0], &minute[0], 1.0, lat, lon, tz, sunn, sunpos);
+
+	int mismatches = 0;
+	vector<double> zen, azm, hextra, dn, df, albedo;
+	for (size_t i = 0; i < n; i++)
+	{
+		irrad irr;
+		set_up_irrad(irr, m[i], d[i], h[i], minute[i], 1.0, 0, 0);
+		irr.calc();
+		for (size_t k = 0; k < 9; k++)
+		{
+			double expected = irr.get_sun_component(k);
+			mismatches += count_mismatches(&sunn[k][i], &expected, 1, tolerance);
+		}
+		if (sunpos[0][i] + sunpos[1][i] / 60.0 != irr.get_sunpos_calc_hour()) mismatches++;
+
+		int sunup;
+		irr.get_sun(0, 0, 0, 0, 0, 0, &sunup, 0, 0, 0);
+		if (sunpos[2][i] != sunup) mismatches++;
+		if (sunup > 0)
+		{
+			zen.push_back(sunn[1][i]);
+			azm.push_back(sunn[0][i]);
+			hextra.push_back(sunn[8][i]);
+			dn.push_back(900 * cos(sunn[1][i]) * (i % 3) / 2.0);
+			df.push_back((i % 5) * 40.0);
+			albedo.push_back(0.2 + 0.1 * (i % 2));
+		}
+	}
+	EXPECT_EQ(mismatches, 0) << "sun position";
+
+	size_t nup = zen.size();
+	vector<double> angles(5 * nup), poa(3 * nup), diffc(3 * nup);
+	double *angle[5], *p[3], *c[3];
+	for (size_t k = 0; k < 5; k++) angle[k] = &angles[k * nup];
+	for (size_t k = 0; k < 3; k++) p[k] = &poa[k * nup];
+	for (size_t k = 0; k < 3; k++) c[k] = &diffc[k * nup];
+
+	for (int mode = 0; mode <= 4; mode++)
+	{
+		bool en_backtrack = (mode == 1);
+		incidence_batch(nup, mode, 25, 170, 45, &zen[0], &azm[0], en_backtrack, 0.4, angle);
+		mismatches = 0;
+		for (size_t i = 0; i < nup; i++)
+		{
+			double a[5], batch[5];
+			incidence(mode, 25, 170, 45, zen[i], azm[i], en_backtrack, 0.4, a);
+			for (size_t k = 0; k < 5; k++) batch[k] = angle[k][i];
+			mismatches += count_mismatches(batch, a, 5, tolerance);
+		}
+		EXPECT_EQ(mismatches, 0) << "incidence mode " << mode;
+
+		for (int model = 0; model < 3; model++)
+		{
+			if (model == 0) isotropic_batch(nup, &hextra[0], &dn[0], &df[0], &albedo[0], angle[0], angle[1], &zen[0], p, c);
+			else if (model == 1) hdkr_batch(nup, &hextra[0], &dn[0], &df[0], &albedo[0], angle[0], angle[1], &zen[0], p, c);
+			else perez_batch(nup, &hextra[0], &dn[0], &df[0], &albedo[0], angle[0], angle[1], &zen[0], p, c);
+			mismatches = 0;
+			for (size_t i = 0; i < nup; i++)
+			{
+				double a[6], batch[6];
+				if (model == 0) isotropic(hextra[i], dn[i], df[i], albedo[i], angle[0][i], angle[1][i], zen[i], &a[0], &a[3]);
+				else if (model == 1) hdkr(hextra[i], dn[i], df[i], albedo[i], angle[0][i], angle[1][i], zen[i], &a[0], &a[3]);
+				else perez(hextra[i], dn[i], df[i], albedo[i], angle[0][i], angle[1][i], zen[i], &a[0], &a[3]);
+				for (size_t k = 0; k < 3; k++)
+				{
+					batch[k] = p[k][i];
+					batch[k + 3] = c[k][i];
+				}
+				mismatches += count_mismatches(batch, a, 6, tolerance);
+			}
+			EXPECT_EQ(mismatches, 0) << "sky model " << model << " incidence mode " << mode;
+		}
+	}
+}
+
 TEST_F(DayCaseIrradProc, solarposTest_lib_irradproc){
 	double sun[9];
 	vector<double> sunrise_times;
@@ -1,6 +1,8 @@
 #ifndef __LIB_IRRADPROC_TEST_H_
 #define __LIB_IRRADPROC_TEST_H_
 
+#include <algorithm>
+#include <cmath>
 #include <cstdlib>
 #include <string>
 #include <iosfwd>
@@ -50,6 +52,38 @@ protected:
 		calc_sunrise = 5.70924; // 5:43 am
 		calc_sunset = 19.5179;  // 7:31 pm
 	}
+
+	/// Calls step(month, day, hour, minute, index) for each time step of a non-leap year with stepsPerHour steps an hour, at the middle of the step
+	template <typename Step>
+	void for_each_step(size_t stepsPerHour, Step step) const
+	{
+		int nday[12] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+		size_t index = 0;
+		for (int m = 1; m <= 12; m++)
+			for (int d = 1; d <= nday[m - 1]; d++)
+				for (int h = 0; h < 24; h++)
+					for (size_t q = 0; q < stepsPerHour; q++, index++)
+						step(m, d, h, (q + 0.5) * 60.0 / stepsPerHour, index);
+	}
+
+	/// Sets up irr for a time step with the location, sky model and surface of the test
+	void set_up_irrad(irrad &irr, int m, int d, int h, double minute, double dtHour, double beam, double diffuse) const
+	{
+		irr.set_time(year, m, d, h, minute, dtHour);
+		irr.set_location(lat, lon, tz);
+		irr.set_sky_model(skymodel, alb);
+		irr.set_beam_diffuse(beam, diffuse);
+		irr.set_surface(tracking, tilt, azim, rotlim, backtrack_on, gcr);
+	}
+
+	/// Number of the n values of a that differ from those of b by more than tolerance, relative to values of b above one; NaN matches NaN
+	static int count_mismatches(const double *a, const double *b, size_t n, double tolerance = 0)
+	{
+		int mismatches = 0;
+		for (size_t i = 0; i < n; i++)
+			if (!(std::isnan(a[i]) && std::isnan(b[i])) && !(fabs(a[i] - b[i]) <= tolerance * std::max(1.0, fabs(b[i])))) mismatches++;
+		return mismatches;
+	}
 };
 
 class NightCaseIrradProc : public IrradTest {
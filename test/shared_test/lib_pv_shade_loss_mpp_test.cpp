@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "lib_pv_shade_loss_mpp.h"
+#include "lib_miniz.h"
+
+// the nested-loop search get_shade_loss used to find the database row: the loop over the second string stops at a
+// match, the loops over the following strings stop only after the innermost loop has finished counting
+static void nested_loop_search(const std::vector<int> &pattern, std::vector<int> &cur_case, int &counter, bool &found)
+{
+	size_t level = cur_case.size();
+	for (int i = 0; i <= cur_case.back(); i++)
+	{
+		cur_case.push_back(i);
+		if (cur_case.size() == pattern.size())
+		{
+			counter++;
+			if (cur_case == pattern)
+				found = true;
+		}
+		else
+			nested_loop_search(pattern, cur_case, counter, found);
+		cur_case.pop_back();
+		if (found && ((level == 1) || (level + 1 < pattern.size())))
+			break;
+	}
+}
+
+static void all_patterns(std::vector<int> &pattern, size_t num_strings, std::vector<std::vector<int>> &patterns)
+{
+	if (pattern.size() == num_strings)
+	{
+		patterns.push_back(pattern);
+		return;
+	}
+	int s_max = pattern.empty() ? 10 : pattern.back();
+	for (int s = 0; s <= s_max; s++)
+	{
+		pattern.push_back(s);
+		all_patterns(pattern, num_strings, patterns);
+		pattern.pop_back();
+	}
+}
+
+/// Database instances on several threads share one decompression of the tables and read the same values as decompressing the data directly
+TEST(libPvShadeLossMppTests, sharedTables_lib_pv_shade_loss_mpp)
+{
+	const size_t table_size = 12091680;
+	std::vector<unsigned char> expected(2 * table_size);
+	size_t status = tinfl_decompress_mem_to_mem((void *)expected.data(), expected.size(), pCmp_data, sizeof(pCmp_data), TINFL_FLAG_PARSE_ZLIB_HEADER);
+	bool decompressed = (status != TINFL_DECOMPRESS_MEM_TO_MEM_FAILED);
+
+	const size_t n_threads = 4;
+	std::vector<size_t> differences(n_threads, 0);
+	std::vector<std::string> errors(n_threads);
+	std::vector<std::thread> threads;
+	for (size_t t = 0; t < n_threads; t++)
+	{
+		threads.push_back(std::thread([&, t]()
+		{
+			ShadeDB8_mpp db8;
+			db8.init();
+			for (size_t i = t; i < table_size / 2; i += 997)
+			{
+				short vmpp = -1, impp = -1;
+				if (decompressed)
+				{
+					vmpp = (short)((expected[2 * i + 1] << 8) | expected[2 * i]);
+					impp = (short)((expected[table_size + 2 * i + 1] << 8) | expected[table_size + 2 * i]);
+				}
+				if (db8.vmpp(i) != vmpp || db8.impp(i) != impp)
+					differences[t]++;
+			}
+			errors[t] = db8.get_error();
+		}));
+	}
+	for (size_t t = 0; t < n_threads; t++)
+	{
+		threads[t].join();
+		EXPECT_EQ(differences[t], 0) << "Thread " << t;
+		EXPECT_EQ(errors[t].empty(), decompressed) << "Thread " << t;
+	}
+
+	ShadeDB8_mpp db8;
+	db8.init();
+	EXPECT_EQ(db8.vmpp(table_size / 2), -1);
+}
+
+/// The closed-form pattern index matches the nested-loop search for every sorted pattern of up to 8 strings
+TEST(libPvShadeLossMppTests, patternIndex_lib_pv_shade_loss_mpp)
+{
+	ShadeDB8_mpp db8;
+	size_t n_patterns = 0;
+	for (size_t num_strings = 1; num_strings <= 8; num_strings++)
+	{
+		std::vector<int> pattern;
+		std::vector<std::vector<int>> patterns;
+		all_patterns(pattern, num_strings, patterns);
+		for (size_t p = 0; p < patterns.size(); p++)
+		{
+			int counter = 1;
+			if (num_strings > 1)
+			{
+				counter = 0;
+				bool found = false;
+				std::vector<int> cur_case(1, patterns[p][0]);
+				nested_loop_search(patterns[p], cur_case, counter, found);
+			}
+			size_t S = db8.get_pattern_index(patterns[p].data(), num_strings);
+			EXPECT_EQ(S, (size_t)counter) << "Strings " << num_strings << " pattern " << p;
+			size_t ndx;
+			if (patterns[p][0] > 0)
+			{
+				EXPECT_TRUE(db8.get_index(num_strings, 1, patterns[p][0], S, ShadeDB8_mpp::VMPP, &ndx));
+			}
+			n_patterns++;
+		}
+	}
+	EXPECT_EQ(n_patterns, 75581);
+}
+
+/// Shade losses read through the row cache match those of a new database instance for every pattern
+TEST(libPvShadeLossMppTests, rowCache_lib_pv_shade_loss_mpp)
+{
+	ShadeDB8_mpp cached;
+	cached.init();
+	for (size_t num_strings = 1; num_strings <= 8; num_strings += 3)
+	{
+		std::vector<int> pattern;
+		std::vector<std::vector<int>> patterns;
+		all_patterns(pattern, num_strings, patterns);
+		for (size_t p = 0; p < patterns.size(); p += 7)
+		{
+			for (size_t repeat = 0; repeat < 2; repeat++)
+			{
+				double gpoa = 800, dpoa = 250 + 50 * repeat;
+				std::vector<double> shade(patterns[p].rbegin(), patterns[p].rend());
+				for (size_t i = 0; i < shade.size(); i++)
+					shade[i] *= 10.0;
+				std::vector<double> shade_new = shade;
+				double loss_cached = cached.get_shade_loss(gpoa, dpoa, shade, true, 45, 10, 300, 250, 480);
+				ShadeDB8_mpp db8;
+				db8.init();
+				double loss_new = db8.get_shade_loss(gpoa, dpoa, shade_new, true, 45, 10, 300, 250, 480);
+				EXPECT_EQ(loss_cached, loss_new) << "Strings " << num_strings << " pattern " << p;
+			}
+		}
+	}
+}
@@ -13,4 +13,82 @@ TEST(libUtilTests, testFormat_lib_util)
 	str = "query point (301.3, 10.4) is too far out of convex hull of data (dist=4.3)... estimating value from 5 parameter modele at (2.2, 2.1)=2.4";
 	ASSERT_EQ(util::format("query point (%lg, %lg) is too far out of convex hull of data (dist=%lg)... estimating value from 5 parameter modele at (%lg, %lg)=%lg",
 		301.3, 10.4, 4.3, 2.2, 2.1, 2.4), str);
-}
\ No newline at end of file
+}
+TEST(libUtilTests, testParallelFor_lib_util)
+{
+	std::vector<size_t> out(1000, 0);
+	util::parallel_for(out.size(), 4, [&out](size_t i) { out[i] = i * i; });
+	for (size_t i = 0; i < out.size(); i++)
+		ASSERT_EQ(out[i], i * i);
+
+	// the first exception is passed back to the caller
+	EXPECT_THROW(util::parallel_for(100, 4, [](size_t i) { if (i == 42) throw std::runtime_error("fail"); }), std::runtime_error);
+}
+TEST(libUtilTests, testGoldenSectionMax_lib_util)
+{
+	size_t evaluations = 0;
+	double f_max = 0;
+	double x = util::golden_section_max([](double v) { return v * (10 - v); }, 0, 8, 1e-6, f_max, &evaluations);
+	EXPECT_NEAR(x, 5, 1e-6);
+	EXPECT_NEAR(f_max, 25, 1e-9);
+	EXPECT_LT(evaluations, (size_t)40);
+
+	// a maximum at the end of the interval
+	x = util::golden_section_max([](double v) { return v; }, 0, 8, 1e-6, f_max);
+	EXPECT_NEAR(x, 8, 1e-6);
+}
+static void count_release(double *, void *count)
+{
+	(*static_cast<int*>(count))++;
+}
+
+TEST(libUtilTests, testMatrixExternal_lib_util)
+{
+	double buf[6] = { 5, 2, 3, 9, 1, 4 };
+	int n_released = 0;
+	{
+		util::matrix_t<double> borrowed;
+		borrowed.assign_external(buf, 2, 3);
+		EXPECT_TRUE(borrowed.is_external());
+		EXPECT_EQ(borrowed.data(), buf);
+		EXPECT_EQ(borrowed.at(1, 0), 9);
+
+		// copies never share the external memory, and assigning never writes to it
+		util::matrix_t<double> copied(borrowed);
+		EXPECT_FALSE(copied.is_external());
+		EXPECT_NE(copied.data(), buf);
+		double other[2] = { 7, 8 };
+		borrowed.assign(other, 2);
+		EXPECT_FALSE(borrowed.is_external());
+		EXPECT_EQ(buf[0], 5);
+
+		// nor does filling or resizing to the same size
+		borrowed.assign_external(buf, 2, 3);
+		borrowed.resize(2, 3);
+		EXPECT_FALSE(borrowed.is_external());
+		EXPECT_EQ(borrowed.at(1, 0), 9);
+		borrowed.assign_external(buf, 2, 3);
+		borrowed.resize_fill(2, 3, 0.0);
+		EXPECT_FALSE(borrowed.is_external());
+		borrowed.assign_external(buf, 2, 3);
+		borrowed.fill(0.0);
+		EXPECT_FALSE(borrowed.is_external());
+		EXPECT_EQ(borrowed.at(1, 0), 0);
+		EXPECT_EQ(buf[0], 5);
+		EXPECT_EQ(buf[3], 9);
+
+		util::matrix_t<double> owned;
+		owned.assign_external(buf, 1, 6, count_release, &n_released);
+		EXPECT_EQ(n_released, 0);
+
+		// release_data hands back new[] memory, so the external buffer is copied and given back
+		double *p = owned.release_data();
+		EXPECT_EQ(n_released, 1);
+		EXPECT_NE(p, buf);
+		EXPECT_EQ(p[5], 4);
+		delete[] p;
+
+		owned.assign_external(buf, 1, 6, count_release, &n_released);
+	}
+	EXPECT_EQ(n_released, 2);
+}
@@ -1,6 +1,16 @@
 #include <string>
 #include <vector>
 #include <cmath>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <unistd.h>
+#endif
  
 #include <gtest/gtest.h>
 #include "lib_weatherfile.h"
@@ -127,6 +137,393 @@ TEST_F(CSVCase_WeatherfileTest, readTest_lib_weatherfile){
 	EXPECT_EQ(wf.get_counter_value(), 1);
 }
 
+/// Writes a one year SAM CSV file with values in the formats found in weather files, some with more digits than a float holds
+static std::vector<std::vector<std::string>> write_generated_csv(const std::string &file, int steps_per_hour)
+{
+	std::vector<std::vector<std::string>> values(8760 * steps_per_hour);
+	FILE *fp = fopen(file.c_str(), "w");
+	fprintf(fp, "Source,Location ID,City,State,Country,Latitude,Longitude,Time Zone,Elevation\n");
+	fprintf(fp, "Generated,0,Golden,CO,USA,39.74,-105.18,-7,1829\n");
+	fprintf(fp, "Year,Month,Day,Hour,Minute,GHI,DNI,DHI,Tdry,Tdew,RH,Pressure,Wspd,Wdir\n");
+	int days[12] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+	char buf[9][32];
+	size_t i = 0;
+	for (int m = 0; m < 12; m++)
+		for (int d = 0; d < days[m]; d++)
+			for (int h = 0; h < 24; h++)
+				for (int s = 0; s < steps_per_hour; s++, i++)
+				{
+					sprintf(buf[0], "%d", (int)(i % 1001));
+					sprintf(buf[1], "%.1f", (i % 9001) * 0.1);
+					sprintf(buf[2], "%.3f", (i % 313) * 0.913);
+					sprintf(buf[3], "%.1f", ((int)(i % 900) - 400) * 0.1);
+					sprintf(buf[4], "%.2f", ((int)(i % 700) - 500) * 0.03);
+					sprintf(buf[5], "%.7g", (i % 997) * 0.100109);
+					sprintf(buf[6], " %.1f", 800 + (i % 4001) * 0.05);
+					sprintf(buf[7], "%.9f", (i % 211) / 7.0);
+					sprintf(buf[8], "%g", (i % 360) * 1e5 / 3.0);
+					fprintf(fp, "2018,%d,%d,%d,%d", m + 1, d + 1, h, s * 60 / steps_per_hour);
+					for (int k = 0; k < 9; k++)
+					{
+						fprintf(fp, ",%s", buf[k]);
+						values[i].push_back(buf[k]);
+					}
+					fprintf(fp, "\n");
+				}
+	fclose(fp);
+	return values;
+}
+
+/// Values in a generated file match strtof, and the test weather files open
+TEST(WeatherfileParser, GeneratedFile_lib_weatherfile)
+{
+	std::string file = "weatherfile_parser_test.csv";
+	std::vector<std::vector<std::string>> values = write_generated_csv(file, 1);
+
+	weatherfile wf(file);
+	std::remove(file.c_str());
+	ASSERT_TRUE(wf.ok()) << wf.message();
+	ASSERT_EQ(wf.nrecords(), (size_t)8760);
+
+	weather_record r;
+	int mismatches = 0;
+	for (size_t i = 0; i < values.size(); i++)
+	{
+		ASSERT_TRUE(wf.read(&r));
+		double parsed[9] = { r.gh, r.dn, r.df, r.tdry, r.tdew, r.rhum, r.pres, r.wspd, r.wdir };
+		for (int k = 0; k < 9; k++)
+			if (parsed[k] != (double)std::stof(values[i][k])) mismatches++;
+	}
+	EXPECT_EQ(mismatches, 0);
+
+	const char *docs[] = { "weather.csv", "weather-noRHum.csv", "weather_15mInterpolated.csv", "weather_30mInterpolated.csv", "weather_30m.epw", "weather_noLineEnding.epw" };
+	for (size_t i = 0; i < sizeof(docs) / sizeof(docs[0]); i++)
+	{
+		std::string path = std::string(std::getenv("SSCDIR")) + "/test/input_docs/" + docs[i];
+		weatherfile doc(path);
+		EXPECT_TRUE(doc.ok()) << docs[i];
+	}
+}
+
+/// Times opening the test weather files and generated hourly, 15 minute and one minute files; run with --gtest_also_run_disabled_tests
+TEST(WeatherfileParser, DISABLED_Benchmark_lib_weatherfile)
+{
+	std::vector<std::string> files;
+	const char *docs[] = { "weather.csv", "weather-noRHum.csv", "weather_15mInterpolated.csv", "weather_30mInterpolated.csv", "weather_30m.epw", "weather_noLineEnding.epw" };
+	for (size_t i = 0; i < sizeof(docs) / sizeof(docs[0]); i++)
+		files.push_back(std::string(std::getenv("SSCDIR")) + "/test/input_docs/" + docs[i]);
+	int steps_per_hour[] = { 1, 4, 60 };
+	for (size_t i = 0; i < 3; i++)
+	{
+		files.push_back("weatherfile_benchmark_" + std::to_string(steps_per_hour[i]) + ".csv");
+		write_generated_csv(files.back(), steps_per_hour[i]);
+	}
+
+	const int passes = 5;
+	for (size_t i = 0; i < files.size(); i++)
+	{
+		double best = 0;
+		size_t nrecords = 0;
+		for (int n = 0; n < passes; n++)
+		{
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			weatherfile wf(files[i]);
+			double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+			ASSERT_TRUE(wf.ok()) << files[i] << ": " << wf.message();
+			nrecords = wf.nrecords();
+			if (n == 0 || elapsed < best) best = elapsed;
+		}
+		printf("%-32s %8zu records %10.2f ms %12.0f records/s\n", files[i].substr(files[i].find_last_of("/\\") + 1).c_str(), nrecords, best, nrecords / (best / 1000));
+	}
+
+	for (size_t i = 0; i < 3; i++)
+		std::remove(files[files.size() - 1 - i].c_str());
+}
+
+/// Records read from a binary cache match the text file, and a changed text file bypasses its stale sidecar cache
+TEST(WeatherfileBinary, SidecarCache_lib_weatherfile)
+{
+	std::string file = "weatherfile_binary_test.epw";
+	std::string cache = weatherfile::binary_cache_file(file);
+	{
+		std::ifstream in(std::string(std::getenv("SSCDIR")) + "/test/input_docs/weather_30m.epw", std::ios::binary);
+		std::ofstream out(file.c_str(), std::ios::binary);
+		out << in.rdbuf();
+	}
+
+	weatherfile text(file);
+	ASSERT_TRUE(text.ok()) << text.message();
+	EXPECT_FALSE(text.from_binary());
+	ASSERT_TRUE(weatherfile::convert_to_binary(file, cache));
+
+	weatherfile binary(file);
+	ASSERT_TRUE(binary.ok()) << binary.message();
+	EXPECT_TRUE(binary.from_binary());
+
+	EXPECT_EQ(binary.type(), text.type());
+	EXPECT_EQ(binary.nrecords(), text.nrecords());
+	EXPECT_EQ(binary.step_sec(), text.step_sec());
+	EXPECT_EQ(binary.start_sec(), text.start_sec());
+	EXPECT_EQ(binary.header().city, text.header().city);
+	EXPECT_EQ(binary.lat(), text.lat());
+	for (size_t id = 0; id < weather_data_provider::_MAXCOL_; id++)
+		EXPECT_EQ(binary.has_data_column(id), text.has_data_column(id));
+
+	weather_record a, b;
+	int mismatches = 0;
+	for (size_t i = 0; i < text.nrecords(); i++)
+	{
+		ASSERT_TRUE(text.read(&a));
+		ASSERT_TRUE(binary.read(&b));
+		double va[] = { a.gh, a.dn, a.df, a.poa, a.wspd, a.wdir, a.tdry, a.twet, a.tdew, a.rhum, a.pres, a.snow, a.alb, a.aod, a.minute };
+		double vb[] = { b.gh, b.dn, b.df, b.poa, b.wspd, b.wdir, b.tdry, b.twet, b.tdew, b.rhum, b.pres, b.snow, b.alb, b.aod, b.minute };
+		for (size_t k = 0; k < sizeof(va) / sizeof(va[0]); k++)
+			if (va[k] != vb[k] && !(std::isnan(va[k]) && std::isnan(vb[k]))) mismatches++;
+		if (a.year != b.year || a.month != b.month || a.day != b.day || a.hour != b.hour) mismatches++;
+	}
+	EXPECT_EQ(mismatches, 0);
+
+	weatherfile direct(cache);
+	EXPECT_TRUE(direct.ok()) << direct.message();
+	EXPECT_TRUE(direct.from_binary());
+
+	{
+		std::ofstream out(file.c_str(), std::ios::binary | std::ios::app);
+		out << "\n";
+	}
+	weatherfile changed(file);
+	EXPECT_TRUE(changed.ok()) << changed.message();
+	EXPECT_FALSE(changed.from_binary());
+
+	std::remove(file.c_str());
+	std::remove(cache.c_str());
+}
+
+/// Several writers of the same cache at once each write their own temporary file, and the cache left behind is complete
+TEST(WeatherfileBinary, ConcurrentWriters_lib_weatherfile)
+{
+	std::string file = "weatherfile_binary_writers.epw";
+	std::string cache = weatherfile::binary_cache_file(file);
+	{
+		std::ifstream in(std::string(std::getenv("SSCDIR")) + "/test/input_docs/weather_30m.epw", std::ios::binary);
+		std::ofstream out(file.c_str(), std::ios::binary);
+		out << in.rdbuf();
+	}
+	weatherfile text(file);
+	ASSERT_TRUE(text.ok()) << text.message();
+
+	std::vector<std::thread> writers;
+	std::vector<int> written(8, 0);
+	for (size_t t = 0; t < written.size(); t++)
+		writers.push_back(std::thread([&file, &cache, &written, t]() {
+			for (int k = 0; k < 5; k++)
+				if (weatherfile::convert_to_binary(file, cache)) written[t]++;
+		}));
+	for (size_t t = 0; t < writers.size(); t++)
+		writers[t].join();
+	for (size_t t = 0; t < written.size(); t++)
+		EXPECT_EQ(written[t], 5) << "writer " << t;
+
+	weatherfile binary(file);
+	ASSERT_TRUE(binary.ok()) << binary.message();
+	EXPECT_TRUE(binary.from_binary());
+	ASSERT_EQ(binary.nrecords(), text.nrecords());
+	weather_record a, b;
+	int mismatches = 0;
+	for (size_t i = 0; i < text.nrecords(); i++)
+	{
+		ASSERT_TRUE(text.read(&a));
+		ASSERT_TRUE(binary.read(&b));
+		if (a.gh != b.gh || a.dn != b.dn || a.tdry != b.tdry || a.wspd != b.wspd) mismatches++;
+	}
+	EXPECT_EQ(mismatches, 0);
+	EXPECT_FALSE(util::file_exists((cache + ".tmp").c_str()));
+
+	std::remove(file.c_str());
+	std::remove(cache.c_str());
+}
+
+/// With the process-wide cache on, repeated opens share one data set, and each reader, including concurrent ones, has its own position
+TEST(WeatherfileCache, SharedDataSet_lib_weatherfile)
+{
+	std::string file = std::string(std::getenv("SSCDIR")) + "/test/input_docs/weather.csv";
+	weatherfile text(file);
+	ASSERT_TRUE(text.ok()) << text.message();
+	EXPECT_FALSE(text.from_cache());
+
+	weatherfile::set_cache_limit(2);
+	weatherfile first(file), second(file);
+	ASSERT_TRUE(first.ok()) << first.message();
+	ASSERT_TRUE(second.ok()) << second.message();
+	EXPECT_TRUE(first.from_cache());
+	EXPECT_TRUE(second.from_cache());
+	EXPECT_EQ(first.nrecords(), text.nrecords());
+	EXPECT_EQ(first.header().city, text.header().city);
+
+	weather_record a, b;
+	for (size_t i = 0; i < 10; i++)
+		first.read(&a);
+	EXPECT_EQ(first.get_counter_value(), 10);
+	EXPECT_EQ(second.get_counter_value(), 0);
+
+	// clearing the cache leaves open readers intact
+	weatherfile::set_cache_limit(0);
+	EXPECT_TRUE(first.read(&a));
+	EXPECT_EQ(first.get_counter_value(), 11);
+
+	std::vector<double> ghi;
+	text.rewind();
+	while (text.read(&a))
+		ghi.push_back(a.gh);
+
+	weatherfile::set_cache_limit(1);
+	int mismatches[4] = { 0, 0, 0, 0 };
+	std::vector<std::thread> threads;
+	for (int t = 0; t < 4; t++)
+	{
+		threads.push_back(std::thread([&file, &ghi, &mismatches, t]() {
+			weatherfile shared(file);
+			weather_record y;
+			size_t n = 0;
+			while (shared.read(&y))
+			{
+				if (n >= ghi.size() || !(y.gh == ghi[n] || (std::isnan(y.gh) && std::isnan(ghi[n])))) mismatches[t]++;
+				n++;
+			}
+			if (n != ghi.size() || !shared.from_cache()) mismatches[t]++;
+		}));
+	}
+	for (size_t t = 0; t < threads.size(); t++)
+		threads[t].join();
+	weatherfile::set_cache_limit(0);
+
+	for (int t = 0; t < 4; t++)
+		EXPECT_EQ(mismatches[t], 0) << "thread " << t;
+
+	second.rewind();
+	text.rewind();
+	for (size_t i = 0; i < text.nrecords(); i++)
+	{
+		ASSERT_TRUE(text.read(&a));
+		ASSERT_TRUE(second.read(&b));
+		ASSERT_EQ(a.dn, b.dn);
+	}
+}
+
+/// Averaged reads match a direct average over the centered window, for weather files and for inline data tables
+TEST(WeatherAverage, ReadAverage_lib_weatherfile)
+{
+	weatherfile wf(std::string(std::getenv("SSCDIR")) + "/test/input_docs/weather.csv");
+	ASSERT_TRUE(wf.ok()) << wf.message();
+
+	size_t n = wf.nrecords();
+	std::vector<double> gh(n), tdry(n);
+	weather_record r;
+	for (size_t i = 0; i < n; i++)
+	{
+		ASSERT_TRUE(wf.read(&r));
+		gh[i] = r.gh;
+		tdry[i] = r.tdry;
+	}
+
+	var_data table;
+	table.type = SSC_TABLE;
+	table.table.assign("lat", 40);
+	table.table.assign("lon", -105);
+	table.table.assign("tz", -7);
+	table.table.assign("elev", 1800);
+	table.table.assign("gh", var_data(&gh[0], (int)n));
+	table.table.assign("tdry", var_data(&tdry[0], (int)n));
+	weatherdata wd(&table);
+
+	std::vector<int> cols = { weather_data_provider::GHI, weather_data_provider::TDRY };
+	size_t window = 5;
+	weather_data_provider *providers[2] = { &wf, &wd };
+	for (int p = 0; p < 2; p++)
+	{
+		providers[p]->rewind();
+		int mismatches = 0;
+		for (size_t i = 0; i < n; i++)
+		{
+			ASSERT_TRUE(providers[p]->read_average(&r, cols, window));
+			size_t start = (i > window / 2) ? i - window / 2 : 0;
+			if (start + window > n) start = n - window;
+			double sum_gh = 0, sum_tdry = 0;
+			for (size_t j = start; j < start + window; j++)
+			{
+				sum_gh += gh[j];
+				sum_tdry += tdry[j];
+			}
+			if (std::abs(r.gh - sum_gh / window) > 1e-6 || std::abs(r.tdry - sum_tdry / window) > 1e-6) mismatches++;
+		}
+		EXPECT_EQ(mismatches, 0) << "provider " << p;
+		EXPECT_FALSE(providers[p]->read_average(&r, cols, window));
+	}
+}
+
+/// Streaming a weather file in small chunks gives the same records as loading it, including after seeks and for averaged reads
+TEST(WeatherfileStream, ChunkedReads_lib_weatherfile)
+{
+	std::string file = "weatherfile_stream_test.epw";
+	{
+		std::ifstream in(std::string(std::getenv("SSCDIR")) + "/test/input_docs/weather_30m.epw", std::ios::binary);
+		std::ofstream out(file.c_str(), std::ios::binary);
+		out << in.rdbuf();
+	}
+
+	weatherfile wf(file);
+	ASSERT_TRUE(wf.ok()) << wf.message();
+	{
+		weatherfile_stream ws(file, 1000);
+		ASSERT_TRUE(ws.ok()) << ws.message();
+		EXPECT_EQ(ws.nrecords(), wf.nrecords());
+		EXPECT_EQ(ws.step_sec(), wf.step_sec());
+		EXPECT_EQ(ws.type(), wf.type());
+		EXPECT_EQ(ws.header().city, wf.header().city);
+		for (size_t id = 0; id < weather_data_provider::_MAXCOL_; id++)
+			EXPECT_EQ(ws.has_data_column(id), wf.has_data_column(id));
+
+		weather_record a, b;
+		int mismatches = 0;
+		for (int pass = 0; pass < 2; pass++)
+		{
+			wf.rewind();
+			ws.rewind();
+			while (wf.read(&a))
+			{
+				ASSERT_TRUE(ws.read(&b));
+				if (a.gh != b.gh || a.dn != b.dn || a.tdry != b.tdry || a.hour != b.hour || a.minute != b.minute) mismatches++;
+			}
+			EXPECT_FALSE(ws.read(&b));
+		}
+
+		size_t seeks[] = { 12345, 17519, 0, 999, 1000 };
+		for (size_t i = 0; i < sizeof(seeks) / sizeof(seeks[0]); i++)
+		{
+			wf.set_counter_to(seeks[i]);
+			ws.set_counter_to(seeks[i]);
+			ASSERT_TRUE(wf.read(&a));
+			ASSERT_TRUE(ws.read(&b));
+			if (a.gh != b.gh || a.tdew != b.tdew) mismatches++;
+		}
+
+		std::vector<int> cols = { weather_data_provider::GHI, weather_data_provider::TDRY };
+		size_t window = 7;
+		wf.set_counter_to(990);
+		ws.set_counter_to(990);
+		for (size_t i = 0; i < 20; i++)
+		{
+			ASSERT_TRUE(wf.read_average(&a, cols, window));
+			ASSERT_TRUE(ws.read_average(&b, cols, window));
+			if (std::abs(a.gh - b.gh) > 1e-6 || std::abs(a.tdry - b.tdry) > 1e-6) mismatches++;
+		}
+		EXPECT_EQ(mismatches, 0);
+	}
+
+	std::remove(file.c_str());
+	std::remove(weatherfile::binary_cache_file(file).c_str());
+}
+
 TEST_F(weatherfileTest, EPWTest_lib_weatherfile) {
 	char filepath[256];
 	int n1 = sprintf(filepath, "%s/test/input_docs/weather_30m.epw", std::getenv("SSCDIR"));
@@ -307,3 +704,85 @@ TEST_F(Data9999CaseWeatherData, readTest2_lib_weatherfile){
 	std::string error = "aod number of entries doesn't match with other fields";
 	EXPECT_EQ(error, wd.message()) << "Irradiance entry length mismatch";
 }
+
+/// One minute data: records are read from the table arrays by index, and missing wet bulb and dew point temperatures are calculated
+TEST(DataMinuteCaseWeatherData, readTest_lib_weatherfile){
+	size_t n = 525600;
+	std::vector<ssc_number_t> gh(n), tdry(n), rhum(n), pres(n);
+	for (size_t i = 0; i < n; i++)
+	{
+		gh[i] = (ssc_number_t)(i % 1000);
+		tdry[i] = (ssc_number_t)((int)(i % 400) - 100) * 0.1;
+		rhum[i] = (ssc_number_t)(i % 100);
+		pres[i] = (ssc_number_t)(900 + i % 100);
+	}
+	var_data table;
+	table.type = SSC_TABLE;
+	table.table.assign("lat", 40);
+	table.table.assign("lon", -105);
+	table.table.assign("tz", -7);
+	table.table.assign("elev", 1800);
+	table.table.assign("gh", var_data(&gh[0], (int)n));
+	table.table.assign("tdry", var_data(&tdry[0], (int)n));
+	table.table.assign("rhum", var_data(&rhum[0], (int)n));
+	table.table.assign("pres", var_data(&pres[0], (int)n));
+
+	weatherdata wd(&table);
+	weather_record r;
+	size_t count = 0, mismatches = 0;
+	while (wd.read(&r))
+	{
+		if (r.gh != gh[count] || r.tdry != tdry[count]) mismatches++;
+		if (r.twet != (float)calc_twet(tdry[count], rhum[count], pres[count])) mismatches++;
+		if (r.tdew != (float)wiki_dew_calc(tdry[count], rhum[count])) mismatches++;
+		count++;
+	}
+
+	EXPECT_FALSE(wd.has_message()) << wd.message();
+	EXPECT_EQ(wd.step_sec(), 60);
+	EXPECT_EQ(count, n);
+	EXPECT_EQ(mismatches, 0);
+	EXPECT_TRUE(wd.has_data_column(weather_data_provider::GHI));
+	EXPECT_FALSE(wd.has_data_column(weather_data_provider::TWET));
+}
+
+/// A text weather file whose sidecar cache cannot be written is streamed from a cache in the temporary folder
+TEST(WeatherfileStream, TemporaryFolderCache_lib_weatherfile)
+{
+	std::string file = "weatherfile_stream_temp_test.epw";
+	{
+		std::ifstream in(std::string(std::getenv("SSCDIR")) + "/test/input_docs/weather_30m.epw", std::ios::binary);
+		std::ofstream out(file.c_str(), std::ios::binary);
+		out << in.rdbuf();
+	}
+	// a folder that is not empty in place of the sidecar file stops it being written, even with administrator rights
+	std::string sidecar = weatherfile::binary_cache_file(file);
+#ifdef _WIN32
+	ASSERT_EQ(_mkdir(sidecar.c_str()), 0);
+#else
+	ASSERT_EQ(mkdir(sidecar.c_str(), 0755), 0);
+#endif
+	std::string blocker = sidecar + "/blocker";
+	std::ofstream(blocker.c_str()) << "x";
+	std::string temp_cache = weatherfile::temp_binary_cache_file(file);
+	std::remove(temp_cache.c_str());
+
+	for (int run = 0; run < 2; run++)
+	{
+		weatherfile_stream ws(file, 1000);
+		ASSERT_TRUE(ws.ok()) << ws.message();
+		EXPECT_EQ(ws.nrecords(), (size_t)17520);
+		weather_record r;
+		EXPECT_TRUE(ws.read(&r));
+	}
+	EXPECT_EQ(weatherfile::binary_cache_for(file), temp_cache);
+
+	std::remove(temp_cache.c_str());
+	std::remove(blocker.c_str());
+#ifdef _WIN32
+	_rmdir(sidecar.c_str());
+#else
+	rmdir(sidecar.c_str());
+#endif
+	std::remove(file.c_str());
+}
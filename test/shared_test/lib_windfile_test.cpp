@@ -45,4 +45,39 @@ TEST_F(windDataProviderCalculatorTest, FindClosestUsingData_lib_windfile_test) {
 	EXPECT_NEAR(spd, 5, e) << "case 2";
 	EXPECT_NEAR(dir, 200, e) << "case 2";
 	EXPECT_NEAR(heightOfClosestMeasuredSpd, 90, e) << "case 2";
-}
\ No newline at end of file
+}
+/// With the process-wide cache on, repeated opens share one set of records and each reader keeps its own position
+TEST(WindfileCache, SharedRecords_lib_windfile_test) {
+	std::string file = std::string(std::getenv("SSCDIR")) + "/test/input_docs/wind.srw";
+	windfile text(file);
+	ASSERT_TRUE(text.ok()) << text.error();
+	EXPECT_FALSE(text.from_cache());
+
+	windfile::set_cache_limit(1);
+	windfile first(file), second(file);
+	ASSERT_TRUE(first.ok()) << first.error();
+	EXPECT_TRUE(first.from_cache());
+	EXPECT_TRUE(second.from_cache());
+	EXPECT_EQ(first.nrecords(), text.nrecords());
+	EXPECT_EQ(first.city, text.city);
+	EXPECT_EQ(first.heights(), text.heights());
+	EXPECT_EQ(first.types(), text.types());
+
+	// clearing the cache leaves open readers intact
+	std::vector<double> a, b;
+	second.read_line(b);
+	windfile::set_cache_limit(0);
+	size_t n = 0, mismatches = 0;
+	while (text.read_line(a))
+	{
+		if (!first.read_line(b) || a != b) mismatches++;
+		n++;
+	}
+	EXPECT_EQ(n, text.nrecords());
+	EXPECT_EQ(mismatches, 0);
+	EXPECT_FALSE(first.read_line(b));
+	EXPECT_TRUE(second.read_line(b));
+
+	windfile closed(file);
+	EXPECT_FALSE(closed.from_cache());
+}
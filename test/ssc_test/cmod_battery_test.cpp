@@ -1,3 +1,4 @@
+#include <map>
 #include <numeric>
 
 #include <gtest/gtest.h>
@@ -34,4 +35,84 @@ TEST_F(CMBattery, CommercialLifetimePeakShaving_cmod_battery) {
 		
 		EXPECT_GT(replacements, 0);
 	}
-}
\ No newline at end of file
+}
+
+struct battery_stream_sink
+{
+	std::map<std::string, std::vector<ssc_number_t>> series;
+	std::map<std::string, size_t> chunks;
+	bool out_of_order = false;
+	std::map<std::string, int> aborted; // offset of the abort call for each output
+	std::string cancel; // output whose second chunk cancels the run
+};
+
+static ssc_bool_t stream_battery_outputs(ssc_module_t, const char *name, int offset, int count, const ssc_number_t *values, void *user_data)
+{
+	battery_stream_sink *sink = static_cast<battery_stream_sink*>(user_data);
+	std::string key(name);
+	if (!values && count == 0)
+	{
+		sink->aborted[key] = offset;
+		return 1;
+	}
+	if (!values)
+		return key == "batt_SOC" || key == "grid_power" || key == "pv_to_load";
+	if (key == sink->cancel && offset > 0)
+		return 0;
+
+	std::vector<ssc_number_t> &series = sink->series[key];
+	if ((size_t)offset != series.size()) sink->out_of_order = true;
+	series.insert(series.end(), values, values + count);
+	sink->chunks[key]++;
+	return 1;
+}
+
+/// Streamed battery outputs arrive a year at a time, match the stored series, and are left out of the data
+TEST_F(CMBattery, StreamedLifetimeOutputs_cmod_battery) {
+	ssc_number_t n_years;
+	ssc_data_get_number(data, "analysis_period", &n_years);
+
+	var_table *vt = static_cast<var_table*>(data);
+	var_table stored;
+	stored = *vt;
+	ssc_data_t stored_data = &stored;
+	ASSERT_FALSE(run_module(stored_data, "battery"));
+
+	battery_stream_sink sink;
+	ssc_module_t module = ssc_module_create("battery");
+	ASSERT_TRUE(ssc_module_exec_with_output_sink(module, data, stream_battery_outputs, &sink));
+	ssc_module_free(module);
+
+	EXPECT_FALSE(sink.out_of_order);
+	EXPECT_EQ(sink.series.size(), (size_t)2) << "pv_to_load is kept for its monthly totals";
+	for (const char *name : { "batt_SOC", "grid_power" })
+	{
+		EXPECT_EQ(sink.chunks[name], (size_t)n_years) << name;
+		EXPECT_EQ(vt->lookup(name), nullptr) << name;
+		var_data *expected = stored.lookup(name);
+		ASSERT_NE(expected, nullptr);
+		ASSERT_EQ(sink.series[name].size(), expected->num.length()) << name;
+		for (size_t i = 0; i < expected->num.length(); i++)
+			ASSERT_EQ(sink.series[name][i], expected->num[i]) << name << " " << i;
+	}
+	ASSERT_NE(vt->lookup("pv_to_load"), nullptr);
+	EXPECT_EQ(vt->lookup("average_battery_roundtrip_efficiency")->num.value(), stored.lookup("average_battery_roundtrip_efficiency")->num.value());
+}
+
+/// A run cancelled by the sink tells the sink how much of each streamed output it received
+TEST_F(CMBattery, CancelledStreamedOutputs_cmod_battery) {
+	battery_stream_sink sink;
+	sink.cancel = "batt_SOC";
+	ssc_module_t module = ssc_module_create("battery");
+	ASSERT_FALSE(ssc_module_exec_with_output_sink(module, data, stream_battery_outputs, &sink));
+	ssc_module_free(module);
+
+	EXPECT_FALSE(sink.out_of_order);
+	EXPECT_EQ(sink.series["batt_SOC"].size(), (size_t)8760);
+	EXPECT_EQ(sink.aborted.size(), (size_t)2);
+	for (const char *name : { "batt_SOC", "grid_power" })
+	{
+		ASSERT_TRUE(sink.aborted.count(name) > 0) << name;
+		EXPECT_EQ((size_t)sink.aborted[name], sink.series[name].size()) << name;
+	}
+}
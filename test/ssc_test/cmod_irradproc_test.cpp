@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+#include "../ssc/sscapi.h"
+
+/// Fills in two days of hourly beam and diffuse irradiance for a fixed array in Phoenix
+static void irradproc_two_days(ssc_data_t data, std::vector<ssc_number_t> &beam, std::vector<ssc_number_t> &diffuse)
+{
+	size_t n = 48;
+	std::vector<ssc_number_t> year(n, 2019), month(n, 6), day(n), hour(n), minute(n, 30);
+	for (size_t i = 0; i < n; i++)
+	{
+		day[i] = (ssc_number_t)(1 + i / 24);
+		hour[i] = (ssc_number_t)(i % 24);
+	}
+	ssc_data_set_array(data, "beam", &beam[0], (int)n);
+	ssc_data_set_array(data, "diffuse", &diffuse[0], (int)n);
+	ssc_data_set_array(data, "year", &year[0], (int)n);
+	ssc_data_set_array(data, "month", &month[0], (int)n);
+	ssc_data_set_array(data, "day", &day[0], (int)n);
+	ssc_data_set_array(data, "hour", &hour[0], (int)n);
+	ssc_data_set_array(data, "minute", &minute[0], (int)n);
+	ssc_data_set_number(data, "lat", 33.45);
+	ssc_data_set_number(data, "lon", -111.98);
+	ssc_data_set_number(data, "tz", -7);
+	ssc_data_set_number(data, "track_mode", 0);
+	ssc_data_set_number(data, "tilt", 20);
+	ssc_data_set_number(data, "azimuth", 180);
+}
+
+/// Irradiance outside the valid range is rejected at any time step, not only the first
+TEST(CMIrradproc, RejectsInvalidIrradianceAfterFirstStep_cmod_irradproc)
+{
+	std::vector<ssc_number_t> beam(48), diffuse(48);
+	for (size_t i = 0; i < 48; i++)
+	{
+		bool up = (i % 24) >= 7 && (i % 24) <= 18;
+		beam[i] = up ? (ssc_number_t)700 : 0;
+		diffuse[i] = up ? (ssc_number_t)100 : 0;
+	}
+
+	ssc_module_exec_set_print(0);
+	ssc_data_t data = ssc_data_create();
+	irradproc_two_days(data, beam, diffuse);
+	EXPECT_EQ(ssc_module_exec_simple_nothread("irradproc", data), nullptr);
+	ssc_data_free(data);
+
+	// negative beam, diffuse above 1500 W/m2, and negative diffuse at night, each well after the first step
+	size_t steps[3] = { 30, 36, 45 };
+	ssc_number_t *bad[3] = { &beam[30], &diffuse[36], &diffuse[45] };
+	ssc_number_t values[3] = { -10, 1600, -1 };
+	for (size_t k = 0; k < 3; k++)
+	{
+		ssc_number_t saved = *bad[k];
+		*bad[k] = values[k];
+		data = ssc_data_create();
+		irradproc_two_days(data, beam, diffuse);
+		const char *err = ssc_module_exec_simple_nothread("irradproc", data);
+		ASSERT_NE(err, nullptr) << "step " << steps[k];
+		EXPECT_NE(std::string(err).find("error code -105"), std::string::npos) << err;
+		ssc_data_free(data);
+		*bad[k] = saved;
+	}
+}
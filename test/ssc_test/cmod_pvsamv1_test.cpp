@@ -3,6 +3,8 @@
 #include "cmod_pvsamv1_test.h"
 #include "../input_cases/pvsamv1_cases.h"
 #include "../input_cases/weather_inputs.h"
+#include "../input_cases/battery_common_data.h"
+#include "sscapi_test.h"
 
 /// Test PVSAMv1 with all defaults and no-financial model
 TEST_F(CMPvsamv1PowerIntegration, DefaultNoFinancialModel_cmod_pvsamv1){
@@ -30,6 +32,32 @@ TEST_F(CMPvsamv1PowerIntegration, DefaultNoFinancialModel_cmod_pvsamv1){
 	}
 }
 
+/// Unrequested time series are not reported and do not change the requested results
+TEST_F(CMPvsamv1PowerIntegration, OutputsRequestedNoFinancialModel_cmod_pvsamv1)
+{
+	var_table *vt = static_cast<var_table*>(data);
+	var_table all;
+	all = *vt;
+	ssc_data_t all_data = &all;
+	EXPECT_FALSE(run_module(all_data, "pvsamv1"));
+
+	vt->assign("outputs_requested", var_data("gen,annual_*,monthly_energy"));
+	EXPECT_FALSE(run_module(data, "pvsamv1"));
+
+	EXPECT_EQ(vt->lookup("annual_energy")->num.value(), all.lookup("annual_energy")->num.value());
+	EXPECT_EQ(vt->lookup("annual_poa_eff")->num.value(), all.lookup("annual_poa_eff")->num.value());
+	ASSERT_NE(vt->lookup("gen"), nullptr);
+	for (size_t i = 0; i < vt->lookup("gen")->num.length(); i++)
+		ASSERT_EQ(vt->lookup("gen")->num[i], all.lookup("gen")->num[i]) << i;
+	for (size_t m = 0; m < 12; m++)
+		EXPECT_EQ(vt->lookup("monthly_energy")->num[m], all.lookup("monthly_energy")->num[m]) << m;
+
+	EXPECT_NE(all.lookup("subarray1_aoi"), nullptr);
+	EXPECT_EQ(vt->lookup("subarray1_aoi"), nullptr);
+	EXPECT_EQ(vt->lookup("sol_zen"), nullptr);
+	EXPECT_EQ(vt->lookup("inv_eff"), nullptr);
+}
+
 /// Run PVSAMv1 with all defaults and lifetime mode for no-financial model
 TEST_F(CMPvsamv1PowerIntegration, DefaultLifetimeNoFinancialModel_cmod_pvsamv1) {
 
@@ -68,6 +96,51 @@ TEST_F(CMPvsamv1PowerIntegration, DefaultLifetimeNoFinancialModel_cmod_pvsamv1)
 }
 
 
+/// Replaying the first year's irradiance and module results in later lifetime years gives the same results as recomputing them
+TEST_F(CMPvsamv1PowerIntegration, LifetimeReuseFirstYear_cmod_pvsamv1)
+{
+	std::map<std::string, double> pairs;
+	pairs["system_use_lifetime_output"] = 1;
+	pairs["analysis_period"] = 5;
+	pairs["en_snow_model"] = 1;
+	pairs["subarray1_nstrings"] = 1;
+	pairs["subarray2_enable"] = 1;
+	pairs["subarray2_nstrings"] = 10;
+	pairs["subarray2_modules_per_string"] = 7;
+	pairs["subarray2_track_mode"] = 1;
+	pairs["subarray2_shade_mode"] = 1;
+
+	ssc_number_t dc_degradation[5] = { 0.5, 0.5, 0.5, 0.5, 0.5 };
+	ssc_data_set_array(data, "dc_degradation", dc_degradation, 5);
+
+	std::vector<std::string> outputs = { "gen", "dc_net", "inverterMppt1_DCVoltage" };
+	std::vector<std::vector<ssc_number_t>> recomputed;
+	pairs["system_lifetime_reuse_first_year"] = 0;
+	int pvsam_errors = modify_ssc_data_and_run_module(data, "pvsamv1", pairs);
+	ASSERT_FALSE(pvsam_errors);
+	for (size_t i = 0; i < outputs.size(); i++)
+	{
+		int n = 0;
+		ssc_number_t *values = ssc_data_get_array(data, outputs[i].c_str(), &n);
+		ASSERT_EQ(n, 5 * 8760) << outputs[i];
+		recomputed.push_back(std::vector<ssc_number_t>(values, values + n));
+	}
+
+	pairs["system_lifetime_reuse_first_year"] = 1;
+	pvsam_errors = modify_ssc_data_and_run_module(data, "pvsamv1", pairs);
+	ASSERT_FALSE(pvsam_errors);
+	for (size_t i = 0; i < outputs.size(); i++)
+	{
+		int n = 0;
+		ssc_number_t *values = ssc_data_get_array(data, outputs[i].c_str(), &n);
+		ASSERT_EQ((size_t)n, recomputed[i].size()) << outputs[i];
+		size_t differences = 0;
+		for (int j = 0; j < n; j++)
+			if (values[j] != recomputed[i][j]) differences++;
+		EXPECT_EQ(differences, 0) << outputs[i];
+	}
+}
+
 /// Test PVSAMv1 with all defaults and residential financial model
 TEST_F(CMPvsamv1PowerIntegration, DefaultResidentialModel_cmod_pvsamv1)
 {
@@ -591,6 +664,88 @@ TEST_F(CMPvsamv1PowerIntegration, NoFinancialModelMultipleMPPT_cmod_pvsamv1)
 
 }
 
+/// Golden-section search for the mismatched subarray string voltage matches the 100-point voltage sweep
+TEST_F(CMPvsamv1PowerIntegration, MismatchVoltageSearch_cmod_pvsamv1)
+{
+	std::map<std::string, double> pairs;
+	pairs["enable_mismatch_vmax_calc"] = 1;
+	pairs["subarray1_nstrings"] = 1;
+	pairs["subarray1_modules_per_string"] = 7;
+	pairs["subarray1_tilt"] = 20;
+	pairs["subarray2_enable"] = 1;
+	pairs["subarray2_nstrings"] = 1;
+	pairs["subarray2_modules_per_string"] = 6;
+	pairs["subarray2_tilt"] = 45;
+	pairs["subarray2_azimuth"] = 90;
+
+	std::vector<ssc_number_t> gen_sweep;
+	ssc_number_t annual_energy_sweep = 0;
+	pairs["mismatch_vmax_method"] = 0;
+	int pvsam_errors = modify_ssc_data_and_run_module(data, "pvsamv1", pairs);
+	ASSERT_FALSE(pvsam_errors);
+	ssc_data_get_number(data, "annual_energy", &annual_energy_sweep);
+	int n = 0;
+	ssc_number_t *gen = ssc_data_get_array(data, "gen", &n);
+	gen_sweep.assign(gen, gen + n);
+
+	// the sweep only resolves the string voltage to 1% of the MPPT range, so the search finds at least as much power within that resolution
+	pairs["mismatch_vmax_method"] = 1;
+	pvsam_errors = modify_ssc_data_and_run_module(data, "pvsamv1", pairs);
+	ASSERT_FALSE(pvsam_errors);
+	ssc_number_t annual_energy_search;
+	ssc_data_get_number(data, "annual_energy", &annual_energy_search);
+	EXPECT_NEAR(annual_energy_search, annual_energy_sweep, 0.001 * annual_energy_sweep) << "Annual energy.";
+	EXPECT_GE(annual_energy_search, annual_energy_sweep - m_error_tolerance_lo) << "Annual energy.";
+
+	gen = ssc_data_get_array(data, "gen", &n);
+	ASSERT_EQ((size_t)n, gen_sweep.size());
+	for (int i = 0; i < n; i++)
+		EXPECT_NEAR(gen[i], gen_sweep[i], 0.01 * fabs(gen_sweep[i]) + 0.001) << "Hour: " << i;
+}
+
+/// Calculating the irradiance on several threads gives the same results as calculating it on one
+TEST_F(CMPvsamv1PowerIntegration, IrradianceThreads_cmod_pvsamv1)
+{
+	std::map<std::string, double> pairs;
+	pairs["cec_is_bifacial"] = 1;
+	pairs["cec_bifacial_transmission_factor"] = 0.013;
+	pairs["cec_bifaciality"] = 0.65;
+	pairs["cec_bifacial_ground_clearance_height"] = 1;
+	pairs["subarray1_track_mode"] = 1;
+	pairs["subarray1_backtrack"] = 1;
+	pairs["subarray2_enable"] = 1;
+	pairs["subarray2_nstrings"] = 10;
+	pairs["subarray2_tilt"] = 30;
+	pairs["subarray2_azimuth"] = 150;
+
+	std::vector<std::string> outputs = { "gen", "dc_net", "subarray1_poa_rear", "subarray2_poa_rear", "subarray1_aoi", "subarray2_poa_eff", "sol_zen" };
+	std::vector<std::vector<ssc_number_t>> serial;
+	pairs["irradiance_threads"] = 1;
+	int pvsam_errors = modify_ssc_data_and_run_module(data, "pvsamv1", pairs);
+	ASSERT_FALSE(pvsam_errors);
+	for (size_t i = 0; i < outputs.size(); i++)
+	{
+		int n = 0;
+		ssc_number_t *values = ssc_data_get_array(data, outputs[i].c_str(), &n);
+		ASSERT_EQ(n, 8760) << outputs[i];
+		serial.push_back(std::vector<ssc_number_t>(values, values + n));
+	}
+
+	pairs["irradiance_threads"] = 4;
+	pvsam_errors = modify_ssc_data_and_run_module(data, "pvsamv1", pairs);
+	ASSERT_FALSE(pvsam_errors);
+	for (size_t i = 0; i < outputs.size(); i++)
+	{
+		int n = 0;
+		ssc_number_t *values = ssc_data_get_array(data, outputs[i].c_str(), &n);
+		ASSERT_EQ((size_t)n, serial[i].size()) << outputs[i];
+		size_t differences = 0;
+		for (int j = 0; j < n; j++)
+			if (values[j] != serial[i][j]) differences++;
+		EXPECT_EQ(differences, 0) << outputs[i];
+	}
+}
+
 /// Test PVSAMv1 with Snow Model enabled and set to 1-axis Tracking
 TEST_F(CMPvsamv1PowerIntegration, SnowModel_cmod_pvsamv1)
 {
@@ -605,4 +760,112 @@ TEST_F(CMPvsamv1PowerIntegration, SnowModel_cmod_pvsamv1)
 	ssc_data_get_number(data, "annual_energy", &annual_energy);
 	EXPECT_NEAR(annual_energy, 11354.7, m_error_tolerance_hi) << "Annual energy.";
 
-}
\ No newline at end of file
+}
+/// Inputs and results written to a binary data file read back identically, and rerunning the read inputs reproduces the results
+TEST_F(CMPvsamv1PowerIntegration, BinaryDataFileRoundTrip_cmod_pvsamv1)
+{
+	std::string file = "pvsamv1_inputs.bin";
+	ASSERT_TRUE(ssc_data_write(data, file.c_str()));
+	ssc_data_t inputs = ssc_data_read(file.c_str());
+	ASSERT_TRUE(inputs != 0);
+
+	EXPECT_FALSE(run_module(data, "pvsamv1"));
+	EXPECT_FALSE(run_module(inputs, "pvsamv1"));
+
+	std::string results_file = "pvsamv1_results.bin";
+	ASSERT_TRUE(ssc_data_write(data, results_file.c_str()));
+	ssc_data_t results = ssc_data_read(results_file.c_str());
+	ASSERT_TRUE(results != 0);
+
+	int n_vars = 0;
+	for (const char *name = ssc_data_first(data); name; name = ssc_data_next(data))
+	{
+		n_vars++;
+		int type = ssc_data_query(data, name);
+		EXPECT_EQ(ssc_data_query(results, name), type) << name;
+		if (type != SSC_ARRAY) continue;
+
+		int len = 0, len_rerun = 0, len_read = 0;
+		ssc_number_t *p = ssc_data_get_array(data, name, &len);
+		ssc_number_t *p_rerun = ssc_data_get_array(inputs, name, &len_rerun);
+		ssc_number_t *p_read = ssc_data_get_array(results, name, &len_read);
+		ASSERT_TRUE(p_rerun != 0 && p_read != 0) << name;
+		ASSERT_EQ(len, len_rerun) << name;
+		ASSERT_EQ(len, len_read) << name;
+		EXPECT_EQ(memcmp(p, p_rerun, len * sizeof(ssc_number_t)), 0) << name;
+		EXPECT_EQ(memcmp(p, p_read, len * sizeof(ssc_number_t)), 0) << name;
+	}
+
+	int n_read = 0;
+	for (const char *name = ssc_data_first(results); name; name = ssc_data_next(results)) n_read++;
+	EXPECT_EQ(n_read, n_vars);
+
+	ssc_data_free(inputs);
+	ssc_data_free(results);
+	remove(file.c_str());
+	remove(results_file.c_str());
+}
+
+struct pvsamv1_stream_sink
+{
+	std::map<std::string, std::vector<ssc_number_t>> series;
+	bool out_of_order = false;
+};
+
+static ssc_bool_t stream_pvsamv1_outputs(ssc_module_t, const char *name, int offset, int count, const ssc_number_t *values, void *user_data)
+{
+	pvsamv1_stream_sink *sink = static_cast<pvsamv1_stream_sink*>(user_data);
+	std::string key(name);
+	if (!values)
+		return key == "batt_SOC" || key == "grid_power";
+
+	std::vector<ssc_number_t> &series = sink->series[key];
+	if ((size_t)offset != series.size()) sink->out_of_order = true;
+	series.insert(series.end(), values, values + count);
+	return 1;
+}
+
+/// A lifetime run with a dc-connected battery streams its battery outputs and keeps grid power, which is rewritten after the battery pass, in the data
+TEST_F(CMPvsamv1PowerIntegration, LifetimeDCBatteryOutputSink_cmod_pvsamv1)
+{
+	battery_commercial_peak_shaving_lifetime(data);
+	ssc_data_unassign(data, "gen");
+	ssc_data_set_number(data, "analysis_period", 2);
+	ssc_data_set_number(data, "batt_ac_or_dc", 0);
+	ssc_number_t dc_degradation[1] = { 0.5 };
+	ssc_data_set_array(data, "dc_degradation", dc_degradation, 1);
+
+	var_table *vt = static_cast<var_table*>(data);
+	var_table stored;
+	stored = *vt;
+	ssc_data_t stored_data = &stored;
+	ASSERT_FALSE(run_module(stored_data, "pvsamv1"));
+
+	pvsamv1_stream_sink sink;
+	ssc_module_t module = ssc_module_create("pvsamv1");
+	ASSERT_TRUE(ssc_module_exec_with_output_sink(module, data, stream_pvsamv1_outputs, &sink));
+	ssc_module_free(module);
+
+	EXPECT_FALSE(sink.out_of_order);
+	EXPECT_EQ(sink.series.size(), (size_t)1);
+	EXPECT_EQ(vt->lookup("batt_SOC"), nullptr);
+	var_data *soc = stored.lookup("batt_SOC");
+	ASSERT_NE(soc, nullptr);
+	ASSERT_EQ(sink.series["batt_SOC"].size(), soc->num.length());
+	for (size_t i = 0; i < soc->num.length(); i++)
+		ASSERT_EQ(sink.series["batt_SOC"][i], soc->num[i]) << i;
+
+	var_data *grid = vt->lookup("grid_power");
+	var_data *expected = stored.lookup("grid_power");
+	ASSERT_NE(grid, nullptr);
+	ASSERT_NE(expected, nullptr);
+	ASSERT_EQ(grid->num.length(), expected->num.length());
+	for (size_t i = 0; i < expected->num.length(); i++)
+		ASSERT_EQ(grid->num[i], expected->num[i]) << i;
+}
+
+/// Concurrent pvsamv1 runs, each on its own data, match the serial run bit for bit
+TEST_F(SSCAPIThreading, ConcurrentPvsamv1MatchSerial_cmod_pvsamv1)
+{
+	expect_concurrent_matches_serial("pvsamv1", [](ssc_data_t data) { pvsamv_nofinancial_default(data); }, "gen", 8760);
+}
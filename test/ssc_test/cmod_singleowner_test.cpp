@@ -1,5 +1,6 @@
 
 #include "cmod_singleowner_test.h"
+#include "sscapi_test.h"
 
 #include "gtest/gtest.h"
 
@@ -12,4 +13,16 @@ TEST_F(CMSingleOwner, ResidentialDefault_cmod_swh) {
     ssc_data_get_number(data, "project_return_aftertax_npv", &npv);
     EXPECT_NEAR(npv, -647727751.2, 0.1);
 
-}
\ No newline at end of file
+}
+
+/// Concurrent singleowner runs, each on its own data, match the serial run bit for bit
+TEST_F(SSCAPIThreading, ConcurrentSingleOwnerMatchSerial_cmod_singleowner)
+{
+    // a specified PPA price runs the cash flow once instead of once per solver iteration
+    expect_concurrent_matches_serial("singleowner", [](ssc_data_t data) {
+        singleowner_common(data);
+        ssc_number_t ppa_price[1] = { 0.1 };
+        ssc_data_set_array(data, "ppa_price_input", ppa_price, 1);
+        ssc_data_set_number(data, "ppa_soln_mode", 1);
+    }, "cf_project_return_aftertax_cash", 26);
+}
@@ -340,6 +340,33 @@ TEST_F(CMWindPowerIntegration, IcingAndLowTempCutoff_cmod_windpower) {
 	free_winddata_array(windresourcedata);
 }
 
+/// Only the requested outputs are reported, and the results match a run that reports everything
+TEST_F(CMWindPowerIntegration, OutputsRequested_cmod_windpower) {
+	auto *vt = static_cast<var_table*>(data);
+	var_table inputs;
+	inputs = *vt;
+	vt->assign("outputs_requested", var_data("gen, annual_*, wind_speed_average"));
+	EXPECT_TRUE(compute());
+
+	ssc_module_t module = ssc_module_create("windpower");
+	ASSERT_TRUE(ssc_module_exec(module, &inputs));
+	ssc_module_free(module);
+
+	EXPECT_EQ(vt->lookup("annual_energy")->num.value(), inputs.lookup("annual_energy")->num.value());
+	EXPECT_EQ(vt->lookup("annual_gross_energy")->num.value(), inputs.lookup("annual_gross_energy")->num.value());
+	EXPECT_EQ(vt->lookup("wind_speed_average")->num.value(), inputs.lookup("wind_speed_average")->num.value());
+	ASSERT_NE(vt->lookup("gen"), nullptr);
+	EXPECT_EQ(vt->lookup("gen")->num.length(), inputs.lookup("gen")->num.length());
+	for (size_t i = 0; i < vt->lookup("gen")->num.length(); i++)
+		ASSERT_EQ(vt->lookup("gen")->num[i], inputs.lookup("gen")->num[i]) << i;
+
+	EXPECT_EQ(vt->lookup("wind_speed"), nullptr);
+	EXPECT_EQ(vt->lookup("wind_direction"), nullptr);
+	EXPECT_EQ(vt->lookup("temp"), nullptr);
+	EXPECT_EQ(vt->lookup("pressure"), nullptr);
+	EXPECT_NE(inputs.lookup("wind_speed"), nullptr);
+}
+
 /// Testing Turbine powercurve calculation
 TEST(windpower_turbine_powercurve, NoData){
     ASSERT_THROW(Turbine_calculate_powercurve(nullptr), std::runtime_error);
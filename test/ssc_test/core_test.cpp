@@ -0,0 +1,428 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include "../ssc/core.h"
+#include "../ssc/common.h"
+
+static var_info _cm_vtab_handle_test[] = {
+/*   VARTYPE           DATATYPE         NAME                LABEL                               UNITS  META  GROUP  REQUIRED_IF  CONSTRAINTS  UI_HINTS*/
+	{ SSC_INPUT,        SSC_NUMBER,      "use_values",       "Flag read once per step",          "",    "",   "",    "*",         "",          "" },
+	{ SSC_INPUT,        SSC_ARRAY,       "values",           "Values summed over the steps",     "",    "",   "",    "*",         "",          "" },
+	{ SSC_INPUT,        SSC_NUMBER,      "years",            "Number of passes over the values", "",    "",   "",    "*",         "",          "" },
+	{ SSC_OUTPUT,       SSC_NUMBER,      "sum_by_name",      "Sum with lookups by name",         "",    "",   "",    "*",         "",          "" },
+	{ SSC_OUTPUT,       SSC_NUMBER,      "sum_by_handle",    "Sum with lookups through handles", "",    "",   "",    "*",         "",          "" },
+	{ SSC_OUTPUT,       SSC_NUMBER,      "handle_errors",    "Errors thrown by invalid handles", "",    "",   "",    "*",         "",          "" },
+var_info_invalid };
+
+/// Reads a flag in every step of a multi-year loop, the way utilityrate5 reads its lifetime flag, once by name and once through a handle
+class cm_handle_test : public compute_module
+{
+public:
+	cm_handle_test()
+	{
+		add_var_info(_cm_vtab_handle_test);
+	}
+
+	void exec()
+	{
+		size_t n = 0;
+		ssc_number_t *values = as_array("values", &n);
+		int years = as_integer("years");
+
+		ssc_number_t sum = 0;
+		for (int y = 0; y < years; y++)
+			for (size_t i = 0; i < n; i++)
+				if (as_integer("use_values") == 1) sum += values[i];
+		assign("sum_by_name", sum);
+
+		var_handle use_values = handle("use_values");
+		sum = 0;
+		for (int y = 0; y < years; y++)
+			for (size_t i = 0; i < n; i++)
+				if (use_values.as_integer() == 1) sum += values[i];
+		assign("sum_by_handle", sum);
+
+		int errors = 0;
+		var_handle missing = handle("not_assigned");
+		if (!missing.is_assigned())
+			try { missing.as_double(); } catch (general_error &) { errors++; }
+		try { handle("values").as_number(); } catch (cast_error &) { errors++; }
+		assign("handle_errors", errors);
+	}
+};
+
+class handle_test_handler : public handler_interface
+{
+public:
+	handle_test_handler(compute_module *cm) : handler_interface(cm) { }
+	virtual void on_log(const std::string &, int, float) { }
+	virtual bool on_update(const std::string &, float, float) { return true; }
+};
+
+/// Handles give the same values as lookups by name, and report missing variables and wrong types
+TEST(VarHandle, MatchesLookupByName_core)
+{
+	std::vector<ssc_number_t> values(8760);
+	for (size_t i = 0; i < values.size(); i++)
+		values[i] = (ssc_number_t)(i % 24);
+
+	var_table data;
+	data.assign("use_values", var_data((ssc_number_t)1));
+	data.assign("values", var_data(&values[0], values.size()));
+	data.assign("years", var_data((ssc_number_t)25));
+
+	cm_handle_test cm;
+	handle_test_handler handler(&cm);
+	ASSERT_TRUE(cm.compute(&handler, &data));
+
+	EXPECT_EQ(data.lookup("sum_by_name")->num.value(), data.lookup("sum_by_handle")->num.value());
+	EXPECT_EQ(data.lookup("sum_by_handle")->num.value(), 25 * 365 * 276);
+	EXPECT_EQ(data.lookup("handle_errors")->num.value(), 2);
+}
+
+static var_info _cm_vtab_handle_benchmark[] = {
+/*   VARTYPE           DATATYPE         NAME                LABEL                               UNITS  META  GROUP  REQUIRED_IF  CONSTRAINTS  UI_HINTS*/
+	{ SSC_INPUT,        SSC_NUMBER,      "use_values",       "Flag read once per step",          "",    "",   "",    "*",         "",          "" },
+	{ SSC_INPUT,        SSC_ARRAY,       "values",           "Values summed over the steps",     "",    "",   "",    "*",         "",          "" },
+	{ SSC_INPUT,        SSC_NUMBER,      "years",            "Number of passes over the values", "",    "",   "",    "*",         "",          "" },
+	{ SSC_INPUT,        SSC_NUMBER,      "by_handle",        "Read the flag through a handle",   "",    "",   "",    "*",         "BOOLEAN",   "" },
+	{ SSC_OUTPUT,       SSC_NUMBER,      "sum",              "Sum of the values",                "",    "",   "",    "*",         "",          "" },
+var_info_invalid };
+
+/// Same loop as cm_handle_test, with the flag read either by name or through a handle in each run
+class cm_handle_benchmark : public compute_module
+{
+public:
+	cm_handle_benchmark()
+	{
+		add_var_info(_cm_vtab_handle_benchmark);
+	}
+
+	void exec()
+	{
+		size_t n = 0;
+		ssc_number_t *values = as_array("values", &n);
+		int years = as_integer("years");
+
+		ssc_number_t sum = 0;
+		if (as_boolean("by_handle"))
+		{
+			var_handle use_values = handle("use_values");
+			for (int y = 0; y < years; y++)
+				for (size_t i = 0; i < n; i++)
+					if (use_values.as_integer() == 1) sum += values[i];
+		}
+		else
+		{
+			for (int y = 0; y < years; y++)
+				for (size_t i = 0; i < n; i++)
+					if (as_integer("use_values") == 1) sum += values[i];
+		}
+		assign("sum", sum);
+	}
+};
+
+/// Times a 25 year hourly run that reads a flag every step by name and through a handle; run with --gtest_also_run_disabled_tests
+TEST(VarHandle, DISABLED_PerRunOverhead_core)
+{
+	std::vector<ssc_number_t> values(8760);
+	for (size_t i = 0; i < values.size(); i++)
+		values[i] = (ssc_number_t)(i % 24);
+
+	const int passes = 5;
+	double best[2] = { 0, 0 };
+	for (int by_handle = 0; by_handle < 2; by_handle++)
+	{
+		for (int n = 0; n < passes; n++)
+		{
+			var_table data;
+			data.assign("use_values", var_data((ssc_number_t)1));
+			data.assign("values", var_data(&values[0], values.size()));
+			data.assign("years", var_data((ssc_number_t)25));
+			data.assign("by_handle", var_data((ssc_number_t)by_handle));
+
+			cm_handle_benchmark cm;
+			handle_test_handler handler(&cm);
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			ASSERT_TRUE(cm.compute(&handler, &data));
+			double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+			EXPECT_EQ(data.lookup("sum")->num.value(), 25 * 365 * 276);
+			if (n == 0 || elapsed < best[by_handle]) best[by_handle] = elapsed;
+		}
+	}
+	printf("219000 flag reads per run: %.3f ms by name, %.3f ms through a handle, %.1f ns saved per read\n",
+		best[0], best[1], (best[0] - best[1]) * 1e6 / 219000);
+}
+
+static var_info _cm_vtab_check_test[] = {
+/*   VARTYPE           DATATYPE         NAME                LABEL                               UNITS  META  GROUP  REQUIRED_IF                CONSTRAINTS                UI_HINTS*/
+	{ SSC_INPUT,        SSC_NUMBER,      "mode",             "Mode",                             "",    "",   "",    "*",                       "INTEGER,MIN=1,MAX=3",     "" },
+	{ SSC_INPUT,        SSC_NUMBER,      "scale",            "Scale with a default",             "",    "",   "",    "?=2.5",                   "POSITIVE",                "" },
+	{ SSC_INPUT,        SSC_NUMBER,      "level",            "Required for modes 2 and 3",       "",    "",   "",    "mode=2|mode=3",           "MIN=0,MAX=10",            "" },
+	{ SSC_INPUT,        SSC_ARRAY,       "profile",          "Required when n is assigned",      "",    "",   "",    "a:n",                     "LENGTH_EQUAL=n",          "" },
+	{ SSC_INPUT,        SSC_NUMBER,      "n",                "Profile length",                   "",    "",   "",    "?",                       "",                        "" },
+	{ SSC_INPUT,        SSC_NUMBER,      "bad_spec",         "Malformed test, reached in mode 3","",    "",   "",    "mode>2&level",            "",                        "" },
+	{ SSC_OUTPUT,       SSC_NUMBER,      "scaled",           "Scale times mode",                 "",    "",   "",    "*",                       "",                        "" },
+var_info_invalid };
+
+class cm_check_test : public compute_module
+{
+public:
+	cm_check_test()
+	{
+		add_var_info(_cm_vtab_check_test);
+	}
+
+	void exec()
+	{
+		assign("scaled", as_number("scale") * as_number("mode"));
+	}
+};
+
+class check_test_handler : public handler_interface
+{
+public:
+	check_test_handler(compute_module *cm) : handler_interface(cm) { }
+	virtual void on_log(const std::string &msg, int, float) { last = msg; }
+	virtual bool on_update(const std::string &, float, float) { return true; }
+	std::string last;
+};
+
+/// Runs a fresh check module on 'data' and returns the last log message, empty on success
+static std::string run_check_test(var_table &data)
+{
+	cm_check_test cm;
+	check_test_handler handler(&cm);
+	if (cm.compute(&handler, &data)) return "";
+	return handler.last.empty() ? "failed" : handler.last;
+}
+
+/// Required-if expressions, default values and constraints behave and report errors as they did when parsed on every check
+TEST(VarChecks, CompiledChecks_core)
+{
+	var_table data;
+	data.assign("mode", var_data((ssc_number_t)1));
+	EXPECT_EQ(run_check_test(data), "");
+	EXPECT_EQ(data.lookup("scale")->num.value(), 2.5);
+	EXPECT_EQ(data.lookup("scaled")->num.value(), 2.5);
+
+	data.assign("mode", var_data((ssc_number_t)1.5));
+	EXPECT_EQ(run_check_test(data), "fail(mode, integer): number could not be interpreted as an integer: 1.5");
+	data.assign("mode", var_data((ssc_number_t)4));
+	EXPECT_EQ(run_check_test(data), "fail(mode, max=3): 4");
+
+	data.assign("mode", var_data((ssc_number_t)2));
+	EXPECT_EQ(run_check_test(data), "precheck input: variable 'level' required but not assigned");
+	data.assign("level", var_data((ssc_number_t)-1));
+	EXPECT_EQ(run_check_test(data), "fail(level, min=0): -1");
+	data.assign("level", var_data((ssc_number_t)5));
+	data.assign("scale", var_data((ssc_number_t)2));
+	EXPECT_EQ(run_check_test(data), "");
+	EXPECT_EQ(data.lookup("scaled")->num.value(), 4);
+
+	ssc_number_t profile[3] = { 1, 2, 3 };
+	data.assign("n", var_data((ssc_number_t)4));
+	EXPECT_EQ(run_check_test(data), "precheck input: variable 'profile' required but not assigned");
+	data.assign("profile", var_data(profile, 3));
+	EXPECT_EQ(run_check_test(data), "fail(profile, length_equal=n): 4");
+	data.assign("n", var_data((ssc_number_t)3));
+	EXPECT_EQ(run_check_test(data), "");
+
+	// the malformed term is only reported once evaluation reaches it
+	data.assign("mode", var_data((ssc_number_t)3));
+	EXPECT_EQ(run_check_test(data), "check fail: reason invalid operator, with 'level' for: bad_spec");
+}
+
+static var_info _cm_vtab_stream_test[] = {
+/*   VARTYPE           DATATYPE         NAME                LABEL                               UNITS  META  GROUP  REQUIRED_IF  CONSTRAINTS  UI_HINTS*/
+	{ SSC_INPUT,        SSC_NUMBER,      "steps",            "Number of steps",                  "",    "",   "",    "*",         "",          "" },
+	{ SSC_INPUT,        SSC_NUMBER,      "go_back",          "Write an earlier step at the end", "",    "",   "",    "?=0",       "BOOLEAN",   "" },
+	{ SSC_INPUT,        SSC_NUMBER,      "throw_at",         "Step that throws a std::exception","",    "",   "",    "?=-1",      "",          "" },
+	{ SSC_OUTPUT,       SSC_ARRAY,       "squares",          "Step squared",                     "",    "",   "",    "*",         "",          "" },
+	{ SSC_OUTPUT,       SSC_ARRAY,       "sums",             "Running sum of the steps",         "",    "",   "",    "*",         "",          "" },
+var_info_invalid };
+
+class cm_stream_test : public compute_module
+{
+public:
+	cm_stream_test()
+	{
+		add_var_info(_cm_vtab_stream_test);
+	}
+
+	void exec()
+	{
+		size_t n = (size_t)as_integer("steps");
+		int throw_at = as_integer("throw_at");
+		output_stream squares = stream_output("squares", n, 10);
+		output_stream sums = stream_output("sums", n, 10);
+		for (size_t i = 0; i < n; i++)
+		{
+			if ((int)i == throw_at)
+				throw std::runtime_error("not a general_error");
+			squares[i] = (ssc_number_t)(i * i);
+			sums[i] = (ssc_number_t)i;
+			if (i > 0) sums[i] += (ssc_number_t)(i * (i - 1) / 2);
+		}
+		if (as_boolean("go_back"))
+			squares[0] = 1;
+	}
+};
+
+class stream_test_handler : public handler_interface
+{
+public:
+	stream_test_handler(compute_module *cm) : handler_interface(cm) { }
+	virtual void on_log(const std::string &msg, int, float) { last = msg; }
+	virtual bool on_update(const std::string &, float, float) { return true; }
+	virtual bool stream_output(const std::string &name, size_t) { return name == "squares"; }
+	virtual bool on_output_chunk(const std::string &name, size_t offset, const ssc_number_t *values, size_t count)
+	{
+		offsets.push_back(offset);
+		if (name == "squares") received.insert(received.end(), values, values + count);
+		return true;
+	}
+	virtual void on_output_abort(const std::string &name, size_t sent) { aborted.push_back(std::make_pair(name, sent)); }
+	std::string last;
+	std::vector<size_t> offsets;
+	std::vector<ssc_number_t> received;
+	std::vector< std::pair<std::string, size_t> > aborted;
+};
+
+/// A streamed output arrives in order in chunks and is not stored, other outputs are stored as before
+TEST(OutputStream, ChunksInOrder_core)
+{
+	var_table data;
+	data.assign("steps", var_data((ssc_number_t)25));
+
+	cm_stream_test cm;
+	stream_test_handler handler(&cm);
+	ASSERT_TRUE(cm.compute(&handler, &data)) << handler.last;
+
+	EXPECT_EQ(handler.offsets, std::vector<size_t>({ 0, 10, 20 }));
+	ASSERT_EQ(handler.received.size(), (size_t)25);
+	for (size_t i = 0; i < 25; i++)
+		EXPECT_EQ(handler.received[i], (ssc_number_t)(i * i));
+	EXPECT_EQ(data.lookup("squares"), nullptr);
+	ASSERT_NE(data.lookup("sums"), nullptr);
+	EXPECT_EQ(data.lookup("sums")->num[24], 300);
+
+	data.assign("go_back", var_data((ssc_number_t)1));
+	cm_stream_test cm2;
+	stream_test_handler handler2(&cm2);
+	EXPECT_FALSE(cm2.compute(&handler2, &data));
+	EXPECT_EQ(handler2.last, "output 'squares' is written in order, index 0 was already sent");
+}
+
+/// An exception that is not a general_error still reaches the caller, and the handler is told the stream is incomplete
+TEST(OutputStream, AbortOnOtherException_core)
+{
+	var_table data;
+	data.assign("steps", var_data((ssc_number_t)25));
+	data.assign("throw_at", var_data((ssc_number_t)15));
+
+	cm_stream_test cm;
+	stream_test_handler handler(&cm);
+	EXPECT_THROW(cm.compute(&handler, &data), std::runtime_error);
+
+	ASSERT_EQ(handler.received.size(), (size_t)10);
+	ASSERT_EQ(handler.aborted.size(), (size_t)1);
+	EXPECT_EQ(handler.aborted[0].first, "squares");
+	EXPECT_EQ(handler.aborted[0].second, (size_t)10);
+}
+
+static var_info _cm_vtab_perf_test[] = {
+/*   VARTYPE           DATATYPE         NAME                LABEL                               UNITS  META  GROUP  REQUIRED_IF  CONSTRAINTS  UI_HINTS*/
+	{ SSC_INPUT,        SSC_NUMBER,      "steps",            "Number of steps",                  "",    "",   "",    "*",         "",          "" },
+	{ SSC_OUTPUT,       SSC_NUMBER,      "total",            "Sum over the steps",               "",    "",   "",    "*",         "",          "" },
+var_info_invalid };
+
+class cm_perf_test : public compute_module
+{
+public:
+	cm_perf_test()
+	{
+		add_var_info(_cm_vtab_perf_test);
+		add_var_info(vtab_perf_instrumentation);
+	}
+
+	void exec()
+	{
+		perf_timer input_timer(this, "input_read");
+		int steps = as_integer("steps");
+		input_timer.stop();
+		if (steps < 0)
+			throw general_error("steps must not be negative");
+
+		double total = 0;
+		for (int year = 0; year < 2; year++)
+		{
+			perf_timer loop_timer(this, "timestep_loop");
+			for (int i = 0; i < steps; i++)
+			{
+				total += sqrt((double)i);
+				perf_count("iterations");
+			}
+		}
+		assign("total", (ssc_number_t)total);
+	}
+};
+
+/// Phase times and counters are reported as perf_* outputs and a trace file only when asked for
+TEST(PerfInstrumentation, OutputsAndTrace_core)
+{
+	var_table data;
+	data.assign("steps", var_data((ssc_number_t)1000));
+
+	cm_perf_test cm;
+	handle_test_handler handler(&cm);
+	ASSERT_TRUE(cm.compute(&handler, &data));
+	EXPECT_EQ(data.lookup("perf_exec"), nullptr);
+	EXPECT_EQ(data.lookup("perf_iterations"), nullptr);
+
+	std::string trace_file = "perf_test_trace.json";
+	data.assign("perf_trace_file", var_data(trace_file));
+	cm_perf_test cm2;
+	handle_test_handler handler2(&cm2);
+	ASSERT_TRUE(cm2.compute(&handler2, &data));
+
+	ASSERT_NE(data.lookup("perf_exec"), nullptr);
+	ASSERT_NE(data.lookup("perf_timestep_loop"), nullptr);
+	EXPECT_GE(data.lookup("perf_timestep_loop")->num.value(), 0);
+	EXPECT_LE(data.lookup("perf_timestep_loop")->num.value(), data.lookup("perf_exec")->num.value());
+	EXPECT_EQ(data.lookup("perf_iterations")->num.value(), 2000);
+
+	std::ifstream in(trace_file);
+	ASSERT_TRUE(in.is_open());
+	std::stringstream trace;
+	trace << in.rdbuf();
+	in.close();
+	std::remove(trace_file.c_str());
+	std::string json = trace.str();
+	EXPECT_EQ(json.find("{\"traceEvents\":["), (size_t)0);
+	EXPECT_NE(json.find("\"name\":\"input_read\""), std::string::npos);
+	EXPECT_NE(json.find("\"iterations\":2000"), std::string::npos);
+	size_t loops = 0;
+	for (size_t pos = json.find("\"timestep_loop\""); pos != std::string::npos; pos = json.find("\"timestep_loop\"", pos + 1))
+		loops++;
+	EXPECT_EQ(loops, (size_t)2);
+}
+
+/// Phase times are still reported when the module fails
+TEST(PerfInstrumentation, OutputsOnFailure_core)
+{
+	var_table data;
+	data.assign("steps", var_data((ssc_number_t)-1));
+	data.assign("perf_outputs", var_data((ssc_number_t)1));
+
+	cm_perf_test cm;
+	handle_test_handler handler(&cm);
+	ASSERT_FALSE(cm.compute(&handler, &data));
+	ASSERT_NE(data.lookup("perf_exec"), nullptr);
+	ASSERT_NE(data.lookup("perf_input_read"), nullptr);
+	EXPECT_EQ(data.lookup("perf_timestep_loop"), nullptr);
+}
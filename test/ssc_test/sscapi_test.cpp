@@ -0,0 +1,198 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <thread>
+
+#include "sscapi_test.h"
+
+/// Each thread runs its own module on its own data; results must match the serial run bit for bit
+TEST_F(SSCAPIThreading, ConcurrentModulesMatchSerial_sscapi)
+{
+	expect_concurrent_matches_serial("pvwattsv5", pvwattsv5_inputs, "ac", 8760);
+}
+
+/// The error text returned by ssc_module_exec_simple_nothread belongs to the calling thread
+TEST_F(SSCAPIThreading, SimpleNoThreadErrorPerThread_sscapi)
+{
+	std::vector<std::string> errors(n_threads);
+	std::vector<const char*> buffers(n_threads, 0);
+	std::atomic<size_t> n_done(0);
+	size_t n = n_threads;
+	std::vector<std::thread> threads;
+	for (size_t i = 0; i < n_threads; i++)
+	{
+		threads.push_back(std::thread([&errors, &buffers, &n_done, n, i]() {
+			ssc_data_t data = ssc_data_create(); // no inputs, so the module fails its input check
+			const char *err = ssc_module_exec_simple_nothread("pvwattsv5", data);
+			ssc_data_free(data);
+
+			// keep every thread alive until all have run, so no two threads can share storage by accident
+			n_done++;
+			while (n_done.load() < n) std::this_thread::yield();
+			buffers[i] = err;
+			if (err) errors[i] = err;
+		}));
+	}
+	for (size_t i = 0; i < n_threads; i++)
+		threads[i].join();
+
+	for (size_t i = 0; i < n_threads; i++)
+	{
+		EXPECT_TRUE(buffers[i] != 0) << "thread " << i;
+		EXPECT_FALSE(errors[i].empty()) << "thread " << i;
+		for (size_t j = 0; j < i; j++)
+			EXPECT_NE(buffers[i], buffers[j]) << "threads " << j << " and " << i << " share an error buffer";
+	}
+}
+
+static ssc_bool_t batch_log_handler(int case_index, int action, float f0, float, const char *s0, const char *, void *user_data)
+{
+	static std::mutex log_lock;
+	if (action == SSC_LOG && (int)f0 == SSC_ERROR && s0)
+	{
+		std::lock_guard<std::mutex> lock(log_lock);
+		(*static_cast<std::map<int, std::string>*>(user_data))[case_index] = s0;
+	}
+	return 1;
+}
+
+/// A batch over several tilts gives the same answers as running each case alone, and reports failing cases
+TEST_F(SSCAPIThreading, ExecBatchMatchesSingleRuns_sscapi)
+{
+	const int n_cases = 7;
+	std::vector<ssc_data_t> cases(n_cases);
+	std::vector<ssc_number_t> expected(n_cases, 0.0);
+	for (int i = 0; i < n_cases; i++)
+	{
+		cases[i] = ssc_data_create();
+		if (i == n_cases - 1) continue; // last case has no inputs and must fail
+		pvwattsv5_inputs(cases[i]);
+		ssc_data_set_number(cases[i], "tilt", 5.0 * i);
+
+		ssc_data_t single = ssc_data_create();
+		pvwattsv5_inputs(single);
+		ssc_data_set_number(single, "tilt", 5.0 * i);
+		ASSERT_TRUE(ssc_module_exec_simple("pvwattsv5", single));
+		ssc_data_get_number(single, "annual_energy", &expected[i]);
+		ssc_data_free(single);
+	}
+
+	std::vector<ssc_bool_t> ok(n_cases, 0);
+	std::map<int, std::string> errors;
+	int n_ok = ssc_module_exec_batch("pvwattsv5", &cases[0], n_cases, 3, &ok[0], batch_log_handler, &errors);
+	EXPECT_EQ(n_ok, n_cases - 1);
+
+	for (int i = 0; i < n_cases - 1; i++)
+	{
+		EXPECT_TRUE(ok[i]) << "case " << i;
+		ssc_number_t annual_energy = 0;
+		ssc_data_get_number(cases[i], "annual_energy", &annual_energy);
+		EXPECT_EQ(annual_energy, expected[i]) << "case " << i;
+		EXPECT_EQ(errors.count(i), 0) << "case " << i;
+	}
+	EXPECT_FALSE(ok[n_cases - 1]);
+
+	EXPECT_EQ(ssc_module_exec_batch("not_a_module", &cases[0], n_cases, 3, &ok[0], 0, 0), -1);
+
+	for (int i = 0; i < n_cases; i++)
+		ssc_data_free(cases[i]);
+}
+
+/// Cases layered on one shared base give the same results as full copies, and leave the base untouched
+TEST_F(SSCAPIThreading, OverlayCasesShareBase_sscapi)
+{
+	ssc_data_t base = ssc_data_create();
+	pvwattsv5_inputs(base);
+	int n_base = 0;
+	for (const char *key = ssc_data_first(base); key; key = ssc_data_next(base)) n_base++;
+
+	const int n_cases = 4;
+	std::vector<ssc_data_t> cases(n_cases);
+	std::vector<ssc_number_t> expected(n_cases, 0.0);
+	for (int i = 0; i < n_cases; i++)
+	{
+		cases[i] = ssc_data_create_overlay(base);
+		ssc_data_set_number(cases[i], "tilt", 10.0 * i);
+
+		ssc_data_t full = ssc_data_create();
+		pvwattsv5_inputs(full);
+		ssc_data_set_number(full, "tilt", 10.0 * i);
+		ASSERT_TRUE(ssc_module_exec_simple("pvwattsv5", full));
+		ssc_data_get_number(full, "annual_energy", &expected[i]);
+		ssc_data_free(full);
+	}
+
+	EXPECT_EQ(ssc_module_exec_batch("pvwattsv5", &cases[0], n_cases, n_cases, 0, 0, 0), n_cases);
+
+	for (int i = 0; i < n_cases; i++)
+	{
+		ssc_number_t annual_energy = 0;
+		ssc_data_get_number(cases[i], "annual_energy", &annual_energy);
+		EXPECT_EQ(annual_energy, expected[i]) << "case " << i;
+		ssc_data_free(cases[i]);
+	}
+
+	int n_after = 0;
+	for (const char *key = ssc_data_first(base); key; key = ssc_data_next(base)) n_after++;
+	EXPECT_EQ(n_after, n_base);
+	ssc_number_t tilt = 0;
+	ssc_data_get_number(base, "tilt", &tilt);
+	EXPECT_EQ(tilt, 20);
+	ssc_data_free(base);
+}
+
+static void release_buffer(ssc_number_t *pvalues, void *user_data)
+{
+	delete[] pvalues;
+	(*static_cast<int*>(user_data))++;
+}
+
+/// Borrowed and owned buffers are used in place and released exactly once, and outputs can be taken without a copy
+TEST_F(SSCAPIThreading, ExternalArrays_sscapi)
+{
+	ssc_data_t data = ssc_data_create();
+	ssc_number_t borrowed[3] = { 1, 2, 3 };
+	ssc_data_set_array_external(data, "borrowed", borrowed, 3, 0, 0);
+	int len = 0;
+	EXPECT_EQ(ssc_data_get_array(data, "borrowed", &len), borrowed);
+	EXPECT_EQ(len, 3);
+
+	int n_released = 0;
+	ssc_number_t *owned = new ssc_number_t[6]{ 5, 2, 3, 9, 1, 4 };
+	ssc_data_set_matrix_external(data, "owned", owned, 2, 3, release_buffer, &n_released);
+	int nr = 0, nc = 0;
+	EXPECT_EQ(ssc_data_get_matrix(data, "owned", &nr, &nc), owned);
+	EXPECT_EQ(nr, 2);
+	EXPECT_EQ(nc, 3);
+
+	// reassigning releases the previous buffer
+	ssc_data_set_number(data, "owned", 1.0);
+	EXPECT_EQ(n_released, 1);
+
+	owned = new ssc_number_t[2]{ 4, 5 };
+	ssc_data_set_array_external(data, "owned", owned, 2, release_buffer, &n_released);
+	ssc_data_free(data);
+	EXPECT_EQ(n_released, 2);
+	EXPECT_EQ(borrowed[2], 3);
+
+	// outputs are moved out of the data object intact, and the variable is gone afterwards
+	std::vector<ssc_number_t> expected = run_pvwattsv5();
+	ASSERT_EQ(expected.size(), 8760);
+	data = ssc_data_create();
+	pvwattsv5_inputs(data);
+	ssc_module_t module = ssc_module_create("pvwattsv5");
+	ASSERT_TRUE(ssc_module_exec(module, data));
+	ssc_module_free(module);
+
+	int n_ac = 0;
+	ssc_number_t *ac = ssc_data_take_array(data, "ac", &n_ac);
+	ASSERT_TRUE(ac != 0);
+	EXPECT_EQ(n_ac, 8760);
+	EXPECT_EQ(memcmp(ac, &expected[0], expected.size() * sizeof(ssc_number_t)), 0);
+	EXPECT_TRUE(ssc_data_get_array(data, "ac", &n_ac) == 0);
+	EXPECT_TRUE(ssc_data_take_matrix(data, "annual_energy", &nr, &nc) == 0);
+	ssc_data_free_array(ac);
+	ssc_data_free(data);
+}
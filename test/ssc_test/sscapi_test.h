@@ -0,0 +1,96 @@
+#ifndef _SSCAPI_TEST_H_
+#define _SSCAPI_TEST_H_
+
+#include <gtest/gtest.h>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../ssc/core.h"
+#include "../ssc/sscapi.h"
+#include "../input_cases/code_generator_utilities.h"
+
+/**
+* SSCAPIThreading runs the same compute module on several threads at once through the public API,
+* and checks that every concurrent run reproduces the serial run exactly. Cases whose default inputs live in
+* another test file's input header run from that file through expect_concurrent_matches_serial.
+*/
+class SSCAPIThreading : public ::testing::Test {
+protected:
+	size_t n_threads = 8;
+
+	/// Fills in a small PVWattsV5 case that reads the Phoenix TMY2 file in the test inputs
+	static void pvwattsv5_inputs(ssc_data_t data)
+	{
+		char hourly[256];
+		sprintf(hourly, "%s/test/input_cases/pvsamv1_data/USA AZ Phoenix (TMY2).csv", SSCDIR);
+		ssc_data_set_number(data, "system_use_lifetime_output", 0);
+		ssc_data_set_number(data, "analysis_period", 25);
+		ssc_data_set_string(data, "solar_resource_file", hourly);
+		ssc_data_set_number(data, "system_capacity", 4);
+		ssc_data_set_number(data, "module_type", 0);
+		ssc_data_set_number(data, "dc_ac_ratio", 1.2);
+		ssc_data_set_number(data, "inv_eff", 96);
+		ssc_data_set_number(data, "losses", 14.07566);
+		ssc_data_set_number(data, "array_type", 0);
+		ssc_data_set_number(data, "tilt", 20);
+		ssc_data_set_number(data, "azimuth", 180);
+		ssc_data_set_number(data, "gcr", 0.4);
+		ssc_data_set_number(data, "adjust:constant", 0);
+	}
+
+	/// Fills in the inputs of one case
+	typedef void (*case_inputs)(ssc_data_t);
+
+	/// Runs a module on a fresh data object filled in by inputs and returns one output array, empty on failure
+	static std::vector<ssc_number_t> run_case(const char *module_name, case_inputs inputs, const char *output)
+	{
+		std::vector<ssc_number_t> values;
+		ssc_data_t data = ssc_data_create();
+		inputs(data);
+		ssc_module_t module = ssc_module_create(module_name);
+		if (module && ssc_module_exec(module, data))
+		{
+			int len = 0;
+			ssc_number_t *p = ssc_data_get_array(data, output, &len);
+			if (p) values.assign(p, p + len);
+		}
+		if (module) ssc_module_free(module);
+		ssc_data_free(data);
+		return values;
+	}
+
+	/// Runs pvwattsv5 on a fresh data object and returns the hourly ac output, empty on failure
+	static std::vector<ssc_number_t> run_pvwattsv5()
+	{
+		return run_case("pvwattsv5", pvwattsv5_inputs, "ac");
+	}
+
+	/// Runs a case serially, then on n_threads threads at once, and expects every concurrent output to match the serial one bit for bit
+	void expect_concurrent_matches_serial(const char *module_name, case_inputs inputs, const char *output, size_t expected_size)
+	{
+		std::vector<ssc_number_t> serial = run_case(module_name, inputs, output);
+		ASSERT_EQ(serial.size(), expected_size) << module_name;
+
+		std::vector<std::vector<ssc_number_t>> results(n_threads);
+		std::vector<std::thread> threads;
+		for (size_t i = 0; i < n_threads; i++)
+			threads.push_back(std::thread([&results, module_name, inputs, output, i]() { results[i] = run_case(module_name, inputs, output); }));
+		for (size_t i = 0; i < n_threads; i++)
+			threads[i].join();
+
+		for (size_t i = 0; i < n_threads; i++)
+		{
+			ASSERT_EQ(results[i].size(), serial.size()) << module_name << " thread " << i;
+			EXPECT_EQ(memcmp(&results[i][0], &serial[0], serial.size() * sizeof(ssc_number_t)), 0) << module_name << " thread " << i;
+		}
+	}
+
+	void SetUp()
+	{
+		ssc_module_exec_set_print(0);
+	}
+};
+
+#endif // _SSCAPI_TEST_H_
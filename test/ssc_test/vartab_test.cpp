@@ -0,0 +1,194 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "../ssc/core.h"
+#include "../ssc/vartab.h"
+
+static void fill_base(var_table &base)
+{
+	std::vector<ssc_number_t> profile(8760);
+	for (size_t i = 0; i < profile.size(); i++)
+		profile[i] = (ssc_number_t)i;
+	base.assign("profile", var_data(&profile[0], profile.size()));
+	base.assign("scalar", var_data((ssc_number_t)1.0));
+	base.assign("name", var_data(std::string("base")));
+}
+
+/// Lookups fall through to the parent, and writes stay in the layer
+TEST(VarTableOverlay, LookupAndAssign_vartab)
+{
+	var_table base;
+	fill_base(base);
+
+	var_table layer(&base);
+	EXPECT_EQ(layer.size(), 3);
+	ASSERT_TRUE(layer.lookup_const("profile") != 0);
+	EXPECT_EQ(layer.lookup_const("profile"), base.lookup_const("profile")); // shared, not copied
+	EXPECT_FALSE(layer.is_local("profile"));
+
+	layer.assign("scalar", var_data((ssc_number_t)2.0));
+	EXPECT_EQ(layer.lookup_const("scalar")->num.value(), 2.0);
+	EXPECT_EQ(base.lookup_const("scalar")->num.value(), 1.0);
+
+	// a writable lookup copies the entry into the layer
+	var_data *name = layer.lookup("NAME");
+	ASSERT_TRUE(name != 0);
+	name->str = "layer";
+	EXPECT_TRUE(layer.is_local("name"));
+	EXPECT_EQ(base.lookup_const("name")->str, "base");
+	EXPECT_EQ(layer.size(), 3);
+}
+
+/// Unassign and rename in a layer hide the parent entries without changing the parent
+TEST(VarTableOverlay, UnassignRenameIterate_vartab)
+{
+	var_table base;
+	fill_base(base);
+
+	var_table layer(&base);
+	layer.unassign("profile");
+	EXPECT_TRUE(layer.lookup("profile") == 0);
+	EXPECT_TRUE(base.lookup_const("profile") != 0);
+
+	EXPECT_TRUE(layer.rename("scalar", "scalar2"));
+	EXPECT_TRUE(layer.lookup_const("scalar") == 0);
+	EXPECT_EQ(layer.lookup_const("scalar2")->num.value(), 1.0);
+	EXPECT_TRUE(base.lookup_const("scalar") != 0);
+
+	layer.assign("profile", var_data((ssc_number_t)5.0));
+	EXPECT_EQ(layer.lookup_const("profile")->type, SSC_NUMBER);
+
+	std::vector<std::string> names;
+	for (const char *key = layer.first(); key != 0; key = layer.next())
+		names.push_back(key);
+	std::sort(names.begin(), names.end());
+	ASSERT_EQ(names.size(), 3);
+	EXPECT_EQ(names[0], "name");
+	EXPECT_EQ(names[1], "profile");
+	EXPECT_EQ(names[2], "scalar2");
+
+	// copying a layered table flattens it
+	var_table copy;
+	copy = layer;
+	EXPECT_TRUE(copy.parent() == 0);
+	EXPECT_EQ(copy.size(), 3);
+	EXPECT_EQ(copy.lookup("name")->str, "base");
+
+	layer.clear();
+	EXPECT_EQ(layer.size(), 0);
+	EXPECT_TRUE(layer.lookup("name") == 0);
+}
+
+/// A table with every type, including nested tables, reads back identically, with arrays mapped from the file
+TEST(VarTableBinary, RoundTrip_vartab)
+{
+	var_table tab;
+	fill_base(tab);
+	ssc_number_t mat[6] = { 5, 2, 3, 9, 1, 4 };
+	tab.assign("matrix", var_data(mat, 2, 3));
+	var_data *nested = tab.assign("nested", var_data());
+	nested->type = SSC_TABLE;
+	nested->table.assign("inner", var_data(std::string("text with, commas\nand a newline")));
+	nested->table.assign("values", var_data(mat, 6));
+
+	std::string file = "vartab_test.bin";
+	std::string err;
+	ASSERT_TRUE(tab.write_binary(file, &err)) << err;
+
+	var_table read;
+	ASSERT_TRUE(read.read_binary(file, &err)) << err;
+	EXPECT_EQ(read.size(), 5);
+	EXPECT_EQ(read.lookup("scalar")->num.value(), 1.0);
+	EXPECT_EQ(read.lookup("name")->str, "base");
+
+	var_data *profile = read.lookup("profile");
+	ASSERT_TRUE(profile != 0);
+	EXPECT_EQ(profile->type, SSC_ARRAY);
+	EXPECT_TRUE(profile->num.is_external());
+	ASSERT_EQ(profile->num.ncols(), 8760);
+	EXPECT_EQ(memcmp(profile->num.data(), tab.lookup("profile")->num.data(), 8760 * sizeof(ssc_number_t)), 0);
+
+	var_data *matrix = read.lookup("matrix");
+	ASSERT_TRUE(matrix != 0);
+	EXPECT_EQ(matrix->type, SSC_MATRIX);
+	EXPECT_EQ(matrix->num.nrows(), 2);
+	EXPECT_EQ(matrix->num.at(1, 0), 9);
+
+	var_data *table = read.lookup("nested");
+	ASSERT_TRUE(table != 0);
+	EXPECT_EQ(table->type, SSC_TABLE);
+	EXPECT_EQ(table->table.lookup("inner")->str, "text with, commas\nand a newline");
+	EXPECT_EQ(table->table.lookup("values")->num.at(5), 4);
+
+	// changing a mapped value changes only this table, not the file
+	profile->num.at(0) = -1;
+	var_table again;
+	ASSERT_TRUE(again.read_binary(file, &err)) << err;
+	EXPECT_EQ(again.lookup("profile")->num.at(0), 0);
+
+	// each mapped value keeps the file contents alive on its own
+	read.unassign("profile");
+	read.unassign("nested");
+	EXPECT_EQ(matrix->num.at(1, 2), 4);
+
+	remove(file.c_str());
+}
+
+/// Files that are not ssc data files, or are cut short, are rejected
+TEST(VarTableBinary, RejectsBadFiles_vartab)
+{
+	var_table tab;
+	fill_base(tab);
+	std::string file = "vartab_test_bad.bin";
+	std::string err;
+	ASSERT_TRUE(tab.write_binary(file, &err)) << err;
+
+	std::vector<char> bytes;
+	FILE *fp = fopen(file.c_str(), "rb");
+	ASSERT_TRUE(fp != 0);
+	for (int c = fgetc(fp); c != EOF; c = fgetc(fp)) bytes.push_back((char)c);
+	fclose(fp);
+
+	// cut short
+	fp = fopen(file.c_str(), "wb");
+	fwrite(&bytes[0], 1, bytes.size() / 2, fp);
+	fclose(fp);
+	var_table read;
+	EXPECT_FALSE(read.read_binary(file, &err));
+	EXPECT_FALSE(err.empty());
+	EXPECT_EQ(read.size(), 0);
+
+	// wrong magic
+	bytes[0] = 'X';
+	fp = fopen(file.c_str(), "wb");
+	fwrite(&bytes[0], 1, bytes.size(), fp);
+	fclose(fp);
+	EXPECT_FALSE(read.read_binary(file, &err));
+
+	EXPECT_FALSE(read.read_binary("no_such_file.bin", &err));
+
+	// an array cut short by one value, with the file size in the header still matching
+	var_table array_only;
+	std::vector<ssc_number_t> values(1000, 1.0);
+	array_only.assign("profile", var_data(&values[0], values.size()));
+	ASSERT_TRUE(array_only.write_binary(file, &err)) << err;
+	fp = fopen(file.c_str(), "rb");
+	ASSERT_TRUE(fp != 0);
+	bytes.clear();
+	for (int c = fgetc(fp); c != EOF; c = fgetc(fp)) bytes.push_back((char)c);
+	fclose(fp);
+	bytes.resize(bytes.size() - sizeof(ssc_number_t));
+	unsigned long long size = bytes.size();
+	memcpy(&bytes[16], &size, sizeof(size));
+	fp = fopen(file.c_str(), "wb");
+	fwrite(&bytes[0], 1, bytes.size(), fp);
+	fclose(fp);
+	err.clear();
+	EXPECT_FALSE(read.read_binary(file, &err));
+	EXPECT_FALSE(err.empty());
+	EXPECT_EQ(read.size(), 0);
+	remove(file.c_str());
+}